@@ -0,0 +1,63 @@
+#pragma once
+
+/**
+ * @brief A callback bound to an object and one of its methods at compile time.
+ *
+ * Callback<> stores the method pointer and calls it through a type erased thunk, so nothing about the target is known
+ * where it gets called. A Delegate's method is a template argument instead, which gets compiled into a small stub
+ * with a direct call to the method. Calling a Delegate is a single indirect call, and the method can be inlined into
+ * the stub. Meant for connections which are fixed at build time and sit on a hot path (ISRs), keep using Callback<>
+ * for anything which gets swapped out at runtime.
+ *
+ * Delegate<void(uint8_t pulse)> ppqnDelegate;
+ * ppqnDelegate = Delegate<void(uint8_t pulse)>::bind<GlobalControl, &GlobalControl::advanceSequencer>(&glblCtrl);
+ * if (ppqnDelegate) ppqnDelegate(pulse);
+ */
+template <typename F>
+class Delegate;
+
+template <typename R, typename... Args>
+class Delegate<R(Args...)>
+{
+public:
+    Delegate() : _obj(nullptr), _stub(nullptr) {}
+
+    template <typename T, R (T::*Method)(Args...)>
+    static Delegate bind(T *obj)
+    {
+        return Delegate(obj, &methodStub<T, Method>);
+    }
+
+    template <R (*Function)(Args...)>
+    static Delegate bind()
+    {
+        return Delegate(nullptr, &functionStub<Function>);
+    }
+
+    R operator()(Args... args) const
+    {
+        return _stub(_obj, args...);
+    }
+
+    explicit operator bool() const { return _stub != nullptr; }
+
+private:
+    typedef R (*Stub)(void *obj, Args... args);
+
+    void *_obj;
+    Stub _stub;
+
+    Delegate(void *obj, Stub stub) : _obj(obj), _stub(stub) {}
+
+    template <typename T, R (T::*Method)(Args...)>
+    static R methodStub(void *obj, Args... args)
+    {
+        return (static_cast<T *>(obj)->*Method)(args...);
+    }
+
+    template <R (*Function)(Args...)>
+    static R functionStub(void *obj, Args... args)
+    {
+        return Function(args...);
+    }
+};
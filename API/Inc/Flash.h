@@ -58,6 +58,7 @@ Example: Erase, Write, Read
 #include "Mutex.h"
 #include <string.h>
 #include "logger.h"
+#include "trace.h"
 
 /**
  * @brief static class for handling flash read, write, and erase methods
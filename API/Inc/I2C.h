@@ -4,6 +4,7 @@
 #include "logger.h"
 #include "Mutex.h"
 #include "gpio_api.h"
+#include "trace.h"
 
 class I2C {
 public:
@@ -3,6 +3,7 @@
 #include "common.h"
 #include "gpio_api.h"
 #include "Callback.h"
+#include "dwt_api.h"
 
 class InterruptIn {
 public:
@@ -16,6 +17,11 @@ public:
     Callback<void()> riseCallback;
     Callback<void()> fallCallback;
 
+    uint32_t _debounce;     // minimum number of cycles between dispatched edges (0 == disabled)
+    uint32_t _lastEdge;     // DWT cycle count of the last dispatched edge
+    uint32_t _dropped;      // number of edges ignored by the debouncer
+    volatile bool _deferred; // an edge landed inside the debounce window and got dispatched early, see handleInterupt()
+
     InterruptIn(PinName pin)
     {
         _pin = pin;
@@ -35,9 +41,14 @@ public:
     void mode(PinMode mode);
     void rise(Callback<void()> func);
     void fall(Callback<void()> func);
+    void debounce(uint32_t us);
+    uint32_t getLastEdge() { return _lastEdge; }
+    uint32_t getDroppedCount() { return _dropped; }
+    uint32_t getDebounceRemaining();
     void gpio_irq_init(PinName pin);
     static void RouteCallback(uint16_t GPIO_Pin);
 
 private:
+    // indexed by EXTI line (ie. pin number). Only one port can own a given EXTI line at a time.
     static InterruptIn *_instances[NUM_GPIO_IRQ_INSTANCES];
 };
\ No newline at end of file
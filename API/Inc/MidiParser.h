@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * MIDI 1.0 byte stream parser.
+ *
+ * Feed it every byte received over the wire, one at a time. It hands back a message once one is complete, handling
+ * running status (status byte left out when it is the same as the previous message), real-time bytes interleaved with
+ * other messages, and skipping over sysex. Has no dependencies on the HAL or the RTOS, so it can be compiled and tested
+ * on the host as is (`make test`, see API/Test/midi_parser_test.cpp).
+ *
+ *   MidiParser parser;
+ *   MidiMessage msg;
+ *   if (parser.parse(byte, &msg)) { ... }
+ */
+
+#define MIDI_NOTE_OFF         0x80
+#define MIDI_NOTE_ON          0x90
+#define MIDI_POLY_PRESSURE    0xA0
+#define MIDI_CONTROL_CHANGE   0xB0
+#define MIDI_PROGRAM_CHANGE   0xC0
+#define MIDI_CHANNEL_PRESSURE 0xD0
+#define MIDI_PITCH_BEND       0xE0
+
+#define MIDI_SYSEX_START      0xF0
+#define MIDI_TIME_CODE        0xF1
+#define MIDI_SONG_POSITION    0xF2
+#define MIDI_SONG_SELECT      0xF3
+#define MIDI_TUNE_REQUEST     0xF6
+#define MIDI_SYSEX_END        0xF7
+#define MIDI_CLOCK            0xF8
+#define MIDI_START            0xFA
+#define MIDI_CONTINUE         0xFB
+#define MIDI_STOP             0xFC
+#define MIDI_ACTIVE_SENSING   0xFE
+#define MIDI_RESET            0xFF
+
+typedef struct MidiMessage
+{
+    uint8_t status; // status byte, including the channel for channel messages
+    uint8_t data1;
+    uint8_t data2;
+
+    uint8_t type() const { return status < MIDI_SYSEX_START ? status & 0xF0 : status; }
+    uint8_t channel() const { return status & 0x0F; }
+    bool isRealTime() const { return status >= MIDI_CLOCK; }
+} MidiMessage;
+
+class MidiParser
+{
+public:
+    MidiParser() { reset(); }
+
+    bool parse(uint8_t byte, MidiMessage *msg);
+    void reset();
+
+    static int dataLength(uint8_t status);
+
+private:
+    uint8_t runningStatus; // 0 when there is none (after power up, sysex or a system common message)
+    uint8_t data[2];
+    uint8_t dataCount;
+    bool sysex;
+};
@@ -3,6 +3,7 @@
 #include "common.h"
 #include "DigitalOut.h"
 #include "Mutex.h"
+#include "trace.h"
 
 class SPI {
 public:
@@ -18,9 +19,13 @@ public:
     void init();
 
     void write(uint8_t *data, int length);
+    void writeFrames(uint8_t *data, int frameLength, int frames);
 
+    void initDMA();
     void mode(int mode);
 
+    static void RouteTxCompleteCallback(SPI_HandleTypeDef *hspi);
+
 private:
     PinName _mosi;
     PinName _miso;
@@ -34,4 +39,16 @@ private:
 
     SPI_HandleTypeDef _hspi;
     static Mutex _mutex;
-};
\ No newline at end of file
+
+    // DMA frame transfers (see writeFrames())
+    uint8_t *_frameData;
+    int _frameLength;
+    volatile int _framesRemaining;
+    SemaphoreHandle_t _txComplete;
+    StaticSemaphore_t _txCompleteBuffer;
+    static SPI *_dmaInstance; // only one instance can own the SPI2 TX DMA stream
+
+    void handleTxComplete();
+};
+
+extern "C" void DMA1_Stream4_IRQHandler(void);
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "cmsis_os.h"
+
+/**
+ * @brief Publishes a small struct from one task so any other task (or ISR) can read a consistent copy of it without
+ * blocking.
+ *
+ * The writer bumps the sequence to an odd number, copies the data in, then bumps it to an even number again. A reader
+ * copies the data out between two reads of the sequence and starts over if the sequence was odd or changed in the
+ * meantime, which only happens when a write preempted the read. Readers never take a lock or wait on the writer.
+ *
+ * Writes happen inside a critical section so writers in different tasks can't interleave, which is fine as long as T
+ * stays a few words. Must not be written from an ISR.
+ *
+ * T must be trivially copyable.
+ */
+template <typename T>
+class Seqlock
+{
+public:
+    Seqlock() : _sequence(0), _data() {}
+
+    void write(const T &data)
+    {
+        taskENTER_CRITICAL();
+        uint32_t sequence = __atomic_load_n(&_sequence, __ATOMIC_RELAXED);
+        __atomic_store_n(&_sequence, sequence + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        _data = data;
+        __atomic_store_n(&_sequence, sequence + 2, __ATOMIC_RELEASE);
+        taskEXIT_CRITICAL();
+    }
+
+    T read() const
+    {
+        T data;
+        uint32_t before;
+        uint32_t after;
+        do
+        {
+            before = __atomic_load_n(&_sequence, __ATOMIC_ACQUIRE);
+            data = _data;
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            after = __atomic_load_n(&_sequence, __ATOMIC_RELAXED);
+        } while ((before & 1) || before != after);
+        return data;
+    }
+
+    /**
+     * @brief incremented twice by every write, so a reader can tell whether anything was published since it last looked
+     */
+    uint32_t version() const { return __atomic_load_n(&_sequence, __ATOMIC_ACQUIRE); }
+
+private:
+    volatile uint32_t _sequence;
+    T _data; // only touched between the atomic sequence accesses, which keep the compiler from caching it
+};
@@ -4,6 +4,8 @@
 #include "logger.h"
 #include "tim_api.h"
 #include "Callback.h"
+#include "Delegate.h"
+#include "trace.h"
 #include "Algorithms.h"
 
 #ifndef PPQN
@@ -19,6 +21,9 @@
 #define MAX_TICKS_PER_PULSE 34299  // (40 BPM)  MAX TIM4 tickers per pulse
 #define MIN_TICKS_PER_PULSE 5716   // (240 BPM) MIN TIM4 tickers per pulse
 
+#define MIDI_CLOCK_PPQN 24
+#define PULSES_PER_MIDI_CLOCK (PPQN / MIDI_CLOCK_PPQN)
+
 extern TIM_HandleTypeDef htim2; // 32-bit timer
 extern TIM_HandleTypeDef htim4; // 16-bit timer
 
@@ -32,11 +37,17 @@ public:
     uint16_t ticksPerStep;  // how many TIM2 ticks per one step / quarter note
     uint16_t ticksPerPulse; // how many TIM2 ticks for one PPQN
     bool externalInputMode;
+    bool midiClockMode;     // following MIDI clock, set by a MIDI start / continue
+    bool midiRunning;       // between a MIDI start / continue and a MIDI stop
+    uint8_t midiClock;      // MIDI clocks received since the start of the current quarter note
+    bool midiClockStarted;  // no MIDI clock received since start, the next one is the first pulse of the sequence
+    bool midiClockTimed;    // at least one MIDI clock received, so TIM2 holds the time since the last one
 
     Callback<void()> tickCallback;           // this callback gets executed at a frequency equal to tim1_freq
-    Callback<void()> input_capture_callback; // this callback gets executed every on the rising edge of external input
-    Callback<void(uint8_t pulse)> ppqnCallback; // this callback gets executed at a rate equal to input capture / PPQN. It passes the current tick values as arguments
-    Callback<void(uint8_t pulse)> resetCallback;
+    // called from the timer ISRs, bound at compile time (see Delegate.h)
+    Delegate<void()> input_capture_callback; // this callback gets executed every on the rising edge of external input
+    Delegate<void(uint8_t pulse)> ppqnCallback; // this callback gets executed at a rate equal to input capture / PPQN. It passes the current tick values as arguments
+    Delegate<void(uint8_t pulse)> resetCallback;
     Callback<void()> overflowCallback;       // callback executes when all when a full step completes
 
     /**
@@ -48,6 +59,12 @@ public:
         instance = this;
         ticksPerStep = 11129;
         ticksPerPulse = ticksPerStep / PPQN;
+        externalInputMode = false;
+        midiClockMode = false;
+        midiRunning = false;
+        midiClock = 0;
+        midiClockStarted = false;
+        midiClockTimed = false;
     };
 
     void init();
@@ -60,10 +77,17 @@ public:
     void enableInputCaptureISR();
     void disableInputCaptureISR();
 
+    // MIDI clock sync, called from the MIDI receive ISR
+    void handleMidiClock();
+    void handleMidiStart();
+    void handleMidiContinue();
+    void handleMidiStop();
+    void disableMidiClock();
+
     // Callback Setters
-    void attachInputCaptureCallback(Callback<void()> func);
-    void attachPPQNCallback(Callback<void(uint8_t pulse)> func);
-    void attachResetCallback(Callback<void(uint8_t pulse)> func);
+    void attachInputCaptureCallback(Delegate<void()> func);
+    void attachPPQNCallback(Delegate<void(uint8_t pulse)> func);
+    void attachResetCallback(Delegate<void(uint8_t pulse)> func);
     
     // Low Level HAL interupt handlers
     void handleInputCaptureCallback();
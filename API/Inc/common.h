@@ -37,4 +37,5 @@
 #define HIGH 1
 #define LOW 0
 
+#define BIT_MAX_12 4095
 #define BIT_MAX_16 65535
\ No newline at end of file
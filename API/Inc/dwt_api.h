@@ -0,0 +1,18 @@
+#pragma once
+
+#include "common.h"
+
+/**
+ * @brief Thin wrapper around the Cortex-M4 DWT cycle counter.
+ * CYCCNT increments once per core clock (180MHz) and wraps roughly every 23.8 seconds, so
+ * only ever compare timestamps via unsigned subtraction ie. (now - then) < interval
+ */
+
+void dwt_init();
+uint32_t dwt_us_to_cycles(uint32_t us);
+uint32_t dwt_cycles_to_us(uint32_t cycles);
+
+static inline uint32_t dwt_get_cycles()
+{
+    return DWT->CYCCNT;
+}
@@ -11,6 +11,59 @@
 #define OK_UART_TX (PinName) PC_10
 #endif
 
+#define LOGGER_BUFFER_SIZE 2048 // must be a power of 2
+#define LOGGER_TX_BUFFER_SIZE 128 // text the logger task formats for each DMA transfer
+#define LOGGER_WRITE_TIMEOUT 500  // ms a task waits for room in a full log ring before dropping its message
+#define LOGGER_SPACE_POLL_PERIOD 5 // ms between checks for room while waiting
+#define LOGGER_ISR_PRIORITY (RTOS_ISR_DEFAULT_PRIORITY + 4) // log output is the least urgent thing in the system
+
+// #define LOGGER_TOKENIZED              // send LOG() format strings as 16-bit tokens. Decode output with log-decode.py
+#define LOGGER_TOKEN_MARKER 0x01         // first byte of a tokenized frame (never appears in plain text output)
+#define LOGGER_TOKEN_FRAME_SIZE 64       // max encoded size of one tokenized message
+#define LOGGER_TOKEN_MAX_STRING_ARG 32   // %s arguments get truncated to this many bytes in tokenized frames
+
+/**
+ * LOG("format %d", args...)
+ *
+ * printf style logging. Supported conversions are %d %i %u %x %f %s and %%. Flags / width are accepted but ignored
+ * on the device. Arguments get encoded by their type, so each one must match its conversion: signed integers for
+ * %d %i, unsigned integers for %u %x, float / double for %f and strings for %s. A mismatch (or the wrong number of
+ * arguments) fails to compile, see log_format_matches().
+ *
+ * With LOGGER_TOKENIZED defined, the format string is placed in the .log_strings section, which is kept in the ELF but
+ * never loaded into flash, and its offset in that section becomes a 16-bit token known at link time. Only the token and
+ * the arguments get sent over the wire:
+ *
+ *   [LOGGER_TOKEN_MARKER] [token lo] [token hi] [arg] [arg] ...
+ *
+ * %d %i         -> zigzag varint
+ * %u %x         -> varint
+ * %f            -> 4 byte little endian float
+ * %s            -> varint length + bytes
+ *
+ * Without LOGGER_TOKENIZED, LOG() sends plain text. Numbers get queued as raw values (like logger_log(int) and
+ * friends do) and TASK_logger turns them into text, so the caller never pays for the formatting.
+ */
+#define LOG_CHECK_FORMAT(fmt, ...) \
+    static_assert(log_format_matches(fmt, decltype(log_arg_types(__VA_ARGS__))()), "LOG() arguments don't match the format")
+
+#ifdef LOGGER_TOKENIZED
+#define LOG(fmt, ...)                                                                                  \
+    do                                                                                                 \
+    {                                                                                                  \
+        LOG_CHECK_FORMAT(fmt, ##__VA_ARGS__);                                                          \
+        static const char _log_fmt[] __attribute__((section(".log_strings"), used)) = fmt;             \
+        logger_log_token((uint16_t)(uintptr_t)_log_fmt, ##__VA_ARGS__);                                \
+    } while (0)
+#else
+#define LOG(fmt, ...)                                                                                  \
+    do                                                                                                 \
+    {                                                                                                  \
+        LOG_CHECK_FORMAT(fmt, ##__VA_ARGS__);                                                          \
+        logger_logf(fmt, ##__VA_ARGS__);                                                               \
+    } while (0)
+#endif
+
 void logger_init();
 
 void logger_log(char const *str);
@@ -29,6 +82,154 @@ void logger_log_err(char const *func_name, HAL_StatusTypeDef error);
 
 void uart_transmit(uint8_t *data);
 
+void logger_write(const uint8_t *data, uint32_t length);
+
+uint32_t logger_get_dropped_bytes();
+
+/* ---- compile time format check ---- */
+
+// the kind of conversion each argument type gets encoded as, picked by the same overloads as log_encode_arg()
+constexpr char log_arg_kind(long) { return 'd'; }
+constexpr char log_arg_kind(int) { return 'd'; }
+constexpr char log_arg_kind(int16_t) { return 'd'; }
+constexpr char log_arg_kind(int8_t) { return 'd'; }
+constexpr char log_arg_kind(unsigned long) { return 'u'; }
+constexpr char log_arg_kind(unsigned int) { return 'u'; }
+constexpr char log_arg_kind(uint16_t) { return 'u'; }
+constexpr char log_arg_kind(uint8_t) { return 'u'; }
+constexpr char log_arg_kind(float) { return 'f'; }
+constexpr char log_arg_kind(double) { return 'f'; }
+constexpr char log_arg_kind(const char *) { return 's'; }
+constexpr char log_arg_kind(char *) { return 's'; }
+
+constexpr char log_conversion_kind(char conversion)
+{
+    return (conversion == 'd' || conversion == 'i') ? 'd'
+         : (conversion == 'u' || conversion == 'x') ? 'u'
+         : (conversion == 'f' || conversion == 's') ? conversion
+         : 0;
+}
+
+constexpr bool log_format_flag(char c)
+{
+    return c == '-' || c == '+' || c == ' ' || c == '#' || c == '.' || c == 'l' || (c >= '0' && c <= '9');
+}
+
+/**
+ * @brief walk the format the same way logger_logf_next() / log-decode.py do, checking each conversion against the
+ * kind of argument it gets
+ *
+ * @param kinds log_arg_kind() of every argument, 0 terminated
+ */
+constexpr bool log_format_matches(const char *fmt, const char *kinds)
+{
+    while (*fmt)
+    {
+        if (*fmt++ != '%')
+            continue;
+        if (*fmt == '%')
+        {
+            fmt++;
+            continue;
+        }
+        while (*fmt && log_format_flag(*fmt))
+            fmt++;
+        char kind = log_conversion_kind(*fmt);
+        if (kind == 0 || *kinds != kind)
+            return false;
+        kinds++;
+        fmt++;
+    }
+    return *kinds == 0;
+}
+
+template <typename... Args>
+struct LogArgTypes
+{
+};
+
+// only ever used inside decltype(), takes the arguments by value so arrays and const decay like they do for the encoder
+template <typename... Args>
+LogArgTypes<Args...> log_arg_types(Args...);
+
+template <typename... Args>
+constexpr bool log_format_matches(const char *fmt, LogArgTypes<Args...>)
+{
+    const char kinds[] = {log_arg_kind(Args())..., 0};
+    return log_format_matches(fmt, kinds);
+}
+
+/* ---- tokenized logging ---- */
+
+void log_encode_arg(uint8_t **buf, const uint8_t *end, long value);
+void log_encode_arg(uint8_t **buf, const uint8_t *end, unsigned long value);
+void log_encode_arg(uint8_t **buf, const uint8_t *end, float value);
+void log_encode_arg(uint8_t **buf, const uint8_t *end, const char *str);
+inline void log_encode_arg(uint8_t **buf, const uint8_t *end, int value) { log_encode_arg(buf, end, (long)value); }
+inline void log_encode_arg(uint8_t **buf, const uint8_t *end, int16_t value) { log_encode_arg(buf, end, (long)value); }
+inline void log_encode_arg(uint8_t **buf, const uint8_t *end, int8_t value) { log_encode_arg(buf, end, (long)value); }
+inline void log_encode_arg(uint8_t **buf, const uint8_t *end, unsigned int value) { log_encode_arg(buf, end, (unsigned long)value); }
+inline void log_encode_arg(uint8_t **buf, const uint8_t *end, uint16_t value) { log_encode_arg(buf, end, (unsigned long)value); }
+inline void log_encode_arg(uint8_t **buf, const uint8_t *end, uint8_t value) { log_encode_arg(buf, end, (unsigned long)value); }
+inline void log_encode_arg(uint8_t **buf, const uint8_t *end, double value) { log_encode_arg(buf, end, (float)value); }
+inline void log_encode_arg(uint8_t **buf, const uint8_t *end, char *str) { log_encode_arg(buf, end, (const char *)str); }
+
+inline void log_encode_args(uint8_t **buf, const uint8_t *end) {}
+
+template <typename T, typename... Args>
+void log_encode_args(uint8_t **buf, const uint8_t *end, T arg, Args... args)
+{
+    log_encode_arg(buf, end, arg);
+    log_encode_args(buf, end, args...);
+}
+
+/**
+ * @brief encode a token and its arguments into a single frame and write it to the log ring in one go
+ */
+template <typename... Args>
+void logger_log_token(uint16_t token, Args... args)
+{
+    uint8_t frame[LOGGER_TOKEN_FRAME_SIZE];
+    uint8_t *buf = frame;
+    *buf++ = LOGGER_TOKEN_MARKER;
+    *buf++ = token & 0xFF;
+    *buf++ = token >> 8;
+    log_encode_args(&buf, frame + LOGGER_TOKEN_FRAME_SIZE, args...);
+    logger_write(frame, buf - frame);
+}
+
+/* ---- plain text formatting (LOGGER_TOKENIZED not defined) ---- */
+
+const char *logger_logf_next(const char *fmt, char *conversion);
+
+void logger_logf_arg(char conversion, long value);
+void logger_logf_arg(char conversion, unsigned long value);
+void logger_logf_arg(char conversion, float value);
+void logger_logf_arg(char conversion, const char *str);
+inline void logger_logf_arg(char conversion, int value) { logger_logf_arg(conversion, (long)value); }
+inline void logger_logf_arg(char conversion, int16_t value) { logger_logf_arg(conversion, (long)value); }
+inline void logger_logf_arg(char conversion, int8_t value) { logger_logf_arg(conversion, (long)value); }
+inline void logger_logf_arg(char conversion, unsigned int value) { logger_logf_arg(conversion, (unsigned long)value); }
+inline void logger_logf_arg(char conversion, uint16_t value) { logger_logf_arg(conversion, (unsigned long)value); }
+inline void logger_logf_arg(char conversion, uint8_t value) { logger_logf_arg(conversion, (unsigned long)value); }
+inline void logger_logf_arg(char conversion, double value) { logger_logf_arg(conversion, (float)value); }
+inline void logger_logf_arg(char conversion, char *str) { logger_logf_arg(conversion, (const char *)str); }
+
+inline void logger_logf(const char *fmt)
+{
+    char conversion;
+    logger_logf_next(fmt, &conversion); // write out the remaining literal text
+}
+
+template <typename T, typename... Args>
+void logger_logf(const char *fmt, T arg, Args... args)
+{
+    char conversion;
+    fmt = logger_logf_next(fmt, &conversion);
+    logger_logf_arg(conversion, arg);
+    logger_logf(fmt, args...);
+}
+
 template <typename T>
 void logger_log_arr(T arr[], int length)
 {
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "common.h"
+#include "cmsis_os.h"
+#include "Delegate.h"
+#include "MidiParser.h"
+
+#ifndef MIDI_UART_TX
+#define MIDI_UART_TX (PinName) PA_9
+#endif
+
+#ifndef MIDI_UART_RX
+#define MIDI_UART_RX (PinName) PA_10
+#endif
+
+#define MIDI_BAUD_RATE 31250
+#define MIDI_RX_DMA_SIZE 16   // received bytes get parsed at least every MIDI_RX_DMA_SIZE / 2 bytes (2.5ms), or sooner if the line goes idle
+#define MIDI_TX_BUFFER_SIZE 256 // must be a power of 2
+#define MIDI_ISR_PRIORITY RTOS_ISR_DEFAULT_PRIORITY // same as the clock timers, so MIDI clock and TIM4 never preempt each other
+#define MIDI_DEFAULT_VELOCITY 100
+
+/**
+ * MIDI in / out on USART1.
+ *
+ * RX: DMA writes every received byte into a small circular buffer. The line going idle, or the buffer being half / all
+ * the way full, interrupts and the new bytes get parsed (see MidiParser) right there in the ISR. Every complete message is
+ * passed to the receive delegate, still in the ISR, so MIDI clock gets handled without waiting on a task.
+ *
+ * TX: messages are copied into a ring buffer which DMA drains in the background, same as the logger. Consecutive
+ * messages with the same status byte get sent using running status, and note offs go out as note ons with velocity 0 so
+ * they can share it too.
+ */
+
+void midi_init();
+void midi_attach_receive(Delegate<void(MidiMessage msg)> func);
+
+void midi_send_note_on(uint8_t channel, uint8_t note, uint8_t velocity);
+void midi_send_note_off(uint8_t channel, uint8_t note);
+void midi_send_realtime(uint8_t status);
+
+uint32_t midi_get_dropped_bytes();
+
+extern "C" void USART1_IRQHandler(void);
+extern "C" void DMA2_Stream2_IRQHandler(void);
+extern "C" void DMA2_Stream7_IRQHandler(void);
@@ -0,0 +1,186 @@
+/**
+ * @file trace.h
+ * @brief Lightweight binary event trace recorder.
+ *
+ * Records are written to a RAM ring buffer from both tasks and ISRs, with the oldest records getting overwritten.
+ * Each record is 8 bytes: | timestamp (DWT cycles, 32-bit) | event id (16-bit) | arg (16-bit) |
+ *
+ * Call trace_dump() to print the buffer over the UART, then run trace-decode.py against the captured serial output
+ * to get a timeline.
+ *
+ * Defining TRACE_IO_ENABLED records every input to the module (clock, touch pads, buttons, degree switches, benders, CV,
+ * tempo pot), every event the buttons / MIDI hand the sequencer, and every output (DAC writes, gate edges) instead. A
+ * capture starts from a sequencer reset and stops once the buffer is full (trace_start_oneshot()). Only every
+ * TRACE_CLOCK_DIVIDER'th clock pulse gets recorded (plus the first one of a capture), so the clock doesn't eat the
+ * buffer. `make replay` builds a host program which plays a capture back into the channels and dumps the outputs they
+ * produce, see Degree/Test/trace_replay.cpp and trace-decode.py --golden.
+ *
+ * NOTE: this header gets included by FreeRTOSConfig.h, so it must stay C compatible.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "stm32f4xx.h"
+
+// #define TRACE_ENABLED
+// #define TRACE_IO_ENABLED
+
+#if defined(TRACE_ENABLED) || defined(TRACE_IO_ENABLED)
+#define TRACE_RECORDING // the trace buffer only exists when something records into it
+#endif
+
+#ifndef TRACE_BUFFER_SIZE
+#ifdef TRACE_IO_ENABLED
+#define TRACE_BUFFER_SIZE 2048 // number of records. Must be a power of 2
+#else
+#define TRACE_BUFFER_SIZE 256 // number of records. Must be a power of 2
+#endif
+#endif
+#define TRACE_MAX_QUEUES  8
+#define TRACE_CLOCK_DIVIDER 24 // record every 24th clock pulse (16th notes at 96 PPQN)
+
+enum TraceEvent
+{
+    TRACE_NONE = 0,
+    TRACE_TASK_SWITCHED_IN,     // arg = task number
+    TRACE_TASK_CREATE,          // arg = task number
+    TRACE_QUEUE_SEND,           // arg = queue number
+    TRACE_QUEUE_SEND_FROM_ISR,  // arg = queue number
+    TRACE_QUEUE_SEND_FAILED,    // arg = queue number
+    TRACE_QUEUE_RECEIVE,        // arg = queue number
+    TRACE_QUEUE_RECEIVE_FAILED, // arg = queue number
+    TRACE_CLOCK_PULSE,          // arg = pulse
+    TRACE_CLOCK_INPUT_CAPTURE,  // arg = pulse at time of capture
+    TRACE_SEQ_EVENT,            // arg = channel << 8 | action
+    TRACE_I2C_BEGIN,            // arg = device address
+    TRACE_I2C_END,              // arg = HAL status
+    TRACE_SPI_BEGIN,            // arg = length
+    TRACE_SPI_END,              // arg = HAL status
+    TRACE_FLASH_BEGIN,          // arg = sector
+    TRACE_FLASH_END,            // arg = HAL status
+    TRACE_INPUT_BUTTONS,        // arg = button states
+    TRACE_INPUT_TOUCH,          // arg = channel << 8 | touched << 7 | pad
+    TRACE_INPUT_SELECT,         // arg = channel select pads touched
+    TRACE_INPUT_DEGREES,        // arg = degree switch states (raw MCP23017 read)
+    TRACE_INPUT_TEMPO,          // arg = tempo pot ADC value
+    TRACE_INPUT_BENDER,         // + channel (4 ids), arg = bend
+    TRACE_INPUT_CV = TRACE_INPUT_BENDER + 4,    // + channel, arg = CV ADC value
+    TRACE_OUTPUT_1VO = TRACE_INPUT_CV + 4,      // + DAC channel, arg = DAC value
+    TRACE_OUTPUT_BEND = TRACE_OUTPUT_1VO + 4,   // + DAC channel, arg = DAC value
+    TRACE_OUTPUT_GATE = TRACE_OUTPUT_BEND + 4,  // arg = channel << 8 | state
+    TRACE_SEQ_DATA,             // arg = data of the TRACE_SEQ_EVENT recorded right before it
+    TRACE_USER                  // first id available for ad-hoc events
+};
+
+#define TRACE_ANALOG_INPUTS (TRACE_OUTPUT_1VO - TRACE_INPUT_TEMPO) // inputs traced with trace_record_analog()
+#define TRACE_ANALOG_THRESHOLD 64 // how far a bender / CV input has to move before it gets recorded again
+
+typedef struct TraceRecord
+{
+    uint32_t timestamp;
+    uint16_t event;
+    uint16_t arg;
+} TraceRecord;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+extern volatile uint16_t trace_queue_peak[TRACE_MAX_QUEUES + 1]; // deepest each registered queue has been, by queue number
+
+#ifdef TRACE_RECORDING
+extern volatile uint32_t trace_head;
+extern volatile uint8_t trace_active;
+extern volatile uint8_t trace_oneshot;
+extern volatile uint8_t trace_clock_sync;
+extern TraceRecord trace_buffer[TRACE_BUFFER_SIZE];
+
+void trace_start(void);
+void trace_stop(void);
+void trace_clear(void);
+void trace_start_oneshot(void);
+void trace_record_analog(uint16_t event, uint16_t value, uint16_t threshold);
+
+/**
+ * @brief add a record to the trace buffer. Safe to call from tasks and ISRs.
+ */
+static inline void trace_record(uint16_t event, uint16_t arg)
+{
+    if (!trace_active)
+        return;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (trace_oneshot && trace_head >= TRACE_BUFFER_SIZE)
+    {
+        __set_PRIMASK(primask);
+        return;
+    }
+    TraceRecord *record = &trace_buffer[trace_head & (TRACE_BUFFER_SIZE - 1)];
+    trace_head = trace_head + 1;
+    record->timestamp = DWT->CYCCNT;
+    record->event = event;
+    record->arg = arg;
+    __set_PRIMASK(primask);
+}
+#endif
+
+/**
+ * @brief keep track of how deep a queue has been. Called by the kernel on every send (see traceQUEUE_SEND below), only
+ * queues given a number by trace_register_queue() are tracked
+ */
+static inline void trace_queue_depth(uint32_t queue, uint32_t depth)
+{
+    if (queue != 0 && queue <= TRACE_MAX_QUEUES && depth > trace_queue_peak[queue])
+        trace_queue_peak[queue] = (uint16_t)depth;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef TRACE_ENABLED
+#define TRACE(event, arg) trace_record((event), (uint16_t)(arg))
+#else
+#define TRACE(event, arg)
+#endif
+
+// inputs and outputs also show up in a full trace, next to the scheduling events
+#ifdef TRACE_RECORDING
+#define TRACE_IO(event, arg) trace_record((event), (uint16_t)(arg))
+#define TRACE_IO_ANALOG(event, value, threshold) trace_record_analog((event), (uint16_t)(value), (threshold))
+#define TRACE_IO_CLOCK(pulse) \
+    do { if ((pulse) % TRACE_CLOCK_DIVIDER == 0 || trace_clock_sync) { trace_clock_sync = 0; trace_record(TRACE_CLOCK_PULSE, (uint16_t)(pulse)); } } while (0)
+#else
+#define TRACE_IO(event, arg)
+#define TRACE_IO_ANALOG(event, value, threshold)
+#define TRACE_IO_CLOCK(pulse)
+#endif
+
+/* FreeRTOS trace macros. See https://www.freertos.org/rtos-trace-macros.html */
+// queue sends are always hooked, for the peak depths reported by the memory telemetry. The item hasn't been copied in yet
+#define traceQUEUE_SEND(pxQueue) \
+    do { TRACE(TRACE_QUEUE_SEND, (pxQueue)->uxQueueNumber); trace_queue_depth((pxQueue)->uxQueueNumber, (pxQueue)->uxMessagesWaiting + 1); } while (0)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue) \
+    do { TRACE(TRACE_QUEUE_SEND_FROM_ISR, (pxQueue)->uxQueueNumber); trace_queue_depth((pxQueue)->uxQueueNumber, (pxQueue)->uxMessagesWaiting + 1); } while (0)
+
+#ifdef TRACE_ENABLED
+#define traceTASK_SWITCHED_IN()                TRACE(TRACE_TASK_SWITCHED_IN, pxCurrentTCB->uxTCBNumber)
+#define traceTASK_CREATE(pxNewTCB)             TRACE(TRACE_TASK_CREATE, (pxNewTCB)->uxTCBNumber)
+#define traceQUEUE_SEND_FAILED(pxQueue)        TRACE(TRACE_QUEUE_SEND_FAILED, (pxQueue)->uxQueueNumber)
+#define traceQUEUE_SEND_FROM_ISR_FAILED(pxQueue) TRACE(TRACE_QUEUE_SEND_FAILED, (pxQueue)->uxQueueNumber)
+#define traceQUEUE_RECEIVE(pxQueue)            TRACE(TRACE_QUEUE_RECEIVE, (pxQueue)->uxQueueNumber)
+#define traceQUEUE_RECEIVE_FAILED(pxQueue)     TRACE(TRACE_QUEUE_RECEIVE_FAILED, (pxQueue)->uxQueueNumber)
+#endif
+
+#ifdef __cplusplus
+struct QueueDefinition; // QueueHandle_t (this header gets included before queue.h)
+
+void trace_register_queue(struct QueueDefinition *queue, const char *name);
+struct QueueDefinition *trace_get_queue(int number);
+const char *trace_get_queue_name(int number);
+#ifdef TRACE_RECORDING
+void trace_dump();
+#endif
+#endif
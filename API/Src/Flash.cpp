@@ -67,7 +67,9 @@ HAL_StatusTypeDef Flash::erase(uint32_t address)
     eraseConfig.Sector = this->getSector(address);
     eraseConfig.NbSectors = 1;
     eraseConfig.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+    TRACE(TRACE_FLASH_BEGIN, eraseConfig.Sector);
     status = HAL_FLASHEx_Erase(&eraseConfig, &sectorError);
+    TRACE(TRACE_FLASH_END, status);
     if (status != HAL_OK)
     {
         flashError = HAL_FLASH_GetError();
@@ -114,6 +116,7 @@ HAL_StatusTypeDef Flash::write(uint32_t address, uint32_t *data, int size)
     __HAL_FLASH_INSTRUCTION_CACHE_ENABLE();
     __HAL_FLASH_DATA_CACHE_ENABLE();
 
+    TRACE(TRACE_FLASH_BEGIN, this->getSector(address));
     while ((size > 0) && (flashError == 0))
     {
         if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, address, (uint64_t)*data) != HAL_OK)
@@ -125,6 +128,7 @@ HAL_StatusTypeDef Flash::write(uint32_t address, uint32_t *data, int size)
             data++;
         }
     }
+    TRACE(TRACE_FLASH_END, flashError);
 
     status = this->lock();
     if (status != HAL_OK)
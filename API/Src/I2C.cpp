@@ -64,12 +64,18 @@ HAL_StatusTypeDef I2C::write(int address, uint8_t *data, int length, bool repeat
 {
     mutex.lock();
     HAL_StatusTypeDef status;
+#ifdef BENCHMARK
+    status = HAL_OK; // benchmark builds measure CPU time only, there is nothing on the other end of the bus
+#else
     while (HAL_I2C_GetState(&_hi2c) != HAL_I2C_STATE_READY)
     {
         // HAL_Delay(1);
     };
 
+    TRACE(TRACE_I2C_BEGIN, address);
     status = HAL_I2C_Master_Transmit(&_hi2c, address, data, length, HAL_MAX_DELAY);
+    TRACE(TRACE_I2C_END, status);
+#endif
     if (status != HAL_OK)
     {
         logger_log_err("I2C->write", status);
@@ -82,13 +88,18 @@ int I2C::read(int address, uint8_t *data, int length, bool repeated /*=false*/)
 {
     mutex.lock();
     HAL_StatusTypeDef status;
-    
+#ifdef BENCHMARK
+    status = HAL_OK; // see I2C::write()
+#else
     while (HAL_I2C_GetState(&_hi2c) != HAL_I2C_STATE_READY)
     {
         // HAL_Delay(1);
     };
 
+    TRACE(TRACE_I2C_BEGIN, address);
     status = HAL_I2C_Master_Receive(&_hi2c, address, data, length, HAL_MAX_DELAY);
+    TRACE(TRACE_I2C_END, status);
+#endif
     if (status != HAL_OK) {
         logger_log_err("I2C->read", status);
     }
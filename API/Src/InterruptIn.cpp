@@ -3,17 +3,14 @@
 InterruptIn *InterruptIn::_instances[NUM_GPIO_IRQ_INSTANCES] = {0};
 
 void InterruptIn::init() {
+    _debounce = 0;
+    _lastEdge = 0;
+    _dropped = 0;
+    _deferred = false;
     gpio_irq_init(_pin);
 
-    // push new instance onto static instances array
-    for (int i = 0; i < NUM_GPIO_IRQ_INSTANCES; i++)
-    {
-        if (_instances[i] == NULL)
-        {
-            _instances[i] = this;
-            break;
-        }
-    }
+    // register instance in the dispatch table using its EXTI line number
+    _instances[STM_PIN(_pin)] = this;
 }
 
 int InterruptIn::read() {
@@ -48,7 +45,54 @@ void InterruptIn::fall(Callback<void()> func)
     gpio_irq_set(_pin, _event, true);
 }
 
+/**
+ * @brief Limit how often edges get dispatched. Handy for noisy lines which could otherwise flood whatever the callback
+ * is feeding.
+ *
+ * The first edge inside the window after a dispatched one still gets dispatched (marked deferred), any more get
+ * ignored. Whoever handles the callback should wait getDebounceRemaining() before acting on it, so a latched interrupt
+ * line (held until the chip gets read) never gets its last edge thrown away and stays stuck.
+ *
+ * @param us minimum time between edges in microseconds (0 disables debouncing)
+ */
+void InterruptIn::debounce(uint32_t us)
+{
+    _debounce = dwt_us_to_cycles(us);
+}
+
+/**
+ * @brief how long until the debounce window of the last dispatched edge closes, 0 if it already has
+ *
+ * @return microseconds
+ */
+uint32_t InterruptIn::getDebounceRemaining()
+{
+    if (!_debounce || !_deferred)
+        return 0;
+    uint32_t elapsed = dwt_get_cycles() - _lastEdge;
+    return elapsed < _debounce ? dwt_cycles_to_us(_debounce - elapsed) + 1 : 0;
+}
+
 void InterruptIn::handleInterupt() {
+    if (_debounce)
+    {
+        uint32_t now = dwt_get_cycles();
+        if (now - _lastEdge < _debounce)
+        {
+            if (_deferred)
+            {
+                _dropped++; // the deferred edge still to be handled covers this one
+                return;
+            }
+            _deferred = true;
+        }
+        else
+        {
+            _deferred = false;
+            _lastEdge = now;
+        }
+    }
+
     if (this->_event == IRQ_EVENT_RISE) {
         if (riseCallback) {
             riseCallback();
@@ -80,15 +124,15 @@ void InterruptIn::gpio_irq_init(PinName pin)
     HAL_NVIC_EnableIRQ(_irq);
 }
 
-// note: potentially add a break; once gpio matched
+/**
+ * @brief HAL passes the pin as a bit mask (GPIO_PIN_x), so the bit position doubles as the EXTI line / table index
+ */
 void InterruptIn::RouteCallback(uint16_t GPIO_Pin)
 {
-    for (auto ins : _instances)
+    InterruptIn *ins = _instances[POSITION_VAL(GPIO_Pin)];
+    if (ins)
     {
-        if (ins && ins->_pin_num == GPIO_Pin)
-        {
-            ins->handleInterupt();
-        }
+        ins->handleInterupt();
     }
 }
 
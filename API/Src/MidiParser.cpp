@@ -0,0 +1,94 @@
+#include "MidiParser.h"
+
+void MidiParser::reset()
+{
+    runningStatus = 0;
+    dataCount = 0;
+    sysex = false;
+}
+
+/**
+ * @brief number of data bytes which follow a status byte
+ */
+int MidiParser::dataLength(uint8_t status)
+{
+    switch (status & 0xF0)
+    {
+    case MIDI_PROGRAM_CHANGE:
+    case MIDI_CHANNEL_PRESSURE:
+        return 1;
+    case 0xF0:
+        switch (status)
+        {
+        case MIDI_TIME_CODE:
+        case MIDI_SONG_SELECT:
+            return 1;
+        case MIDI_SONG_POSITION:
+            return 2;
+        default:
+            return 0;
+        }
+    default:
+        return 2;
+    }
+}
+
+/**
+ * @brief feed the next received byte to the parser
+ *
+ * Real-time messages (clock, start, stop etc.) are one byte long and may show up in the middle of any other message,
+ * they come out right away and leave whatever was being parsed untouched.
+ *
+ * @param byte received byte
+ * @param msg filled in when a message is complete
+ * @return true if msg holds a new message
+ */
+bool MidiParser::parse(uint8_t byte, MidiMessage *msg)
+{
+    if (byte >= MIDI_CLOCK)
+    {
+        msg->status = byte;
+        msg->data1 = 0;
+        msg->data2 = 0;
+        return true;
+    }
+
+    if (byte & 0x80) // status byte
+    {
+        dataCount = 0;
+        sysex = byte == MIDI_SYSEX_START;
+        if (byte < MIDI_SYSEX_START)
+        {
+            runningStatus = byte;
+            return false;
+        }
+
+        runningStatus = 0; // system common messages and sysex cancel running status
+        if (byte == MIDI_TUNE_REQUEST)
+        {
+            msg->status = byte;
+            msg->data1 = 0;
+            msg->data2 = 0;
+            return true;
+        }
+        if (dataLength(byte) > 0)
+            runningStatus = byte; // only kept until its data bytes arrive, see below
+        return false; // sysex start / end, or an undefined status
+    }
+
+    // data byte
+    if (sysex || runningStatus == 0)
+        return false; // sysex payload, or data without a status byte (ie. joined the stream part way through a message)
+
+    data[dataCount++] = byte;
+    if (dataCount < dataLength(runningStatus))
+        return false;
+
+    msg->status = runningStatus;
+    msg->data1 = data[0];
+    msg->data2 = dataCount > 1 ? data[1] : 0;
+    dataCount = 0;
+    if (runningStatus >= MIDI_SYSEX_START)
+        runningStatus = 0; // system common messages don't take part in running status
+    return true;
+}
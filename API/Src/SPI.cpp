@@ -1,6 +1,8 @@
 #include "SPI.h"
 
 Mutex SPI::_mutex;
+SPI *SPI::_dmaInstance = NULL;
+DMA_HandleTypeDef hdma_spi2_tx;
 
 void SPI::init()
 {
@@ -72,8 +74,123 @@ void SPI::write(uint8_t *data, int length)
 {
     _mutex.lock();
     HAL_StatusTypeDef status;
+#ifdef BENCHMARK
+    status = HAL_OK; // benchmark builds measure CPU time only, see I2C::write()
+#else
+    TRACE(TRACE_SPI_BEGIN, length);
     _slaveSelect.write(0);
     status = HAL_SPI_Transmit(&_hspi, (uint8_t *)data, length, HAL_MAX_DELAY);
     _slaveSelect.write(1);
+    TRACE(TRACE_SPI_END, status);
+#endif
     _mutex.unlock();
+}
+
+/**
+ * @brief route SPI2 TX through DMA so writeFrames() doesn't keep the CPU busy while the bytes go out
+ * NOTE: must be called after init()
+ */
+void SPI::initDMA()
+{
+    _txComplete = xSemaphoreCreateBinaryStatic(&_txCompleteBuffer);
+    _dmaInstance = this;
+
+    /* SPI2_TX -> DMA1 Stream 4, Channel 0 */
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    hdma_spi2_tx.Instance = DMA1_Stream4;
+    hdma_spi2_tx.Init.Channel = DMA_CHANNEL_0;
+    hdma_spi2_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    hdma_spi2_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_spi2_tx.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_spi2_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma_spi2_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hdma_spi2_tx.Init.Mode = DMA_NORMAL;
+    hdma_spi2_tx.Init.Priority = DMA_PRIORITY_HIGH;
+    hdma_spi2_tx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    HAL_StatusTypeDef status = HAL_DMA_Init(&hdma_spi2_tx);
+    error_handler(status);
+    __HAL_LINKDMA(&_hspi, hdmatx, hdma_spi2_tx);
+
+    HAL_NVIC_SetPriority(DMA1_Stream4_IRQn, RTOS_ISR_DEFAULT_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Stream4_IRQn);
+}
+
+/**
+ * @brief Write several equally sized frames back to back, toggling slave select between each one (ie. one 24-bit frame
+ * per DAC channel). Each frame is sent via DMA and the next one gets started from the transfer complete interrupt, so the
+ * calling task blocks until the last frame is out, but the CPU is free to run other tasks in the meantime.
+ * NOTE: requires initDMA(). data must stay valid until this function returns.
+ *
+ * @param data frames, stored one after the other
+ * @param frameLength number of bytes in each frame
+ * @param frames number of frames
+ */
+void SPI::writeFrames(uint8_t *data, int frameLength, int frames)
+{
+    if (frames < 1)
+        return;
+    _mutex.lock();
+#ifdef BENCHMARK
+    _mutex.unlock();
+    return;
+#endif
+    TRACE(TRACE_SPI_BEGIN, frameLength * frames);
+    _frameData = data;
+    _frameLength = frameLength;
+    _framesRemaining = frames;
+    _slaveSelect.write(0);
+    HAL_StatusTypeDef status = HAL_SPI_Transmit_DMA(&_hspi, _frameData, _frameLength);
+    if (status == HAL_OK)
+    {
+        xSemaphoreTake(_txComplete, portMAX_DELAY);
+    }
+    else
+    {
+        _slaveSelect.write(1);
+    }
+    TRACE(TRACE_SPI_END, status);
+    _mutex.unlock();
+}
+
+/**
+ * @brief called from the DMA transfer complete interrupt once a frame is out. Latch it and start the next one.
+ */
+void SPI::handleTxComplete()
+{
+    _slaveSelect.write(1);
+    if (--_framesRemaining > 0)
+    {
+        _frameData += _frameLength;
+        _slaveSelect.write(0);
+        if (HAL_SPI_Transmit_DMA(&_hspi, _frameData, _frameLength) == HAL_OK)
+            return;
+        _slaveSelect.write(1);
+    }
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    xSemaphoreGiveFromISR(_txComplete, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+void SPI::RouteTxCompleteCallback(SPI_HandleTypeDef *hspi)
+{
+    if (_dmaInstance && hspi == &_dmaInstance->_hspi)
+    {
+        _dmaInstance->handleTxComplete();
+    }
+}
+
+extern "C" void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+    SPI::RouteTxCompleteCallback(hspi);
+}
+
+// a failed frame is dropped rather than leaving the writing task blocked forever
+extern "C" void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi)
+{
+    SPI::RouteTxCompleteCallback(hspi);
+}
+
+extern "C" void DMA1_Stream4_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&hdma_spi2_tx);
 }
\ No newline at end of file
@@ -141,6 +141,7 @@ void SuperClock::setPulseFrequency(uint32_t ticks)
  */
 void SuperClock::handleInputCaptureCallback()
 {
+    TRACE_IO(TRACE_CLOCK_INPUT_CAPTURE, pulse);
     // almost always, there will need to be at least 1 pulse not yet executed prior to an input capture, 
     // so you must execute all remaining until
     if (pulse < PPQN)
@@ -183,6 +184,7 @@ void SuperClock::disableInputCaptureISR()
 */ 
 void SuperClock::handleOverflowCallback()
 {
+    TRACE_IO_CLOCK(pulse);
     if (ppqnCallback)
         ppqnCallback(pulse); // when clock inits, this ensures the 0ith pulse will get handled
 
@@ -192,7 +194,14 @@ void SuperClock::handleOverflowCallback()
     //         resetCallback();
     // }
 
-    if (pulse < PPQN - 1) {
+    if (midiClockMode)
+    {
+        pulse++;
+        if (pulse % PULSES_PER_MIDI_CLOCK == 0)
+            __HAL_TIM_DISABLE(&htim4); // halt TIM4, the next MIDI clock resumes it (see handleMidiClock())
+    }
+    else if (pulse < PPQN - 1)
+    {
         pulse++;
     } else {
         if (externalInputMode)
@@ -205,17 +214,120 @@ void SuperClock::handleOverflowCallback()
     }
 }
 
-void SuperClock::attachInputCaptureCallback(Callback<void()> func)
+/**
+ * @brief Upsample MIDI clock (24 PPQN) to the internal PPQN.
+ *
+ * Works like the external clock input, just on every MIDI clock instead of every quarter note. Each MIDI clock fires the
+ * first of its PULSES_PER_MIDI_CLOCK pulses right away, and sets TIM4 to spread the rest evenly over the time the last
+ * MIDI clock took. TIM4 halts after the last of them, so if the tempo slows down the sequence waits for the next MIDI
+ * clock instead of running ahead. If the tempo speeds up, whichever pulses TIM4 didn't get to yet get fired here first.
+ * Either way the sequencer lands on every MIDI clock exactly.
+ */
+void SuperClock::handleMidiClock()
+{
+    if (!midiClockMode)
+        return; // TIM2 belongs to the external clock input until a MIDI start / continue
+
+    uint32_t ticks = __HAL_TIM_GetCounter(&htim2); // TIM2 ticks since the last MIDI clock
+    __HAL_TIM_SetCounter(&htim2, 0);
+
+    if (midiClockTimed)
+    {
+        uint32_t ticksPerPulse = ticks / PULSES_PER_MIDI_CLOCK;
+        if (ticksPerPulse < MIN_TICKS_PER_PULSE)
+            ticksPerPulse = MIN_TICKS_PER_PULSE;
+        else if (ticksPerPulse > MAX_TICKS_PER_PULSE)
+            ticksPerPulse = MAX_TICKS_PER_PULSE;
+        this->setPulseFrequency(ticksPerPulse);
+    }
+    midiClockTimed = true;
+
+    if (!midiRunning)
+        return; // clock gets sent while stopped too, which keeps the tempo up to date
+
+    TRACE_IO(TRACE_CLOCK_INPUT_CAPTURE, pulse);
+    if (midiClockStarted)
+    {
+        midiClockStarted = false; // first clock after a start is the first pulse of the sequence
+    }
+    else
+    {
+        int target = midiClock == 0 ? PPQN : midiClock * PULSES_PER_MIDI_CLOCK;
+        while (pulse < target)
+            this->handleOverflowCallback();
+        if (midiClock == 0)
+            pulse = 0;
+    }
+    midiClock = (midiClock + 1) % MIDI_CLOCK_PPQN;
+
+    __HAL_TIM_SetCounter(&htim4, 0);
+    __HAL_TIM_ENABLE(&htim4);
+    this->handleOverflowCallback();
+}
+
+/**
+ * @brief Take over from the tempo pot / external clock input and wait for the first MIDI clock
+ */
+void SuperClock::handleMidiStart()
+{
+    HAL_NVIC_DisableIRQ(TIM2_IRQn); // external clock input is ignored while following MIDI clock
+    externalInputMode = false;
+    midiClockMode = true;
+    midiRunning = true;
+    midiClockStarted = true;
+    midiClockTimed = false; // TIM2 was timing the external clock input up to now
+    midiClock = 0;
+    pulse = 0;
+    __HAL_TIM_DISABLE(&htim4);
+}
+
+/**
+ * @brief pick up from wherever a MIDI stop left off
+ */
+void SuperClock::handleMidiContinue()
+{
+    if (!midiClockMode)
+    {
+        this->handleMidiStart();
+        return;
+    }
+    midiRunning = true;
+}
+
+void SuperClock::handleMidiStop()
+{
+    midiRunning = false;
+    __HAL_TIM_DISABLE(&htim4);
+}
+
+/**
+ * @brief go back to the internal clock (the tempo pot got moved). Called from a task, so it keeps the MIDI receive ISR
+ * out while switching over
+ */
+void SuperClock::disableMidiClock()
+{
+    taskENTER_CRITICAL();
+    if (midiClockMode)
+    {
+        midiClockMode = false;
+        midiRunning = false;
+        pulse = pulse % PPQN;
+        __HAL_TIM_ENABLE(&htim4);
+    }
+    taskEXIT_CRITICAL();
+}
+
+void SuperClock::attachInputCaptureCallback(Delegate<void()> func)
 {
     input_capture_callback = func;
 }
 
-void SuperClock::attachPPQNCallback(Callback<void(uint8_t pulse)> func)
+void SuperClock::attachPPQNCallback(Delegate<void(uint8_t pulse)> func)
 {
     ppqnCallback = func;
 }
 
-void SuperClock::attachResetCallback(Callback<void(uint8_t pulse)> func)
+void SuperClock::attachResetCallback(Delegate<void(uint8_t pulse)> func)
 {
     resetCallback = func;
 }
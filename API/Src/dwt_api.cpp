@@ -0,0 +1,21 @@
+#include "dwt_api.h"
+
+/**
+ * @brief enable the DWT cycle counter. Must be called after SystemClock_Config()
+ */
+void dwt_init()
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; // enable trace and debug blocks (required for DWT)
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+uint32_t dwt_us_to_cycles(uint32_t us)
+{
+    return us * (SystemCoreClock / 1000000);
+}
+
+uint32_t dwt_cycles_to_us(uint32_t cycles)
+{
+    return cycles / (SystemCoreClock / 1000000);
+}
@@ -1,8 +1,58 @@
 #include "logger.h"
 
 UART_HandleTypeDef huart3;
+DMA_HandleTypeDef hdma_usart3_tx;
 // okQueue<char *> Q_logger(5);
 
+/**
+ * Log output goes through a multi-producer / single-consumer ring of records, which the logger task turns into text and
+ * sends out over USART3 TX DMA. Producers only copy raw bytes and values in, so formatting numbers never costs the
+ * (often time critical) task or ISR doing the logging.
+ *
+ * Record layout:
+ *   LOG_RECORD_BYTES  | type | length lo | length hi | bytes ... |  text (or tokenized frames), sent as is
+ *   LOG_RECORD_<num>  | type | value (4 bytes, little endian) |     formatted by the logger task
+ *
+ * Producers (any task or ISR) claim space by advancing ring_reserved with a compare-and-swap and copy their record in.
+ * Each record gets published on its own by writing its type byte last. The logger task is the only consumer: it reads
+ * records in order, waits on a record whose type still reads LOG_RECORD_PENDING (its writer got preempted part way
+ * through), zeroes every byte it consumes so the space reads as pending again, and is the only thing that advances
+ * ring_tail.
+ *
+ * All positions are free running counters, masked down to a buffer index when used.
+ * When the ring is full, a task waits (up to LOGGER_WRITE_TIMEOUT) for the logger task to make room. ISRs, code
+ * running before the scheduler starts or inside a critical section can't wait, their record gets dropped (not
+ * truncated) and its size counted in ring_dropped.
+ *
+ * Nothing goes out until the logger task runs, so anything logged before the scheduler starts waits in the ring.
+ */
+enum LogRecordType : uint8_t
+{
+    LOG_RECORD_PENDING, // space reserved (or free), the record hasn't been published yet
+    LOG_RECORD_BYTES,
+    LOG_RECORD_INT,   // signed decimal
+    LOG_RECORD_UINT,  // unsigned decimal
+    LOG_RECORD_HEX,   // unsigned hex
+    LOG_RECORD_FLOAT  // 3 decimal places
+};
+#define LOG_RECORD_HEADER_SIZE 3 // type + 16-bit length of a LOG_RECORD_BYTES record
+#define LOG_RECORD_VALUE_SIZE  5 // type + 32-bit value
+#define LOG_VALUE_TEXT_SIZE    16 // longest formatted value ("-4294967295.999")
+
+#define LOGGER_NOTIFY_RECORDS 0x01 // a record got published
+#define LOGGER_NOTIFY_TX_DONE 0x02 // the DMA transfer finished
+
+static uint8_t ring_buffer[LOGGER_BUFFER_SIZE]; // zeroed, so all of it reads as LOG_RECORD_PENDING
+static volatile uint32_t ring_reserved = 0;  // end of space claimed by producers
+static volatile uint32_t ring_tail = 0;      // start of records not yet consumed
+static volatile uint32_t ring_dropped = 0;   // number of bytes discarded because the ring was full
+static SemaphoreHandle_t ring_space = NULL;  // given by the logger task whenever it frees up space
+static StaticSemaphore_t ring_space_buffer;
+static uint8_t tx_buffer[LOGGER_TX_BUFFER_SIZE]; // text of the DMA transfer in flight, owned by the logger task
+static uint32_t record_sent = 0;                 // bytes of the LOG_RECORD_BYTES record at ring_tail already sent
+static TaskHandle_t logger_task_handle = NULL;
+static bool logger_ready = false;
+
 void logger_init()
 {
     GPIO_InitTypeDef GPIO_InitStruct = {0};
@@ -36,6 +86,386 @@ void logger_init()
     huart3.Init.HwFlowCtl = UART_HWCONTROL_NONE;
     huart3.Init.OverSampling = UART_OVERSAMPLING_16;
     HAL_UART_Init(&huart3);
+
+    /* USART3_TX -> DMA1 Stream 3, Channel 4 */
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    hdma_usart3_tx.Instance = DMA1_Stream3;
+    hdma_usart3_tx.Init.Channel = DMA_CHANNEL_4;
+    hdma_usart3_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    hdma_usart3_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_usart3_tx.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_usart3_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma_usart3_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hdma_usart3_tx.Init.Mode = DMA_NORMAL;
+    hdma_usart3_tx.Init.Priority = DMA_PRIORITY_LOW;
+    hdma_usart3_tx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    HAL_DMA_Init(&hdma_usart3_tx);
+    __HAL_LINKDMA(&huart3, hdmatx, hdma_usart3_tx);
+
+    HAL_NVIC_SetPriority(DMA1_Stream3_IRQn, LOGGER_ISR_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Stream3_IRQn);
+    HAL_NVIC_SetPriority(USART3_IRQn, LOGGER_ISR_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(USART3_IRQn);
+
+    ring_space = xSemaphoreCreateBinaryStatic(&ring_space_buffer);
+    logger_ready = true; // the logger task sends anything logged before now once it runs
+}
+
+/**
+ * @brief true when the caller is a task which is allowed to block: the scheduler is running, and it isn't inside an
+ * ISR or a critical section
+ */
+static bool logger_can_block()
+{
+    return __get_IPSR() == 0 && __get_BASEPRI() == 0 && __get_PRIMASK() == 0 &&
+           xTaskGetSchedulerState() == taskSCHEDULER_RUNNING && xTaskGetCurrentTaskHandle() != logger_task_handle;
+}
+
+/**
+ * @brief wake the logger task. Skipped where the kernel can't be called (scheduler not running / suspended, ISRs above
+ * configMAX_SYSCALL_INTERRUPT_PRIORITY), the record then goes out with the next one which does wake it.
+ */
+static void logger_notify()
+{
+    if (logger_task_handle == NULL)
+        return;
+    uint32_t exception = __get_IPSR();
+    if (exception == 0)
+    {
+        if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+            xTaskNotify(logger_task_handle, LOGGER_NOTIFY_RECORDS, eSetBits);
+    }
+    else if (exception >= 16 && NVIC_GetPriority((IRQn_Type)(exception - 16)) >= configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY)
+    {
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+        xTaskNotifyFromISR(logger_task_handle, LOGGER_NOTIFY_RECORDS, eSetBits, &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    }
+}
+
+/**
+ * @brief copy a record into the log ring and publish it. Never blocks ISRs or code running before the scheduler starts,
+ * a task waits for room when the ring is full (see note at top of file).
+ *
+ * @param header record type followed by its length / value
+ * @param data payload following the header, if any
+ */
+static void ring_write(const uint8_t *header, uint32_t headerLength, const uint8_t *data, uint32_t length)
+{
+#ifdef LOGGING_ENABLED
+    uint32_t size = headerLength + length;
+    TickType_t waitStart = 0;
+    bool waiting = false;
+
+    // claim space
+    uint32_t start = ring_reserved;
+    while (1)
+    {
+        if (size <= LOGGER_BUFFER_SIZE - (start - ring_tail))
+        {
+            if (__atomic_compare_exchange_n(&ring_reserved, &start, start + size, true, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+                break;
+            continue; // start got updated with the latest reservation
+        }
+        if (size > LOGGER_BUFFER_SIZE || !logger_ready || !logger_can_block())
+        {
+            __atomic_add_fetch(&ring_dropped, size, __ATOMIC_RELAXED);
+            return;
+        }
+        if (!waiting)
+        {
+            waiting = true;
+            waitStart = xTaskGetTickCount();
+        }
+        else if (xTaskGetTickCount() - waitStart >= pdMS_TO_TICKS(LOGGER_WRITE_TIMEOUT))
+        {
+            __atomic_add_fetch(&ring_dropped, size, __ATOMIC_RELAXED);
+            return;
+        }
+        logger_notify();
+        // short timeout, as one give only wakes one of possibly several waiting tasks
+        xSemaphoreTake(ring_space, pdMS_TO_TICKS(LOGGER_SPACE_POLL_PERIOD));
+        start = ring_reserved;
+    }
+
+    // fill it, everything but the type byte
+    for (uint32_t i = 1; i < headerLength; i++)
+        ring_buffer[(start + i) & (LOGGER_BUFFER_SIZE - 1)] = header[i];
+    for (uint32_t i = 0; i < length; i++)
+        ring_buffer[(start + headerLength + i) & (LOGGER_BUFFER_SIZE - 1)] = data[i];
+
+    // publish it
+    __atomic_store_n(&ring_buffer[start & (LOGGER_BUFFER_SIZE - 1)], header[0], __ATOMIC_RELEASE);
+    logger_notify();
+#endif
+}
+
+/**
+ * @brief queue bytes to be sent as they are
+ */
+void logger_write(const uint8_t *data, uint32_t length)
+{
+    if (length == 0)
+        return;
+    if (length > 0xFFFF)
+        length = 0xFFFF;
+    uint8_t header[LOG_RECORD_HEADER_SIZE] = {LOG_RECORD_BYTES, (uint8_t)(length & 0xFF), (uint8_t)(length >> 8)};
+    ring_write(header, LOG_RECORD_HEADER_SIZE, data, length);
+}
+
+/**
+ * @brief queue a number, the logger task turns it into text
+ */
+static void logger_write_value(LogRecordType type, uint32_t value)
+{
+    uint8_t record[LOG_RECORD_VALUE_SIZE] = {type, (uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16),
+                                             (uint8_t)(value >> 24)};
+    ring_write(record, LOG_RECORD_VALUE_SIZE, NULL, 0);
+}
+
+static inline uint8_t ring_read(uint32_t position)
+{
+    return ring_buffer[position & (LOGGER_BUFFER_SIZE - 1)];
+}
+
+/**
+ * @brief format a value record
+ *
+ * @param str at least LOG_VALUE_TEXT_SIZE bytes
+ * @return length of the text
+ */
+static uint32_t logger_format_value(uint8_t type, uint32_t value, char *str)
+{
+    switch (type)
+    {
+    case LOG_RECORD_INT:
+        ltoa((int32_t)value, str, 10);
+        return strlen(str);
+    case LOG_RECORD_HEX:
+        utoa(value, str, 16);
+        return strlen(str);
+    case LOG_RECORD_FLOAT:
+    {
+        float f;
+        memcpy(&f, &value, 4);
+        char *ptr = str;
+        if (f < 0)
+        {
+            *ptr++ = '-';
+            f = -f;
+        }
+        uint32_t whole = (uint32_t)f;
+        uint32_t fraction = (uint32_t)((f - whole) * 1000 + 0.5f);
+        if (fraction >= 1000)
+        {
+            whole++;
+            fraction -= 1000;
+        }
+        utoa(whole, ptr, 10);
+        ptr += strlen(ptr);
+        *ptr++ = '.';
+        *ptr++ = '0' + fraction / 100;
+        *ptr++ = '0' + (fraction / 10) % 10;
+        *ptr++ = '0' + fraction % 10;
+        return ptr - str;
+    }
+    default:
+        utoa(value, str, 10);
+        return strlen(str);
+    }
+}
+
+/**
+ * @brief mark consumed bytes as LOG_RECORD_PENDING again, so a record later written over them doesn't get read early
+ */
+static void ring_clear(uint32_t position, uint32_t length)
+{
+    for (uint32_t i = 0; i < length; i++)
+        ring_buffer[(position + i) & (LOGGER_BUFFER_SIZE - 1)] = LOG_RECORD_PENDING;
+}
+
+/**
+ * @brief turn committed records into text in tx_buffer, until it is full or the ring is empty. A bytes record too long
+ * to fit gets sent over several transfers.
+ *
+ * @return number of bytes in tx_buffer
+ */
+static uint32_t logger_format_records()
+{
+    uint32_t length = 0;
+    uint32_t tail = ring_tail;
+    uint32_t reserved = __atomic_load_n(&ring_reserved, __ATOMIC_ACQUIRE);
+    while (tail != reserved)
+    {
+        uint8_t type = __atomic_load_n(&ring_buffer[tail & (LOGGER_BUFFER_SIZE - 1)], __ATOMIC_ACQUIRE);
+        if (type == LOG_RECORD_PENDING)
+            break; // its writer hasn't finished, everything after it waits
+        if (type == LOG_RECORD_BYTES)
+        {
+            uint32_t size = ring_read(tail + 1) | (ring_read(tail + 2) << 8);
+            uint32_t count = size - record_sent;
+            if (count > LOGGER_TX_BUFFER_SIZE - length)
+                count = LOGGER_TX_BUFFER_SIZE - length;
+            for (uint32_t i = 0; i < count; i++)
+                tx_buffer[length + i] = ring_read(tail + LOG_RECORD_HEADER_SIZE + record_sent + i);
+            length += count;
+            record_sent += count;
+            if (record_sent < size)
+                break; // tx_buffer is full
+            record_sent = 0;
+            ring_clear(tail, LOG_RECORD_HEADER_SIZE + size);
+            tail += LOG_RECORD_HEADER_SIZE + size;
+        }
+        else
+        {
+            if (LOGGER_TX_BUFFER_SIZE - length < LOG_VALUE_TEXT_SIZE)
+                break;
+            uint32_t value = ring_read(tail + 1) | (ring_read(tail + 2) << 8) | (ring_read(tail + 3) << 16) |
+                             ((uint32_t)ring_read(tail + 4) << 24);
+            length += logger_format_value(type, value, (char *)&tx_buffer[length]);
+            ring_clear(tail, LOG_RECORD_VALUE_SIZE);
+            tail += LOG_RECORD_VALUE_SIZE;
+        }
+    }
+    if (tail != ring_tail)
+    {
+        __atomic_store_n(&ring_tail, tail, __ATOMIC_RELEASE); // hand the space back to producers
+        if (ring_space != NULL)
+            xSemaphoreGive(ring_space);
+    }
+    return length;
+}
+
+/**
+ * @brief total number of log bytes discarded because the ring buffer was full
+ */
+uint32_t logger_get_dropped_bytes()
+{
+    return ring_dropped;
+}
+
+/**
+ * @brief write an unsigned LEB128 style varint (7 bits per byte, MSB set on every byte but the last)
+ */
+static void log_encode_varint(uint8_t **buf, const uint8_t *end, uint32_t value)
+{
+    if (end - *buf < 5)
+        return; // no room left in frame, argument is dropped
+    while (value > 0x7F)
+    {
+        *(*buf)++ = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    *(*buf)++ = value;
+}
+
+void log_encode_arg(uint8_t **buf, const uint8_t *end, long value)
+{
+    int32_t v = value;
+    log_encode_varint(buf, end, ((uint32_t)v << 1) ^ (uint32_t)(v >> 31)); // zigzag, so small negative numbers stay short
+}
+
+void log_encode_arg(uint8_t **buf, const uint8_t *end, unsigned long value)
+{
+    log_encode_varint(buf, end, value);
+}
+
+void log_encode_arg(uint8_t **buf, const uint8_t *end, float value)
+{
+    if (end - *buf < 4)
+        return;
+    memcpy(*buf, &value, 4);
+    *buf += 4;
+}
+
+void log_encode_arg(uint8_t **buf, const uint8_t *end, const char *str)
+{
+    uint32_t length = strlen(str);
+    if (length > LOGGER_TOKEN_MAX_STRING_ARG)
+        length = LOGGER_TOKEN_MAX_STRING_ARG;
+    if (end - *buf < 1)
+        return;
+    if (length > (uint32_t)(end - *buf - 1))
+        length = end - *buf - 1;
+    *(*buf)++ = length;
+    memcpy(*buf, str, length);
+    *buf += length;
+}
+
+/**
+ * @brief write the literal text of fmt up to its next conversion specifier
+ * 
+ * @param fmt format string
+ * @param conversion set to the conversion character (ie. 'd'), or 0 when the end of fmt was reached
+ * @return pointer to the character after the conversion specifier
+ */
+const char *logger_logf_next(const char *fmt, char *conversion)
+{
+    const char *literal = fmt;
+    *conversion = 0;
+    while (*fmt)
+    {
+        if (*fmt != '%')
+        {
+            fmt++;
+            continue;
+        }
+        logger_write((const uint8_t *)literal, fmt - literal);
+        fmt++;
+        if (*fmt == '%')
+        {
+            literal = fmt++; // the second '%' gets written with the next literal run
+            continue;
+        }
+        while (*fmt && strchr("-+ #0123456789.l", *fmt)) // flags, width, precision and length are ignored
+            fmt++;
+        if (*fmt)
+            *conversion = *fmt++;
+        return fmt;
+    }
+    logger_write((const uint8_t *)literal, fmt - literal);
+    return fmt;
+}
+
+void logger_logf_arg(char conversion, long value)
+{
+    logger_write_value(conversion == 'x' ? LOG_RECORD_HEX : LOG_RECORD_INT, (uint32_t)value);
+}
+
+void logger_logf_arg(char conversion, unsigned long value)
+{
+    logger_write_value(conversion == 'x' ? LOG_RECORD_HEX : LOG_RECORD_UINT, value);
+}
+
+void logger_logf_arg(char conversion, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, 4);
+    logger_write_value(LOG_RECORD_FLOAT, bits);
+}
+
+void logger_logf_arg(char conversion, const char *str)
+{
+    uart_transmit((uint8_t *)str);
+}
+
+extern "C" void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->Instance != USART3 || logger_task_handle == NULL)
+        return;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    xTaskNotifyFromISR(logger_task_handle, LOGGER_NOTIFY_TX_DONE, eSetBits, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+extern "C" void DMA1_Stream3_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&hdma_usart3_tx);
+}
+
+extern "C" void USART3_IRQHandler(void)
+{
+    HAL_UART_IRQHandler(&huart3);
 }
 
 void logger_log(char const *str)
@@ -44,22 +474,15 @@ void logger_log(char const *str)
 }
 
 void logger_log(int const num) {
-    char tmp[33];
-    itoa(num, tmp, 10);
-    uart_transmit((uint8_t *)tmp);
+    logger_write_value(LOG_RECORD_INT, (uint32_t)num);
 }
 
 void logger_log(uint32_t const num) {
-    char str[33];
-    itoa(num, str, 10);
-    uart_transmit((uint8_t *)str);
+    logger_write_value(LOG_RECORD_UINT, num);
 }
 
 void logger_log(float const f) {
-    char str[33];
-    utoa(f, str, 10);
-    // snprintf(str, sizeof(str), "%f", f);
-    uart_transmit((uint8_t *)str);
+    logger_write_value(LOG_RECORD_UINT, (uint32_t)f); // whole part only
 }
 
 void logger_log(bool const boolean) {
@@ -73,39 +496,34 @@ void logger_log(bool const boolean) {
 
 void logger_log_err(char const *func_name, HAL_StatusTypeDef error)
 {
-    logger_log("\n** ERROR ** Function -> ");
-    logger_log(func_name);
-    logger_log(" :: ");
+    const char *error_name = "";
     switch (error)
     {
     case HAL_ERROR:
-        logger_log("HAL_ERROR");
+        error_name = "HAL_ERROR";
         break;
     case HAL_BUSY:
-        logger_log("HAL_BUSY");
+        error_name = "HAL_BUSY";
         break;
     case HAL_TIMEOUT:
-        logger_log("HAL_TIMEOUT");
+        error_name = "HAL_TIMEOUT";
         break;
     case HAL_OK:
         break;
     default:
         break;
     }
+    LOG("\n** ERROR ** Function -> %s :: %s", func_name, error_name);
 }
 
 /**
- * @brief Hardware UART Transmit function
+ * @brief Hardware UART Transmit function. Queues a null terminated string for output over UART DMA
  * 
  * @param data 
  */
 void uart_transmit(uint8_t *data)
 {
-    #ifdef LOGGING_ENABLED
-    vTaskSuspendAll();
-    HAL_UART_Transmit(&huart3, data, strlen((const char *)data), HAL_MAX_DELAY);
-    xTaskResumeAll();
-    #endif
+    logger_write(data, strlen((const char *)data));
 }
 
 void logger_log_system_config()
@@ -140,25 +558,37 @@ void logger_log_task_watermark(TaskHandle_t task_handle) {
     logger_log((uint32_t)stackSpace);
 }
 
-static QueueHandle_t logger_queue = NULL;
 void logger_queue_message(uint16_t message) {
-    BaseType_t xHigherPriorityTaskWoken;
-    xHigherPriorityTaskWoken = pdFALSE;
-    uint16_t _message = message;
-    xQueueSendFromISR(logger_queue, (void *)&message, &xHigherPriorityTaskWoken);
-    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    logger_log("\n");
+    logger_log((uint32_t)message);
 }
 
+/**
+ * @brief the only consumer of the log ring. Formats whatever has been logged and sends it over UART DMA, one
+ * LOGGER_TX_BUFFER_SIZE chunk at a time, waiting on the transfer complete callback in between.
+ */
 void TASK_logger(void *params) {
-    uint16_t pulse;
-    logger_queue = xQueueCreate(32, sizeof(uint16_t));
+    logger_task_handle = xTaskGetCurrentTaskHandle();
+    uint32_t pending = LOGGER_NOTIFY_RECORDS; // anything logged before now didn't get to wake this task
     while (1)
     {
-        if (xQueueReceive(logger_queue, &pulse, portMAX_DELAY))
+        uint32_t wanted = LOGGER_NOTIFY_RECORDS;
+        if (pending & LOGGER_NOTIFY_RECORDS)
         {
-            logger_log("\n");
-            logger_log(pulse);
+            pending &= ~LOGGER_NOTIFY_RECORDS;
+            uint32_t length = logger_ready ? logger_format_records() : 0;
+            if (length > 0 && HAL_UART_Transmit_DMA(&huart3, tx_buffer, length) == HAL_OK)
+            {
+                pending &= ~LOGGER_NOTIFY_TX_DONE;
+                pending |= LOGGER_NOTIFY_RECORDS; // more may be waiting behind what fit in tx_buffer
+                wanted = LOGGER_NOTIFY_TX_DONE;
+            }
         }
-        
-    }   
-}
\ No newline at end of file
+        while (!(pending & wanted))
+        {
+            uint32_t bits = 0;
+            xTaskNotifyWait(0, 0xFFFFFFFF, &bits, portMAX_DELAY);
+            pending |= bits;
+        }
+    }
+}
@@ -0,0 +1,224 @@
+#include "midi_api.h"
+
+UART_HandleTypeDef huart1;
+DMA_HandleTypeDef hdma_usart1_rx;
+DMA_HandleTypeDef hdma_usart1_tx;
+
+static uint8_t rx_buffer[MIDI_RX_DMA_SIZE];
+static uint32_t rx_read = 0; // index of the next byte in rx_buffer the parser hasn't seen
+static MidiParser parser;
+static Delegate<void(MidiMessage msg)> receive_callback;
+
+// TX ring, positions are free running counters masked down to a buffer index when used
+static uint8_t tx_buffer[MIDI_TX_BUFFER_SIZE];
+static uint32_t tx_head = 0;
+static uint32_t tx_tail = 0;
+static uint32_t tx_length = 0;          // length of the DMA transfer in flight (0 when idle)
+static uint8_t tx_running_status = 0;   // last channel status byte sent
+static volatile uint32_t tx_dropped = 0;
+
+static void midi_rx_process(DMA_HandleTypeDef *hdma);
+static void midi_tx_complete(DMA_HandleTypeDef *hdma);
+
+void midi_init()
+{
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+    __HAL_RCC_USART1_CLK_ENABLE();
+    __HAL_RCC_DMA2_CLK_ENABLE();
+
+    gpio_enable_clock(MIDI_UART_TX);
+    GPIO_InitStruct.Pin = gpio_get_pin(MIDI_UART_TX);
+    GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+    GPIO_InitStruct.Pull = GPIO_NOPULL;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+    GPIO_InitStruct.Alternate = GPIO_AF7_USART1;
+    HAL_GPIO_Init(gpio_get_port(MIDI_UART_TX), &GPIO_InitStruct);
+
+    gpio_enable_clock(MIDI_UART_RX);
+    GPIO_InitStruct.Pin = gpio_get_pin(MIDI_UART_RX);
+    GPIO_InitStruct.Pull = GPIO_PULLUP; // line idles high, keeps a disconnected input from reading as noise
+    HAL_GPIO_Init(gpio_get_port(MIDI_UART_RX), &GPIO_InitStruct);
+
+    huart1.Instance = USART1;
+    huart1.Init.BaudRate = MIDI_BAUD_RATE;
+    huart1.Init.WordLength = UART_WORDLENGTH_8B;
+    huart1.Init.StopBits = UART_STOPBITS_1;
+    huart1.Init.Parity = UART_PARITY_NONE;
+    huart1.Init.Mode = UART_MODE_TX_RX;
+    huart1.Init.HwFlowCtl = UART_HWCONTROL_NONE;
+    huart1.Init.OverSampling = UART_OVERSAMPLING_16;
+    HAL_UART_Init(&huart1);
+
+    /* USART1_RX -> DMA2 Stream 2, Channel 4 */
+    hdma_usart1_rx.Instance = DMA2_Stream2;
+    hdma_usart1_rx.Init.Channel = DMA_CHANNEL_4;
+    hdma_usart1_rx.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    hdma_usart1_rx.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_usart1_rx.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_usart1_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma_usart1_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hdma_usart1_rx.Init.Mode = DMA_CIRCULAR;
+    hdma_usart1_rx.Init.Priority = DMA_PRIORITY_HIGH;
+    hdma_usart1_rx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    HAL_DMA_Init(&hdma_usart1_rx);
+    hdma_usart1_rx.XferHalfCpltCallback = midi_rx_process;
+    hdma_usart1_rx.XferCpltCallback = midi_rx_process;
+
+    /* USART1_TX -> DMA2 Stream 7, Channel 4 */
+    hdma_usart1_tx.Instance = DMA2_Stream7;
+    hdma_usart1_tx.Init.Channel = DMA_CHANNEL_4;
+    hdma_usart1_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    hdma_usart1_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_usart1_tx.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_usart1_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma_usart1_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hdma_usart1_tx.Init.Mode = DMA_NORMAL;
+    hdma_usart1_tx.Init.Priority = DMA_PRIORITY_MEDIUM;
+    hdma_usart1_tx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    HAL_DMA_Init(&hdma_usart1_tx);
+    hdma_usart1_tx.XferCpltCallback = midi_tx_complete;
+
+    HAL_NVIC_SetPriority(DMA2_Stream2_IRQn, MIDI_ISR_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(DMA2_Stream2_IRQn);
+    HAL_NVIC_SetPriority(DMA2_Stream7_IRQn, MIDI_ISR_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(DMA2_Stream7_IRQn);
+    HAL_NVIC_SetPriority(USART1_IRQn, MIDI_ISR_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(USART1_IRQn);
+
+    // the DMA streams are driven directly rather than through HAL_UART_xxx_DMA(), so the UART callbacks stay the loggers
+    HAL_DMA_Start_IT(&hdma_usart1_rx, (uint32_t)&USART1->DR, (uint32_t)rx_buffer, MIDI_RX_DMA_SIZE);
+    SET_BIT(USART1->CR3, USART_CR3_DMAR | USART_CR3_DMAT);
+    __HAL_UART_CLEAR_IDLEFLAG(&huart1);
+    __HAL_UART_ENABLE_IT(&huart1, UART_IT_IDLE);
+}
+
+void midi_attach_receive(Delegate<void(MidiMessage msg)> func)
+{
+    receive_callback = func;
+}
+
+/**
+ * @brief parse every byte DMA has written since the last call. Runs in the USART1 (line idle) and DMA2 Stream 2 (half /
+ * full) ISRs, which share a priority so they never interleave
+ */
+static void midi_rx_process(DMA_HandleTypeDef *hdma)
+{
+    uint32_t write = MIDI_RX_DMA_SIZE - __HAL_DMA_GET_COUNTER(&hdma_usart1_rx);
+    if (write == MIDI_RX_DMA_SIZE)
+        write = 0;
+    while (rx_read != write)
+    {
+        MidiMessage msg;
+        if (parser.parse(rx_buffer[rx_read], &msg) && receive_callback)
+            receive_callback(msg);
+        rx_read = (rx_read + 1) % MIDI_RX_DMA_SIZE;
+    }
+}
+
+/**
+ * @brief start a DMA transfer of the next contiguous block of queued bytes, if one isn't already running. Must be called
+ * with interrupts masked
+ */
+static void midi_tx_kick()
+{
+    if (tx_length != 0)
+        return; // the transfer in flight picks up the new bytes once it completes
+
+    uint32_t pending = tx_head - tx_tail;
+    uint32_t index = tx_tail & (MIDI_TX_BUFFER_SIZE - 1);
+    if (pending > MIDI_TX_BUFFER_SIZE - index)
+        pending = MIDI_TX_BUFFER_SIZE - index; // DMA can't wrap, send up to the end of the buffer and the rest next time
+    if (pending == 0)
+        return;
+
+    if (HAL_DMA_Start_IT(&hdma_usart1_tx, (uint32_t)&tx_buffer[index], (uint32_t)&USART1->DR, pending) == HAL_OK)
+        tx_length = pending;
+}
+
+static void midi_tx_complete(DMA_HandleTypeDef *hdma)
+{
+    tx_tail += tx_length;
+    tx_length = 0;
+    midi_tx_kick();
+}
+
+/**
+ * @brief queue a channel message. Safe to call from tasks and ISRs alike
+ */
+static void midi_send(uint8_t status, uint8_t data1, uint8_t data2, int length)
+{
+    UBaseType_t isr_state = taskENTER_CRITICAL_FROM_ISR();
+    int size = status == tx_running_status ? length : length + 1;
+    if (size > (int)(MIDI_TX_BUFFER_SIZE - (tx_head - tx_tail)))
+    {
+        tx_dropped += size;
+    }
+    else
+    {
+        if (status != tx_running_status)
+            tx_buffer[tx_head++ & (MIDI_TX_BUFFER_SIZE - 1)] = status;
+        tx_buffer[tx_head++ & (MIDI_TX_BUFFER_SIZE - 1)] = data1;
+        if (length > 1)
+            tx_buffer[tx_head++ & (MIDI_TX_BUFFER_SIZE - 1)] = data2;
+        tx_running_status = status;
+        midi_tx_kick();
+    }
+    taskEXIT_CRITICAL_FROM_ISR(isr_state);
+}
+
+void midi_send_note_on(uint8_t channel, uint8_t note, uint8_t velocity)
+{
+    midi_send(MIDI_NOTE_ON | (channel & 0x0F), note & 0x7F, velocity & 0x7F, 2);
+}
+
+void midi_send_note_off(uint8_t channel, uint8_t note)
+{
+    midi_send(MIDI_NOTE_ON | (channel & 0x0F), note & 0x7F, 0, 2); // velocity 0, so it can share running status with note ons
+}
+
+/**
+ * @brief queue a real-time message (clock, start, stop ...). These may go out in between running status messages
+ */
+void midi_send_realtime(uint8_t status)
+{
+    UBaseType_t isr_state = taskENTER_CRITICAL_FROM_ISR();
+    if (tx_head - tx_tail < MIDI_TX_BUFFER_SIZE)
+    {
+        tx_buffer[tx_head++ & (MIDI_TX_BUFFER_SIZE - 1)] = status;
+        midi_tx_kick();
+    }
+    else
+    {
+        tx_dropped++;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(isr_state);
+}
+
+/**
+ * @brief total number of bytes not sent because the TX buffer was full
+ */
+uint32_t midi_get_dropped_bytes()
+{
+    return tx_dropped;
+}
+
+extern "C" void USART1_IRQHandler(void)
+{
+    if (__HAL_UART_GET_FLAG(&huart1, UART_FLAG_IDLE))
+    {
+        __HAL_UART_CLEAR_IDLEFLAG(&huart1);
+        midi_rx_process(&hdma_usart1_rx);
+    }
+    if (__HAL_UART_GET_FLAG(&huart1, UART_FLAG_ORE))
+        __HAL_UART_CLEAR_OREFLAG(&huart1); // DMA keeps up at 31250 baud, but a stuck overrun flag would stop reception
+}
+
+extern "C" void DMA2_Stream2_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&hdma_usart1_rx);
+}
+
+extern "C" void DMA2_Stream7_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&hdma_usart1_tx);
+}
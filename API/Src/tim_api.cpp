@@ -8,13 +8,13 @@
  */
 uint32_t tim_get_APBx_freq(TIM_HandleTypeDef *htim) {
     uint32_t pclk;
-    if (htim->Instance == TIM1)
+    if (htim->Instance == TIM1 || htim->Instance == TIM8 || htim->Instance == TIM9 || htim->Instance == TIM10 || htim->Instance == TIM11)
     {
-        pclk = HAL_RCC_GetPCLK1Freq();
+        pclk = HAL_RCC_GetPCLK2Freq();
     }
     else
     {
-        pclk = HAL_RCC_GetPCLK2Freq();
+        pclk = HAL_RCC_GetPCLK1Freq();
     }
     return pclk * 2; // Timer clocks are always equal to PCLK * 2
 }
@@ -38,19 +38,18 @@ uint32_t tim_get_overflow_freq(TIM_HandleTypeDef *htim)
 }
 
 /**
- * @brief
- * period = APBx / (prescaler * target_frequency)
- *
- * TODO: when period gets set to less than 1, than target frequency is not possible given the current prescaler value.
- * So subtract the prescaler value by 1 and try again until target frequency can be achieved.
+ * @brief program the prescaler and period so the timer overflows at target_freq. The smallest prescaler which lets the
+ * period fit the 16-bit auto-reload register is used, so the rate is exact whenever the timer clock divides by
+ * target_freq (ie. 16kHz on TIM8 is 180MHz / 11250, not 180MHz / (101 * 112))
  *
  * @param htim
  * @param target_freq
  */
 void tim_set_overflow_freq(TIM_HandleTypeDef *htim, uint32_t target_freq) {
-    uint32_t period;
-    uint16_t prescaler = htim->Instance->PSC;
-    uint32_t APBx_freq = tim_get_APBx_freq(htim);
-    period = APBx_freq / ((prescaler + 1) * target_freq);
-    __HAL_TIM_SET_AUTORELOAD(htim, period);
-}
\ No newline at end of file
+    uint32_t ticks = tim_get_APBx_freq(htim) / target_freq;             // timer clocks per overflow
+    uint32_t prescaler = (ticks - 1) / 0x10000;                          // the period has to fit in 16 bits
+    uint32_t period = (ticks + (prescaler + 1) / 2) / (prescaler + 1);   // rounded
+    __HAL_TIM_SET_PRESCALER(htim, prescaler);
+    __HAL_TIM_SET_AUTORELOAD(htim, period - 1);
+    htim->Instance->EGR = TIM_EGR_UG; // the prescaler is buffered, load it now rather than at the next overflow
+}
@@ -0,0 +1,177 @@
+#include "trace.h"
+#include "cmsis_os.h"
+#include "logger.h"
+
+volatile uint16_t trace_queue_peak[TRACE_MAX_QUEUES + 1];
+
+static const char *queueNames[TRACE_MAX_QUEUES + 1]; // index 0 is reserved for un-registered queues / semaphores
+static QueueHandle_t queueHandles[TRACE_MAX_QUEUES + 1];
+
+#ifdef TRACE_RECORDING
+volatile uint32_t trace_head = 0;
+volatile uint8_t trace_active = 1;
+volatile uint8_t trace_oneshot = 0;
+volatile uint8_t trace_clock_sync = 0; // record the next clock pulse whatever it is, so a capture knows where it started
+TraceRecord trace_buffer[TRACE_BUFFER_SIZE];
+
+static uint16_t analogValues[TRACE_ANALOG_INPUTS];   // last traced value of each analog input
+
+void trace_start(void)
+{
+    trace_active = 1;
+}
+
+void trace_stop(void)
+{
+    trace_active = 0;
+}
+
+void trace_clear(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    trace_head = 0;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief clear the buffer and record until it is full, so the start of a capture never gets overwritten
+ */
+void trace_start_oneshot(void)
+{
+    trace_stop();
+    trace_clear();
+    for (int i = 0; i < TRACE_ANALOG_INPUTS; i++)
+        analogValues[i] = 0;
+    trace_oneshot = 1;
+    trace_clock_sync = 1;
+    trace_start();
+}
+
+/**
+ * @brief record an analog input, but only once it has moved further than threshold from the last recorded value.
+ * Keeps ADC noise from filling the buffer
+ *
+ * @param event TRACE_INPUT_TEMPO .. TRACE_INPUT_CV + 3
+ */
+void trace_record_analog(uint16_t event, uint16_t value, uint16_t threshold)
+{
+    uint16_t *last = &analogValues[event - TRACE_INPUT_TEMPO];
+    int delta = (int)value - (int)*last;
+    if (delta > (int)threshold || delta < -(int)threshold)
+    {
+        *last = value;
+        trace_record(event, value);
+    }
+}
+#endif
+
+/**
+ * @brief give a queue a number and name so it can be identified in the trace output
+ */
+void trace_register_queue(QueueHandle_t queue, const char *name)
+{
+    for (int i = 1; i <= TRACE_MAX_QUEUES; i++)
+    {
+        if (queueNames[i] == NULL)
+        {
+            queueNames[i] = name;
+            queueHandles[i] = queue;
+            vQueueSetQueueNumber(queue, i);
+            return;
+        }
+    }
+}
+
+/**
+ * @return the queue registered as number, NULL if there is none
+ */
+QueueHandle_t trace_get_queue(int number)
+{
+    return (number > 0 && number <= TRACE_MAX_QUEUES) ? queueHandles[number] : NULL;
+}
+
+const char *trace_get_queue_name(int number)
+{
+    return (number > 0 && number <= TRACE_MAX_QUEUES) ? queueNames[number] : NULL;
+}
+
+#ifdef TRACE_RECORDING
+static void hex_to_string(uint32_t value, int digits, char *str)
+{
+    static const char hex[] = "0123456789abcdef";
+    for (int i = digits - 1; i >= 0; i--)
+    {
+        str[i] = hex[value & 0xF];
+        value >>= 4;
+    }
+}
+
+/**
+ * @brief print the contents of the trace buffer (oldest record first) along with the task and queue names.
+ * Recording is paused while dumping so the snapshot doesn't get overwritten.
+ *
+ * Format:
+ * TRACE_BEGIN <record count> <cpu clock hz>
+ * TRACE_TASK <number> <name>
+ * TRACE_QUEUE <number> <name>
+ * TRACE <timestamp><event><arg> ... (16 hex characters per record, 8 records per line)
+ * TRACE_END
+ */
+void trace_dump()
+{
+    uint8_t wasActive = trace_active;
+    trace_stop();
+
+    uint32_t head = trace_head;
+    uint32_t count = head < TRACE_BUFFER_SIZE ? head : TRACE_BUFFER_SIZE;
+
+    logger_log("\nTRACE_BEGIN ");
+    logger_log(count);
+    logger_log(" ");
+    logger_log(SystemCoreClock);
+
+    static TaskStatus_t tasks[16];
+    UBaseType_t taskCount = uxTaskGetSystemState(tasks, 16, NULL);
+    for (UBaseType_t i = 0; i < taskCount; i++)
+    {
+        logger_log("\nTRACE_TASK ");
+        logger_log((uint32_t)tasks[i].xTaskNumber);
+        logger_log(" ");
+        logger_log(tasks[i].pcTaskName);
+    }
+
+    for (int i = 1; i <= TRACE_MAX_QUEUES; i++)
+    {
+        if (queueNames[i])
+        {
+            logger_log("\nTRACE_QUEUE ");
+            logger_log(i);
+            logger_log(" ");
+            logger_log(queueNames[i]);
+        }
+    }
+
+    char line[6 + (8 * 16) + 1];
+    for (uint32_t i = 0; i < count; i += 8)
+    {
+        memcpy(line, "TRACE ", 6);
+        char *ptr = &line[6];
+        for (uint32_t j = i; j < i + 8 && j < count; j++)
+        {
+            TraceRecord *record = &trace_buffer[(head - count + j) & (TRACE_BUFFER_SIZE - 1)];
+            hex_to_string(record->timestamp, 8, ptr);
+            hex_to_string(record->event, 4, ptr + 8);
+            hex_to_string(record->arg, 4, ptr + 12);
+            ptr += 16;
+        }
+        *ptr = '\0';
+        logger_log("\n");
+        logger_log(line);
+    }
+    logger_log("\nTRACE_END\n");
+
+    if (wasActive)
+        trace_start();
+}
+#endif
@@ -0,0 +1,119 @@
+/**
+ * Host test for MidiParser. Built and run with `make test`, no hardware needed.
+ *
+ * Each case feeds a byte stream through a fresh parser and checks the messages which come out, in order.
+ */
+
+#include "MidiParser.h"
+#include <stdio.h>
+
+static int failures = 0;
+
+/**
+ * @brief feed bytes to a fresh parser and compare every message it hands back against expected
+ *
+ * @param expected messages as status, data1, data2 triplets
+ */
+static void check(const char *name, const uint8_t *bytes, int length, const MidiMessage *expected, int expectedCount)
+{
+    MidiParser parser;
+    MidiMessage msg;
+    int count = 0;
+    bool ok = true;
+    for (int i = 0; i < length; i++)
+    {
+        if (!parser.parse(bytes[i], &msg))
+            continue;
+        if (count >= expectedCount)
+        {
+            printf("  unexpected message %02x %02x %02x\n", msg.status, msg.data1, msg.data2);
+            ok = false;
+        }
+        else if (msg.status != expected[count].status || msg.data1 != expected[count].data1 ||
+                 msg.data2 != expected[count].data2)
+        {
+            printf("  message %d: got %02x %02x %02x, expected %02x %02x %02x\n", count, msg.status, msg.data1,
+                   msg.data2, expected[count].status, expected[count].data1, expected[count].data2);
+            ok = false;
+        }
+        count++;
+    }
+    if (count < expectedCount)
+    {
+        printf("  got %d messages, expected %d\n", count, expectedCount);
+        ok = false;
+    }
+    printf("%s %s\n", ok ? "PASS" : "FAIL", name);
+    if (!ok)
+        failures++;
+}
+
+#define CHECK(name, bytes, expected) \
+    check(name, bytes, sizeof(bytes), expected, sizeof(expected) / sizeof(MidiMessage))
+
+int main()
+{
+    {
+        // second and third note on leave out the status byte
+        const uint8_t bytes[] = {0x90, 60, 100, 62, 101, 64, 0};
+        const MidiMessage expected[] = {{0x90, 60, 100}, {0x90, 62, 101}, {0x90, 64, 0}};
+        CHECK("running status", bytes, expected);
+    }
+    {
+        // one data byte messages keep running status too
+        const uint8_t bytes[] = {0xC3, 5, 6, 0xD3, 7};
+        const MidiMessage expected[] = {{0xC3, 5, 0}, {0xC3, 6, 0}, {0xD3, 7, 0}};
+        CHECK("running status, one data byte", bytes, expected);
+    }
+    {
+        // clock and stop show up between the status and data bytes of a note on, without breaking it up
+        const uint8_t bytes[] = {0x91, MIDI_CLOCK, 60, MIDI_STOP, 100, MIDI_ACTIVE_SENSING, 61, MIDI_CLOCK, 90};
+        const MidiMessage expected[] = {
+            {MIDI_CLOCK, 0, 0}, {MIDI_STOP, 0, 0}, {0x91, 60, 100}, {MIDI_ACTIVE_SENSING, 0, 0},
+            {MIDI_CLOCK, 0, 0}, {0x91, 61, 90}};
+        CHECK("real-time bytes mid message", bytes, expected);
+    }
+    {
+        // the sysex payload is skipped, a clock inside it still comes out. Running status is gone after the sysex
+        const uint8_t bytes[] = {0x90, 60, 100, MIDI_SYSEX_START, 0x7E, 0x01, MIDI_CLOCK, 0x02, MIDI_SYSEX_END,
+                                 62, 101, 0x80, 60, 0};
+        const MidiMessage expected[] = {{0x90, 60, 100}, {MIDI_CLOCK, 0, 0}, {0x80, 60, 0}};
+        CHECK("sysex skipped", bytes, expected);
+    }
+    {
+        // a sysex cut short by a new status byte
+        const uint8_t bytes[] = {MIDI_SYSEX_START, 0x10, 0x20, 0xB0, 7, 127};
+        const MidiMessage expected[] = {{0xB0, 7, 127}};
+        CHECK("sysex ended by a status byte", bytes, expected);
+    }
+    {
+        // song position and tune request cancel the running note on status, data after them gets dropped
+        const uint8_t bytes[] = {0x90, 60, 100, MIDI_SONG_POSITION, 0x10, 0x02, 62, 101,
+                                 0x90, 60, 0, MIDI_TUNE_REQUEST, 62, 101};
+        const MidiMessage expected[] = {{0x90, 60, 100}, {MIDI_SONG_POSITION, 0x10, 0x02}, {0x90, 60, 0},
+                                        {MIDI_TUNE_REQUEST, 0, 0}};
+        CHECK("system common cancels running status", bytes, expected);
+    }
+    {
+        // one data byte system common messages
+        const uint8_t bytes[] = {MIDI_SONG_SELECT, 3, 4, MIDI_TIME_CODE, 0x21};
+        const MidiMessage expected[] = {{MIDI_SONG_SELECT, 3, 0}, {MIDI_TIME_CODE, 0x21, 0}};
+        CHECK("system common, one data byte", bytes, expected);
+    }
+    {
+        // joined the stream part way through a note on
+        const uint8_t bytes[] = {100, 62, 101, 0x90, 64, 102};
+        const MidiMessage expected[] = {{0x90, 64, 102}};
+        CHECK("data bytes before any status", bytes, expected);
+    }
+    {
+        // a new status byte part way through a message drops its partial data
+        const uint8_t bytes[] = {0x90, 60, 0xE0, 0x00, 0x40};
+        const MidiMessage expected[] = {{0xE0, 0x00, 0x40}};
+        CHECK("interrupted message", bytes, expected);
+    }
+
+    if (failures)
+        printf("%d failed\n", failures);
+    return failures ? 1 : 0;
+}
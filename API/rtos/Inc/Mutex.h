@@ -60,4 +60,5 @@ public:
 
 private:
     SemaphoreHandle_t _handle;
+    StaticSemaphore_t _buffer;
 };
\ No newline at end of file
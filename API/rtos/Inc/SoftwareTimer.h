@@ -43,7 +43,8 @@ public:
     void detachCallback();
 
 private:
-    TimerHandle_t handle;
+    TimerHandle_t handle = NULL;
+    StaticTimer_t _buffer;
     Callback<void()> _callback;
 
     static void callbackHandler(TimerHandle_t xTimer);
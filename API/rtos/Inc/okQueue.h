@@ -18,15 +18,16 @@
 
 #include "cmsis_os.h"
 
+/**
+ * NOTE: the queue storage is statically allocated as part of the object, so a global okQueue gets created during
+ * static initialization (before main() and well before the scheduler starts or any ISR which posts to it is enabled)
+ */
 template <class T, uint32_t queue_sz>
 class okQueue
 {
 public:
     okQueue() {
-        handle = xQueueCreate(queue_sz, sizeof(T));
-        if (handle == NULL) {
-            // logger_log("there is insufficient heap RAM available for the queue to be created.");
-        }
+        handle = xQueueCreateStatic(queue_sz, sizeof(T), storage, &buffer);
     }
 
     QueueHandle_t handle;
@@ -68,4 +69,8 @@ public:
     {
         return xQueueReceive(this->handle, buffer_ptr, delay);
     }
+
+private:
+    uint8_t storage[queue_sz * sizeof(T)];
+    StaticQueue_t buffer;
 };
\ No newline at end of file
@@ -21,7 +21,7 @@
 class okSemaphore {
 public:
     okSemaphore(){
-        handle = xSemaphoreCreateBinary();
+        handle = xSemaphoreCreateBinaryStatic(&buffer);
         this->give();
     };
 
@@ -30,6 +30,7 @@ public:
     }
 
     SemaphoreHandle_t handle;
+    StaticSemaphore_t buffer;
 
     void give() {
         xSemaphoreGive(handle);
@@ -13,6 +13,8 @@
 #include "cmsis_os.h"
 #include "logger.h"
 
+#define OK_TASK_STACK_SIZE 100
+
 class okTask
 {
 public:
@@ -20,14 +22,7 @@ public:
     {
         name = _name;
         task_func = _func;
-        BaseType_t status;
-        status = xTaskCreate(this->startTask, name, 100, this, 1, &this->handle);
-        if (status != pdPASS) {
-            logger_log("Task Create COULD_NOT_ALLOCATE_REQUIRED_MEMORY\n");
-            logger_log("TASK: ");
-            logger_log(name);
-            logger_log("\n");
-        }
+        handle = xTaskCreateStatic(this->startTask, name, OK_TASK_STACK_SIZE, this, 1, stack, &tcb);
     };
 
     char *name;
@@ -38,4 +33,34 @@ public:
     {
         static_cast<okTask *>(_this)->task_func(NULL);
     }
+
+private:
+    StackType_t stack[OK_TASK_STACK_SIZE];
+    StaticTask_t tcb;
+};
+
+/**
+ * @brief Statically allocated stack and TCB for a task. Declare one per task at global scope so its size shows up
+ * in the link map / ram-budget.py report, then call create() before the scheduler starts.
+ *
+ * @note a task created in this buffer can be deleted and re-created, as long as it is deleted by another task
+ * (a task deleting itself isn't fully removed until the idle task runs).
+ *
+ * @tparam STACK_SIZE stack depth in words
+ */
+template <uint32_t STACK_SIZE>
+class okStaticTask
+{
+public:
+    TaskHandle_t create(TaskFunction_t func, const char *name, void *params, UBaseType_t priority)
+    {
+        handle = xTaskCreateStatic(func, name, STACK_SIZE, params, priority, stack, &tcb);
+        return handle;
+    }
+
+    TaskHandle_t handle = NULL;
+
+private:
+    StackType_t stack[STACK_SIZE];
+    StaticTask_t tcb;
 };
\ No newline at end of file
@@ -0,0 +1,33 @@
+/**
+ * @file task_stats.h
+ * @brief per-task CPU usage, stack watermarks and deadline misses.
+ *
+ * CPU usage is calculated from the FreeRTOS run time stats counter (see getRunTimeCounterValue() in freertos.c),
+ * and is relative to the previous call to task_stats_sample()
+ */
+
+#pragma once
+
+#include "cmsis_os.h"
+#include "logger.h"
+
+#define TASK_STATS_MAX_TASKS          16
+#define TASK_STATS_MAX_PERIODIC_TASKS 8
+#define TASK_STATS_STACK_WARNING      32 // stack high water mark (in words) considered dangerously low
+
+typedef struct TaskStats
+{
+    const char *name;
+    UBaseType_t number;      // unique task number assigned by the kernel
+    uint8_t cpu;             // percentage of CPU time used since the previous sample
+    uint16_t stackFree;      // minimum amount of stack space (in words) that has remained since the task was created
+    uint32_t deadlineMisses; // number of times a periodic task was not ready by its next wake time
+} TaskStats;
+
+void task_delay_until(TickType_t *prevWakeTime, TickType_t period);
+uint32_t task_stats_get_deadline_misses(TaskHandle_t handle);
+
+int task_stats_sample();
+const TaskStats *task_stats_get(int index);
+bool task_stats_warning(const TaskStats *stats);
+void task_stats_log();
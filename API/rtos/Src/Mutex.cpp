@@ -9,7 +9,7 @@
 
 Mutex::Mutex()
 {
-    _handle = xSemaphoreCreateMutex();
+    _handle = xSemaphoreCreateMutexStatic(&_buffer);
 }
 
 void Mutex::lock(TickType_t wait /*=portMAX_DELAY*/)
@@ -5,7 +5,8 @@ SoftwareTimer::SoftwareTimer() {}
 SoftwareTimer::~SoftwareTimer()
 {
     detachCallback();
-    xTimerDelete(handle, 1);
+    if (handle)
+        xTimerDelete(handle, 1);
 }
 
 /**
@@ -64,6 +65,8 @@ void SoftwareTimer::setPeriod(TickType_t period)
 /**
  * @brief attach a callback for the timer to execute
  * 
+ * @note the timer is statically allocated inside this object. Calling this again re-uses the existing timer
+ * 
  * @param func 
  * @param period frequency
  * @param repeated one-shot or autoreload
@@ -71,12 +74,21 @@ void SoftwareTimer::setPeriod(TickType_t period)
 void SoftwareTimer::attachCallback(Callback<void()> func, TickType_t period, bool repeated)
 {
     _callback = func;
-    handle = xTimerCreate(
+    if (handle)
+    {
+        xTimerStop(handle, 0);
+        xTimerChangePeriod(handle, period, 0);
+        xTimerStop(handle, 0); // changing the period of a dormant timer starts it
+        vTimerSetReloadMode(handle, repeated ? pdTRUE : pdFALSE);
+        return;
+    }
+    handle = xTimerCreateStatic(
         "timer",                     // name for timer
         period,                      // period of timer in ticks
         repeated ? pdTRUE : pdFALSE, // auto-reload flag
         this,                        // unique ID for timer
-        callbackHandler);            // callback function
+        callbackHandler,             // callback function
+        &_buffer);                   // statically allocated timer
 }
 
 void SoftwareTimer::detachCallback()
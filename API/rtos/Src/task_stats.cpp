@@ -0,0 +1,141 @@
+#include "task_stats.h"
+
+typedef struct PeriodicTask
+{
+    TaskHandle_t handle;
+    uint32_t misses;
+} PeriodicTask;
+
+static PeriodicTask periodicTasks[TASK_STATS_MAX_PERIODIC_TASKS];
+
+static TaskStatus_t taskStatus[TASK_STATS_MAX_TASKS];
+static TaskStats taskStats[TASK_STATS_MAX_TASKS];
+static int taskCount = 0;
+
+static uint32_t prevTaskRunTime[TASK_STATS_MAX_TASKS + 1]; // indexed by task number
+static uint32_t prevTotalRunTime = 0;
+
+static PeriodicTask *get_periodic_task(TaskHandle_t handle, bool create)
+{
+    for (int i = 0; i < TASK_STATS_MAX_PERIODIC_TASKS; i++)
+    {
+        if (periodicTasks[i].handle == handle)
+            return &periodicTasks[i];
+    }
+    if (create)
+    {
+        for (int i = 0; i < TASK_STATS_MAX_PERIODIC_TASKS; i++)
+        {
+            if (periodicTasks[i].handle == NULL)
+            {
+                periodicTasks[i].handle = handle;
+                return &periodicTasks[i];
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief drop in replacement for vTaskDelayUntil() which counts missed deadlines.
+ * A deadline is missed when the task finishes its work after its next scheduled wake time, in which case
+ * vTaskDelayUntil() returns immediately and the period is lost.
+ *
+ * @param prevWakeTime same as vTaskDelayUntil()
+ * @param period same as vTaskDelayUntil()
+ */
+void task_delay_until(TickType_t *prevWakeTime, TickType_t period)
+{
+    if ((TickType_t)(xTaskGetTickCount() - *prevWakeTime) > period)
+    {
+        PeriodicTask *task = get_periodic_task(xTaskGetCurrentTaskHandle(), true);
+        if (task)
+            task->misses++;
+    }
+    vTaskDelayUntil(prevWakeTime, period);
+}
+
+uint32_t task_stats_get_deadline_misses(TaskHandle_t handle)
+{
+    PeriodicTask *task = get_periodic_task(handle, false);
+    return task ? task->misses : 0;
+}
+
+/**
+ * @brief take a snapshot of every task. CPU usage is relative to the previous snapshot.
+ * @return number of tasks in the snapshot
+ */
+int task_stats_sample()
+{
+    uint32_t totalRunTime;
+    taskCount = uxTaskGetSystemState(taskStatus, TASK_STATS_MAX_TASKS, &totalRunTime);
+    uint32_t elapsed = totalRunTime - prevTotalRunTime;
+    prevTotalRunTime = totalRunTime;
+
+    for (int i = 0; i < taskCount; i++)
+    {
+        TaskStatus_t *status = &taskStatus[i];
+        uint32_t runTime = status->ulRunTimeCounter;
+        uint32_t prev = 0;
+        if (status->xTaskNumber <= TASK_STATS_MAX_TASKS)
+        {
+            prev = prevTaskRunTime[status->xTaskNumber];
+            prevTaskRunTime[status->xTaskNumber] = runTime;
+        }
+
+        TaskStats *stats = &taskStats[i];
+        stats->name = status->pcTaskName;
+        stats->number = status->xTaskNumber;
+        stats->cpu = elapsed ? (uint8_t)(((uint64_t)(runTime - prev) * 100) / elapsed) : 0;
+        stats->stackFree = status->usStackHighWaterMark;
+        stats->deadlineMisses = task_stats_get_deadline_misses(status->xHandle);
+    }
+
+    // sort by task number so tasks always appear in the order they were created
+    for (int i = 1; i < taskCount; i++)
+    {
+        TaskStats tmp = taskStats[i];
+        int j = i - 1;
+        while (j >= 0 && taskStats[j].number > tmp.number)
+        {
+            taskStats[j + 1] = taskStats[j];
+            j--;
+        }
+        taskStats[j + 1] = tmp;
+    }
+    return taskCount;
+}
+
+const TaskStats *task_stats_get(int index)
+{
+    return (index < taskCount) ? &taskStats[index] : NULL;
+}
+
+bool task_stats_warning(const TaskStats *stats)
+{
+    return stats->deadlineMisses > 0 || stats->stackFree < TASK_STATS_STACK_WARNING;
+}
+
+/**
+ * @brief log the most recent snapshot as a table
+ */
+void task_stats_log()
+{
+    logger_log("\n\nTASK            CPU%   STACK   MISSED");
+    for (int i = 0; i < taskCount; i++)
+    {
+        TaskStats *stats = &taskStats[i];
+        logger_log("\n");
+        logger_log(stats->name);
+        for (int pad = strlen(stats->name); pad < configMAX_TASK_NAME_LEN; pad++)
+            logger_log(" ");
+        logger_log((uint32_t)stats->cpu);
+        logger_log("\t");
+        logger_log((uint32_t)stats->stackFree);
+        logger_log("\t");
+        logger_log(stats->deadlineMisses);
+        if (task_stats_warning(stats))
+            logger_log("\t<-- !!");
+    }
+    logger_log("\n");
+}
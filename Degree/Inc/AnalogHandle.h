@@ -7,12 +7,26 @@
 #include "okSemaphore.h"
 #include "logger.h"
 
+#define ADC_SAMPLE_READY_QUEUE_LENGTH 16
+
 #define ADC_SAMPLE_COUNTER_LIMIT 2000
+#define ADC_QUICK_DENOISE_SAMPLES 200  // short noise measurement used to check cached idle values for drift
+#define ADC_IDLE_DRIFT_TOLERANCE  500  // how far (on top of its noise) an inputs idle value may move before it gets re-measured
 #define ADC_DEFAULT_INPUT_MAX BIT_MAX_16
 #define ADC_DEFAULT_INPUT_MIN 0
+#define ADC_DENOISE_RATE_HZ 2000       // rate the sample counts passed to initDenoising() are given at
+
+// task notification bits set by the conversion complete ISRs, one per DMA block
+#define ADC_BLOCK_CONTROL   (1 << 0)  // ADC1 finished a scan of the controls
+#define ADC_BLOCK_CV_FIRST  (1 << 1)  // ADC2 filled the first half of the CV buffer
+#define ADC_BLOCK_CV_SECOND (1 << 2)  // ADC2 filled the second half of the CV buffer
 
 /**
  * @brief Simple class that pulls the data from a DMA buffer into an object
+ *
+ * CV inputs are scanned by ADC2 at ADC_CV_SAMPLE_RATE_HZ, the benders and tempo pot by ADC1 at
+ * ADC_CONTROL_SAMPLE_RATE_HZ. Each input then runs at its own rate (see setSampleRate()), by averaging blocks of raw
+ * samples down before they get filtered and processed, so slow inputs cost next to nothing.
 */ 
 class AnalogHandle {
 public:
@@ -28,10 +42,16 @@ public:
     uint16_t noiseFloor;                       // lowest read noise value when idle
     uint16_t inputMax = ADC_DEFAULT_INPUT_MAX; // highest read value from signal
     uint16_t inputMin = ADC_DEFAULT_INPUT_MIN; // lowest read value from signal
+    uint16_t cachedIdleValue = 0;              // avgValueWhenIdle from the last session (loaded from flash, 0 if none)
+    uint16_t cachedNoiseThreshold = 0;         // idleNoiseThreshold from the last session (loaded from flash)
 
     Callback<void(uint16_t progress)> samplingProgressCallback;
 
     uint16_t read_u16();
+    void setSampleRate(uint32_t hz);
+    uint32_t getSampleRate() { return getADCSampleRate() / decimation; }
+    uint32_t getADCSampleRate() { return isCV() ? ADC_CV_SAMPLE_RATE_HZ : ADC_CONTROL_SAMPLE_RATE_HZ; }
+    bool isCV() { return index < ADC_CV_CHANNELS; }
     void setFilter(float value);
     void enableFilter() { filter = true; }
     void disableFilter() { filter = false; }
@@ -40,8 +60,13 @@ public:
     void log_noise_threshold_to_console(char const *source_id);
     void log_min_max(char const *source_id);
 
-    okSemaphore * initDenoising();
+    okSemaphore * initDenoising(uint16_t numSamples = ADC_SAMPLE_COUNTER_LIMIT);
     void sampleSignalNoise(uint16_t sample);
+    bool hasCachedNoise() { return cachedNoiseThreshold != 0; }
+    bool restoreCachedNoise();
+
+    static void initDenoisingAll(uint16_t numSamples);
+    static void waitForDenoisingAll();
 
     okSemaphore * beginMinMaxSampling(uint16_t numSamples);
     void resetMinMax();
@@ -52,20 +77,31 @@ public:
     uint16_t getInputMin(void) { return inputMin; }
     uint16_t getInputMedian(void) { return inputMin + ((inputMax - inputMin) / 2); }
 
+    void addSample(uint16_t sample);
     void sampleReadyCallback(uint16_t sample);
     void attachSamplingProgressCallback(Callback<void(uint16_t progress)> func);
     void detachSamplingProgressCallback();
 
     static void sampleReadyTask(void *params);
-    static void RouteConversionCompleteCallback();
+    static void RouteConversionCompleteCallback(uint32_t block);
+    static void notifyEverySamples(TaskHandle_t task, uint8_t samples);
 
-    static uint16_t DMA_BUFFER[ADC_DMA_BUFF_SIZE];
-    static PinName ADC_PINS[ADC_DMA_BUFF_SIZE];
-    static AnalogHandle *_instances[ADC_DMA_BUFF_SIZE];
-    static SemaphoreHandle_t semaphore;
+    static uint16_t DMA_BUFFER[ADC_DMA_BUFF_SIZE];       // ADC1, one scan of the controls
+    static uint16_t CV_DMA_BUFFER[ADC_CV_DMA_BUFF_SIZE]; // ADC2, two halves of ADC_CV_BLOCK_SCANS interleaved CV scans
+    static PinName ADC_PINS[ADC_INPUT_COUNT];            // CV pins first, then the controls in ADC1 scan order
+    static AnalogHandle *_instances[ADC_INPUT_COUNT];
 
 private:
-    
+    static TaskHandle_t _sampleTask;   // the task running sampleReadyTask(), NULL until the scheduler has started it
+    static TaskHandle_t _notifyTask;   // task notified once every _notifySamples control blocks, after all instances have been updated
+    static uint8_t _notifySamples;
+
+    uint16_t latestSample();
+
+    uint8_t decimation = 1;    // how many raw samples get averaged into one processed sample
+    uint8_t decimationCount = 0;
+    uint32_t decimationSum = 0;
+
     uint16_t currValue;
     uint16_t prevValue;
     bool filter = false;
@@ -73,6 +109,7 @@ private:
     bool invert = false;
 
     uint16_t sampleTime;      // how long / how many samples you wish to sample for
+    uint16_t denoiseSamples = ADC_SAMPLE_COUNTER_LIMIT; // how many samples the current noise measurement takes
     uint16_t sampleCounter;   // basic counter for DSP
     bool samplingNoise;       // flag to tell handle whether to use the incloming data in the DMA_BUFFER for denoising an idle input signal
     bool samplingMinMax;
@@ -12,7 +12,6 @@
 #include "main.h"
 #include "logger.h"
 #include "okSemaphore.h"
-#include "Callback.h"
 #include "DAC8554.h"
 #include "ArrayMethods.h"
 #include "AnalogHandle.h"
@@ -36,9 +35,6 @@ public:
     DAC8554 *dac;              // pointer to Pitch Bends DAC
     DAC8554::Channel dacChan;  // which dac channel to address
     AnalogHandle adc;              // CV input via Instrumentation Amplifier
-    Callback<void()> idleCallback;                    // MBED Callback which gets called when the Bender is idle / not-active
-    Callback<void(uint16_t bend)> activeCallback;     // MBED Callback which gets called when the Bender is active / being bent
-    Callback<void(BendState state)> triStateCallback; // callback which gets called when bender changes from one of three BendState states
 
     BendState currState;
     BendState prevState;
@@ -60,7 +56,34 @@ public:
     };
 
     void init();
-    void poll();
+    void updateState();
+
+    /**
+     * @brief run the bender state machine and notify the listener (the TouchChannel which owns the bender). Gets called
+     * at BENDER_CONTROL_RATE_HZ for every channel, so the listener is bound at compile time rather than through a
+     * Callback, and these calls are direct.
+     *
+     * Listener must implement:
+     *   benderIdleCallback()                   - called every poll while the bender is idle / not-active
+     *   benderActiveCallback(uint16_t bend)     - called every poll while the bender is active / being bent
+     *   benderTriStateCallback(BendState state) - called when the bender changes from one of three BendState states
+     */
+    template <typename Listener>
+    void poll(Listener *listener)
+    {
+        updateState();
+        if (isIdle())
+            listener->benderIdleCallback();
+        else
+            listener->benderActiveCallback(currBend); // should this be passing the currBend value or the raw ADC value?
+
+        if (currState != prevState)
+        {
+            listener->benderTriStateCallback(currState);
+            prevState = currState;
+        }
+    }
+
     uint16_t read();
     uint16_t getIdleValue();
     uint16_t getMaxBend();
@@ -70,10 +93,7 @@ public:
 
     void setRatchetThresholds();
     void updateDAC(uint16_t value, bool bypassFilter = false);
-    bool isIdle();
+    bool isIdle() { return currState == BENDING_IDLE; }
     int setMode(int targetMode = 0);
     uint16_t calculateOutput(uint16_t value);
-    void attachIdleCallback(Callback<void()> func);
-    void attachActiveCallback(Callback<void(uint16_t bend)> func);
-    void attachTriStateCallback(Callback<void(BendState state)> func);
 };
\ No newline at end of file
@@ -26,9 +26,13 @@
 #include "IS31FL3739.h"
 
 #define DISPLAY_COLUMN_COUNT      16
+#define DISPLAY_ROW_COUNT         4
 #define DISPLAY_LED_COUNT         64
 #define DISPLAY_CHANNEL_LED_COUNT 16
 
+#define DISPLAY_LED_MASK(index) ((uint64_t)1 << (index))
+#define DISPLAY_ALL_LEDS_MASK   (~(uint64_t)0)
+
 static const int CHAN_DISPLAY_LED_MAP[4][DISPLAY_CHANNEL_LED_COUNT] {
     {0, 1, 2, 3, 16, 17, 18, 19, 32, 33, 34, 35, 48, 49, 50, 51},
     {4, 5, 6, 7, 20, 21, 22, 23, 36, 37, 38, 39, 52, 53, 54, 55},
@@ -51,20 +55,29 @@ enum PWM : uint8_t
     PWM_HIGH = 255,
 };
 
-struct DisplayScene {
+/**
+ * The display is composited from a stack of layers. Each layer keeps its own copy of all 64 LEDs, and an opacity mask
+ * with a bit per LED. An LED shows the topmost layer whose opacity bit is set for it.
+ *
+ * SEQUENCER    - always opaque. Sequence playback draws here no matter what menu is open
+ * MENU         - settings, calibration etc. Opened over the whole display and closed when the menu exits
+ * NOTIFICATION - transient animations drawn by the display task, only opaque for the LEDs being animated
+ */
+enum class LAYER {
+    SEQUENCER,
+    MENU,
+    NOTIFICATION,
+    NUM_LAYERS
+};
+typedef enum LAYER LAYER;
+
+struct DisplayLayer {
     bool blink = false;
+    uint64_t opacity = 0; // bit per LED, set where this layer hides the layers beneath it
     std::array<uint8_t, 64> led_state_pwm;
     std::array<bool, 64> led_state_blink;
 };
-typedef struct DisplayScene DisplayScene;
-
-enum class SCENE {
-    SEQUENCER,
-    SEQUENCE_LENGTH,
-    SETTINGS,
-    NUM_SCENES
-};
-typedef enum SCENE SCENE;
+typedef struct DisplayLayer DisplayLayer;
 
 class Display
 {
@@ -73,55 +86,51 @@ public:
     IS31FL3739 ledMatrix;
 
     Display(I2C *i2c_ptr) : ledMatrix(i2c_ptr) {
-        for (int i = 0; i < static_cast<int>(SCENE::NUM_SCENES); i++)
-        {
-            _scenes[i] = (DisplayScene *)malloc(sizeof(DisplayScene));
-            _scenes[i]->blink = false;
-        }
-        
-        _currScene = _scenes[0];
+        _layers[static_cast<int>(LAYER::SEQUENCER)].opacity = DISPLAY_ALL_LEDS_MASK;
     }
 
     void init();
-    void clear();
-    void clear(int chan);
-    void fill(uint8_t pwm, bool blink);
-    void fill(int chan, uint8_t pwm, bool blink);
+    void clear(LAYER layer = LAYER::SEQUENCER);
+    void clear(int chan, LAYER layer = LAYER::SEQUENCER);
+    void fill(uint8_t pwm, bool blink, LAYER layer = LAYER::SEQUENCER);
+    void fill(int chan, uint8_t pwm, bool blink, LAYER layer = LAYER::SEQUENCER);
 
-    void enableBlink();
-    void disableBlink();
+    void enableBlink(LAYER layer = LAYER::SEQUENCER);
+    void disableBlink(LAYER layer = LAYER::SEQUENCER);
 
     void blinkScene();
-    void setScene(SCENE scene);
-    void redrawScene();
-    void resetScene();
-
-    // having two display scenes would be helpful. The sequencer task could continue to run
-    // and set LEDs in "scene A", while other tasks and functions which ise the display set LEDs in "scene B"
-    // Then when you go back to the default mode, you just need to update the display
-    // with the "scene A" and all should be good.
+    bool isBlinking();
+    void openLayer(LAYER layer);
+    void closeLayer(LAYER layer);
 
     void setGlobalCurrent(uint8_t value);
     void setBlinkStatus(int chan, bool status);
-    void setLED(int index, uint8_t pwm, bool blink);
+    void setLED(int index, uint8_t pwm, bool blink, LAYER layer = LAYER::SEQUENCER);
     void toggleLED(int index);
     void toggleChannelLED(int chan, int index);
-    void redrawLED(int index);
-    void setColumn(int column, uint8_t pwm, bool blink);
-    void setChannelLED(int chan, int index, uint8_t pwm, bool blink);
+    void setColumn(int column, uint8_t pwm, bool blink, LAYER layer = LAYER::SEQUENCER);
+    void drawBar(int column, uint8_t percent, bool blink, LAYER layer = LAYER::SEQUENCER);
+    void setChannelLED(int chan, int index, uint8_t pwm, bool blink, LAYER layer = LAYER::SEQUENCER);
     void benderCalibration();
 
-    void setSpiralLED(int chan, int index, uint8_t pwm, bool blink);
+    void setSpiralLED(int chan, int index, uint8_t pwm, bool blink, LAYER layer = LAYER::SEQUENCER);
 
-    void drawSquare(int chan, TickType_t speed);
-    void drawSpiral(int chan, bool direction, uint8_t pwm, TickType_t speed);
-    void flash(int flashes, TickType_t ticks);
+    // the notification layer, drawn by the display tasks animations
+    void setOverlayLED(int index, uint8_t pwm);
+    void releaseOverlay(uint64_t mask);
+    static uint64_t channelMask(int chan);
+    static uint64_t columnMask(int column);
 
 private:
     uint8_t channel_blink_status; // value to hold the blink state of each channel. If bit is HIGH, blink all those LEDs
     bool _blinkState;
-    DisplayScene *_scenes[static_cast<int>(SCENE::NUM_SCENES)];
-    DisplayScene *_currScene = nullptr;
+    DisplayLayer _layers[static_cast<int>(LAYER::NUM_LAYERS)] = {}; // statically allocated along with the Display
+    uint8_t _output[DISPLAY_LED_COUNT] = {};                         // what each LED of the matrix was last set to
+
+    void drawLED(LAYER layer, int index, uint8_t pwm, bool blink);
+    uint8_t composeLED(int index);
+    void outputLED(int index);
+    void outputLEDs(uint64_t mask);
 
     static Mutex _mutex;
 };
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "main.h"
+
+#define GLIDE_RATE_HZ 4000     // how often a running glide steps the 1v/o DAC (TIM6 overflow frequency)
+#define GLIDE_TIME_MAX 2000    // ms
+#define GLIDE_EXPO_TIME_CONSTANTS 5 // an exponential glide covers this many time constants in its glide time (~99% of the way there)
+
+#define GLIDE_FIXED_POINT_BITS 16 // glide position is a 16 bit fraction on top of the value being slewed
+
+extern "C" void TIM6_DAC_IRQHandler(void);
+
+void glide_timer_init(TaskHandle_t task);
+void glide_timer_start();
+void glide_timer_stop();
+
+namespace DEGREE {
+    const uint16_t GLIDE_TIME_MAP[8] = {0, 15, 30, 60, 125, 250, 500, 1000}; // ms, selected via the degree pads
+
+    /**
+     * @brief Slews a value (the pitch of a VoltPerOctave output, which can exceed 16 bits) towards a target, one step every 1 / GLIDE_RATE_HZ seconds.
+     * setTarget() / jump() can be called from any task, tick() only gets called by task_glide.
+     */
+    class Glide
+    {
+    public:
+        enum Curve : uint8_t
+        {
+            LINEAR,     // constant rate, reaches the target in exactly the glide time
+            EXPONENTIAL // fast then slow, like the RC portamento of an analog synth
+        };
+
+        Glide()
+        {
+            time = 0;
+            curve = LINEAR;
+            position = 0;
+            target = 0;
+            increment = 0;
+            active = false;
+            setTime(0);
+        };
+
+        void setTime(uint16_t ms);
+        uint16_t getTime();
+        void setCurve(Curve value);
+        Curve getCurve();
+
+        void setTarget(uint32_t value);
+        void jump(uint32_t value);
+        bool tick();
+
+        bool isActive() { return active; }
+        uint32_t read() { return (uint32_t)(position >> GLIDE_FIXED_POINT_BITS); }
+
+    private:
+        uint16_t time;         // glide time in ms, 0 disables gliding
+        Curve curve;
+        uint32_t steps;        // how many ticks a glide lasts
+        uint32_t coefficient;  // fraction of the remaining distance covered each tick by an exponential glide (0.16 fixed point)
+        int64_t position;      // 32.16 fixed point
+        int64_t target;        // 32.16 fixed point
+        int64_t increment;     // linear glides only, 32.16 fixed point
+        volatile bool active;
+    };
+}
@@ -9,17 +9,29 @@
 #include "TouchChannel.h"
 #include "Callback.h"
 #include "SoftwareTimer.h"
+#include "okTask.h"
+#include "rtos_stats.h"
+#include "task_stats.h"
 #include "Flash.h"
 #include "MCP23017.h"
 #include "CAP1208.h"
 #include "SuperClock.h"
 #include "Display.h"
 #include "AnalogHandle.h"
+#include "UIState.h"
+#include "SessionSnapshot.h"
+#include "MemTelemetry.h"
+#include "midi_api.h"
 
 #define ACTION_EXIT_CLEAR   0
 #define ACTION_EXIT_STAGE_1 1
 #define ACTION_EXIT_STAGE_2 2
 
+#define CTRL_POLL_PERIOD_MS 10 // how often taskMain gets woken to poll the tempo pot / bender calibration
+
+#define BOOT_TASK_STACK_SIZE 256 // stack size of the tasks which initialize each I2C bus during boot
+#define BOOT_SPIRAL_SPEED    5   // ms between each step of the boot animation
+
 namespace DEGREE {
     class TouchChannel; // forward declaration
     
@@ -34,7 +46,9 @@ namespace DEGREE {
             CALIBRATING_BENDER,
             SETTING_SEQUENCE_LENGTH,
             SETTING_QUANTIZE_AMOUNT,
-            HARDWARE_TESTING
+            SETTING_GLIDE_TIME,
+            HARDWARE_TESTING,
+            SYSTEM_STATUS
         };
 
         GlobalControl(
@@ -49,6 +63,10 @@ namespace DEGREE {
             Display *display_ptr) : ioInterrupt(BUTTONS_INT, PullUp), touchInterrupt(GLBL_TOUCH_INT), recLED(REC_LED, 0), freezeLED(FREEZE_LED, 0), tempoPot(TEMPO_POT), tempoLED(TEMPO_LED), tempoGate(INT_CLOCK_OUTPUT)
         {
             mode = DEFAULT;
+            freezeHeld = false;
+            memoryWarningLED = false;
+            telemetryPollCount = 0;
+            copySource = -1;
             clock = clock_ptr;
             channels[0] = chanA_ptr;
             channels[1] = chanB_ptr;
@@ -76,6 +94,7 @@ namespace DEGREE {
         DigitalOut tempoGate;
 
         SoftwareTimer actionTimer;   // triggers a callback for handling timed gestures
+        SoftwareTimer pollTimer;     // periodically wakes taskMain to call poll()
         int actionCounter;           // this value gets incremented by timer when a pad is touched, and resets to 0 when released
         int actionCounterLimit;      // 
         int actionExitFlag;          // Used to exit current mode and dismiss button presses and releases. Pressing any tactile button will exit the current mode
@@ -83,6 +102,9 @@ namespace DEGREE {
         int selectedChannel;
 
         bool recordEnabled;          // global recording flag
+        bool freezeHeld;             // freeze button is held down (and the freeze LED lit)
+        bool memoryWarningLED;       // the freeze LED is flashing a memory telemetry warning
+        int telemetryPollCount;      // polls since boot, for timing the memory telemetry
         bool settingSequenceLength;  //
 
         bool sampleVCO;          // global flag for calibration routine
@@ -95,18 +117,28 @@ namespace DEGREE {
         uint16_t prevTempoPotValue;
 
         bool gestureFlag;
+        bool historyGesture;         // an undo / redo gesture is being held, releasing the clear buttons shouldn't clear anything
+        int copySource;              // channel whose sequence the copy gesture is copying, -1 when not copying
         uint8_t currTouched;
         uint8_t prevTouched;
 
         void init();
+        void publishUIState();
+        void initI2C1Peripherals();
+        void initI2C3Peripherals();
+        void denoiseAnalogInputs(bool cached);
         void poll();
+        void pollTimerCallback();
         void pollButtons();
         void pollTouchPads();
+        void handleCopyGesture();
         void pollTempoPot();
+        void pollMemoryTelemetry();
         void exitCurrentMode();
 
         void advanceSequencer(uint8_t pulse);
         void resetSequencer(uint8_t pulse);
+        void handleMidiMessage(MidiMessage msg);
 
         void handleFreeze(bool freeze);
 
@@ -127,16 +159,20 @@ namespace DEGREE {
 
         void loadCalibrationDataFromFlash();
         void saveCalibrationDataToFlash();
+        void writeCalibrationDataToFlash();
         void deleteCalibrationDataFromFlash();
 
         void loadChannelConfigDataFromFlash();
         void saveChannelConfigDataToFlash();
+        void writeChannelConfigDataToFlash(bool showProgress = false);
+        void restoreSessionSnapshot();
         void deleteChannelConfigDataFromFlash();
 
         void resetCalibrationDataToDefault();
         void resetCalibration1VO(int chan);
 
         void log_system_status();
+        void drawSystemStatus();
 
         void handleHardwareTest(uint16_t pressedButtons);
 
@@ -182,6 +218,7 @@ namespace DEGREE {
         enum Gestures : uint16_t
         {
             QUANTIZE_AMOUNT = SHIFT | PB_RANGE,
+            GLIDE_TIME = SHIFT | RESET,
             CALIBRATE_BENDER = SHIFT | BEND_MODE,
             RESET_BENDER_CAL_DATA = SHIFT | BEND_MODE | FREEZE,
             SETTINGS_RESET = SHIFT | FREEZE, // SHIFT + FREEZE
@@ -189,6 +226,10 @@ namespace DEGREE {
             CALIBRATE_1VO = SHIFT | CMODE,
             RESET_1VO_CAL_DATA = SHIFT | CMODE | FREEZE,
             CLEAR_SEQ_ALL = CLEAR_SEQ_BEND | CLEAR_SEQ_TOUCH,
+            UNDO_SEQ = SHIFT | CLEAR_SEQ_TOUCH,
+            REDO_SEQ = SHIFT | CLEAR_SEQ_BEND,
+            SONG_APPEND = SHIFT | SEQ_LENGTH,    // with select pads touched
+            SONG_CLEAR = SHIFT | QUANTIZE_SEQ,   // with select pads touched
             ENTER_HARDWARE_TEST = SHIFT | SEQ_LENGTH | QUANTIZE_SEQ | CMODE,
             LOG_SYSTEM_STATUS = SHIFT | QUANTIZE_SEQ | SEQ_LENGTH
         };
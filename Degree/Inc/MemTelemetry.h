@@ -0,0 +1,107 @@
+#pragma once
+
+#include "main.h"
+#include "okTask.h"
+#include "trace.h"
+#include "task_stats.h"
+#include "SeqHistory.h"
+
+namespace DEGREE {
+    class TouchChannel; // forward declaration, TouchChannel.h includes this header (via GlobalControl.h)
+}
+using DEGREE::TouchChannel;
+
+/**
+ * Runtime memory telemetry.
+ *
+ * Sampled once every MEM_TELEMETRY_PERIOD_MS by taskMain (see GlobalControl::poll()):
+ *   - RTOS heap free now, and the least it has ever been (heap_4 keeps track of that itself)
+ *   - stack high water mark of every registered task
+ *   - the deepest each queue registered with trace_register_queue() has been (tracked on every send, see trace.h)
+ *   - touch events per channel against SEQ_QUANTIZE_MAX_EVENTS, past which sequences play back unquantized and get
+ *     truncated by the brown out snapshot
+ *   - pages of the undo / redo pool in use (the pool drops old undo levels when full, so never raises a warning)
+ *
+ * Anything within its warning margin sets a bit in MemTelemetry::warnings, and the freeze LED flashes
+ * MEM_TELEMETRY_LED_PATTERN while any bit is set. Heap, stack and queue readings are all "worst ever", so once one of
+ * those warns it stays warning.
+ *
+ * The status gesture logs the latest sample as a table, followed by the same data as a binary blob which
+ * mem-decode.py turns back into a table:
+ *   MEM_BEGIN <blob size>
+ *   MEM_TASK <index> <name>
+ *   MEM_QUEUE <index> <name>
+ *   MEM <blob as hex>
+ *   MEM_END
+ *
+ * Blob layout (little endian):
+ *   u8 version, u8 task count, u8 queue count, u8 channel count
+ *   u32 heap size, u32 heap free, u32 heap min ever free, u32 warnings
+ *   per task:    u16 stack size (words), u16 stack min ever free (words)
+ *   per queue:   u16 length, u16 waiting, u16 peak
+ *   per channel: u16 touch events, u16 peak touch events
+ *   u16 max events per channel, u16 history pages used, u16 peak history pages used, u16 history pool size
+ */
+
+#define MEM_TELEMETRY_PERIOD_MS       1000
+#define MEM_TELEMETRY_MAX_TASKS       12
+#define MEM_TELEMETRY_VERSION         1
+#define MEM_TELEMETRY_BLOB_SIZE       (4 + 16 + MEM_TELEMETRY_MAX_TASKS * 4 + TRACE_MAX_QUEUES * 6 + CHANNEL_COUNT * 4 + 8)
+
+#define MEM_TELEMETRY_HEAP_WARNING    (configTOTAL_HEAP_SIZE / 8) // bytes of heap left
+#define MEM_TELEMETRY_STACK_WARNING   TASK_STATS_STACK_WARNING    // words of stack left
+#define MEM_TELEMETRY_QUEUE_WARNING   75 // % of a queue filled
+#define MEM_TELEMETRY_EVENTS_WARNING  90 // % of SEQ_QUANTIZE_MAX_EVENTS
+
+#define MEM_TELEMETRY_LED_STEP_MS     100
+#define MEM_TELEMETRY_LED_STEPS       10
+#define MEM_TELEMETRY_LED_PATTERN     0b0000000101 // one bit per step, LSB first. Two short flashes a second
+
+enum MemTelemetryWarning
+{
+    MEM_WARNING_HEAP = (1 << 0),
+    MEM_WARNING_STACK = (1 << 1),
+    MEM_WARNING_QUEUE = (1 << 2),
+    MEM_WARNING_EVENTS = (1 << 3)
+};
+
+typedef struct MemTelemetryTask
+{
+    TaskHandle_t handle;
+    uint16_t stackSize; // words
+    uint16_t stackFree; // minimum amount of stack (in words) that has remained since the task was created
+} MemTelemetryTask;
+
+typedef struct MemTelemetry
+{
+    uint32_t heapFree;
+    uint32_t heapMinFree;
+    MemTelemetryTask tasks[MEM_TELEMETRY_MAX_TASKS];
+    int taskCount;
+    uint16_t queueLength[TRACE_MAX_QUEUES + 1]; // indexed by queue number, 0 when no queue has the number
+    uint16_t queueWaiting[TRACE_MAX_QUEUES + 1];
+    uint16_t queuePeak[TRACE_MAX_QUEUES + 1];
+    uint16_t events[CHANNEL_COUNT];
+    uint16_t eventsPeak[CHANNEL_COUNT];
+    uint16_t historyPages;
+    uint16_t historyPeak;
+    uint32_t warnings; // MemTelemetryWarning bits
+} MemTelemetry;
+
+void mem_telemetry_init(TouchChannel **channels);
+void mem_telemetry_register_task(TaskHandle_t handle, uint32_t stackSize);
+void mem_telemetry_sample();
+const MemTelemetry *mem_telemetry_get();
+uint32_t mem_telemetry_warnings();
+int mem_telemetry_serialize(uint8_t *buffer, int size);
+void mem_telemetry_log();
+void mem_telemetry_dump();
+
+/**
+ * @brief register a statically allocated task, its stack size comes from the task buffer
+ */
+template <uint32_t STACK_SIZE>
+void mem_telemetry_register_task(okStaticTask<STACK_SIZE> &task)
+{
+    mem_telemetry_register_task(task.handle, STACK_SIZE);
+}
@@ -4,15 +4,23 @@
 #include "tim_api.h"
 #include "AnalogHandle.h"
 #include "logger.h"
+#include "okTask.h"
 
 extern ADC_HandleTypeDef hadc1;
+extern ADC_HandleTypeDef hadc2;
 extern DMA_HandleTypeDef hdma_adc1;
+extern DMA_HandleTypeDef hdma_adc2;
 extern TIM_HandleTypeDef htim3;
+extern TIM_HandleTypeDef htim8;
 
 #ifndef ADC_DMA_BUFF_SIZE
 #define ADC_DMA_BUFF_SIZE 8
 #endif
 
+#ifndef ADC_CV_DMA_BUFF_SIZE
+#define ADC_CV_DMA_BUFF_SIZE 64
+#endif
+
 #ifndef ADC_TIM_PRESCALER
 #define ADC_TIM_PRESCALER 100
 #endif
@@ -21,8 +29,6 @@ extern TIM_HandleTypeDef htim3;
 #define ADC_TIM_PERIOD 2000
 #endif
 
-#define ADC_SAMPLE_RATE_HZ 2000
-
 void multi_chan_adc_init();
 void multi_chan_adc_start();
 
@@ -33,7 +39,9 @@ void multi_chan_adc_enable_irq();
 void multi_chan_adc_disable_irq();
 
 void MX_ADC1_Init(void);
+void MX_ADC2_Init(void);
 void MX_TIM3_Init(void);
+void MX_TIM8_Init(void);
 void MX_DMA_Init(void);
 
 void ADC1_DMA_Callback(uint16_t values[]);
\ No newline at end of file
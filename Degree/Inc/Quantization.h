@@ -28,5 +28,6 @@ const int Q_THIRTY_SECOND_NOTE[9] = {0, 12, 24, 36, 48, 60, 72, 84, 96};
 const int Q_SIXTY_FOURTH_NOTE[12] = {0, 6, 12, 18, 24, 30, 36, 72, 78, 84, 90, 96};
 
 int getQuantizedPosition(int pos, int length, QUANT target);
+int quantize_position(int pos, QUANT target);
 int quant_value_to_index(QUANT value);
 int quant_value_to_int(QUANT value);
\ No newline at end of file
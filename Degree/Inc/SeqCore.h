@@ -0,0 +1,45 @@
+#pragma once
+
+#include "main.h"
+
+#define SEQ_CORE_MAX_CHANNELS 8 // room for an expander, the advance loop only covers the sequences which exist
+
+// reasons a channel needs handleClock() called on every pulse, not just on new steps and at its next event
+#define SEQ_WAKE_RECORD        0x01 // recording / overdubbing
+#define SEQ_WAKE_BENDER        0x02 // the bender is active (bend recording, ratchets)
+#define SEQ_WAKE_CV            0x04 // quantizer modes sample the CV input every pulse
+#define SEQ_WAKE_BEND_PLAYBACK 0x08 // recorded bend events get played back every pulse
+#define SEQ_WAKE_UI            0x10 // a menu animates in time with the clock
+
+class SuperSeq; // forward declaration
+
+/**
+ * @brief Playback state of every sequence packed into arrays, so all the channels advance in one pass over a few
+ * cache lines instead of chasing pointers through each TouchChannel / SuperSeq.
+ *
+ * SuperSeq's position members are references into these arrays, so everything else keeps reading them like before.
+ * Only the sequencer task advances positions.
+ */
+typedef struct SeqCore
+{
+    int position[SEQ_CORE_MAX_CHANNELS];     // SuperSeq::currPosition
+    int prevPosition[SEQ_CORE_MAX_CHANNELS]; // SuperSeq::prevPosition
+    int stepPosition[SEQ_CORE_MAX_CHANNELS]; // SuperSeq::currStepPosition
+    int step[SEQ_CORE_MAX_CHANNELS];         // SuperSeq::currStep
+    int prevStep[SEQ_CORE_MAX_CHANNELS];     // SuperSeq::prevStep
+    int length[SEQ_CORE_MAX_CHANNELS];       // SuperSeq::length
+    int lengthPPQN[SEQ_CORE_MAX_CHANNELS];   // SuperSeq::lengthPPQN
+    int nextEvent[SEQ_CORE_MAX_CHANNELS];    // position the next touch event gets triggered at, -1 if there are none
+    bool adaptive[SEQ_CORE_MAX_CHANNELS];    // SuperSeq::adaptiveLength
+    uint8_t wake[SEQ_CORE_MAX_CHANNELS];     // SEQ_WAKE_* flags, only modified via seq_core_set_wake()
+    volatile uint8_t resync[SEQ_CORE_MAX_CHANNELS]; // the sequence changed, wake on the next pulse so nextEvent gets recalculated
+    SuperSeq *sequences[SEQ_CORE_MAX_CHANNELS];
+    int count;
+} SeqCore;
+
+extern SeqCore seq_core;
+
+int seq_core_register(SuperSeq *sequence);
+void seq_core_set_wake(int index, uint8_t reason, bool enable);
+bool seq_core_advance_channel(int index);
+uint32_t seq_core_advance();
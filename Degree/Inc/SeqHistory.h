@@ -0,0 +1,97 @@
+#pragma once
+
+#include "main.h"
+
+#define SEQ_HISTORY_PAGE_EVENTS PPQN                                         // events per page (one step)
+#define SEQ_HISTORY_PAGE_COUNT (MAX_SEQ_LENGTH_PPQN / SEQ_HISTORY_PAGE_EVENTS) // pages per sequence, per plane
+#define SEQ_HISTORY_POOL_PAGES (2 * SEQ_HISTORY_PAGE_COUNT) // saved pages shared by every channel (192 bytes each), enough to undo clearing a full sequence
+#define SEQ_HISTORY_LEVELS 4      // undo + redo levels per channel
+#define SEQ_HISTORY_NO_PAGE 0xFF
+
+class SuperSeq; // forward declaration
+
+/**
+ * @brief the two halves of a sequence event which get saved separately, so clearing bend events doesn't copy touch
+ * events (and vice versa)
+ */
+enum class SEQ_PLANE : uint8_t
+{
+    TOUCH, // SequenceNode activeDegrees + data
+    BEND   // SequenceNode bend
+};
+
+typedef struct SeqHistoryPage
+{
+    uint16_t data[SEQ_HISTORY_PAGE_EVENTS];
+} SeqHistoryPage;
+
+/**
+ * @brief Copy-on-write undo / redo for a SuperSeq.
+ *
+ * checkpoint() only opens a new level, nothing gets copied. The first time a page of the sequence gets modified after
+ * that, SuperSeq calls save() and the page's current contents are copied into a page from a pool shared by all channels.
+ * Undo swaps the saved pages with the sequence, which turns the level into a redo level holding the newer contents.
+ *
+ * When the pool runs dry the oldest level of any channel gets dropped to make room, so one busy channel can't starve
+ * the undo of the others.
+ *
+ * Checkpoints made between beginGroup() and endGroup() (ie. clearing every channel at once) share a stamp, and get
+ * dropped together or not at all, so undoing them on every channel always restores all of them. The pool can't hold
+ * every channel's full sequence, reserve() tells upfront if a group change can be undone.
+ */
+class SeqHistory
+{
+public:
+    SeqHistory(SuperSeq *seq_ptr)
+    {
+        seq = seq_ptr;
+        base = 0;
+        undoCount = 0;
+        redoCount = 0;
+        registerHistory(this);
+    };
+
+    void checkpoint();
+    void save(SEQ_PLANE plane, int position);
+    bool undo();
+    bool redo();
+    void clear();
+
+    int getUndoCount() { return undoCount; }
+    int getRedoCount() { return redoCount; }
+
+    int countPages(SEQ_PLANE plane);
+
+    static int getPoolPagesUsed();
+    static void beginGroup();
+    static void endGroup();
+    static bool reserve(int pages);
+
+private:
+    typedef struct Level
+    {
+        uint8_t pages[2][SEQ_HISTORY_PAGE_COUNT]; // index into the pool for each saved page, SEQ_HISTORY_NO_PAGE if untouched
+        bool modified;                            // the sequence was changed since the checkpoint
+        int length;                               // sequence length (in steps) at the checkpoint
+        bool containsTouchEvents;
+        bool containsBendEvents;
+        uint32_t stamp;                           // when the checkpoint was made, for finding the oldest level of any channel
+    } Level;
+
+    SuperSeq *seq;
+    Level levels[SEQ_HISTORY_LEVELS]; // ring buffer, oldest undo level first followed by the redo levels
+    int base;                         // ring index of the oldest undo level
+    int undoCount;
+    int redoCount;
+
+    Level *getLevel(int index) { return &levels[(base + index) % SEQ_HISTORY_LEVELS]; }
+    void swap(Level *level);
+    void release(Level *level);
+    void dropOldest();
+    void clearRedo();
+    Level *getEvictable(bool current);
+    void evict();
+
+    static void registerHistory(SeqHistory *history);
+    static bool evictOldest(SeqHistory *saving, uint32_t keep);
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "main.h"
+
+#ifndef SEQ_PATTERN_SONG_SLOTS
+#define SEQ_PATTERN_SONG_SLOTS 0                                      // distinct patterns songs can hold on top of the ones the channels are playing
+#endif
+#define SEQ_PATTERN_POOL_SIZE (CHANNEL_COUNT + SEQ_PATTERN_SONG_SLOTS) // 12KB each
+#define SEQ_PATTERN_NONE 0xFF
+#define SEQ_SONG_MAX_LENGTH 8                                         // patterns chained per channel
+
+struct SequenceNode; // forward declaration
+
+/**
+ * @brief Pool of pattern buffers (a full events array each) shared by every channel.
+ *
+ * A SuperSeq holds a reference to one pattern rather than owning its events. Copying a sequence to another channel, or
+ * chaining it into a song, only takes another reference. The first edit to a pattern with more than one reference
+ * copies it into a free buffer (see SuperSeq::unshare()), so the other holders never see the change.
+ *
+ * Every channel always holds exactly one reference, so with CHANNEL_COUNT + SEQ_PATTERN_SONG_SLOTS buffers a free
+ * buffer is guaranteed to exist for every copy-on-write as long as songs pin no more than SEQ_PATTERN_SONG_SLOTS
+ * distinct patterns. seq_pattern_pin() enforces that.
+ *
+ * RAM trade-off: sharing only saves copying, the pool is sized for the worst case where every channel plays its own
+ * pattern, so CHANNEL_COUNT buffers cost the same as the events arrays the channels used to own. Each song slot is
+ * another 12KB on top of that, and songs can only chain as many distinct patterns as there are slots. There are no
+ * slots until `make ram-budget` confirms the headroom, build with -DSEQ_PATTERN_SONG_SLOTS=n to turn them on. Without
+ * a slot a song entry pins nothing and follows later edits instead, see SeqSongEntry.
+ *
+ * Only the sequencer task (or boot code running before it) may call these.
+ */
+
+uint8_t seq_pattern_alloc();
+void seq_pattern_retain(uint8_t pattern);
+void seq_pattern_release(uint8_t pattern);
+bool seq_pattern_pin(uint8_t pattern);
+void seq_pattern_unpin(uint8_t pattern);
+bool seq_pattern_shared(uint8_t pattern);
+SequenceNode *seq_pattern_events(uint8_t pattern);
+int seq_pattern_used();
+
+/**
+ * @brief a pattern chained into a song, along with the sequence settings it was recorded with.
+ *
+ * When no song slot was left to pin the pattern, pattern is SEQ_PATTERN_NONE and the entry is live: it keeps playing
+ * whatever the channel holds by then (edits included), only switching to the entry's length.
+ */
+typedef struct SeqSongEntry
+{
+    uint8_t pattern;
+    uint8_t length; // steps
+    bool containsTouchEvents;
+    bool containsBendEvents;
+} SeqSongEntry;
+
+/**
+ * @brief Chain of pinned pattern references a channel plays one after the other, moving on every time its sequence
+ * loops. The same pattern can be chained any number of times for the cost of one buffer.
+ */
+class SeqSong
+{
+public:
+    SeqSong()
+    {
+        count = 0;
+        position = 0;
+    };
+
+    bool append(uint8_t pattern, int length, bool containsTouchEvents, bool containsBendEvents);
+    void clear();
+    SeqSongEntry *next();
+
+    int getLength() { return count; }
+    bool isPlaying() { return count > 1; } // a single entry would just keep replacing the sequence with itself
+
+private:
+    SeqSongEntry entries[SEQ_SONG_MAX_LENGTH];
+    int count;
+    int position; // entry currently loaded into the sequence
+};
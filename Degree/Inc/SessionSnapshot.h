@@ -0,0 +1,43 @@
+#pragma once
+
+#include "main.h"
+#include "SuperSeq.h"
+
+namespace DEGREE {
+    class TouchChannel; // forward declaration, TouchChannel.h includes this header (via GlobalControl.h)
+}
+using DEGREE::TouchChannel;
+
+/**
+ * Emergency save of the live session on brown out.
+ *
+ * The PVD (programmable voltage detector) fires an interrupt as soon as VDD drops below ~2.9V, which leaves the few
+ * milliseconds it takes the PSU rails to collapse. In that time every channels config, sequence config and touch events
+ * get written into FLASH_SNAPSHOT_ADDR, an area of the config sector which is always kept erased so nothing has to be
+ * erased (~1s) before writing. On the next boot the snapshot gets loaded on top of whatever was saved to flash, and then
+ * saved the regular way, which erases the config sector and so gets the snapshot area ready for the next power down.
+ *
+ * Bend events are left out, at one per PPQN there are far too many of them to write in time. A restored sequence keeps
+ * the bend events it was last saved with.
+ *
+ * Snapshot layout (32-bit words):
+ *   [0] SNAPSHOT_BEGIN, programmed first so an interrupted snapshot still marks the area as used
+ *   [1] number of payload words
+ *   [2] checksum of the payload
+ *   [3] SNAPSHOT_COMMIT, programmed last. A snapshot without it never finished and gets ignored
+ *   [4] payload, per channel: channel config (8), sequence config (8), touch event count, touch events (see
+ *       SuperSeq::serializeTouchEvents())
+ */
+
+#define SNAPSHOT_BEGIN  0x534E4150 // "SNAP"
+#define SNAPSHOT_COMMIT 0x444F4E45 // "DONE"
+#define SNAPSHOT_HEADER_SIZE 4
+#define SNAPSHOT_CONFIG_SIZE 8
+#define SNAPSHOT_MAX_EVENTS SEQ_QUANTIZE_MAX_EVENTS // per channel, touch events past this don't make it into the snapshot
+#define SNAPSHOT_MAX_WORDS (SNAPSHOT_HEADER_SIZE + CHANNEL_COUNT * (SNAPSHOT_CONFIG_SIZE * 2 + 1 + SNAPSHOT_MAX_EVENTS))
+#define SNAPSHOT_PVD_PRIORITY 0 // above every other interrupt, the handler never calls into the RTOS
+
+void session_snapshot_init(TouchChannel **channels);
+bool session_snapshot_write();
+bool session_snapshot_pending();
+bool session_snapshot_restore(TouchChannel **channels);
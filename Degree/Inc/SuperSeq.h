@@ -4,11 +4,15 @@
 #include "Bender.h"
 #include "ArrayMethods.h"
 #include "Quantization.h"
+#include "SeqHistory.h"
+#include "SeqPattern.h"
+#include "SeqCore.h"
 
 #define NULL_NOTE_INDEX 99 // used to identify a 'null' or 'deleted' sequence event
 #define SEQ_EVENT_STATUS_BIT 5
 #define SEQ_EVENT_GATE_BIT 4
-#define SEQ_EVENT_INDEX_BIT_MASK 0b00001111
+#define SEQ_EVENT_GLIDE_BIT 3
+#define SEQ_EVENT_INDEX_BIT_MASK 0b00000111
 #define SEQ_EVENT_OCTAVE_BIT_MASK 0b11000000
 
 #define SEQ_LENGTH_BLOCK_1 (MAX_SEQ_LENGTH / 4)                        // 1 bar
@@ -16,48 +20,95 @@
 #define SEQ_LENGTH_BLOCK_3 ((MAX_SEQ_LENGTH / 2) + SEQ_LENGTH_BLOCK_1) // 3 bars
 #define SEQ_LENGTH_BLOCK_4 (MAX_SEQ_LENGTH)                            // 4 bars
 
+#define SEQ_QUANTIZE_MAX_EVENTS 256 // sequences with more touch events than this play back unquantized
+#define SEQ_CONFIG_WORDS 6          // words storeSequenceConfigData() fills in
+
 typedef struct SequenceNode
 {
     uint8_t activeDegrees; // byte for holding active/inactive notes for a chord
-    uint8_t data;          // bits 0..3: Degree Index || bit 4: Gate || bit 5: status || bits 6,7: octave
+    uint8_t data;          // bits 0..2: Degree Index || bit 3: Glide || bit 4: Gate || bit 5: status || bits 6,7: octave
     uint16_t bend;         // raw ADC value from pitch bend
     bool getStatus() { return bitwise_read_bit(data, SEQ_EVENT_STATUS_BIT); }
     uint8_t getDegree() { return data & SEQ_EVENT_INDEX_BIT_MASK; }
     bool getGate() { return bitwise_read_bit(data, SEQ_EVENT_GATE_BIT); }
+    bool getGlide() { return bitwise_read_bit(data, SEQ_EVENT_GLIDE_BIT); }
     uint8_t getOctave() { return (data & SEQ_EVENT_OCTAVE_BIT_MASK) >> 6; }
     uint8_t getActiveOctaves() { return data; }
 } SequenceNode;
 
+/**
+ * @brief maps a recorded touch event to the position it gets triggered at when quantized playback is enabled
+ */
+typedef struct QuantizedEvent
+{
+    uint16_t event;    // position the event was recorded at (index into SuperSeq::events)
+    uint16_t position; // quantized playback position
+} QuantizedEvent;
+
 class SuperSeq {
 public:
 
-    SuperSeq(Bender *benderPtr) {
+    SuperSeq(Bender *benderPtr) : coreIndex(seq_core_register(this)),
+                                  history(this),
+                                  length(seq_core.length[coreIndex]),
+                                  lengthPPQN(seq_core.lengthPPQN[coreIndex]),
+                                  currStepPosition(seq_core.stepPosition[coreIndex]),
+                                  currStep(seq_core.step[coreIndex]),
+                                  prevStep(seq_core.prevStep[coreIndex]),
+                                  currPosition(seq_core.position[coreIndex]),
+                                  prevPosition(seq_core.prevPosition[coreIndex]),
+                                  adaptiveLength(seq_core.adaptive[coreIndex])
+    {
+        pattern = seq_pattern_alloc(); // the pool holds a buffer for every channel
+        events = seq_pattern_events(pattern);
         bender = benderPtr;
         setLength(DEFAULT_SEQ_LENGTH);
+        quantizeEnabled = false;
+        quantizedEventCount = 0;
+        quantizedEventStart = 0;
+        quantizedEventsOverflow = false;
+        quantizeEventsDirty = true;
+        quantizeCursor = 0;
+        quantizeCursorPosition = -1;
         setQuantizeAmount(QUANT::EIGTH);
     };
 
-    SequenceNode events[MAX_SEQ_LENGTH_PPQN];
+    int coreIndex;        // this sequences slot in seq_core
+    uint8_t pattern;      // this sequences buffer in the pattern pool, may be shared with other channels and songs
+    SequenceNode *events; // the pattern's events. Read them freely, but anything modifying them must call unshare() first
+    SeqHistory history;   // undo / redo of changes to the events
+    SeqSong song;         // patterns this sequence steps through each time it loops
     Bender *bender;       // you need the instance of a bender for determing its idle value when clearing / initializing bender events
     QUANT quantizeAmount;
 
-    int length;              // how many steps the sequence contains
-    int lengthPPQN;          // how many PPQN the sequence contains
-    int currStepPosition;    // the number of PPQN that have passed since the last step was advanced
-    int currStep;            // current sequence step
-    int prevStep;            // the previous step executed in the sequence
-    int currPosition;        // current position of sequence (in PPQN)
-    int prevPosition;
+    // playback state lives in seq_core so every sequence can be advanced in one pass
+    int &length;             // how many steps the sequence contains
+    int &lengthPPQN;         // how many PPQN the sequence contains
+    int &currStepPosition;   // the number of PPQN that have passed since the last step was advanced
+    int &currStep;           // current sequence step
+    int &prevStep;           // the previous step executed in the sequence
+    int &currPosition;       // current position of sequence (in PPQN)
+    int &prevPosition;
     int prevEventPos;        // represents the position of the last event which got triggered (either HIGH or LOW)
     int newEventPos;         // when a new event is created, we store the position in this variable in case we need it for something (ie. sequence overdubing)
 
-    bool adaptiveLength;     // flag determining if the sequence length should increase past its current length
+    bool &adaptiveLength;    // flag determining if the sequence length should increase past its current length
     bool overdub;            // flag gets set to true so that the sequence handler clears/overdubs existing events
     bool recordEnabled;      // when true, sequence will create and new events to the event list
     bool playbackEnabled;    // when true, sequence will playback event list
     bool bendEnabled;        // flag used for overriding current recorded bend with active bend    
     bool containsTouchEvents;// flag indicating if a sequence has any touch events
     bool containsBendEvents; // flag indicating if a sequence has any bend events
+    bool quantizeEnabled;    // when true, touch events get triggered at their quantized position. Recorded events are never moved
+
+    QuantizedEvent quantizedEvents[SEQ_QUANTIZE_MAX_EVENTS]; // every touch event in recorded order
+    int quantizedEventCount;
+    int quantizedEventStart;      // index of the event with the earliest quantized position
+    bool quantizedEventsOverflow; // more than SEQ_QUANTIZE_MAX_EVENTS touch events
+    bool quantizeEventsDirty;     // touch events were added / removed since quantizedEvents was last built
+    bool quantizeGridDirty;       // quantize amount or length changed since quantized positions were last calculated
+    int quantizeCursor;           // next event (in quantized order) getQuantizedEvent() will return
+    int quantizeCursorPosition;   // the position quantizeCursor was found for
 
     void init();
     void reset();
@@ -69,10 +120,18 @@ public:
     void clearBendAtPosition(int position);
     void clearTouchAtPosition(int position);
 
+    void unshare();
+    void modify(SEQ_PLANE plane, int position);
+    void share(SuperSeq *source);
+    void loadPattern(uint8_t source, int steps, bool touchEvents, bool bendEvents);
+    bool appendToSong();
+    void clearSong();
+    bool advanceSong();
+
     void copyPaste(int prevPosition, int newPosition);
     void cutPaste(int prevPosition, int newPosition);
 
-    void createTouchEvent(int position, uint8_t degree, uint8_t octave, bool gate);
+    void createTouchEvent(int position, uint8_t degree, uint8_t octave, bool gate, bool glide = false);
     void createBendEvent(int position, uint16_t bend);
     void createChordEvent(int position, uint8_t degrees, uint8_t octaves);
     
@@ -95,13 +154,26 @@ public:
     void enableOverdub();
     void disableOverdub();
 
-    void quantize();
+    void eventsChanged();
+    void setWake(uint8_t reason, bool enable);
+    void updateNextEvent(bool enable);
+    int getIndexedEventPosition(int index, bool quantized);
+
+    void enableQuantize();
+    void disableQuantize();
     void setQuantizeAmount(QUANT value);
+    bool quantizedPlayback();
+    int getQuantizedEvent(int position);
+    void indexQuantizedEvents();
+    void updateQuantizedPositions();
 
-    void setEventData(int position, uint8_t degree, uint8_t octave, bool gate, bool status);
+    void setEventData(int position, uint8_t degree, uint8_t octave, bool gate, bool status, bool glide = false);
 
     uint32_t encodeEventData(int position);
     void decodeEventData(int position, uint32_t data);
+    template <typename Sink>
+    int serializeTouchEvents(Sink &sink, int maxEvents);
+    void deserializeTouchEvent(uint32_t data);
     void storeSequenceConfigData(uint32_t *arr);
     void loadSequenceConfigData(uint32_t *arr);
 
@@ -110,6 +182,7 @@ public:
     uint8_t getActiveDegrees(int position);
     uint8_t getActiveOctaves(int position);
     bool getEventGate(int position);
+    bool getEventGlide(int position);
     bool getEventStatus(int position);
     bool eventsAreAssociated(int pos1, int pos2);
     uint16_t getBend(int position);
@@ -118,9 +191,34 @@ public:
 
     uint8_t setIndexBits(uint8_t degree, uint8_t byte);
     uint8_t setGateBits(bool state, uint8_t byte);
+    uint8_t setGlideBits(bool glide, uint8_t byte);
     uint8_t setStatusBits(bool status, uint8_t byte);
     uint8_t setOctaveBits(uint8_t octave, uint8_t byte);
     uint8_t setActiveOctaveBits(uint8_t octaves);
 
     void logSequenceToConsole();
-};
\ No newline at end of file
+};
+
+/**
+ * @brief pass every touch event to sink(word) in position order, packed as position (16 bits) | activeDegrees (8 bits)
+ * | data (8 bits). Bend events are left out.
+ *
+ * Takes at most lengthPPQN reads of the event array and maxEvents calls to sink, no matter what the sequence holds, so
+ * it is safe to call from an ISR with a deadline (see session_snapshot_write()).
+ *
+ * @return number of touch events passed to sink
+ */
+template <typename Sink>
+int SuperSeq::serializeTouchEvents(Sink &sink, int maxEvents)
+{
+    int count = 0;
+    for (int position = 0; position < lengthPPQN && count < maxEvents; position++)
+    {
+        if (events[position].getStatus())
+        {
+            sink(((uint32_t)position << 16) | ((uint32_t)events[position].activeDegrees << 8) | events[position].data);
+            count++;
+        }
+    }
+    return count;
+}
@@ -11,6 +11,9 @@
 #include "Display.h"
 #include "okSemaphore.h"
 #include "task_sequence_handler.h"
+#include "task_display.h"
+#include "UIState.h"
+#include "midi_api.h"
 
 typedef struct QuantOctave
 {
@@ -31,6 +34,10 @@ namespace DEGREE {
     #define CHANNEL_PB_LED 9
     #define CHANNEL_QUANT_LED 8
     #define CV_QUANTIZER_DEBOUNCE 1000 // used to avoid rapid re-triggering of a degree when the CV signal is noisy
+    #define CV_INPUT_SAMPLE_RATE_HZ 2000 // rate the CV input gets processed at outside of calibration (decimated from ADC_CV_SAMPLE_RATE_HZ)
+    #define MIDI_NOTE_BASE 36          // MIDI note of dacVoltageMap[0] (C2). Notes in and out are relative to it
+    #define MIDI_NOTE_NONE 0xFF
+    #define CHANNEL_CONFIG_WORDS 5     // words copyConfigData() fills in
 
     static const int OCTAVE_LED_PINS[4] = { 3, 2, 1, 0 };               // led driver pin map for octave LEDs
     static const int DEGREE_LED_PINS[8] = { 15, 14, 13, 12, 7, 6, 5, 4 }; // led driver pin map for channel LEDs
@@ -40,6 +47,7 @@ namespace DEGREE {
 
     static const int DAC_OCTAVE_MAP[4] = { 0, 12, 24, 36 };               // for mapping a value between 0..3 to octaves
     static const int DEGREE_INDEX_MAP[8] = { 0, 2, 4, 6, 8, 10, 12, 14 }; // for mapping an index between 0..7 to a scale degree
+    static const PinName TOUCH_INT_PINS[CHANNEL_COUNT] = { TOUCH_INT_A, TOUCH_INT_B, TOUCH_INT_C, TOUCH_INT_D }; // touch IC interrupt pin per channel
     
     class TouchChannel {
     public:
@@ -65,7 +73,8 @@ namespace DEGREE {
             UI_PLAYBACK,
             UI_PITCH_BEND_RANGE,
             UI_SEQUENCE_LENGTH,
-            UI_QUANTIZE_AMOUNT
+            UI_QUANTIZE_AMOUNT,
+            UI_GLIDE_TIME
         };
 
         enum PlaybackMode
@@ -118,6 +127,9 @@ namespace DEGREE {
             activeOctaves = 0xF;
             numActiveDegrees = DEGREE_COUNT;
             numActiveOctaves = OCTAVE_COUNT;
+            midiPitch = MIDI_NOTE_BASE;
+            midiNoteSounding = MIDI_NOTE_NONE;
+            midiNotesHeld = 0;
         };
 
         int channelIndex;          // an index value used for accessing the odd array
@@ -133,8 +145,6 @@ namespace DEGREE {
 
         bool led_state[16];
 
-        bool selectPadIsTouched;      // each channel has a select pad in the control section
-        bool armSelectPadRelease;     // if an event happens while selectPadIsTouched == true, should the pad be released, we want to treat the next event as if it is still touched
 
         uint8_t currRatchetRate;
         uint8_t prevRatchetRate;
@@ -168,11 +178,20 @@ namespace DEGREE {
         QuantDegree activeDegreeValues[8]; // array which holds noteIndex values and their associated DAC/1vo values
         QuantOctave activeOctaveValues[OCTAVE_COUNT];
 
+        // MIDI members
+        uint8_t midiPitch;        // MIDI note of the pitch currently on the DAC
+        uint8_t midiNoteSounding; // MIDI note a note on was last sent for, MIDI_NOTE_NONE once its note off went out
+        int midiNotesHeld;        // MIDI notes received and not yet released. The CV input is ignored while any are held
+
         SuperSeq sequence;
 
+        void initOutputs();
+        void initLEDs();
+        void initTouchPads();
         void init();
         void poll();
         void handleClock();
+        void pollBender();
         void setUIMode(UIMode targetMode);
         void setPlaybackMode(PlaybackMode targetMode);
         void toggleMode();
@@ -183,7 +202,7 @@ namespace DEGREE {
         void handleReleasePlaybackEvent(uint8_t pad);
         void onTouch(uint8_t pad);
         void onRelease(uint8_t pad);
-        void triggerNote(int degree, int octave, Action action);
+        void triggerNote(int degree, int octave, Action action, bool glide = true);
         void freeze(bool state);
         void updateDegrees();
 
@@ -198,25 +217,33 @@ namespace DEGREE {
         void setOctaveLed(int octave, LedState state, bool isPlaybackEvent);
         void setAllOctaveLeds(LedState state, bool isPlaybackEvent);
 
-        // Display Methods
-        void displayProgressCallback(uint16_t progress);
-
         // Quantizer methods
         void initQuantizer();
         void handleCVInput();
+        void triggerQuantizedNote(int degreeRank, int octave, bool retrigger);
+        void handleMidiNote(uint8_t note, uint8_t velocity);
+        void updateMidiOutput();
         void setActiveDegreeLimit(int value);
         void setActiveDegrees(uint8_t degrees);
         void setActiveOctaves(int octave);
 
         // Sequencer methods
         void handleSequence(int position);
+        void updateClockWake();
+        void handleSequenceEvent(int position);
         void resetSequence();
         void updateSequenceLength(uint8_t steps);
-        void setSequenceLED(uint8_t step, uint8_t pwm, bool blink);
-        void drawSequenceToDisplay(bool blink);
+        void setSequenceLED(uint8_t step, uint8_t pwm, bool blink, LAYER layer = LAYER::SEQUENCER);
+        void drawSequenceToDisplay(bool blink, LAYER layer = LAYER::SEQUENCER);
         void stepSequenceLED(int currStep, int prevStep, int length);
         void enableSequenceRecording();
         void disableSequenceRecording();
+        void undoSequence();
+        void redoSequence();
+        void copySequence(TouchChannel *source);
+        void appendSequenceToSong();
+        void clearSong();
+        void updateSequencePlayback();
         void handleQuantAmountLEDs();
 
         // Bender methods
@@ -231,9 +258,12 @@ namespace DEGREE {
 
         // Gate Output Methods
         void setGate(bool state);
+        bool selectPadIsTouched() { return bitwise_read_bit(ui_state.read().selectPads, channelIndex); } // each channel has a select pad in the control section
         uint8_t calculateRatchet(uint16_t bend);
         void handleRatchet(int position, uint16_t value);
 
+        int getGlideTimeIndex();
+
         void copyConfigData(uint32_t *arr);
         void loadConfigData(uint32_t *arr);
         
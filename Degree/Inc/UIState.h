@@ -0,0 +1,20 @@
+#pragma once
+
+#include "main.h"
+#include "Seqlock.h"
+
+/**
+ * @brief Snapshot of the global control state other tasks act on. GlobalControl publishes a new one after handling each
+ * input event (see GlobalControl::publishUIState()), the sequencer / channels read it via ui_state.read() without
+ * blocking or a round trip through the sequencer queue.
+ */
+typedef struct UIState
+{
+    uint8_t touched;    // raw select pad state (GlobalControl::currTouched)
+    uint8_t selectPads; // bit n set while channel n's select pad is touched
+    uint8_t mode;       // GlobalControl::ControlMode
+    bool gesture;       // a select pad is being held while pressing a button (GlobalControl::gestureFlag)
+    bool recordEnabled; // global recording flag
+} UIState;
+
+extern Seqlock<UIState> ui_state;
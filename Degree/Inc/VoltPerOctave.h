@@ -7,6 +7,7 @@
 #include "PitchFrequencies.h"
 #include "AnalogHandle.h"
 #include "MultiChanADC.h"
+#include "Glide.h"
 
 #ifndef DAC_1VO_ARR_SIZE
 #define DAC_1VO_ARR_SIZE 64
@@ -18,6 +19,10 @@
 #define CALIBRATION_FLOOR 0.2f
 #define NUM_OCTAVES 6
 
+#define PITCH_FRACTION_BITS 10                     // pitch is a fixed point note index, 1/1024th of a semitone resolution
+#define PITCH_SEMITONE (1 << PITCH_FRACTION_BITS)
+#define PITCH_MAX ((DAC_1VO_ARR_SIZE - 1) << PITCH_FRACTION_BITS)
+
 namespace DEGREE {
     const int PB_RANGE_MAP[8] = {1, 2, 3, 4, 5, 7, 10, 12};
     class VoltPerOctave
@@ -30,18 +35,20 @@ namespace DEGREE {
         uint16_t currOutput; // value being output to the DAC
         int currNoteIndex;
 
-        uint16_t dacSemitone = 938;               //
         uint16_t dacVoltageMap[DAC_1VO_ARR_SIZE]; // pre/post calibrated 16-bit DAC values
+        int16_t dacSemitoneMap[DAC_1VO_ARR_SIZE]; // DAC distance from each note in dacVoltageMap to the next, for interpolating between them
 
         // PITCH BEND
         int pbRangeIndex = 4; // an index value which gets mapped to PB_RANGE_MAP
         int pbNoteOffset;     // the amount of pitch bend to apply to the 1v/o DAC output. Can be positive/negative centered @ 0
 
-        uint16_t maxPitchBend;     // must be a float!
+        uint16_t maxPitchBend;     // pitch bend range, in semitones (fixed point, see PITCH_FRACTION_BITS)
         uint16_t minPitchBend = 0; // should always be 0
-        uint16_t currPitchBend;    // the amount of pitch bend to apply to the 1v/o DAC output. Can be positive/negative centered @ 0
+        uint16_t currPitchBend;    // the amount of pitch bend to apply to the 1v/o output, in semitones (fixed point, see PITCH_FRACTION_BITS)
         bool bendDirection;        // pitch bend up = true, down = false
 
+        Glide glide;               // slews between notes, stepped by task_glide
+
         VoltPerOctave(DAC8554 *_dac, DAC8554::Channel _chan, AnalogHandle *_adc)
         {
             this->dac = _dac;
@@ -51,9 +58,13 @@ namespace DEGREE {
         };
 
         void init();
-        void setPitch(int index);
+        void setPitch(int index, bool slew = false);
         void setPitchBend(uint16_t value, bool direction = false);
         void updateDAC();
+        bool stepGlide();
+        uint16_t calculateOutput(int32_t pitch);
+        uint16_t resolvePitch(int32_t pitch);
+        void updateSemitoneMap();
         void resetDAC();
         void setPitchBendRange(int value);
         int getPitchBendRange();
@@ -23,7 +23,13 @@
 #define MAX_SEQ_LENGTH_PPQN (MAX_SEQ_LENGTH * PPQN)
 
 #define CHANNEL_COUNT 4
-#define ADC_DMA_BUFF_SIZE   9
+#define ADC_INPUT_COUNT     9     // CV inputs, benders and the tempo pot
+#define ADC_CV_CHANNELS     4     // CV inputs A - D, scanned by ADC2
+#define ADC_DMA_BUFF_SIZE   5     // benders A - D and the tempo pot, scanned by ADC1
+#define ADC_CV_BLOCK_SCANS  8     // CV scans per half of the ADC2 DMA buffer
+#define ADC_CV_DMA_BUFF_SIZE (ADC_CV_CHANNELS * ADC_CV_BLOCK_SCANS * 2)
+#define ADC_CV_SAMPLE_RATE_HZ      16000 // high enough to measure a VCO for calibration, so it never has to change
+#define ADC_CONTROL_SAMPLE_RATE_HZ 1000  // bender control rate, the tempo pot decimates down from here
 #define ADC_TIM_PRESCALER   100
 #define ADC_TIM_PERIOD      2000
 
@@ -53,6 +59,10 @@
 #define FLASH_SEQUENCE_DATA_ADDR (FLASH_SEQUENCE_CONFIG_ADDR + FLASH_SEQUENCE_CONFIG_SIZE)
 #define FLASH_CHANNEL_BLOCK_SIZE ((FLASH_SEQUENCE_DATA_ADDR + FLASH_SEQUENCE_DATA_SIZE) - FLASH_CHANNEL_CONFIG_ADDR + (uint32_t)0x1000)
 
+// last 32 Kbytes of the config sector are kept erased for the session snapshot taken on brown out (see SessionSnapshot.h)
+#define FLASH_SNAPSHOT_ADDR (FLASH_CONFIG_ADDR + 0x18000)
+#define FLASH_SNAPSHOT_SIZE 0x8000
+
 #define OCTAVE_COUNT 4
 #define DEGREE_COUNT 8
 
@@ -67,6 +77,7 @@
 #define TEMPO_POT PA_2
 #define TEMPO_POT_MIN_ADC 1000
 #define TEMPO_POT_MAX_ADC 60000
+#define TEMPO_POT_SAMPLE_RATE_HZ 50
 
 #define EXT_CLOCK_INPUT PA_3
 
@@ -141,4 +152,9 @@ typedef enum CHAN CHAN;
 
 #define ISR_ID_TOGGLE_SWITCHES 0
 #define ISR_ID_TACTILE_BUTTONS 1
-#define ISR_ID_TOUCH_PADS 2
\ No newline at end of file
+#define ISR_ID_TOUCH_PADS 2
+#define ISR_ID_CHANNEL_TOUCH 3
+
+#define ISR_DEBOUNCE_TOGGLE_SWITCHES_US 2000 // minimum time between dispatched toggle switch interrupts
+#define ISR_DEBOUNCE_TACTILE_BUTTONS_US 2000 // minimum time between dispatched tactile button interrupts
+#define ISR_DEBOUNCE_TOUCH_PADS_US      1000 // minimum time between dispatched global touch pad interrupts
\ No newline at end of file
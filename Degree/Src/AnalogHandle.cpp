@@ -1,13 +1,16 @@
 #include "AnalogHandle.h"
 
-QueueHandle_t qh_adc_sample_ready;
-SemaphoreHandle_t AnalogHandle::semaphore;
-AnalogHandle *AnalogHandle::_instances[ADC_DMA_BUFF_SIZE] = {0};
+static okQueue<uint16_t, ADC_SAMPLE_READY_QUEUE_LENGTH> adc_sample_ready_q;
+QueueHandle_t qh_adc_sample_ready = adc_sample_ready_q.handle;
+AnalogHandle *AnalogHandle::_instances[ADC_INPUT_COUNT] = {0};
+TaskHandle_t AnalogHandle::_sampleTask = NULL;
+TaskHandle_t AnalogHandle::_notifyTask = NULL;
+uint8_t AnalogHandle::_notifySamples = 1;
 
 AnalogHandle::AnalogHandle(PinName pin)
 {
     // iterate over static member ADC_PINS and match index to pin
-    for (int i = 0; i < ADC_DMA_BUFF_SIZE; i++)
+    for (int i = 0; i < ADC_INPUT_COUNT; i++)
     {
         if (pin == ADC_PINS[i])
         {
@@ -16,7 +19,7 @@ AnalogHandle::AnalogHandle(PinName pin)
         }
     }
     // Add constructed instance to the static list of instances (required for IRQ routing)
-    for (int i = 0; i < ADC_DMA_BUFF_SIZE; i++)
+    for (int i = 0; i < ADC_INPUT_COUNT; i++)
     {
         if (_instances[i] == NULL)
         {
@@ -31,6 +34,35 @@ uint16_t AnalogHandle::read_u16()
     return invert ? BIT_MAX_16 - currValue : currValue;
 }
 
+/**
+ * @brief the most recent raw sample DMA wrote for this input
+ */
+uint16_t AnalogHandle::latestSample()
+{
+    return isCV() ? CV_DMA_BUFFER[index] : DMA_BUFFER[index - ADC_CV_CHANNELS];
+}
+
+/**
+ * @brief set the rate this input gets processed at. Rounded to a whole fraction of the rate its ADC runs at, the raw
+ * samples in between get averaged together (which doubles as the anti aliasing filter)
+ *
+ * @param hz anything from the ADC rate (no decimation) down to 1/255th of it
+ */
+void AnalogHandle::setSampleRate(uint32_t hz)
+{
+    uint32_t factor = hz == 0 ? 255 : getADCSampleRate() / hz;
+    if (factor < 1)
+        factor = 1;
+    else if (factor > 255)
+        factor = 255;
+
+    taskENTER_CRITICAL(); // the ADC task must not see the new factor with a half finished sum
+    decimation = factor;
+    decimationCount = 0;
+    decimationSum = 0;
+    taskEXIT_CRITICAL();
+}
+
 void AnalogHandle::invertReadings()
 {
     this->invert = !this->invert;
@@ -49,7 +81,7 @@ void AnalogHandle::setFilter(float value)
     }
     else
     {
-        prevValue = convert12to16(DMA_BUFFER[index]);
+        prevValue = convert12to16(latestSample());
         filterAmount = value;
         filter = true;
     }
@@ -59,19 +91,67 @@ void AnalogHandle::setFilter(float value)
  * @brief takes the denoising semaphore and gives it once calculation is finished.
  * NOTE: don't forget to "give()" the semaphore back after waiting for it.
  * 
+ * @param numSamples length of the measurement in samples at ADC_DENOISE_RATE_HZ, scaled to this inputs rate so every
+ * input measures for the same amount of time
  * @return okSemaphore* 
  */
-okSemaphore* AnalogHandle::initDenoising() {
-    this->samplingNoise = true;
+okSemaphore* AnalogHandle::initDenoising(uint16_t numSamples /*= ADC_SAMPLE_COUNTER_LIMIT*/) {
     denoisingSemaphore.take(); // create a semaphore
+    uint32_t samples = (uint32_t)numSamples * getSampleRate() / ADC_DENOISE_RATE_HZ;
+    this->denoiseSamples = samples < 2 ? 2 : samples;
+    this->samplingNoise = true;
     return &denoisingSemaphore;
 }
 
+/**
+ * @brief start denoising every ADC input at once. They all get fed by the same DMA stream, so measuring all of them
+ * takes no longer than measuring one. Call waitForDenoisingAll() to block until they are all done.
+ * 
+ * @param numSamples 
+ */
+void AnalogHandle::initDenoisingAll(uint16_t numSamples) // static
+{
+    for (auto ins : _instances)
+    {
+        if (ins)
+            ins->initDenoising(numSamples);
+    }
+}
+
+void AnalogHandle::waitForDenoisingAll() // static
+{
+    for (auto ins : _instances)
+    {
+        if (ins)
+            ins->denoisingSemaphore.wait();
+    }
+}
+
+/**
+ * @brief compare a (quick) noise measurement against the idle values cached from the last session. If the input
+ * hasn't drifted, the cached values (which came from a full length measurement) replace the quick ones.
+ * 
+ * @return false if there are no cached values or the input has drifted, meaning it needs a full measurement
+ */
+bool AnalogHandle::restoreCachedNoise()
+{
+    if (!hasCachedNoise())
+        return false;
+    int drift = (int)avgValueWhenIdle - (int)cachedIdleValue;
+    if (drift < 0)
+        drift = -drift;
+    if (drift > cachedNoiseThreshold + ADC_IDLE_DRIFT_TOLERANCE || idleNoiseThreshold > cachedNoiseThreshold * 2 + ADC_IDLE_DRIFT_TOLERANCE)
+        return false;
+    avgValueWhenIdle = cachedIdleValue;
+    idleNoiseThreshold = cachedNoiseThreshold;
+    return true;
+}
+
 // set this as a task so that in the main loop you block with a semaphore until this task gives the semaphore back (once it has completed)
 void AnalogHandle::sampleSignalNoise(uint16_t sample)
 {
     // get max read, get min read, get avg read
-    if (sampleCounter < ADC_SAMPLE_COUNTER_LIMIT)
+    if (sampleCounter < denoiseSamples)
     {
         if (sampleCounter == 0) {
             noiseCeiling = sample;
@@ -98,6 +178,28 @@ void AnalogHandle::sampleSignalNoise(uint16_t sample)
     }
 }
 
+/**
+ * @brief feed a raw sample from the DMA buffer. Every `decimation` samples, their average gets processed
+ *
+ * @param sample 12 bit ADC sample
+ */
+void AnalogHandle::addSample(uint16_t sample)
+{
+    if (decimation == 1)
+    {
+        sampleReadyCallback(sample);
+        return;
+    }
+    decimationSum += sample;
+    if (++decimationCount >= decimation)
+    {
+        uint16_t average = decimationSum / decimation;
+        decimationCount = 0;
+        decimationSum = 0;
+        sampleReadyCallback(average);
+    }
+}
+
 /**
  * @brief This is not exactly a callback, its really a "sender" task
  * 
@@ -135,39 +237,85 @@ void AnalogHandle::sampleReadyCallback(uint16_t sample)
 
 
 /**
- * @brief A static member function which gets called as an ISR whenever the ADC DMA Conversion is completed
+ * @brief A static member function which gets called as an ISR whenever an ADC DMA block is completed
  * 
+ * @param block which block is ready to be read (ADC_BLOCK_xxx)
  */
-void AnalogHandle::RouteConversionCompleteCallback() // static
+void AnalogHandle::RouteConversionCompleteCallback(uint32_t block) // static
 {
+    if (_sampleTask == NULL)
+        return; // scheduler hasn't started yet, nobody to hand the samples to
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    xSemaphoreGiveFromISR(AnalogHandle::semaphore, &xHigherPriorityTaskWoken);
+    xTaskNotifyFromISR(_sampleTask, block, eSetBits, &xHigherPriorityTaskWoken);
     portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
 
 /**
- * @brief This task waits for a semaphore to be made available by the RouteConversionCompleteCallback()
- * When it takes the semaphore, the task will trigger a callback function for every AnalogHandle 
- * instance that exists.
+ * @brief This task waits for the RouteConversionCompleteCallback() to notify it of a finished DMA block, then feeds
+ * every sample in that block to the AnalogHandle instance it belongs to.
+ *
+ * CV blocks hold ADC_CV_BLOCK_SCANS scans, so the task wakes at ADC_CV_SAMPLE_RATE_HZ / ADC_CV_BLOCK_SCANS for them
+ * rather than once per sample.
  *
  * @param params
  */
 void AnalogHandle::sampleReadyTask(void *params) {
     logger_log_task_watermark();
-    qh_adc_sample_ready = xQueueCreate(16, sizeof(uint16_t));
+    trace_register_queue(qh_adc_sample_ready, "adc sample");
+    _sampleTask = xTaskGetCurrentTaskHandle();
+    uint8_t samples = 0;
     while (1)
     {
-        xSemaphoreTake(AnalogHandle::semaphore, portMAX_DELAY);
+        uint32_t blocks = 0;
+        xTaskNotifyWait(0, 0xFFFFFFFF, &blocks, portMAX_DELAY);
+
+        for (int half = 0; half < 2; half++)
+        {
+            if (!(blocks & (half == 0 ? ADC_BLOCK_CV_FIRST : ADC_BLOCK_CV_SECOND)))
+                continue;
+            uint16_t *block = &CV_DMA_BUFFER[half * ADC_CV_CHANNELS * ADC_CV_BLOCK_SCANS];
+            for (auto ins : _instances)
+            {
+                if (ins && ins->isCV())
+                {
+                    for (int scan = 0; scan < ADC_CV_BLOCK_SCANS; scan++)
+                        ins->addSample(block[scan * ADC_CV_CHANNELS + ins->index]);
+                }
+            }
+        }
+
+        if (!(blocks & ADC_BLOCK_CONTROL))
+            continue;
+
         for (auto ins : _instances)
         {
-            if (ins) // if instance not NULL
+            if (ins && !ins->isCV()) // if instance not NULL
             {
-                ins->sampleReadyCallback(AnalogHandle::DMA_BUFFER[ins->index]);
+                ins->addSample(AnalogHandle::DMA_BUFFER[ins->index - ADC_CV_CHANNELS]);
             }
         }
+
+        if (_notifyTask && ++samples >= _notifySamples)
+        {
+            samples = 0;
+            xTaskNotifyGive(_notifyTask);
+        }
     }
 }
 
+/**
+ * @brief wake a task in step with the control ADC, once every few DMA blocks. The task gets notified right after every
+ * instance has been updated with the new block, so it always reads fresh (and filtered) values.
+ *
+ * @param task task waiting on ulTaskNotifyTake()
+ * @param samples how many control blocks per notification (ie. ADC_CONTROL_SAMPLE_RATE_HZ / 500 for 500Hz)
+ */
+void AnalogHandle::notifyEverySamples(TaskHandle_t task, uint8_t samples)
+{
+    _notifySamples = samples == 0 ? 1 : samples;
+    _notifyTask = task;
+}
+
 void AnalogHandle::log_noise_threshold_to_console(char const *source_id)
 {
     logger_log("\n");
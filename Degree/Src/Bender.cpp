@@ -7,20 +7,23 @@ Bender D ADC Noise: 760, Idle: 32271
 
 #include "Bender.h"
 
+/**
+ * @brief initialize the DAC and park the output at its idle position.
+ * NOTE: the ADC idle value gets measured separately (see GlobalControl::denoiseAnalogInputs()), call
+ * setRatchetThresholds() once it is known.
+ */
 void Bender::init()
 {
     dac->init();
-    adc.setFilter(0.1);
-    okSemaphore *sem = adc.initDenoising();
-    sem->wait();
-    setRatchetThresholds();
+    adc.setFilter(0.2); // at the 1kHz control rate, about the same response 0.1 had at 2kHz
     currOutput = BENDER_DAC_ZERO; // initialize at idle position for filtering
-    updateDAC(currOutput);
+    updateDAC(currOutput, true);
 }
 
-// polling should no longer check if the bender is idle. It should just update the DAC and call the activeCallback
-// there are no cycles being saved either way.
-void Bender::poll() {
+/**
+ * @brief apply hysteresis to the ADC reading and work out the current bend. See poll()
+ */
+void Bender::updateState() {
     
     // handle hysterisis 
     switch (currState)
@@ -52,9 +55,6 @@ void Bender::poll() {
     if (this->isIdle())
     {
         currBend = BENDER_DAC_ZERO;
-        
-        if (idleCallback)
-            idleCallback();
     }
     else
     {
@@ -62,18 +62,6 @@ void Bender::poll() {
 #ifdef TESTING
         logger_log(currBend);
 #endif        
-        if (activeCallback)
-            activeCallback(currBend); // should this be passing the currBend value or the raw ADC value?
-    }
-
-    // handle tri-state
-    if (currState != prevState)
-    {
-        if (triStateCallback)
-        {
-            triStateCallback(currState);
-        }
-        prevState = currState;
     }
 }
 
@@ -110,39 +98,19 @@ uint16_t Bender::calculateOutput(uint16_t value)
  * @brief apply a slew filter and write the benders state to the DAC
  * 
  * Output will be between 0V and 2.5V, centered at 2.5V/2
+ * NOTE: this gets called at BENDER_CONTROL_RATE_HZ, so the DAC only gets written when the filtered output actually moves
 */
 void Bender::updateDAC(uint16_t value, bool bypassFilter /*=false*/)
 {
     prevOutput = currOutput;
     currOutput = bypassFilter ? value : filter_one_pole<uint16_t>(value, prevOutput, 0.065);
-    dac->write(dacChan, currOutput);
-}
-
-bool Bender::isIdle()
-{
-    if (currState != BENDING_IDLE)
+    if (bypassFilter || currOutput != prevOutput)
     {
-        return false;
-    } else {
-        return true;
+        dac->write(dacChan, currOutput);
+        TRACE_IO(TRACE_OUTPUT_BEND + (int)dacChan, currOutput);
     }
 }
 
-void Bender::attachIdleCallback(Callback<void()> func)
-{
-    idleCallback = func;
-}
-
-void Bender::attachActiveCallback(Callback<void(uint16_t bend)> func)
-{
-    activeCallback = func;
-}
-
-void Bender::attachTriStateCallback(Callback<void(BendState state)> func)
-{
-    triStateCallback = func;
-}
-
 uint16_t Bender::read()
 {
     return adc.read_u16();
@@ -17,15 +17,13 @@ void Degrees::init()
 
 void Degrees::enableInterrupt()
 {
+    ioInterupt.debounce(ISR_DEBOUNCE_TOGGLE_SWITCHES_US);
     ioInterupt.fall(callback(this, &Degrees::handleInterrupt));
 }
 
 void Degrees::handleInterrupt()
 {
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    uint8_t isr_id = ISR_ID_TOGGLE_SWITCHES;
-    xQueueSendFromISR(qhInterruptQueue, &isr_id, &xHigherPriorityTaskWoken);
-    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    dispatch_input_event_ISR(ISR_ID_TOGGLE_SWITCHES, ioInterupt._pin, 0);
 };
 
 void Degrees::attachCallback(Callback<void()> func)
@@ -38,6 +36,7 @@ void Degrees::updateDegreeStates()
     currState = io->digitalReadAB();
     if (currState != prevState)
     {
+        TRACE_IO(TRACE_INPUT_DEGREES, currState);
         int switchIndex = 0;
         for (int i = 0; i < 16; i++)
         { // iterate over all 16 bits
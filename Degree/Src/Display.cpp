@@ -1,4 +1,5 @@
 #include "Display.h"
+#include "task_display.h"
 
 Mutex Display::_mutex;
 
@@ -6,100 +7,127 @@ void Display::init()
 {
     ledMatrix.init();
     ledMatrix.setGlobalCurrent(DISPLAY_MAX_CURRENT);
+    for (int i = 0; i < DISPLAY_LED_COUNT; i++)
+    {
+        _output[i] = PWM::PWM_OFF;
+        ledMatrix.setPWM(i, PWM::PWM_OFF);
+    }
 }
 
 /**
  * @brief set all 64 leds low / off
 */ 
-void Display::clear()
+void Display::clear(LAYER layer)
 {
     _mutex.lock();
     for (int i = 0; i < DISPLAY_LED_COUNT; i++)
     {
-        this->setLED(i, PWM::PWM_OFF, false);
+        this->drawLED(layer, i, PWM::PWM_OFF, false);
     }
     _mutex.unlock();
 }
 
-void Display::clear(int chan)
+void Display::clear(int chan, LAYER layer)
 {
     _mutex.lock();
     for (int i = 0; i < DISPLAY_CHANNEL_LED_COUNT; i++)
     {
-        this->setChannelLED(chan, i, PWM::PWM_OFF, false);
+        this->drawLED(layer, CHAN_DISPLAY_LED_MAP[chan][i], PWM::PWM_OFF, false);
     }
     _mutex.unlock();
 }
 
-void Display::fill(uint8_t pwm, bool blink)
+void Display::fill(uint8_t pwm, bool blink, LAYER layer)
 {
     _mutex.lock();
     for (int i = 0; i < DISPLAY_LED_COUNT; i++)
     {
-        this->setLED(i, pwm, blink);
+        this->drawLED(layer, i, pwm, blink);
     }
     _mutex.unlock();
 }
 
-void Display::fill(int chan, uint8_t pwm, bool blink)
+void Display::fill(int chan, uint8_t pwm, bool blink, LAYER layer)
 {
     _mutex.lock();
     for (int i = 0; i < DISPLAY_CHANNEL_LED_COUNT; i++)
     {
-        this->setChannelLED(chan, i, pwm, blink);
+        this->drawLED(layer, CHAN_DISPLAY_LED_MAP[chan][i], pwm, blink);
     }
     _mutex.unlock();
 }
 
-void Display::enableBlink() { _currScene->blink = true; }
-void Display::disableBlink() { _currScene->blink = false; }
+void Display::enableBlink(LAYER layer)
+{
+    _mutex.lock();
+    _layers[static_cast<int>(layer)].blink = true;
+    _mutex.unlock();
+    display_wake(); // the display task sleeps while nothing blinks
+}
 
-void Display::blinkScene()
+void Display::disableBlink(LAYER layer)
 {
-    if (_currScene->blink)
-    {
-        for (int channel = 0; channel < 4; channel++)
-        {
-            if (bitwise_read_bit(channel_blink_status, channel))
-            {
-                for (int i = 0; i < DISPLAY_CHANNEL_LED_COUNT; i++)
-                {
-                    uint8_t led_index = CHAN_DISPLAY_LED_MAP[channel][i];
-                    if (_currScene->led_state_blink[led_index])
-                    {
-                        ledMatrix.setPWM(led_index, _blinkState ? _currScene->led_state_pwm[led_index] : 0);
-                    }
-                }
-            }
-        }
+    _mutex.lock();
+    _layers[static_cast<int>(layer)].blink = false;
+    outputLEDs(DISPLAY_ALL_LEDS_MASK); // LEDs caught in the off half of a blink
+    _mutex.unlock();
+}
 
-        _blinkState = !_blinkState;
+/**
+ * @brief true while any layer has blinking turned on
+ */
+bool Display::isBlinking()
+{
+    for (int i = 0; i < static_cast<int>(LAYER::NUM_LAYERS); i++)
+    {
+        if (_layers[i].blink)
+            return true;
     }
-    
+    return false;
 }
 
-void Display::setScene(SCENE scene)
+/**
+ * @brief toggle every blinking LED. Only LEDs which end up changing get written to the matrix
+ */
+void Display::blinkScene()
 {
-    _currScene = _scenes[static_cast<int>(scene)];
+    _mutex.lock();
+    _blinkState = !_blinkState;
+    outputLEDs(DISPLAY_ALL_LEDS_MASK);
+    _mutex.unlock();
 }
 
 /**
- * @brief Iterate over entire scene and redraw the associated LED data
- * 
- * @param scene 
+ * @brief clear a layer and make it cover the entire display. The layers beneath keep getting drawn to, they just aren't shown
+ *
+ * @param layer LAYER::MENU
  */
-void Display::redrawScene()
+void Display::openLayer(LAYER layer)
 {
-    for (int i = 0; i < DISPLAY_LED_COUNT; i++)
-    {
-        redrawLED(i);
-    }
+    _mutex.lock();
+    DisplayLayer *target = &_layers[static_cast<int>(layer)];
+    target->blink = false;
+    target->led_state_pwm.fill(PWM::PWM_OFF);
+    target->led_state_blink.fill(false);
+    target->opacity = DISPLAY_ALL_LEDS_MASK;
+    outputLEDs(DISPLAY_ALL_LEDS_MASK);
+    _mutex.unlock();
 }
 
-void Display::resetScene()
+/**
+ * @brief hide a layer, revealing whatever the layers beneath it hold by now. Only LEDs which differ get written.
+ *
+ * @param layer LAYER::MENU
+ */
+void Display::closeLayer(LAYER layer)
 {
-    this->disableBlink();
-    this->clear();    
+    _mutex.lock();
+    DisplayLayer *target = &_layers[static_cast<int>(layer)];
+    uint64_t covered = target->opacity;
+    target->opacity = 0;
+    target->blink = false;
+    outputLEDs(covered);
+    _mutex.unlock();
 }
 
 /**
@@ -120,54 +148,72 @@ void Display::setBlinkStatus(int chan, bool status)
     channel_blink_status = bitwise_write_bit(channel_blink_status, chan, status);
 }
 
-void Display::setLED(int index, uint8_t pwm, bool blink)
+void Display::setLED(int index, uint8_t pwm, bool blink, LAYER layer)
 {
-    if (_currScene)
-    {
-        _currScene->led_state_pwm[index] = pwm;
-        _currScene->led_state_blink[index] = blink;
-    }
-    ledMatrix.setPWM(index, pwm);
+    _mutex.lock();
+    drawLED(layer, index, pwm, blink);
+    _mutex.unlock();
 }
 
 /**
- * @brief Toggle the current scenes LED on or off
+ * @brief Toggle an LED of the matrix on or off, without changing any layer
  * @note not yet tested!
  * @param index 
  */
 void Display::toggleLED(int index)
 {
-    if (_currScene) {
-        if (_currScene->led_state_pwm[index] > 0)
-        {
-            ledMatrix.setPWM(index, 0);
-        } else {
-            ledMatrix.setPWM(index, _currScene->led_state_pwm[index]);
-        }
+    _mutex.lock();
+    if (_output[index] > 0)
+    {
+        _output[index] = 0;
+        ledMatrix.setPWM(index, 0);
+    } else {
+        outputLED(index);
     }
+    _mutex.unlock();
 }
 
 void Display::toggleChannelLED(int chan, int index) {
     this->toggleLED(CHAN_DISPLAY_LED_MAP[chan][index]);
 }
 
-void Display::redrawLED(int index) {
-    uint8_t pwm = _currScene->led_state_pwm[index];
-    ledMatrix.setPWM(index, pwm);
-}
-
 /**
  * @brief Set a column of LEDs
  * @param column value between 0..15
  * @param state on or off
  * @param pwm brightness
  */
-void Display::setColumn(int column, uint8_t pwm, bool blink)
+void Display::setColumn(int column, uint8_t pwm, bool blink, LAYER layer)
 {
-    this->setLED(column, pwm, blink);
-    this->setLED(column + 16, pwm, blink);
-    this->setLED(column + 32, pwm, blink);
-    this->setLED(column + 48, pwm, blink);
+    this->setLED(column, pwm, blink, layer);
+    this->setLED(column + 16, pwm, blink, layer);
+    this->setLED(column + 32, pwm, blink, layer);
+    this->setLED(column + 48, pwm, blink, layer);
+}
+
+/**
+ * @brief draw a vertical bar graph in a column, starting from the bottom row.
+ * The top most LED of the bar gets dimmed proportionally, and the bottom LED is always dimly lit so empty bars are still visible
+ *
+ * @param column value between 0..15
+ * @param percent value between 0..100
+ * @param blink
+ */
+void Display::drawBar(int column, uint8_t percent, bool blink, LAYER layer)
+{
+    int level = (percent * DISPLAY_ROW_COUNT * PWM::PWM_HIGH) / 100; // bar height in PWM units
+    for (int i = 0; i < DISPLAY_ROW_COUNT; i++) // i == 0 is the bottom row
+    {
+        int pwm = level - (i * PWM::PWM_HIGH);
+        if (pwm > PWM::PWM_HIGH)
+            pwm = PWM::PWM_HIGH;
+        if (pwm < 0)
+            pwm = 0;
+        if (i == 0 && pwm < PWM::PWM_LOW)
+            pwm = PWM::PWM_LOW;
+        int row = (DISPLAY_ROW_COUNT - 1) - i;
+        this->setLED(row * DISPLAY_COLUMN_COUNT + column, (uint8_t)pwm, blink, layer);
+    }
 }
 
 /**
@@ -177,9 +223,9 @@ void Display::setColumn(int column, uint8_t pwm, bool blink)
  * @param index value between 0..15. 0 is top left of the grid, 15 is bottom right of the grid
  * @param on on or off
  */
-void Display::setChannelLED(int chan, int index, uint8_t pwm, bool blink)
+void Display::setChannelLED(int chan, int index, uint8_t pwm, bool blink, LAYER layer)
 {
-    this->setLED(CHAN_DISPLAY_LED_MAP[chan][index], pwm, blink);
+    this->setLED(CHAN_DISPLAY_LED_MAP[chan][index], pwm, blink, layer);
 }
 
 /**
@@ -187,6 +233,7 @@ void Display::setChannelLED(int chan, int index, uint8_t pwm, bool blink)
  * the middle row + top / bottom rows as the Bender gets more and more calibrated.
  * 
  * Have the display flash when it is finished.
+ * NOTE: draws to the menu layer, which must already be open
 */
 void Display::benderCalibration()
 {
@@ -196,75 +243,128 @@ void Display::benderCalibration()
         {
             if (i >= 1 && i < 3)
             {
-                this->setChannelLED(chan, i, PWM::PWM_LOW_MID, true);
+                this->setChannelLED(chan, i, PWM::PWM_LOW_MID, true, LAYER::MENU);
             }
             else if (i >= 13 && i < 15)
             {
-                this->setChannelLED(chan, i, PWM::PWM_LOW_MID, true);
+                this->setChannelLED(chan, i, PWM::PWM_LOW_MID, true, LAYER::MENU);
             }
         }
     }
 }
 
 /**
- * @brief Draw a square
+ * @brief given an index between 0..15, set the LED relative spiral LED
  * 
- * @param chan channel index
- * @param speed how fast to draw it
+ * @param chan 
+ * @param index 
+ * @param pwm 
+ */
+void Display::setSpiralLED(int chan, int index, uint8_t pwm, bool blink, LAYER layer)
+{
+    this->setChannelLED(chan, DISPLAY_SPIRAL_LED_MAP[index], pwm, blink, layer);
+}
+
+/**
+ * @brief draw an LED to the notification layer, on top of every other layer. The LED stays there
+ * until releaseOverlay() gets called for it. Only the display task should call this.
+ *
+ * @param index 0..63
+ * @param pwm
  */
-void Display::drawSquare(int chan, TickType_t speed)
+void Display::setOverlayLED(int index, uint8_t pwm)
 {
-    for (int i = 0; i < DISPLAY_SQUARE_LENGTH; i++)
+    _mutex.lock();
+    _layers[static_cast<int>(LAYER::NOTIFICATION)].opacity |= DISPLAY_LED_MASK(index);
+    drawLED(LAYER::NOTIFICATION, index, pwm, false);
+    _mutex.unlock();
+}
+
+/**
+ * @brief hide the given LEDs of the notification layer, revealing the layers beneath
+ *
+ * @param mask bit per LED
+ */
+void Display::releaseOverlay(uint64_t mask)
+{
+    _mutex.lock();
+    _layers[static_cast<int>(LAYER::NOTIFICATION)].opacity &= ~mask;
+    outputLEDs(mask);
+    _mutex.unlock();
+}
+
+uint64_t Display::channelMask(int chan)
+{
+    uint64_t mask = 0;
+    for (int i = 0; i < DISPLAY_CHANNEL_LED_COUNT; i++)
     {
-        this->setChannelLED(chan, DISPLAY_SQUARE_LED_MAP[i], PWM::PWM_HIGH, false);
-        vTaskDelay(speed);
+        mask |= DISPLAY_LED_MASK(CHAN_DISPLAY_LED_MAP[chan][i]);
     }
+    return mask;
+}
+
+uint64_t Display::columnMask(int column)
+{
+    uint64_t mask = 0;
+    for (int row = 0; row < DISPLAY_ROW_COUNT; row++)
+    {
+        mask |= DISPLAY_LED_MASK(row * DISPLAY_COLUMN_COUNT + column);
+    }
+    return mask;
 }
 
 /**
- * @brief given an index between 0..15, set the LED relative spiral LED
- * 
- * @param chan 
- * @param index 
- * @param pwm 
+ * @brief store an LED in a layer, and output it if that changed what the display should show.
+ * NOTE: _mutex must be held
  */
-void Display::setSpiralLED(int chan, int index, uint8_t pwm, bool blink)
+void Display::drawLED(LAYER layer, int index, uint8_t pwm, bool blink)
 {
-    this->setChannelLED(chan, DISPLAY_SPIRAL_LED_MAP[index], pwm, blink);
+    DisplayLayer *target = &_layers[static_cast<int>(layer)];
+    target->led_state_pwm[index] = pwm;
+    target->led_state_blink[index] = blink;
+    if (target->opacity & DISPLAY_LED_MASK(index))
+        outputLED(index);
 }
 
 /**
- * @brief Illuminate a channels LEDs in a spiral / circular direction
- *
- * @param chan channel index
- * @param direction true = clockwise, false = counter clockwise
- * @param speed how fast
+ * @brief what an LED should show right now: the topmost layer covering it, blinked if that layer is blinking
  */
-void Display::drawSpiral(int chan, bool direction, uint8_t pwm, TickType_t speed)
+uint8_t Display::composeLED(int index)
 {
-    int index;
-    for (int i = 0; i < DISPLAY_SPIRAL_LENGTH; i++)
+    for (int i = static_cast<int>(LAYER::NUM_LAYERS) - 1; i >= 0; i--)
     {
-        index = direction ? i : (DISPLAY_SPIRAL_LENGTH - 1) - i;
-        this->setSpiralLED(chan, i, pwm, false);
-        vTaskDelay(speed);
+        DisplayLayer *layer = &_layers[i];
+        if (layer->opacity & DISPLAY_LED_MASK(index))
+        {
+            int chan = (index % DISPLAY_COLUMN_COUNT) / 4;
+            if (layer->blink && layer->led_state_blink[index] && !_blinkState && bitwise_read_bit(channel_blink_status, chan))
+                return PWM::PWM_OFF;
+            return layer->led_state_pwm[index];
+        }
     }
+    return PWM::PWM_OFF;
 }
 
 /**
- * @brief flash the display on and off
- * 
- * @param flashes how many times to flash
- * @param ticks how long each flash should take
+ * @brief write an LED to the matrix, only if it differs from what the matrix already shows.
+ * NOTE: _mutex must be held
  */
-void Display::flash(int flashes, TickType_t ticks)
+void Display::outputLED(int index)
 {
-    for (int i = 0; i < flashes; i++)
+    uint8_t pwm = composeLED(index);
+    if (pwm != _output[index])
+    {
+        _output[index] = pwm;
+        ledMatrix.setPWM(index, pwm);
+    }
+}
+
+void Display::outputLEDs(uint64_t mask)
+{
+    for (int i = 0; i < DISPLAY_LED_COUNT; i++)
     {
-        this->setGlobalCurrent(0);
-        vTaskDelay(ticks);
-        this->setGlobalCurrent(DISPLAY_MAX_CURRENT);
-        vTaskDelay(ticks);
+        if (mask & DISPLAY_LED_MASK(i))
+            outputLED(i);
     }
 }
 
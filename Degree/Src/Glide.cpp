@@ -0,0 +1,162 @@
+#include "Glide.h"
+#include <math.h>
+
+using namespace DEGREE;
+
+static TaskHandle_t glide_task = NULL; // woken on every TIM6 overflow
+
+/**
+ * @brief Configure TIM6 to overflow at GLIDE_RATE_HZ. The timer only runs while a glide is in progress, so an idle
+ * output costs nothing.
+ *
+ * @param task the task to notify on every overflow (task_glide)
+ */
+void glide_timer_init(TaskHandle_t task)
+{
+    glide_task = task;
+    __HAL_RCC_TIM6_CLK_ENABLE();
+    uint32_t timclock = 2 * HAL_RCC_GetPCLK1Freq();
+    TIM6->PSC = (timclock / 1000000U) - 1U; // 1MHz counter
+    TIM6->ARR = (1000000U / GLIDE_RATE_HZ) - 1U;
+    TIM6->EGR = TIM_EGR_UG; // load the prescaler
+    TIM6->SR = 0;           // UG sets the update flag, clear it
+    TIM6->DIER = TIM_DIER_UIE;
+    HAL_NVIC_SetPriority(TIM6_DAC_IRQn, RTOS_ISR_DEFAULT_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(TIM6_DAC_IRQn);
+}
+
+void glide_timer_start()
+{
+    if (!(TIM6->CR1 & TIM_CR1_CEN))
+    {
+        TIM6->CNT = 0;
+        TIM6->CR1 |= TIM_CR1_CEN;
+    }
+}
+
+void glide_timer_stop()
+{
+    TIM6->CR1 &= ~TIM_CR1_CEN;
+}
+
+extern "C" void TIM6_DAC_IRQHandler(void)
+{
+    if (TIM6->SR & TIM_SR_UIF)
+    {
+        TIM6->SR = ~TIM_SR_UIF;
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+        if (glide_task)
+            vTaskNotifyGiveFromISR(glide_task, &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    }
+}
+
+/**
+ * @brief set how long a glide takes to reach its target. 0 disables gliding
+ *
+ * @param ms 0..GLIDE_TIME_MAX
+ */
+void Glide::setTime(uint16_t ms)
+{
+    if (ms > GLIDE_TIME_MAX)
+        return;
+    time = ms;
+    steps = ((uint32_t)ms * GLIDE_RATE_HZ) / 1000;
+    if (steps == 0)
+        steps = 1;
+    // solve for the per tick coefficient once here, so tick() is a single multiply
+    coefficient = (uint32_t)((1.0f - expf(-(float)GLIDE_EXPO_TIME_CONSTANTS / (float)steps)) * (1 << GLIDE_FIXED_POINT_BITS));
+}
+
+uint16_t Glide::getTime()
+{
+    return time;
+}
+
+void Glide::setCurve(Curve value)
+{
+    if (value <= EXPONENTIAL)
+        curve = value;
+}
+
+Glide::Curve Glide::getCurve()
+{
+    return curve;
+}
+
+/**
+ * @brief glide from wherever the output currently is to a new value. Jumps straight there when the glide time is 0.
+ *
+ * @param value pitch (or any value up to 32 bits)
+ */
+void Glide::setTarget(uint32_t value)
+{
+    if (time == 0)
+    {
+        jump(value);
+        return;
+    }
+    taskENTER_CRITICAL();
+    target = (int64_t)value << GLIDE_FIXED_POINT_BITS;
+    int64_t distance = target - position;
+    increment = distance / (int64_t)steps;
+    if (increment == 0)
+        increment = distance < 0 ? -1 : 1;
+    active = distance != 0;
+    if (active)
+        glide_timer_start();
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief cancel any running glide and set the output immediately
+ *
+ * @param value pitch (or any value up to 32 bits)
+ */
+void Glide::jump(uint32_t value)
+{
+    taskENTER_CRITICAL();
+    target = (int64_t)value << GLIDE_FIXED_POINT_BITS;
+    position = target;
+    active = false;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief advance the glide by one tick (1 / GLIDE_RATE_HZ seconds)
+ *
+ * @return true if the glide was running, meaning read() has a new value for the DAC
+ */
+bool Glide::tick()
+{
+    if (!active)
+        return false;
+
+    int64_t distance = target - position;
+    int64_t delta;
+    if (curve == LINEAR)
+    {
+        delta = increment;
+    }
+    else
+    {
+        delta = (distance * coefficient) >> GLIDE_FIXED_POINT_BITS;
+        if (delta == 0)
+            delta = distance < 0 ? -1 : 1;
+    }
+
+    bool landed = distance > 0 ? delta >= distance : delta <= distance;
+    if (curve == EXPONENTIAL && llabs(distance) < (1 << GLIDE_FIXED_POINT_BITS))
+        landed = true; // within one DAC step, an exponential glide would otherwise never quite get there
+
+    if (landed)
+    {
+        position = target;
+        active = false;
+    }
+    else
+    {
+        position += delta;
+    }
+    return true;
+}
@@ -3,25 +3,110 @@
 using namespace DEGREE;
 
 uint32_t SETTINGS_BUFFER[SETTINGS_BUFFER_SIZE];
+Seqlock<UIState> ui_state;
 
+// one-shot tasks which bring up the peripherals on each I2C bus in parallel during boot
+static okStaticTask<BOOT_TASK_STACK_SIZE> i2c1BootTask;
+static okStaticTask<BOOT_TASK_STACK_SIZE> i2c3BootTask;
+
+static void task_boot_i2c1(void *params)
+{
+    ((GlobalControl *)params)->initI2C1Peripherals();
+    xTaskNotifyGive(main_task_handle);
+    vTaskDelete(NULL);
+}
+
+static void task_boot_i2c3(void *params)
+{
+    ((GlobalControl *)params)->initI2C3Peripherals();
+    xTaskNotifyGive(main_task_handle);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Boot pipeline. Runs in taskMain.
+ * 
+ * 1. SPI DACs get initialized and parked at their idle outputs
+ * 2. every ADC input starts denoising at once (they share one DMA stream)
+ * 3. while that runs, each I2C bus gets initialized by its own task
+ * 4. idle values get checked against the ones cached in flash, and only re-measured if they have drifted
+ * 5. the rest of the channel setup, then the clock starts
+ *
+ * A session snapshot left behind by a brown out gets loaded right after the saved config (see SessionSnapshot.h)
+ */
 void GlobalControl::init() {
     suspend_sequencer_task();
     this->loadCalibrationDataFromFlash();
     this->loadChannelConfigDataFromFlash();
+    this->restoreSessionSnapshot();
 
-    display->init();
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+    {
+        channels[i]->initOutputs();
+    }
+
+    // Tempo Pot ADC Noise: 1300ish w/ 100nF
+    tempoPot.setSampleRate(TEMPO_POT_SAMPLE_RATE_HZ); // decimation averages most of the noise out already
+    tempoPot.setFilter(0.5);
+
+    bool idleValuesCached = true;
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+    {
+        if (!channels[i]->bender->adc.hasCachedNoise())
+            idleValuesCached = false;
+    }
+    AnalogHandle::initDenoisingAll(idleValuesCached ? ADC_QUICK_DENOISE_SAMPLES : ADC_SAMPLE_COUNTER_LIMIT);
+
+    i2c1BootTask.create(task_boot_i2c1, "boot i2c1", this, RTOS_PRIORITY_LOW);
+    i2c3BootTask.create(task_boot_i2c3, "boot i2c3", this, RTOS_PRIORITY_LOW);
+    ulTaskNotifyTake(pdFALSE, portMAX_DELAY); // each boot task gives one notification when it's done
+    ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+
+    this->denoiseAnalogInputs(idleValuesCached);
+
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+    {
+        channels[i]->init();
+    }
     display->clear();
 
-    logger_log("\n");
-    logger_log("\n** Global Control **");
-    logger_log("\nToggle Switches: connected = ");
-    logger_log(switches->io->isConnected());
-    logger_log(", ISR pin (before) = ");
-    logger_log(switches->ioInterupt.read());
-    switches->init();
-    logger_log(", ISR pin (after) = ");
-    logger_log(switches->ioInterupt.read());
+    // initialize tempo
+    clock->init();
+    clock->attachResetCallback(Delegate<void(uint8_t pulse)>::bind<GlobalControl, &GlobalControl::resetSequencer>(this));
+    clock->attachPPQNCallback(Delegate<void(uint8_t pulse)>::bind<GlobalControl, &GlobalControl::advanceSequencer>(this)); // always do this last
+    clock->disableInputCaptureISR(); // pollTempoPot() will re-enable should pot be in teh right position
+    currTempoPotValue = tempoPot.read_u16();
+    TRACE_IO_ANALOG(TRACE_INPUT_TEMPO, currTempoPotValue, 200);
+    handleTempoAdjustment(currTempoPotValue);
+    prevTempoPotValue = currTempoPotValue;
+    clock->start();
+    midi_init();
+    midi_attach_receive(Delegate<void(MidiMessage msg)>::bind<GlobalControl, &GlobalControl::handleMidiMessage>(this));
+
+    switches->attachCallback(callback(this, &GlobalControl::handleSwitchChange));
+    switches->enableInterrupt();
+    switches->updateDegreeStates(); // not ideal, but you have to clear the interrupt after initialization
+    ioInterrupt.debounce(ISR_DEBOUNCE_TACTILE_BUTTONS_US);
+    ioInterrupt.fall(callback(this, &GlobalControl::handleButtonInterrupt));
+    buttons->digitalReadAB();
+    touchInterrupt.debounce(ISR_DEBOUNCE_TOUCH_PADS_US);
+    touchInterrupt.fall(callback(this, &GlobalControl::handleTouchInterrupt));
+    publishUIState();
+    session_snapshot_init(channels);
+    mem_telemetry_init(channels);
+
+    pollTimer.attachCallback(callback(this, &GlobalControl::pollTimerCallback), pdMS_TO_TICKS(CTRL_POLL_PERIOD_MS), true);
+    pollTimer.start();
+    resume_sequencer_task();
 
+    LOG("\nAudio ready %u ms after reset", (uint32_t)HAL_GetTick());
+}
+
+/**
+ * @brief everything on I2C1: tactile buttons, global touch pads and each channels touch pads
+ */
+void GlobalControl::initI2C1Peripherals()
+{
     logger_log("\nTactile Buttons: connected = ");
     logger_log(buttons->isConnected());
     logger_log(", ISR pin (before) = ");
@@ -50,46 +135,98 @@ void GlobalControl::init() {
     logger_log(", ISR pin (after) = ");
     logger_log(touchInterrupt.read());
 
-    // Tempo Pot ADC Noise: 1300ish w/ 100nF
-    tempoPot.setFilter(0.1);
-    okSemaphore *sem_ptr = tempoPot.initDenoising();
-    sem_ptr->take(); // wait
-    sem_ptr->give();
-    tempoPot.log_noise_threshold_to_console("Tempo Pot");
-    tempoPot.invertReadings();
-    logger_log("\n");
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+    {
+        channels[i]->initTouchPads();
+    }
+}
 
-    // initializing channels here might be initializing the SPI while an interrupt is getting fired by
-    // the tactile buttons / switches, which may be interrupting this task and using the SPI periph before
-    // it is initialized
-    channels[0]->init();
-    channels[1]->init();
-    channels[2]->init();
-    channels[3]->init();
+/**
+ * @brief everything on I2C3: display, toggle switches and each channels LED driver
+ */
+void GlobalControl::initI2C3Peripherals()
+{
+    display->init();
     display->clear();
 
-    // initialize tempo
-    clock->init();
-    clock->attachResetCallback(callback(this, &GlobalControl::resetSequencer));
-    clock->attachPPQNCallback(callback(this, &GlobalControl::advanceSequencer)); // always do this last
-    clock->disableInputCaptureISR(); // pollTempoPot() will re-enable should pot be in teh right position
-    currTempoPotValue = tempoPot.read_u16();
-    handleTempoAdjustment(currTempoPotValue);
-    prevTempoPotValue = currTempoPotValue;
-    clock->start();
+    logger_log("\n");
+    logger_log("\n** Global Control **");
+    logger_log("\nToggle Switches: connected = ");
+    logger_log(switches->io->isConnected());
+    logger_log(", ISR pin (before) = ");
+    logger_log(switches->ioInterupt.read());
+    switches->init();
+    logger_log(", ISR pin (after) = ");
+    logger_log(switches->ioInterupt.read());
 
-    switches->attachCallback(callback(this, &GlobalControl::handleSwitchChange));
-    switches->enableInterrupt();
-    switches->updateDegreeStates(); // not ideal, but you have to clear the interrupt after initialization
-    ioInterrupt.fall(callback(this, &GlobalControl::handleButtonInterrupt));
-    buttons->digitalReadAB();
-    touchInterrupt.fall(callback(this, &GlobalControl::handleTouchInterrupt));
-    resume_sequencer_task();
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+    {
+        channels[i]->initLEDs();
+    }
+
+    // boot animation, all four channels at once
+    for (int chan = 0; chan < CHANNEL_COUNT; chan++)
+    {
+        display_animate_spiral(chan, true, false, PWM::PWM_HIGH, BOOT_SPIRAL_SPEED);
+    }
 }
 
+/**
+ * @brief Wait for the denoising started in init() to finish.
+ * 
+ * If every bender had idle values cached in flash, only a short measurement was taken. Any bender whose idle value
+ * has drifted from the cached one gets re-measured at full length, and the new values get written back to flash.
+ * 
+ * @param cached whether the measurement in progress is the short one
+ */
+void GlobalControl::denoiseAnalogInputs(bool cached)
+{
+    AnalogHandle::waitForDenoisingAll();
+
+    if (cached)
+    {
+        bool drifted = false;
+        for (int i = 0; i < CHANNEL_COUNT; i++)
+        {
+            AnalogHandle *adc = &channels[i]->bender->adc;
+            if (!adc->restoreCachedNoise())
+            {
+                LOG("\nBender %d idle value drifted, re-measuring", i);
+                adc->initDenoising();
+                drifted = true;
+            }
+        }
+        if (drifted)
+        {
+            for (int i = 0; i < CHANNEL_COUNT; i++)
+            {
+                channels[i]->bender->adc.denoisingSemaphore.wait();
+            }
+            this->writeCalibrationDataToFlash(); // nothing is running yet, so the CPU stall from erasing flash is harmless
+        }
+    }
+
+    tempoPot.log_noise_threshold_to_console("Tempo Pot");
+    tempoPot.invertReadings();
+    logger_log("\n");
+}
+
+/**
+ * @brief runs in the timer service task, so just wake taskMain and let it do the polling
+ */
+void GlobalControl::pollTimerCallback()
+{
+    xTaskNotifyGive(main_task_handle);
+}
+
+/**
+ * @brief gets called by taskMain every CTRL_POLL_PERIOD_MS
+ */
 void GlobalControl::poll()
 {
-    switch (mode)
+    pollMemoryTelemetry();
+
+    switch ((ControlMode)ui_state.read().mode) // runs in taskMain, mode gets changed by the interrupt handler task
     {
     case DEFAULT:
         pollTempoPot(); // TODO: possibly move this into sequence handler on every clock tick
@@ -110,6 +247,34 @@ void GlobalControl::poll()
     }
 }
 
+/**
+ * @brief sample the memory telemetry every MEM_TELEMETRY_PERIOD_MS, and flash the freeze LED while it is warning
+ */
+void GlobalControl::pollMemoryTelemetry()
+{
+    telemetryPollCount++;
+    if (telemetryPollCount % (MEM_TELEMETRY_PERIOD_MS / CTRL_POLL_PERIOD_MS) == 0)
+        mem_telemetry_sample();
+
+    if (mem_telemetry_warnings() == 0)
+    {
+        if (memoryWarningLED)
+        {
+            memoryWarningLED = false;
+            freezeLED.write(freezeHeld);
+        }
+        return;
+    }
+
+    const int pollsPerStep = MEM_TELEMETRY_LED_STEP_MS / CTRL_POLL_PERIOD_MS;
+    if (telemetryPollCount % pollsPerStep != 0)
+        return;
+    int step = (telemetryPollCount / pollsPerStep) % MEM_TELEMETRY_LED_STEPS;
+    bool on = (MEM_TELEMETRY_LED_PATTERN >> step) & 1;
+    freezeLED.write(freezeHeld ? !on : on); // inverted while frozen, so the pattern still shows
+    memoryWarningLED = true;
+}
+
 /**
  * @brief exit out of current mode
  */
@@ -123,28 +288,20 @@ void GlobalControl::exitCurrentMode()
     case ControlMode::VCO_CALIBRATION:
         actionTimer.stop();
         actionTimer.detachCallback();
-        display->disableBlink();
-        display->clear();
+        display->closeLayer(LAYER::MENU); // the sequencer layer is still intact underneath
         resume_sequencer_task();
-        dispatch_sequencer_event(CHAN::ALL, SEQ::DISPLAY, 0);
-        // enter default mode, check if any sequences are active and running, if so, update the display
         break;
     case ControlMode::CALIBRATING_BENDER:
         /* code */
         break;
 
     case ControlMode::SETTING_SEQUENCE_LENGTH:
-        // iterate over each channel and then keep the display LEDs on or off based on sequence containing events
         for (int chan = 0; chan < CHANNEL_COUNT; chan++)
         {
-            if (!channels[chan]->sequence.containsEvents())
-            {
-                display->clear(chan);
-            }
             channels[chan]->disableBenderOverride();
             channels[chan]->setUIMode(TouchChannel::UIMode::UI_PLAYBACK);
-            display->disableBlink();
         }
+        display->closeLayer(LAYER::MENU);
         break;
 
     case ControlMode::SETTING_QUANTIZE_AMOUNT:
@@ -154,9 +311,20 @@ void GlobalControl::exitCurrentMode()
         }
         break;
 
+    case ControlMode::SETTING_GLIDE_TIME:
+        for (int i = 0; i < CHANNEL_COUNT; i++)
+        {
+            channels[i]->setUIMode(TouchChannel::UIMode::UI_PLAYBACK);
+        }
+        break;
+
     case ControlMode::HARDWARE_TESTING:
         /* code */
         break;
+
+    case ControlMode::SYSTEM_STATUS:
+        display->closeLayer(LAYER::MENU);
+        break;
     }
     // always revert to default mode
     mode = ControlMode::DEFAULT;
@@ -169,17 +337,11 @@ void GlobalControl::handleSwitchChange()
 
 void GlobalControl::handleButtonInterrupt()
 {
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    uint8_t isr_id = ISR_ID_TACTILE_BUTTONS;
-    xQueueSendFromISR(qhInterruptQueue, &isr_id, &xHigherPriorityTaskWoken);
-    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    dispatch_input_event_ISR(ISR_ID_TACTILE_BUTTONS, ioInterrupt._pin, 0);
 }
 
 void GlobalControl::handleTouchInterrupt() {
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    uint8_t isr_id = ISR_ID_TOUCH_PADS;
-    xQueueSendFromISR(qhInterruptQueue, &isr_id, &xHigherPriorityTaskWoken);
-    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    dispatch_input_event_ISR(ISR_ID_TOUCH_PADS, touchInterrupt._pin, 0);
 }
 
 void GlobalControl::pollTempoPot()
@@ -193,6 +355,7 @@ void GlobalControl::pollTempoPot()
 
 void GlobalControl::handleTempoAdjustment(uint16_t value)
 {
+    clock->disableMidiClock(); // moving the pot takes back over from MIDI clock
     if (value > 1000)
     {
         if (clock->externalInputMode)
@@ -220,13 +383,41 @@ void GlobalControl::pollTouchPads() {
 #else
     currTouched = touchPads->touched();
 #endif
+    if (currTouched != prevTouched)
+        TRACE_IO(TRACE_INPUT_SELECT, currTouched);
     // queue select pad
-    dispatch_sequencer_event(CHAN::ALL, SEQ::HANDLE_SELECT_PAD, 0);
     if (currTouched == 0x00) {
         gestureFlag = false;
     } else {
         gestureFlag = true;
     }
+    handleCopyGesture();
+    publishUIState();
+}
+
+/**
+ * @brief while only SHIFT is held, touch and hold a channel's select pad, then touch the select pads of the channels to
+ * copy its sequence to. The copies share the pattern until one of them gets modified
+ */
+void GlobalControl::handleCopyGesture()
+{
+    if (currButtonsState != SHIFT || recordEnabled || mode != ControlMode::DEFAULT)
+    {
+        copySource = -1;
+        return;
+    }
+    if (copySource != -1 && !touchPads->padIsTouched(copySource, currTouched))
+        copySource = -1; // source released, the next pad touched becomes the new source
+
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+    {
+        if (!touchPads->padIsTouched(i, currTouched) || touchPads->padIsTouched(i, prevTouched))
+            continue; // only pads touched since the last poll
+        if (copySource == -1)
+            copySource = i;
+        else
+            dispatch_sequencer_event(CHAN(i), SEQ::COPY, copySource);
+    }
 }
 
 /**
@@ -237,6 +428,7 @@ void GlobalControl::pollButtons()
     currButtonsState = buttons->digitalReadAB();
     if (currButtonsState != prevButtonsState)
     {
+        TRACE_IO(TRACE_INPUT_BUTTONS, currButtonsState);
         for (int i = 0; i < 16; i++)
         {
             // if state went HIGH and was LOW before
@@ -264,6 +456,27 @@ void GlobalControl::pollButtons()
 
     // reset polling
     prevButtonsState = currButtonsState;
+    publishUIState();
+}
+
+/**
+ * @brief make the current select pad / mode / record state visible to other tasks (see UIState.h). Call once an input
+ * event has been fully handled, so readers never see half of a gesture
+ */
+void GlobalControl::publishUIState()
+{
+    UIState state;
+    state.touched = currTouched;
+    state.selectPads = 0;
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+    {
+        if (touchPads->padIsTouched(i, currTouched))
+            state.selectPads |= (1 << i);
+    }
+    state.mode = (uint8_t)mode;
+    state.gesture = gestureFlag;
+    state.recordEnabled = recordEnabled;
+    ui_state.write(state);
 }
 
 /**
@@ -294,6 +507,7 @@ void GlobalControl::handleButtonPress(int pad)
         break;
     case FREEZE:
         if (recordEnabled == true) break;
+        freezeHeld = true;
         freezeLED.write(HIGH);
         this->handleFreeze(true);
         break;
@@ -314,12 +528,37 @@ void GlobalControl::handleButtonPress(int pad)
         dispatch_sequencer_event(CHAN::ALL, SEQ::QUANTIZE, 0);
         break;
 
+    case Gestures::UNDO_SEQ:
+    case Gestures::REDO_SEQ:
+        if (recordEnabled == true) break;
+        historyGesture = true;
+        if (gestureFlag)
+        {
+            for (int i = 0; i < CHANNEL_COUNT; i++)
+            {
+                if (touchPads->padIsTouched(i, currTouched))
+                    dispatch_sequencer_event(CHAN(i), pad == Gestures::UNDO_SEQ ? SEQ::UNDO : SEQ::REDO, 0);
+            }
+        } else {
+            dispatch_sequencer_event(CHAN::ALL, pad == Gestures::UNDO_SEQ ? SEQ::UNDO : SEQ::REDO, 0);
+        }
+        break;
+
+    case Gestures::SONG_APPEND:
+    case Gestures::SONG_CLEAR:
+        if (recordEnabled == true || !gestureFlag) break; // these are also part of the way to LOG_SYSTEM_STATUS
+        for (int i = 0; i < CHANNEL_COUNT; i++)
+        {
+            if (touchPads->padIsTouched(i, currTouched))
+                dispatch_sequencer_event(CHAN(i), pad == Gestures::SONG_APPEND ? SEQ::SONG_APPEND : SEQ::SONG_CLEAR, 0);
+        }
+        break;
+
     case Gestures::CALIBRATE_BENDER:
         if (recordEnabled == true) break;
         if (this->mode == CALIBRATING_BENDER)
         {
-            this->saveCalibrationDataToFlash();
-            display->disableBlink();
+            this->saveCalibrationDataToFlash(); // closes the menu layer
             this->mode = DEFAULT;
             logger_log("\nEXIT Bender Calibration");
             resume_sequencer_task();
@@ -329,7 +568,8 @@ void GlobalControl::handleButtonPress(int pad)
             suspend_sequencer_task();
             logger_log("\nENTER Bender Calibration");
             this->mode = CALIBRATING_BENDER;
-            display->enableBlink();
+            display->openLayer(LAYER::MENU);
+            display->enableBlink(LAYER::MENU);
             display->benderCalibration();
             for (int i = 0; i < 4; i++)
             {
@@ -361,8 +601,9 @@ void GlobalControl::handleButtonPress(int pad)
         actionExitFlag = ACTION_EXIT_STAGE_1; // set exit flag
         mode = ControlMode::VCO_CALIBRATION;
         suspend_sequencer_task();
-        display->enableBlink();
-        display->fill(30, true);
+        display->openLayer(LAYER::MENU); // stays open until calibration is saved, or the gesture gets cancelled
+        display->enableBlink(LAYER::MENU);
+        display->fill(30, true, LAYER::MENU);
         actionCounter = 0; // reset
         actionCounterLimit = 15;
         actionTimer.attachCallback(callback(this, &GlobalControl::pressHold), 100, true);
@@ -375,6 +616,10 @@ void GlobalControl::handleButtonPress(int pad)
 
     case Gestures::LOG_SYSTEM_STATUS:
         log_system_status();
+        if (recordEnabled == true) break;
+        actionExitFlag = ACTION_EXIT_STAGE_1;
+        mode = ControlMode::SYSTEM_STATUS;
+        drawSystemStatus();
         break;
 
     case BEND_MODE:
@@ -410,16 +655,27 @@ void GlobalControl::handleButtonPress(int pad)
         }
         break;
 
+    case GLIDE_TIME:
+        if (recordEnabled == true) break;
+        actionExitFlag = ACTION_EXIT_STAGE_1;
+        mode = ControlMode::SETTING_GLIDE_TIME;
+        for (int i = 0; i < CHANNEL_COUNT; i++)
+        {
+            channels[i]->setUIMode(TouchChannel::UIMode::UI_GLIDE_TIME);
+        }
+        break;
+
     case SEQ_LENGTH:
         if (recordEnabled == true) break;
         actionExitFlag = ACTION_EXIT_STAGE_1;
         mode = ControlMode::SETTING_SEQUENCE_LENGTH;
+        display->openLayer(LAYER::MENU);
+        display->enableBlink(LAYER::MENU);
         for (int chan = 0; chan < CHANNEL_COUNT; chan++)
         {
             channels[chan]->setUIMode(TouchChannel::UIMode::UI_SEQUENCE_LENGTH);
             channels[chan]->enableBenderOverride();
-            display->enableBlink();
-            channels[chan]->drawSequenceToDisplay(true);
+            channels[chan]->drawSequenceToDisplay(true, LAYER::MENU);
         }
         break;
 
@@ -451,11 +707,18 @@ void GlobalControl::handleButtonRelease(int pad)
         actionExitFlag = ACTION_EXIT_CLEAR;
         return;
     }
+    if (historyGesture)
+    {
+        if ((currButtonsState & (CLEAR_SEQ_TOUCH | CLEAR_SEQ_BEND)) == 0)
+            historyGesture = false;
+        return;
+    }
     switch (pad)
     {
     case FREEZE:
         if (recordEnabled == true)
             break;
+        freezeHeld = false;
         freezeLED.write(LOW);
         handleFreeze(false);
         break;
@@ -577,9 +840,15 @@ void GlobalControl::loadCalibrationDataFromFlash()
             {
                 channels[chan]->output.dacVoltageMap[i] = (uint16_t)SETTINGS_BUFFER[i];
             }
-            flash.read(FLASH_BENDER_CALIBRATION_ADDR, SETTINGS_BUFFER, 2);
+            channels[chan]->output.updateSemitoneMap();
+            flash.read(FLASH_BENDER_CALIBRATION_ADDR + address_offset, SETTINGS_BUFFER, 4);
             channels[chan]->bender->setMinBend((uint16_t)SETTINGS_BUFFER[0]);
             channels[chan]->bender->setMaxBend((uint16_t)SETTINGS_BUFFER[1]);
+            if (SETTINGS_BUFFER[2] != 0xFFFFFFFF && SETTINGS_BUFFER[3] != 0xFFFFFFFF) // not saved by older firmware
+            {
+                channels[chan]->bender->adc.cachedIdleValue = (uint16_t)SETTINGS_BUFFER[2];
+                channels[chan]->bender->adc.cachedNoiseThreshold = (uint16_t)SETTINGS_BUFFER[3];
+            }
         }
     }
 }
@@ -607,8 +876,8 @@ void GlobalControl::loadChannelConfigDataFromFlash()
             channels[chan]->loadConfigData(channel_config);
 
             // load sequence data
-            uint32_t sequence_config[4];
-            flash.read(FLASH_SEQUENCE_CONFIG_ADDR + address_offset, sequence_config, 4);
+            uint32_t sequence_config[8];
+            flash.read(FLASH_SEQUENCE_CONFIG_ADDR + address_offset, sequence_config, 8);
             channels[chan]->sequence.loadSequenceConfigData(sequence_config);
 
             if (channels[chan]->sequence.containsEvents())
@@ -634,8 +903,23 @@ void GlobalControl::loadChannelConfigDataFromFlash()
 */
 void GlobalControl::saveCalibrationDataToFlash()
 {
-    this->display->fill(PWM::PWM_MID, true);
+    this->display->openLayer(LAYER::MENU);
+    this->display->enableBlink(LAYER::MENU);
+    this->display->fill(PWM::PWM_MID, true, LAYER::MENU);
 
+    this->writeCalibrationDataToFlash();
+
+    // flash the grid of leds on and off for a sec then exit
+    display_animate_flash(DISPLAY_ALL_LEDS_MASK, PWM::PWM_MID, 3, 300);
+    this->display->closeLayer(LAYER::MENU);
+    logger_log("\nSaved Calibration Data to Flash");
+}
+
+/**
+ * @brief erase and re-write the calibration sector (firmware version, 1v/o maps, bender range and bender idle values)
+ */
+void GlobalControl::writeCalibrationDataToFlash()
+{
     Flash flash;
     flash.erase(FLASH_CALIBRATION_ADDR);
 
@@ -662,16 +946,15 @@ void GlobalControl::saveCalibrationDataToFlash()
         }
         flash.write(FLASH_1VO_CALIBRATION_ADDR + address_offset, SETTINGS_BUFFER, DAC_1VO_ARR_SIZE);
 
-        // max and min Bender calibration data
+        // max and min Bender calibration data, plus the idle values so the next boot can skip measuring them
         SETTINGS_BUFFER[0] = channels[chan]->bender->adc.getInputMin();
         SETTINGS_BUFFER[1] = channels[chan]->bender->adc.getInputMax();
-        flash.write(FLASH_BENDER_CALIBRATION_ADDR + address_offset, SETTINGS_BUFFER, 2);
+        SETTINGS_BUFFER[2] = channels[chan]->bender->adc.avgValueWhenIdle;
+        SETTINGS_BUFFER[3] = channels[chan]->bender->adc.idleNoiseThreshold;
+        flash.write(FLASH_BENDER_CALIBRATION_ADDR + address_offset, SETTINGS_BUFFER, 4);
+        channels[chan]->bender->adc.cachedIdleValue = channels[chan]->bender->adc.avgValueWhenIdle;
+        channels[chan]->bender->adc.cachedNoiseThreshold = channels[chan]->bender->adc.idleNoiseThreshold;
     }
-
-    // flash the grid of leds on and off for a sec then exit
-    this->display->flash(3, 300);
-    this->display->clear();
-    logger_log("\nSaved Calibration Data to Flash");
 }
 
 /**
@@ -680,8 +963,23 @@ void GlobalControl::saveCalibrationDataToFlash()
  */
 void GlobalControl::saveChannelConfigDataToFlash()
 {
-    this->display->fill(PWM::PWM_MID, true);
+    display_animate_progress(0, PWM::PWM_MID);
+
+    this->writeChannelConfigDataToFlash(true);
 
+    // flash the grid of leds on and off for a sec then exit
+    display_animate_flash(DISPLAY_ALL_LEDS_MASK, PWM::PWM_MID, 3, 300);
+    logger_log("\nSaved Calibration Data to Flash");
+}
+
+/**
+ * @brief erase and re-write the config sector (channel config, sequence config and sequence data). Erasing the sector
+ * also clears the session snapshot area
+ *
+ * @param showProgress fill the display as each channel gets written (the display isn't up yet during boot)
+ */
+void GlobalControl::writeChannelConfigDataToFlash(bool showProgress)
+{
     Flash flash;
     flash.erase(FLASH_CONFIG_ADDR);
     for (int chan = 0; chan < CHANNEL_COUNT; chan++)
@@ -716,32 +1014,40 @@ void GlobalControl::saveChannelConfigDataToFlash()
                 flash.write(address, sequence_data, PPQN);
             }
         }
+        if (showProgress)
+            display_animate_progress(((chan + 1) * 100) / CHANNEL_COUNT, PWM::PWM_MID);
     }
+}
 
-    // flash the grid of leds on and off for a sec then exit
-    this->display->flash(3, 300);
-    this->display->clear();
-    logger_log("\nSaved Calibration Data to Flash");
+/**
+ * @brief load the session snapshot taken on the last brown out, if there is one, then save the session the regular way.
+ * Saving erases the snapshot area so it is ready for the next brown out, which also has to happen when a snapshot got
+ * cut short.
+ */
+void GlobalControl::restoreSessionSnapshot()
+{
+    if (!session_snapshot_pending())
+        return;
+
+    if (session_snapshot_restore(channels))
+        logger_log("\nChannel Config Source: SNAPSHOT");
+    else
+        logger_log("\nDiscarding incomplete session snapshot");
+
+    this->writeChannelConfigDataToFlash();
 }
 
 void GlobalControl::deleteCalibrationDataFromFlash()
 {
-    display->setScene(SCENE::SETTINGS);
-    display->resetScene();
-    display->enableBlink();
-    display->fill(127, true);
+    display->openLayer(LAYER::MENU);
+    display->enableBlink(LAYER::MENU);
+    display->fill(127, true, LAYER::MENU);
 
     Flash flash;
     flash.erase(FLASH_CALIBRATION_ADDR);
 
-    for (int i = 0; i < DISPLAY_COLUMN_COUNT; i++)
-    {
-        int led = DISPLAY_COLUMN_COUNT - 1 - i; // go backwards
-        display->setColumn(led, 30, true);
-        vTaskDelay(50);
-    }
-    display->setScene(SCENE::SEQUENCER);
-    display->redrawScene();
+    display_animate_column_fade(127, 30, true, 50); // go backwards
+    display->closeLayer(LAYER::MENU);
 }
 
 /**
@@ -750,22 +1056,15 @@ void GlobalControl::deleteCalibrationDataFromFlash()
  */
 void GlobalControl::deleteChannelConfigDataFromFlash()
 {
-    display->setScene(SCENE::SETTINGS);
-    display->resetScene();
-    display->enableBlink();
-    display->fill(127, true);
+    display->openLayer(LAYER::MENU);
+    display->enableBlink(LAYER::MENU);
+    display->fill(127, true, LAYER::MENU);
 
     Flash flash;
     flash.erase(FLASH_CONFIG_ADDR);
 
-    for (int i = 0; i < DISPLAY_COLUMN_COUNT; i++)
-    {
-        int led = DISPLAY_COLUMN_COUNT - 1 - i; // go backwards
-        display->setColumn(led, 30, true);
-        vTaskDelay(50);
-    }
-    display->setScene(SCENE::SEQUENCER);
-    display->redrawScene();
+    display_animate_column_fade(127, 30, true, 50); // go backwards
+    display->closeLayer(LAYER::MENU);
 }
 
 void GlobalControl::resetCalibrationDataToDefault()
@@ -825,6 +1124,43 @@ void GlobalControl::resetSequencer(uint8_t pulse)
     dispatch_sequencer_event_ISR(CHAN::ALL, SEQ::CORRECT, 0);
 }
 
+/**
+ * @brief Called from the MIDI receive ISR for every complete message.
+ *
+ * Clock / start / stop / continue drive the SuperClock right here, so the sequencer lines up with MIDI clock without
+ * waiting on a task. Notes on MIDI channels 1..4 go to channels A..D through the sequencer queue (see
+ * TouchChannel::handleMidiNote()).
+ */
+void GlobalControl::handleMidiMessage(MidiMessage msg)
+{
+    switch (msg.type())
+    {
+    case MIDI_CLOCK:
+        clock->handleMidiClock();
+        break;
+    case MIDI_START:
+        clock->handleMidiStart();
+        dispatch_sequencer_event_ISR(CHAN::ALL, SEQ::RESET, 0);
+        break;
+    case MIDI_CONTINUE:
+        clock->handleMidiContinue();
+        break;
+    case MIDI_STOP:
+        clock->handleMidiStop();
+        break;
+    case MIDI_NOTE_ON:
+    case MIDI_NOTE_OFF:
+        if (msg.channel() < CHANNEL_COUNT)
+        {
+            uint8_t velocity = msg.type() == MIDI_NOTE_ON ? msg.data2 : 0;
+            dispatch_sequencer_event_ISR((CHAN)msg.channel(), SEQ::MIDI_NOTE, (msg.data1 << 8) | velocity);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
 void GlobalControl::handleFreeze(bool freeze) {
     if (this->gestureFlag)
     {
@@ -842,6 +1178,7 @@ void GlobalControl::handleFreeze(bool freeze) {
 
 void GlobalControl::disableVCOCalibration() {
     this->mode = ControlMode::DEFAULT;
+    publishUIState();
 }
 
 /**
@@ -852,7 +1189,7 @@ void GlobalControl::pressHold() {
     if (gestureFlag)
     {
         int touchedChannel = getTouchedChannel();
-        display->setSpiralLED(touchedChannel, actionCounter, 255, false);
+        display->setSpiralLED(touchedChannel, actionCounter, 255, false, LAYER::MENU);
         actionCounter++;
         if (actionCounter > actionCounterLimit) {
             actionTimer.stop();
@@ -863,7 +1200,7 @@ void GlobalControl::pressHold() {
         // reset
         if (actionCounter != 0)
         {
-            display->fill(30, true);
+            display->fill(30, true, LAYER::MENU);
         }
         actionCounter = 0;
     }
@@ -909,12 +1246,55 @@ void GlobalControl::log_system_status()
 
     logger_log("\nTouch ISR pin = ");
     logger_log(touchInterrupt.read());
+
+    logger_log("\nDebounced edges (switches, buttons, touch) = ");
+    logger_log(switches->ioInterupt.getDroppedCount());
+    logger_log(", ");
+    logger_log(ioInterrupt.getDroppedCount());
+    logger_log(", ");
+    logger_log(touchInterrupt.getDroppedCount());
+    logger_log("\nDropped input events = ");
+    logger_log(input_events_dropped);
+
+    logger_log("\nDropped log bytes = ");
+    logger_log(logger_get_dropped_bytes());
+
+    logger_log("\nCPU idle = ");
+    logger_log(rtos_get_idle_percent());
+    logger_log("%");
+
+    task_stats_sample();
+    task_stats_log();
+
+    mem_telemetry_log(); // last periodic sample, at most MEM_TELEMETRY_PERIOD_MS old
+    mem_telemetry_dump();
+
+#ifdef TRACE_RECORDING
+    trace_dump();
+#endif
     for (int i = 0; i < CHANNEL_COUNT; i++) {
         channels[i]->logPeripherals();
         channels[i]->output.logVoltageMap();
     }
 }
 
+/**
+ * @brief draw the CPU usage of each task (from the last task_stats_sample()) as a bar graph, one column per task.
+ * Columns blink when a task has missed a deadline or is running low on stack.
+ */
+void GlobalControl::drawSystemStatus()
+{
+    display->openLayer(LAYER::MENU);
+    display->enableBlink(LAYER::MENU);
+    for (int i = 0; i < DISPLAY_COLUMN_COUNT; i++)
+    {
+        const TaskStats *stats = task_stats_get(i);
+        if (stats == NULL)
+            break;
+        display->drawBar(i, stats->cpu, task_stats_warning(stats), LAYER::MENU);
+    }
+}
+
 void GlobalControl::handleHardwareTest(uint16_t pressedButtons)
 {
     switch (pressedButtons)
@@ -0,0 +1,295 @@
+#include "MemTelemetry.h"
+#include "TouchChannel.h"
+
+static MemTelemetry telemetry;
+static TouchChannel **telemetry_channels = nullptr;
+
+/**
+ * @brief counts the events SuperSeq::serializeTouchEvents() hands it
+ */
+struct EventCounter
+{
+    int count;
+    void operator()(uint32_t event) { count++; }
+};
+
+/**
+ * @param channels all CHANNEL_COUNT channels, for their sequence occupancy
+ */
+void mem_telemetry_init(TouchChannel **channels)
+{
+    telemetry_channels = channels;
+    mem_telemetry_sample();
+}
+
+/**
+ * @brief add a task to the stack watermark report. Only register tasks which never get deleted, the handle of a deleted
+ * task isn't safe to query
+ *
+ * @param handle task handle
+ * @param stackSize stack depth in words
+ */
+void mem_telemetry_register_task(TaskHandle_t handle, uint32_t stackSize)
+{
+    if (handle == NULL || telemetry.taskCount >= MEM_TELEMETRY_MAX_TASKS)
+        return;
+    MemTelemetryTask *task = &telemetry.tasks[telemetry.taskCount];
+    task->handle = handle;
+    task->stackSize = stackSize;
+    task->stackFree = stackSize;
+    telemetry.taskCount++;
+}
+
+/**
+ * @brief take a new sample and update the warnings. Runs in taskMain, walking every registered stack takes a few
+ * hundred microseconds
+ */
+void mem_telemetry_sample()
+{
+    uint32_t warnings = 0;
+
+    telemetry.heapFree = xPortGetFreeHeapSize();
+    telemetry.heapMinFree = xPortGetMinimumEverFreeHeapSize();
+    if (telemetry.heapMinFree < MEM_TELEMETRY_HEAP_WARNING)
+        warnings |= MEM_WARNING_HEAP;
+
+    for (int i = 0; i < telemetry.taskCount; i++)
+    {
+        MemTelemetryTask *task = &telemetry.tasks[i];
+        task->stackFree = uxTaskGetStackHighWaterMark(task->handle);
+        if (task->stackFree < MEM_TELEMETRY_STACK_WARNING)
+            warnings |= MEM_WARNING_STACK;
+    }
+
+    for (int i = 1; i <= TRACE_MAX_QUEUES; i++)
+    {
+        QueueHandle_t queue = trace_get_queue(i);
+        if (queue == NULL)
+            continue;
+        telemetry.queueWaiting[i] = uxQueueMessagesWaiting(queue);
+        telemetry.queueLength[i] = telemetry.queueWaiting[i] + uxQueueSpacesAvailable(queue);
+        telemetry.queuePeak[i] = trace_queue_peak[i];
+        if (telemetry.queuePeak[i] * 100 >= telemetry.queueLength[i] * MEM_TELEMETRY_QUEUE_WARNING)
+            warnings |= MEM_WARNING_QUEUE;
+    }
+
+    if (telemetry_channels)
+    {
+        for (int chan = 0; chan < CHANNEL_COUNT; chan++)
+        {
+            EventCounter counter = {0};
+            telemetry_channels[chan]->sequence.serializeTouchEvents(counter, MAX_SEQ_LENGTH_PPQN);
+            telemetry.events[chan] = counter.count;
+            if (counter.count > telemetry.eventsPeak[chan])
+                telemetry.eventsPeak[chan] = counter.count;
+            if (counter.count * 100 >= SEQ_QUANTIZE_MAX_EVENTS * MEM_TELEMETRY_EVENTS_WARNING)
+                warnings |= MEM_WARNING_EVENTS;
+        }
+    }
+
+    telemetry.historyPages = SeqHistory::getPoolPagesUsed();
+    if (telemetry.historyPages > telemetry.historyPeak)
+        telemetry.historyPeak = telemetry.historyPages;
+
+    telemetry.warnings = warnings;
+}
+
+const MemTelemetry *mem_telemetry_get()
+{
+    return &telemetry;
+}
+
+/**
+ * @return MemTelemetryWarning bits raised by the last sample
+ */
+uint32_t mem_telemetry_warnings()
+{
+    return telemetry.warnings;
+}
+
+/**
+ * @brief little endian writer for the blob
+ */
+struct BlobWriter
+{
+    uint8_t *buffer;
+    int size;
+    int length;
+
+    void put(uint32_t value, int bytes)
+    {
+        for (int i = 0; i < bytes; i++)
+        {
+            if (length < size)
+                buffer[length] = (uint8_t)(value >> (i * 8));
+            length++;
+        }
+    }
+};
+
+/**
+ * @brief write the last sample into buffer, in the layout described in MemTelemetry.h
+ *
+ * @return number of bytes the blob takes, which is larger than size if it didn't fit
+ */
+int mem_telemetry_serialize(uint8_t *buffer, int size)
+{
+    BlobWriter blob = {buffer, size, 0};
+    int queueCount = 0;
+    for (int i = 1; i <= TRACE_MAX_QUEUES; i++)
+    {
+        if (trace_get_queue(i))
+            queueCount = i; // queues are numbered in the order they got registered, so there are no gaps
+    }
+
+    blob.put(MEM_TELEMETRY_VERSION, 1);
+    blob.put(telemetry.taskCount, 1);
+    blob.put(queueCount, 1);
+    blob.put(CHANNEL_COUNT, 1);
+    blob.put(configTOTAL_HEAP_SIZE, 4);
+    blob.put(telemetry.heapFree, 4);
+    blob.put(telemetry.heapMinFree, 4);
+    blob.put(telemetry.warnings, 4);
+    for (int i = 0; i < telemetry.taskCount; i++)
+    {
+        blob.put(telemetry.tasks[i].stackSize, 2);
+        blob.put(telemetry.tasks[i].stackFree, 2);
+    }
+    for (int i = 1; i <= queueCount; i++)
+    {
+        blob.put(telemetry.queueLength[i], 2);
+        blob.put(telemetry.queueWaiting[i], 2);
+        blob.put(telemetry.queuePeak[i], 2);
+    }
+    for (int chan = 0; chan < CHANNEL_COUNT; chan++)
+    {
+        blob.put(telemetry.events[chan], 2);
+        blob.put(telemetry.eventsPeak[chan], 2);
+    }
+    blob.put(SEQ_QUANTIZE_MAX_EVENTS, 2);
+    blob.put(telemetry.historyPages, 2);
+    blob.put(telemetry.historyPeak, 2);
+    blob.put(SEQ_HISTORY_POOL_PAGES, 2);
+    return blob.length;
+}
+
+static void log_usage(uint32_t used, uint32_t size)
+{
+    logger_log(used);
+    logger_log(" / ");
+    logger_log(size);
+}
+
+/**
+ * @brief log the last sample as a table
+ */
+void mem_telemetry_log()
+{
+    logger_log("\n\nMEMORY (used / size, worst ever)");
+    logger_log("\nheap            ");
+    log_usage(configTOTAL_HEAP_SIZE - telemetry.heapMinFree, configTOTAL_HEAP_SIZE);
+    if (telemetry.warnings & MEM_WARNING_HEAP)
+        logger_log("\t<-- !!");
+
+    for (int i = 0; i < telemetry.taskCount; i++)
+    {
+        const MemTelemetryTask *task = &telemetry.tasks[i];
+        const char *name = pcTaskGetName(task->handle);
+        logger_log("\nstack ");
+        logger_log(name);
+        for (int pad = strlen(name); pad < 10; pad++)
+            logger_log(" ");
+        log_usage(task->stackSize - task->stackFree, task->stackSize);
+        if (task->stackFree < MEM_TELEMETRY_STACK_WARNING)
+            logger_log("\t<-- !!");
+    }
+
+    for (int i = 1; i <= TRACE_MAX_QUEUES; i++)
+    {
+        const char *name = trace_get_queue_name(i);
+        if (name == NULL)
+            continue;
+        logger_log("\nqueue ");
+        logger_log(name);
+        for (int pad = strlen(name); pad < 10; pad++)
+            logger_log(" ");
+        log_usage(telemetry.queuePeak[i], telemetry.queueLength[i]);
+        if (telemetry.queuePeak[i] * 100 >= telemetry.queueLength[i] * MEM_TELEMETRY_QUEUE_WARNING)
+            logger_log("\t<-- !!");
+    }
+
+    for (int chan = 0; chan < CHANNEL_COUNT; chan++)
+    {
+        logger_log("\nevents ");
+        logger_log(chan);
+        logger_log("        ");
+        log_usage(telemetry.events[chan], SEQ_QUANTIZE_MAX_EVENTS);
+        logger_log(" (peak ");
+        logger_log((uint32_t)telemetry.eventsPeak[chan]);
+        logger_log(")");
+        if (telemetry.events[chan] * 100 >= SEQ_QUANTIZE_MAX_EVENTS * MEM_TELEMETRY_EVENTS_WARNING)
+            logger_log("\t<-- !!");
+    }
+
+    logger_log("\nundo history    ");
+    log_usage(telemetry.historyPages, SEQ_HISTORY_POOL_PAGES);
+    logger_log(" (peak ");
+    logger_log((uint32_t)telemetry.historyPeak);
+    logger_log(")");
+
+    logger_log("\npatterns        ");
+    log_usage(seq_pattern_used(), SEQ_PATTERN_POOL_SIZE);
+    logger_log("\n");
+}
+
+static void hex_to_string(uint8_t value, char *str)
+{
+    static const char hex[] = "0123456789abcdef";
+    str[0] = hex[value >> 4];
+    str[1] = hex[value & 0xF];
+}
+
+/**
+ * @brief log the last sample as a binary blob (see MemTelemetry.h), for mem-decode.py
+ */
+void mem_telemetry_dump()
+{
+    static uint8_t blob[MEM_TELEMETRY_BLOB_SIZE]; // static, the status gesture runs on the small interrupt handler stack
+    static char line[4 + 64 + 1];
+    int length = mem_telemetry_serialize(blob, sizeof(blob));
+
+    logger_log("\nMEM_BEGIN ");
+    logger_log(length);
+    for (int i = 0; i < telemetry.taskCount; i++)
+    {
+        logger_log("\nMEM_TASK ");
+        logger_log(i);
+        logger_log(" ");
+        logger_log(pcTaskGetName(telemetry.tasks[i].handle));
+    }
+    for (int i = 1; i <= TRACE_MAX_QUEUES; i++)
+    {
+        if (trace_get_queue_name(i))
+        {
+            logger_log("\nMEM_QUEUE ");
+            logger_log(i);
+            logger_log(" ");
+            logger_log(trace_get_queue_name(i));
+        }
+    }
+
+    for (int i = 0; i < length; i += 32)
+    {
+        memcpy(line, "MEM ", 4);
+        char *ptr = &line[4];
+        for (int j = i; j < i + 32 && j < length; j++)
+        {
+            hex_to_string(blob[j], ptr);
+            ptr += 2;
+        }
+        *ptr = '\0';
+        logger_log("\n");
+        logger_log(line);
+    }
+    logger_log("\nMEM_END\n");
+}
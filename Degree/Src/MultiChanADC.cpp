@@ -1,80 +1,74 @@
 #include "MultiChanADC.h"
+#include "MemTelemetry.h"
 
 ADC_HandleTypeDef hadc1;
+ADC_HandleTypeDef hadc2;
 DMA_HandleTypeDef hdma_adc1;
+DMA_HandleTypeDef hdma_adc2;
 TIM_HandleTypeDef htim3;
+TIM_HandleTypeDef htim8;
+okStaticTask<RTOS_STACK_SIZE_MIN> adcTask;
 
+/**
+ * Two independent ADCs, each triggered by its own timer and drained by its own DMA stream:
+ *
+ * ADC1 (TIM3, DMA2 Stream 0)  benders A - D and the tempo pot, at ADC_CONTROL_SAMPLE_RATE_HZ
+ * ADC2 (TIM8, DMA2 Stream 3)  CV inputs A - D, at ADC_CV_SAMPLE_RATE_HZ
+ *
+ * The rates are fixed, inputs which don't need every sample get decimated by AnalogHandle (see setSampleRate())
+ */
 void multi_chan_adc_init()
 {
     MX_DMA_Init();
     MX_ADC1_Init();
+    MX_ADC2_Init();
     MX_TIM3_Init();
+    MX_TIM8_Init();
 
-    multi_chan_adc_set_sample_rate(&hadc1, &htim3, ADC_SAMPLE_RATE_HZ);
+    multi_chan_adc_set_sample_rate(&hadc1, &htim3, ADC_CONTROL_SAMPLE_RATE_HZ);
+    multi_chan_adc_set_sample_rate(&hadc2, &htim8, ADC_CV_SAMPLE_RATE_HZ);
 
-    logger_log("ADC Sample Rate: ");
+    logger_log("ADC Sample Rate (controls): ");
     logger_log(multi_chan_adc_get_sample_rate(&hadc1, &htim3));
+    logger_log(", (CV): ");
+    logger_log(multi_chan_adc_get_sample_rate(&hadc2, &htim8));
     logger_log("\n");
 
-    AnalogHandle::semaphore = xSemaphoreCreateBinary();
-    xTaskCreate(AnalogHandle::sampleReadyTask, "ADC Task", RTOS_STACK_SIZE_MIN, NULL, RTOS_PRIORITY_MED, NULL);
+    adcTask.create(AnalogHandle::sampleReadyTask, "ADC Task", NULL, RTOS_PRIORITY_MED);
+    mem_telemetry_register_task(adcTask);
 }
 
 void multi_chan_adc_start()
 {
     HAL_TIM_Base_Start(&htim3);
+    HAL_TIM_Base_Start(&htim8);
     HAL_ADC_Start_DMA(&hadc1, (uint32_t *)AnalogHandle::DMA_BUFFER, ADC_DMA_BUFF_SIZE);
+    HAL_ADC_Start_DMA(&hadc2, (uint32_t *)AnalogHandle::CV_DMA_BUFFER, ADC_CV_DMA_BUFF_SIZE);
 }
 
 void multi_chan_adc_enable_irq()
 {
     HAL_NVIC_EnableIRQ(DMA2_Stream0_IRQn);
+    HAL_NVIC_EnableIRQ(DMA2_Stream3_IRQn);
 }
 
 void multi_chan_adc_disable_irq()
 {
     HAL_NVIC_DisableIRQ(DMA2_Stream0_IRQn);
+    HAL_NVIC_DisableIRQ(DMA2_Stream3_IRQn);
 }
 
+/**
+ * @brief every timer overflow triggers one scan of all the ADCs channels, so the sample rate is the overflow frequency
+ */
 uint32_t multi_chan_adc_get_sample_rate(ADC_HandleTypeDef *hadc, TIM_HandleTypeDef *htim)
 {
-    uint32_t tim_overflow_freq = tim_get_overflow_freq(htim);
-    switch (hadc->Init.ClockPrescaler)
-    {
-    case ADC_CLOCK_SYNC_PCLK_DIV2:
-        return tim_overflow_freq / 2;
-    case ADC_CLOCK_SYNC_PCLK_DIV4:
-        return tim_overflow_freq / 4;
-    case ADC_CLOCK_SYNC_PCLK_DIV6:
-        return tim_overflow_freq / 6;
-    case ADC_CLOCK_SYNC_PCLK_DIV8:
-        return tim_overflow_freq / 8;
-    default:
-        return tim_overflow_freq / 2;
-    }
+    return tim_get_overflow_freq(htim);
 }
 
 void multi_chan_adc_set_sample_rate(ADC_HandleTypeDef *hadc, TIM_HandleTypeDef *htim, uint32_t sample_rate_hz)
 {
-    switch (hadc->Init.ClockPrescaler)
-    {
-    case ADC_CLOCK_SYNC_PCLK_DIV2:
-        
-        tim_set_overflow_freq(htim, sample_rate_hz * 2);
-        break;
-    case ADC_CLOCK_SYNC_PCLK_DIV4:
-        tim_set_overflow_freq(htim, sample_rate_hz * 4);
-        break;
-    case ADC_CLOCK_SYNC_PCLK_DIV6:
-        tim_set_overflow_freq(htim, sample_rate_hz * 6);
-        break;
-    case ADC_CLOCK_SYNC_PCLK_DIV8:
-        tim_set_overflow_freq(htim, sample_rate_hz * 8);
-        break;
-    default:
-        tim_set_overflow_freq(htim, sample_rate_hz * 2);
-        break;
-    }
+    tim_set_overflow_freq(htim, sample_rate_hz);
 }
 
 /**
@@ -93,29 +87,19 @@ void MX_ADC1_Init(void)
     __HAL_RCC_ADC1_CLK_ENABLE();
 
     __HAL_RCC_GPIOA_CLK_ENABLE();
-    __HAL_RCC_GPIOC_CLK_ENABLE();
     __HAL_RCC_GPIOB_CLK_ENABLE();
     /**ADC1 GPIO Configuration
   PA2     ------> ADC1_IN2
   PA4     ------> ADC1_IN4
   PA5     ------> ADC1_IN5
-  PA6     ------> ADC1_IN6
-  PA7     ------> ADC1_IN7
-  PC4     ------> ADC1_IN14
-  PC5     ------> ADC1_IN15
   PB0     ------> ADC1_IN8
   PB1     ------> ADC1_IN9
   */
-    GPIO_InitStruct.Pin = GPIO_PIN_2 | GPIO_PIN_4 | GPIO_PIN_5 | GPIO_PIN_6 | GPIO_PIN_7;
+    GPIO_InitStruct.Pin = GPIO_PIN_2 | GPIO_PIN_4 | GPIO_PIN_5;
     GPIO_InitStruct.Mode = GPIO_MODE_ANALOG;
     GPIO_InitStruct.Pull = GPIO_NOPULL;
     HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
 
-    GPIO_InitStruct.Pin = GPIO_PIN_4 | GPIO_PIN_5;
-    GPIO_InitStruct.Mode = GPIO_MODE_ANALOG;
-    GPIO_InitStruct.Pull = GPIO_NOPULL;
-    HAL_GPIO_Init(GPIOC, &GPIO_InitStruct);
-
     GPIO_InitStruct.Pin = GPIO_PIN_0 | GPIO_PIN_1;
     GPIO_InitStruct.Mode = GPIO_MODE_ANALOG;
     GPIO_InitStruct.Pull = GPIO_NOPULL;
@@ -156,65 +140,120 @@ void MX_ADC1_Init(void)
     hadc1.Init.ExternalTrigConvEdge = ADC_EXTERNALTRIGCONVEDGE_RISING;
     hadc1.Init.ExternalTrigConv = ADC_EXTERNALTRIGCONV_T3_TRGO;
     hadc1.Init.DataAlign = ADC_DATAALIGN_RIGHT;
-    hadc1.Init.NbrOfConversion = 9;
+    hadc1.Init.NbrOfConversion = ADC_DMA_BUFF_SIZE;
     hadc1.Init.DMAContinuousRequests = ENABLE;
     hadc1.Init.EOCSelection = ADC_EOC_SEQ_CONV;
     HAL_ADC_Init(&hadc1);
 
     /** Configure for the selected ADC regular channel its corresponding rank in the sequencer and its sample time.
 */
-    sConfig.Channel = ADC_CHANNEL_6;
+    sConfig.Channel = ADC_CHANNEL_4;
     sConfig.Rank = 1;
     sConfig.SamplingTime = ADC_SAMPLETIME_15CYCLES;
     HAL_ADC_ConfigChannel(&hadc1, &sConfig);
 
     /** Configure for the selected ADC regular channel its corresponding rank in the sequencer and its sample time.
 */
-    sConfig.Channel = ADC_CHANNEL_7;
+    sConfig.Channel = ADC_CHANNEL_5;
     sConfig.Rank = 2;
     HAL_ADC_ConfigChannel(&hadc1, &sConfig);
 
     /** Configure for the selected ADC regular channel its corresponding rank in the sequencer and its sample time.
 */
-    sConfig.Channel = ADC_CHANNEL_15;
+    sConfig.Channel = ADC_CHANNEL_8;
     sConfig.Rank = 3;
     HAL_ADC_ConfigChannel(&hadc1, &sConfig);
 
     /** Configure for the selected ADC regular channel its corresponding rank in the sequencer and its sample time.
 */
-    sConfig.Channel = ADC_CHANNEL_14;
+    sConfig.Channel = ADC_CHANNEL_9;
     sConfig.Rank = 4;
     HAL_ADC_ConfigChannel(&hadc1, &sConfig);
 
     /** Configure for the selected ADC regular channel its corresponding rank in the sequencer and its sample time.
 */
-    sConfig.Channel = ADC_CHANNEL_4;
+    sConfig.Channel = ADC_CHANNEL_2;
     sConfig.Rank = 5;
     HAL_ADC_ConfigChannel(&hadc1, &sConfig);
+}
 
-    /** Configure for the selected ADC regular channel its corresponding rank in the sequencer and its sample time.
-*/
-    sConfig.Channel = ADC_CHANNEL_5;
-    sConfig.Rank = 6;
-    HAL_ADC_ConfigChannel(&hadc1, &sConfig);
+/**
+  * @brief ADC2 Initialization Function, scans the CV inputs
+  * NOTE: PA6, PA7, PC4 and PC5 are only wired to ADC1 and ADC2, and the bender pins the same, so there is no ADC3 here
+  * @param None
+  * @retval None
+  */
+void MX_ADC2_Init(void)
+{
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+    __HAL_RCC_ADC2_CLK_ENABLE();
 
-    /** Configure for the selected ADC regular channel its corresponding rank in the sequencer and its sample time.
-*/
-    sConfig.Channel = ADC_CHANNEL_8;
-    sConfig.Rank = 7;
-    HAL_ADC_ConfigChannel(&hadc1, &sConfig);
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    __HAL_RCC_GPIOC_CLK_ENABLE();
+    /**ADC2 GPIO Configuration
+  PA6     ------> ADC2_IN6
+  PA7     ------> ADC2_IN7
+  PC4     ------> ADC2_IN14
+  PC5     ------> ADC2_IN15
+  */
+    GPIO_InitStruct.Pin = GPIO_PIN_6 | GPIO_PIN_7;
+    GPIO_InitStruct.Mode = GPIO_MODE_ANALOG;
+    GPIO_InitStruct.Pull = GPIO_NOPULL;
+    HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
 
-    /** Configure for the selected ADC regular channel its corresponding rank in the sequencer and its sample time.
-*/
-    sConfig.Channel = ADC_CHANNEL_9;
-    sConfig.Rank = 8;
-    HAL_ADC_ConfigChannel(&hadc1, &sConfig);
+    GPIO_InitStruct.Pin = GPIO_PIN_4 | GPIO_PIN_5;
+    GPIO_InitStruct.Mode = GPIO_MODE_ANALOG;
+    GPIO_InitStruct.Pull = GPIO_NOPULL;
+    HAL_GPIO_Init(GPIOC, &GPIO_InitStruct);
 
-    /** Configure for the selected ADC regular channel its corresponding rank in the sequencer and its sample time.
-*/
-    sConfig.Channel = ADC_CHANNEL_2;
-    sConfig.Rank = 9;
-    HAL_ADC_ConfigChannel(&hadc1, &sConfig);
+    /* ADC2 DMA Init */
+    hdma_adc2.Instance = DMA2_Stream3;
+    hdma_adc2.Init.Channel = DMA_CHANNEL_1;
+    hdma_adc2.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    hdma_adc2.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_adc2.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_adc2.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    hdma_adc2.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+    hdma_adc2.Init.Mode = DMA_CIRCULAR;
+    hdma_adc2.Init.Priority = DMA_PRIORITY_MEDIUM; // 8x the transfers of ADC1, an overrun would stop the scan
+    hdma_adc2.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    HAL_DMA_Init(&hdma_adc2);
+
+    __HAL_LINKDMA(&hadc2, DMA_Handle, hdma_adc2);
+
+    ADC_ChannelConfTypeDef sConfig = {0};
+
+    hadc2.Instance = ADC2;
+    hadc2.Init.ClockPrescaler = ADC_CLOCK_SYNC_PCLK_DIV2;
+    hadc2.Init.Resolution = ADC_RESOLUTION_12B;
+    hadc2.Init.ScanConvMode = ENABLE;
+    hadc2.Init.ContinuousConvMode = DISABLE;
+    hadc2.Init.DiscontinuousConvMode = DISABLE;
+    hadc2.Init.ExternalTrigConvEdge = ADC_EXTERNALTRIGCONVEDGE_RISING;
+    hadc2.Init.ExternalTrigConv = ADC_EXTERNALTRIGCONV_T8_TRGO;
+    hadc2.Init.DataAlign = ADC_DATAALIGN_RIGHT;
+    hadc2.Init.NbrOfConversion = ADC_CV_CHANNELS;
+    hadc2.Init.DMAContinuousRequests = ENABLE;
+    hadc2.Init.EOCSelection = ADC_EOC_SEQ_CONV;
+    HAL_ADC_Init(&hadc2);
+
+    // same order as AnalogHandle::ADC_PINS
+    sConfig.Channel = ADC_CHANNEL_6;
+    sConfig.Rank = 1;
+    sConfig.SamplingTime = ADC_SAMPLETIME_15CYCLES;
+    HAL_ADC_ConfigChannel(&hadc2, &sConfig);
+
+    sConfig.Channel = ADC_CHANNEL_7;
+    sConfig.Rank = 2;
+    HAL_ADC_ConfigChannel(&hadc2, &sConfig);
+
+    sConfig.Channel = ADC_CHANNEL_15;
+    sConfig.Rank = 3;
+    HAL_ADC_ConfigChannel(&hadc2, &sConfig);
+
+    sConfig.Channel = ADC_CHANNEL_14;
+    sConfig.Rank = 4;
+    HAL_ADC_ConfigChannel(&hadc2, &sConfig);
 }
 
 /**
@@ -245,6 +284,35 @@ void MX_TIM3_Init(void)
     HAL_TIMEx_MasterConfigSynchronization(&htim3, &sMasterConfig);
 }
 
+/**
+  * @brief TIM8 Initialization Function, triggers ADC2
+  * @param None
+  * @retval None
+  */
+void MX_TIM8_Init(void)
+{
+    __HAL_RCC_TIM8_CLK_ENABLE();
+
+    TIM_ClockConfigTypeDef sClockSourceConfig = {0};
+    TIM_MasterConfigTypeDef sMasterConfig = {0};
+
+    htim8.Instance = TIM8;
+    htim8.Init.Prescaler = ADC_TIM_PRESCALER;
+    htim8.Init.CounterMode = TIM_COUNTERMODE_UP;
+    htim8.Init.Period = ADC_TIM_PERIOD;
+    htim8.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+    htim8.Init.RepetitionCounter = 0;
+    htim8.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+    HAL_TIM_Base_Init(&htim8);
+
+    sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
+    HAL_TIM_ConfigClockSource(&htim8, &sClockSourceConfig);
+
+    sMasterConfig.MasterOutputTrigger = TIM_TRGO_UPDATE;
+    sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+    HAL_TIMEx_MasterConfigSynchronization(&htim8, &sMasterConfig);
+}
+
 /**
   * Enable DMA controller clock
   */
@@ -258,6 +326,9 @@ void MX_DMA_Init(void)
     /* DMA2_Stream0_IRQn interrupt configuration */
     HAL_NVIC_SetPriority(DMA2_Stream0_IRQn, RTOS_ISR_DEFAULT_PRIORITY, 0);
     HAL_NVIC_EnableIRQ(DMA2_Stream0_IRQn);
+    /* DMA2_Stream3_IRQn interrupt configuration */
+    HAL_NVIC_SetPriority(DMA2_Stream3_IRQn, RTOS_ISR_DEFAULT_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(DMA2_Stream3_IRQn);
 }
 
 /**
@@ -270,6 +341,22 @@ extern "C" void DMA2_Stream0_IRQHandler(void)
     HAL_DMA_IRQHandler(&hdma_adc1);
 }
 
+extern "C" void DMA2_Stream3_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&hdma_adc2);
+}
+
+/**
+  * @brief  Half of the DMA buffer has been filled, only ADC2 (CV) uses a double buffer
+  */
+extern "C" void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc)
+{
+    if (hadc->Instance == ADC2)
+    {
+        AnalogHandle::RouteConversionCompleteCallback(ADC_BLOCK_CV_FIRST);
+    }
+}
+
 /**
   * @brief  Regular conversion complete callback in non blocking mode 
   * @param  hadc pointer to a ADC_HandleTypeDef structure that contains
@@ -280,6 +367,10 @@ extern "C" void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
 {
     if (hadc->Instance == ADC1)
     {
-        AnalogHandle::RouteConversionCompleteCallback();
+        AnalogHandle::RouteConversionCompleteCallback(ADC_BLOCK_CONTROL);
+    }
+    else if (hadc->Instance == ADC2)
+    {
+        AnalogHandle::RouteConversionCompleteCallback(ADC_BLOCK_CV_SECOND);
     }
 }
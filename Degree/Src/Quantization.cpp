@@ -43,6 +43,18 @@ int getQuantizedPosition(int pos, int length, QUANT target)
     }
 };
 
+/**
+ * @brief snap a position to the nearest line of a quantize grid. Unlike getQuantizedPosition() the result does not wrap,
+ * so a position rounded up past the end of a sequence returns the sequence length
+ */
+int quantize_position(int pos, QUANT target)
+{
+    int grid = quant_value_to_int(target);
+    if (grid == 0)
+        return pos;
+    return ((pos + (grid / 2)) / grid) * grid;
+}
+
 int quant_value_to_index(QUANT value)
 {
     switch (value)
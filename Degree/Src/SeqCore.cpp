@@ -0,0 +1,97 @@
+#include "SeqCore.h"
+#include "SuperSeq.h"
+
+static_assert(CHANNEL_COUNT <= SEQ_CORE_MAX_CHANNELS, "every channel's sequence needs a slot in the core");
+
+SeqCore seq_core; // zero initialized before any SuperSeq gets constructed
+
+/**
+ * @brief give a sequence a slot in the core. Called from the SuperSeq constructor, running out of slots halts
+ *
+ * @return int the sequences index into the SeqCore arrays
+ */
+int seq_core_register(SuperSeq *sequence)
+{
+    configASSERT(seq_core.count < SEQ_CORE_MAX_CHANNELS);
+    int index = seq_core.count;
+    seq_core.sequences[index] = sequence;
+    seq_core.nextEvent[index] = -1;
+    seq_core.resync[index] = 1;
+    seq_core.count++;
+    return index;
+}
+
+/**
+ * @brief set or clear one of the reasons a channel needs waking on every pulse. Safe to call from any task
+ *
+ * @param reason SEQ_WAKE_*
+ */
+void seq_core_set_wake(int index, uint8_t reason, bool enable)
+{
+    if (((seq_core.wake[index] & reason) != 0) == enable)
+        return; // gets called at the bender poll rate, only pay for the critical section on a change
+    taskENTER_CRITICAL();
+    if (enable)
+        seq_core.wake[index] |= reason;
+    else
+        seq_core.wake[index] &= ~reason;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief advance a sequence by 1 PPQN
+ *
+ * @return true if the channel has something to do on this pulse (new step, an event, or it asked to be woken)
+ */
+bool seq_core_advance_channel(int i)
+{
+    int position = seq_core.position[i] + 1;
+    bool newStep = position % PPQN == 0;
+
+    seq_core.prevPosition[i] = seq_core.position[i];
+    seq_core.stepPosition[i] += 1;
+    if (newStep)
+    {
+        seq_core.prevStep[i] = seq_core.step[i];
+        seq_core.step[i] += 1;
+        seq_core.stepPosition[i] = 0;
+    }
+
+    if (position >= seq_core.lengthPPQN[i])
+    {
+        if (seq_core.adaptive[i]) // recording into an empty sequence, keep counting upwards until the max length is reached
+        {
+            if (seq_core.step[i] >= MAX_SEQ_LENGTH)
+            {
+                seq_core.adaptive[i] = false;
+                seq_core.sequences[i]->setLength(MAX_SEQ_LENGTH);
+                position = 0;
+                seq_core.step[i] = 0;
+            }
+        }
+        else // reset loop
+        {
+            position = 0;
+            seq_core.step[i] = 0;
+            newStep = true;
+        }
+    }
+    seq_core.position[i] = position;
+
+    return newStep || position == seq_core.nextEvent[i] || seq_core.wake[i] || seq_core.resync[i];
+}
+
+/**
+ * @brief advance every sequence by 1 PPQN
+ *
+ * @return uint32_t bit n set if sequence n needs its channel's handleClock() called on this pulse
+ */
+uint32_t seq_core_advance()
+{
+    uint32_t wake = 0;
+    for (int i = 0; i < seq_core.count; i++)
+    {
+        wake |= (uint32_t)seq_core_advance_channel(i) << i;
+    }
+    return wake;
+}
@@ -0,0 +1,343 @@
+#include "SeqHistory.h"
+#include "SuperSeq.h"
+#include <string.h>
+
+static_assert(SEQ_HISTORY_POOL_PAGES <= 64, "page pool usage is tracked with a 64-bit mask");
+static_assert(SEQ_HISTORY_POOL_PAGES < SEQ_HISTORY_NO_PAGE, "page indexes are stored as uint8_t");
+static_assert(SEQ_HISTORY_POOL_PAGES >= 2 * SEQ_HISTORY_PAGE_COUNT, "clearing a full sequence has to be undoable");
+
+static SeqHistoryPage seq_history_pool[SEQ_HISTORY_POOL_PAGES];
+static uint64_t seq_history_used = 0; // bit n set when seq_history_pool[n] holds a saved page
+static SeqHistory *seq_history_list[SEQ_CORE_MAX_CHANNELS]; // every channel's history, they all share the pool
+static int seq_history_count = 0;
+static uint32_t seq_history_stamp = 0; // incremented by every checkpoint
+static uint32_t seq_history_group_stamp = 0; // shared by every checkpoint of the open group
+static bool seq_history_grouped = false;
+
+static uint8_t seq_history_alloc()
+{
+    uint64_t available = ~seq_history_used & ((SEQ_HISTORY_POOL_PAGES == 64) ? ~0ULL : ((1ULL << SEQ_HISTORY_POOL_PAGES) - 1));
+    if (available == 0)
+        return SEQ_HISTORY_NO_PAGE;
+    uint8_t page = (uint8_t)__builtin_ctzll(available);
+    seq_history_used |= (1ULL << page);
+    return page;
+}
+
+static void seq_history_free(uint8_t page)
+{
+    seq_history_used &= ~(1ULL << page);
+}
+
+/**
+ * @brief called from the constructor, so evictOldest() can find the levels of every channel
+ */
+void SeqHistory::registerHistory(SeqHistory *history) // static
+{
+    if (seq_history_count < SEQ_CORE_MAX_CHANNELS)
+        seq_history_list[seq_history_count++] = history;
+}
+
+/**
+ * @brief how many pages of the pool shared by every channel currently hold a saved page
+ */
+int SeqHistory::getPoolPagesUsed() // static
+{
+    return __builtin_popcountll(seq_history_used);
+}
+
+/**
+ * @brief how many pages clearing a plane of the sequence would save, ie. the pages holding anything in that plane
+ */
+int SeqHistory::countPages(SEQ_PLANE plane)
+{
+    int count = 0;
+    for (int page = 0; page < SEQ_HISTORY_PAGE_COUNT; page++)
+    {
+        SequenceNode *events = &seq->events[page * SEQ_HISTORY_PAGE_EVENTS];
+        for (int i = 0; i < SEQ_HISTORY_PAGE_EVENTS; i++)
+        {
+            if (plane == SEQ_PLANE::TOUCH ? events[i].data != 0x00 : events[i].bend != BENDER_DAC_ZERO)
+            {
+                count++;
+                break;
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief make every checkpoint until endGroup() part of the same change
+ */
+void SeqHistory::beginGroup() // static
+{
+    seq_history_group_stamp = seq_history_stamp++;
+    seq_history_grouped = true;
+}
+
+void SeqHistory::endGroup() // static
+{
+    seq_history_grouped = false;
+}
+
+/**
+ * @brief free up pool pages ahead of a group change, dropping levels older than the group
+ *
+ * @return false if the pool can't hold that many pages, the change can't be undone
+ */
+bool SeqHistory::reserve(int pages) // static
+{
+    if (pages > SEQ_HISTORY_POOL_PAGES)
+        return false;
+    while (SEQ_HISTORY_POOL_PAGES - getPoolPagesUsed() < pages)
+    {
+        if (!evictOldest(nullptr, seq_history_group_stamp))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief start a new undo level. Costs nothing until the sequence gets modified, and discards anything that could be redone
+ */
+void SeqHistory::checkpoint()
+{
+    clearRedo();
+    Level *level;
+    if (undoCount && !getLevel(undoCount - 1)->modified)
+    {
+        // nothing happened since the last checkpoint, reuse it rather than filling the history with empty levels
+        level = getLevel(undoCount - 1);
+    }
+    else
+    {
+        if (undoCount == SEQ_HISTORY_LEVELS)
+            dropOldest();
+        level = getLevel(undoCount);
+        memset(level->pages, SEQ_HISTORY_NO_PAGE, sizeof(level->pages));
+        undoCount++;
+    }
+    level->modified = false;
+    level->stamp = seq_history_grouped ? seq_history_group_stamp : seq_history_stamp++;
+    level->length = seq->length;
+    level->containsTouchEvents = seq->containsTouchEvents;
+    level->containsBendEvents = seq->containsBendEvents;
+}
+
+/**
+ * @brief SuperSeq calls this right before modifying an event. Copies the page holding the event if it hasn't been saved
+ * since the last checkpoint
+ *
+ * @param plane which half of the event is about to change
+ * @param position event position
+ */
+void SeqHistory::save(SEQ_PLANE plane, int position)
+{
+    if (redoCount)
+        clearRedo(); // the sequence no longer matches what the redo levels were saved against
+    if (undoCount == 0)
+        return;
+
+    int page = position / SEQ_HISTORY_PAGE_EVENTS;
+    Level *level = getLevel(undoCount - 1);
+    level->modified = true;
+    if (level->pages[(int)plane][page] != SEQ_HISTORY_NO_PAGE)
+        return;
+
+    uint8_t saved = seq_history_alloc();
+    while (saved == SEQ_HISTORY_NO_PAGE && evictOldest(this, level->stamp))
+        saved = seq_history_alloc();
+    level = getLevel(undoCount - 1); // the ring moved if this channel's older levels were dropped
+    if (saved == SEQ_HISTORY_NO_PAGE) // not enough room to undo this change at all
+    {
+        dropOldest();
+        return;
+    }
+
+    level->pages[(int)plane][page] = saved;
+    uint16_t *dest = seq_history_pool[saved].data;
+    SequenceNode *src = &seq->events[page * SEQ_HISTORY_PAGE_EVENTS];
+    for (int i = 0; i < SEQ_HISTORY_PAGE_EVENTS; i++)
+    {
+        dest[i] = plane == SEQ_PLANE::TOUCH ? (uint16_t)((src[i].activeDegrees << 8) | src[i].data) : src[i].bend;
+    }
+}
+
+/**
+ * @brief restore the sequence to how it was at the last checkpoint
+ *
+ * @return true if there was anything to undo
+ */
+bool SeqHistory::undo()
+{
+    if (undoCount == 0)
+        return false;
+    undoCount--;
+    redoCount++;
+    swap(getLevel(undoCount));
+    return true;
+}
+
+/**
+ * @brief reapply the last undone level
+ *
+ * @return true if there was anything to redo
+ */
+bool SeqHistory::redo()
+{
+    if (redoCount == 0)
+        return false;
+    swap(getLevel(undoCount));
+    undoCount++;
+    redoCount--;
+    return true;
+}
+
+/**
+ * @brief discard every undo and redo level
+ */
+void SeqHistory::clear()
+{
+    clearRedo();
+    while (undoCount)
+        dropOldest();
+}
+
+/**
+ * @brief exchange the saved pages and sequence settings of a level with the sequence. Doing it twice is a no-op, which is
+ * what lets the same level serve as both the undo and redo copy
+ */
+void SeqHistory::swap(Level *level)
+{
+    seq->unshare(); // another channel or a song may be playing the same pattern
+    for (int page = 0; page < SEQ_HISTORY_PAGE_COUNT; page++)
+    {
+        SequenceNode *events = &seq->events[page * SEQ_HISTORY_PAGE_EVENTS];
+        if (level->pages[(int)SEQ_PLANE::TOUCH][page] != SEQ_HISTORY_NO_PAGE)
+        {
+            uint16_t *saved = seq_history_pool[level->pages[(int)SEQ_PLANE::TOUCH][page]].data;
+            for (int i = 0; i < SEQ_HISTORY_PAGE_EVENTS; i++)
+            {
+                uint16_t touch = (uint16_t)((events[i].activeDegrees << 8) | events[i].data);
+                events[i].activeDegrees = (uint8_t)(saved[i] >> 8);
+                events[i].data = (uint8_t)(saved[i] & 0xFF);
+                saved[i] = touch;
+            }
+        }
+        if (level->pages[(int)SEQ_PLANE::BEND][page] != SEQ_HISTORY_NO_PAGE)
+        {
+            uint16_t *saved = seq_history_pool[level->pages[(int)SEQ_PLANE::BEND][page]].data;
+            for (int i = 0; i < SEQ_HISTORY_PAGE_EVENTS; i++)
+            {
+                uint16_t bend = events[i].bend;
+                events[i].bend = saved[i];
+                saved[i] = bend;
+            }
+        }
+    }
+
+    int length = seq->length;
+    bool containsTouchEvents = seq->containsTouchEvents;
+    bool containsBendEvents = seq->containsBendEvents;
+    seq->setLength(level->length);
+    seq->containsTouchEvents = level->containsTouchEvents;
+    seq->containsBendEvents = level->containsBendEvents;
+    level->length = length;
+    level->containsTouchEvents = containsTouchEvents;
+    level->containsBendEvents = containsBendEvents;
+    seq->eventsChanged();
+}
+
+void SeqHistory::release(Level *level)
+{
+    for (int plane = 0; plane < 2; plane++)
+    {
+        for (int page = 0; page < SEQ_HISTORY_PAGE_COUNT; page++)
+        {
+            if (level->pages[plane][page] != SEQ_HISTORY_NO_PAGE)
+            {
+                seq_history_free(level->pages[plane][page]);
+                level->pages[plane][page] = SEQ_HISTORY_NO_PAGE;
+            }
+        }
+    }
+}
+
+void SeqHistory::dropOldest()
+{
+    if (undoCount == 0)
+        return;
+    release(getLevel(0));
+    base = (base + 1) % SEQ_HISTORY_LEVELS;
+    undoCount--;
+}
+
+/**
+ * @brief the level evict() would drop: the oldest undo level, or the furthest redo level when there are no undo levels
+ *
+ * @param current false to keep the level changes are being saved into
+ * @return nullptr when there is nothing which can be dropped
+ */
+SeqHistory::Level *SeqHistory::getEvictable(bool current)
+{
+    if (undoCount > (current ? 0 : 1))
+        return getLevel(0);
+    if (undoCount == 0 && redoCount)
+        return getLevel(redoCount - 1);
+    return nullptr;
+}
+
+void SeqHistory::evict()
+{
+    if (undoCount)
+    {
+        dropOldest();
+    }
+    else if (redoCount)
+    {
+        redoCount--;
+        release(getLevel(redoCount));
+    }
+}
+
+/**
+ * @brief free up pool pages by dropping the oldest level of any channel, along with the levels of other channels made by
+ * the same group checkpoint. Never the level `saving` is saving into, nor any level of the checkpoint `keep`
+ *
+ * @return false if there was nothing left to drop
+ */
+bool SeqHistory::evictOldest(SeqHistory *saving, uint32_t keep) // static
+{
+    bool found = false;
+    uint32_t oldest = 0;
+    for (int i = 0; i < seq_history_count; i++)
+    {
+        SeqHistory *history = seq_history_list[i];
+        Level *level = history->getEvictable(history != saving);
+        if (level && level->stamp != keep && (!found || (int32_t)(level->stamp - oldest) < 0))
+        {
+            found = true;
+            oldest = level->stamp;
+        }
+    }
+    if (!found)
+        return false;
+    for (int i = 0; i < seq_history_count; i++)
+    {
+        SeqHistory *history = seq_history_list[i];
+        Level *level = history->getEvictable(history != saving);
+        if (level && level->stamp == oldest)
+            history->evict();
+    }
+    return true;
+}
+
+void SeqHistory::clearRedo()
+{
+    while (redoCount)
+    {
+        redoCount--;
+        release(getLevel(undoCount + redoCount));
+    }
+}
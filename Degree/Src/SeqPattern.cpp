@@ -0,0 +1,143 @@
+#include "SeqPattern.h"
+#include "SuperSeq.h"
+
+static_assert(SEQ_PATTERN_POOL_SIZE <= 32, "pattern pool usage is tracked with a 32-bit mask");
+
+typedef struct SeqPatternBuffer
+{
+    SequenceNode events[MAX_SEQ_LENGTH_PPQN];
+} SeqPatternBuffer;
+
+// zero initialized before any SuperSeq gets constructed and allocates its first pattern
+static SeqPatternBuffer seq_pattern_pool[SEQ_PATTERN_POOL_SIZE];
+static uint8_t seq_pattern_refs[SEQ_PATTERN_POOL_SIZE]; // channels + song entries holding each pattern
+static uint8_t seq_pattern_pins[SEQ_PATTERN_POOL_SIZE]; // song entries holding each pattern
+static uint32_t seq_pattern_used_mask = 0;
+
+/**
+ * @brief take a free pattern buffer, holding one reference. Its contents are whatever the last holder left in it
+ *
+ * @return pattern index, SEQ_PATTERN_NONE if every buffer is in use
+ */
+uint8_t seq_pattern_alloc()
+{
+    uint32_t available = ~seq_pattern_used_mask & ((1UL << SEQ_PATTERN_POOL_SIZE) - 1);
+    if (available == 0)
+        return SEQ_PATTERN_NONE;
+    uint8_t pattern = (uint8_t)__builtin_ctz(available);
+    seq_pattern_used_mask |= (1UL << pattern);
+    seq_pattern_refs[pattern] = 1;
+    seq_pattern_pins[pattern] = 0;
+    return pattern;
+}
+
+void seq_pattern_retain(uint8_t pattern)
+{
+    seq_pattern_refs[pattern]++;
+}
+
+/**
+ * @brief drop a reference, the buffer goes back to the pool with the last one
+ */
+void seq_pattern_release(uint8_t pattern)
+{
+    if (pattern == SEQ_PATTERN_NONE || seq_pattern_refs[pattern] == 0)
+        return;
+    seq_pattern_refs[pattern]--;
+    if (seq_pattern_refs[pattern] == 0)
+        seq_pattern_used_mask &= ~(1UL << pattern);
+}
+
+/**
+ * @brief take a song reference to a pattern. Refused when songs already pin SEQ_PATTERN_SONG_SLOTS other patterns,
+ * otherwise a later copy-on-write could find the pool empty
+ */
+bool seq_pattern_pin(uint8_t pattern)
+{
+    if (seq_pattern_pins[pattern] == 0)
+    {
+        int pinned = 0;
+        for (int i = 0; i < SEQ_PATTERN_POOL_SIZE; i++)
+        {
+            if (seq_pattern_pins[i])
+                pinned++;
+        }
+        if (pinned >= SEQ_PATTERN_SONG_SLOTS)
+            return false;
+    }
+    seq_pattern_pins[pattern]++;
+    seq_pattern_retain(pattern);
+    return true;
+}
+
+void seq_pattern_unpin(uint8_t pattern)
+{
+    if (seq_pattern_pins[pattern] == 0)
+        return;
+    seq_pattern_pins[pattern]--;
+    seq_pattern_release(pattern);
+}
+
+/**
+ * @brief true when something other than the caller holds the pattern, and it must be copied before being modified
+ */
+bool seq_pattern_shared(uint8_t pattern)
+{
+    return seq_pattern_refs[pattern] > 1;
+}
+
+SequenceNode *seq_pattern_events(uint8_t pattern)
+{
+    return seq_pattern_pool[pattern].events;
+}
+
+/**
+ * @brief how many buffers of the pool hold a pattern
+ */
+int seq_pattern_used()
+{
+    return __builtin_popcount(seq_pattern_used_mask);
+}
+
+/**
+ * @brief chain a pattern onto the end of the song. If no more distinct patterns can be pinned the entry gets added
+ * live, without a buffer of its own (see SeqSongEntry)
+ *
+ * @return false if the song is full
+ */
+bool SeqSong::append(uint8_t pattern, int length, bool containsTouchEvents, bool containsBendEvents)
+{
+    if (count == SEQ_SONG_MAX_LENGTH)
+        return false;
+    SeqSongEntry *entry = &entries[count];
+    entry->pattern = seq_pattern_pin(pattern) ? pattern : SEQ_PATTERN_NONE;
+    entry->length = (uint8_t)length;
+    entry->containsTouchEvents = containsTouchEvents;
+    entry->containsBendEvents = containsBendEvents;
+    if (count == 0)
+        position = 0; // the sequence is playing the first entry right now
+    count++;
+    return true;
+}
+
+void SeqSong::clear()
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (entries[i].pattern != SEQ_PATTERN_NONE)
+            seq_pattern_unpin(entries[i].pattern);
+    }
+    count = 0;
+    position = 0;
+}
+
+/**
+ * @brief move on to the next entry, wrapping back to the start of the song
+ */
+SeqSongEntry *SeqSong::next()
+{
+    if (count == 0)
+        return nullptr;
+    position = (position + 1) % count;
+    return &entries[position];
+}
@@ -0,0 +1,256 @@
+#include "SessionSnapshot.h"
+#include "TouchChannel.h"
+
+static_assert(FLASH_CONFIG_ADDR + CHANNEL_COUNT * FLASH_CHANNEL_BLOCK_SIZE <= FLASH_SNAPSHOT_ADDR, "channel config overlaps the snapshot area");
+static_assert(SNAPSHOT_MAX_WORDS * 4 <= FLASH_SNAPSHOT_SIZE, "snapshot doesn't fit the snapshot area");
+static_assert(CHANNEL_CONFIG_WORDS <= SNAPSHOT_CONFIG_SIZE && SEQ_CONFIG_WORDS <= SNAPSHOT_CONFIG_SIZE, "config doesn't fit the snapshot");
+
+extern FLASH_ProcessTypeDef pFlash; // HAL flash driver state, held while one of its operations runs
+
+static TouchChannel **snapshot_channels = nullptr;
+static volatile bool snapshot_taken = false;
+
+static inline uint32_t snapshot_word(int index)
+{
+    return *(__IO uint32_t *)(FLASH_SNAPSHOT_ADDR + index * 4);
+}
+
+/**
+ * @brief programs the payload one word at a time, straight into flash. Only ever used with the flash unlocked and
+ * interrupts disabled
+ */
+struct SnapshotWriter
+{
+    uint32_t address;
+    uint32_t words;
+    uint32_t checksum;
+    bool failed; // a word didn't program, nothing else gets written
+
+    void operator()(uint32_t word)
+    {
+        if (!failed && HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, address, (uint64_t)word) != HAL_OK)
+            failed = true;
+        address += 4;
+        words++;
+        checksum += word; // a plain sum, so words can be written out of order (see the event count below)
+    }
+};
+
+/**
+ * @brief check if the live session is the same as the one saved in flash, in which case there is no point taking a
+ * snapshot (and erasing the config sector again on the next boot). Bend events are not compared, they don't make it into
+ * a snapshot anyway
+ */
+static bool session_matches_flash()
+{
+    for (int chan = 0; chan < CHANNEL_COUNT; chan++)
+    {
+        TouchChannel *channel = snapshot_channels[chan];
+        uint32_t address_offset = FLASH_CHANNEL_BLOCK_SIZE * chan;
+        uint32_t config[SNAPSHOT_CONFIG_SIZE] = {0};
+
+        channel->copyConfigData(config);
+        for (int i = 0; i < CHANNEL_CONFIG_WORDS; i++)
+        {
+            if (config[i] != *(__IO uint32_t *)(FLASH_CHANNEL_CONFIG_ADDR + address_offset + i * 4))
+                return false;
+        }
+
+        channel->sequence.storeSequenceConfigData(config);
+        for (int i = 0; i < SEQ_CONFIG_WORDS; i++)
+        {
+            if (config[i] != *(__IO uint32_t *)(FLASH_SEQUENCE_CONFIG_ADDR + address_offset + i * 4))
+                return false;
+        }
+
+        if (channel->sequence.containsTouchEvents)
+        {
+            for (int i = 0; i < channel->sequence.lengthPPQN; i++)
+            {
+                uint32_t saved = *(__IO uint32_t *)(FLASH_SEQUENCE_DATA_ADDR + address_offset + i * 4);
+                if ((channel->sequence.encodeEventData(i) & 0xFFFF) != (saved & 0xFFFF)) // touch data only, no bend
+                    return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief enable the PVD interrupt which takes the snapshot. Call once the session has been loaded and the snapshot area
+ * is erased
+ *
+ * @param channels all CHANNEL_COUNT channels
+ */
+void session_snapshot_init(TouchChannel **channels)
+{
+    snapshot_channels = channels;
+
+    __HAL_RCC_PWR_CLK_ENABLE();
+    PWR_PVDTypeDef config = {0};
+    config.PVDLevel = PWR_PVDLEVEL_7; // highest threshold (~2.9V), buys the most time before VDD leaves the 2.7V - 3.6V range word programming needs
+    config.Mode = PWR_PVD_MODE_IT_RISING; // PVD output rises when VDD falls below the threshold
+    HAL_PWR_ConfigPVD(&config);
+    HAL_PWR_EnablePVD();
+
+    HAL_NVIC_SetPriority(PVD_IRQn, SNAPSHOT_PVD_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(PVD_IRQn);
+}
+
+/**
+ * @brief write the live session into the snapshot area. Called from the PVD interrupt with every other interrupt
+ * disabled, so it can't use the Flash class (mutex, task suspension, logging).
+ *
+ * Worst case is SNAPSHOT_MAX_WORDS words (~1100). Word programming typically takes 16us, so a full snapshot needs around
+ * 18ms, a handful of short sequences more like 2 - 5ms. Whatever doesn't make it before the supply is gone is lost
+ * without harm, the commit word is never written and the next boot loads the last regular save. The same goes for a word
+ * which fails to program.
+ *
+ * Nothing gets written while a regular save (see Flash.cpp) has the flash unlocked or busy, it may be erasing the very
+ * sector the snapshot area is in. The regular save is left to finish (or not) on its own, and the lock left to it.
+ *
+ * @return true if a snapshot was written
+ */
+bool session_snapshot_write()
+{
+    if (snapshot_taken || snapshot_channels == nullptr)
+        return false;
+    if (!(FLASH->CR & FLASH_CR_LOCK) || (FLASH->SR & FLASH_SR_BSY) || pFlash.Lock == HAL_LOCKED)
+        return false; // a regular save is in progress, and owns the flash
+    if (snapshot_word(0) != 0xFFFFFFFF || session_matches_flash())
+        return false; // a dip with nothing to save doesn't use up the snapshot, a later brown out still gets one
+    snapshot_taken = true; // only one try per boot, the area can't be rewritten without an erase
+
+    if (HAL_FLASH_Unlock() != HAL_OK)
+        return false;
+    __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_EOP | FLASH_FLAG_OPERR | FLASH_FLAG_WRPERR | FLASH_FLAG_PGAERR | FLASH_FLAG_PGPERR | FLASH_FLAG_PGSERR);
+
+    if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, FLASH_SNAPSHOT_ADDR, SNAPSHOT_BEGIN) != HAL_OK)
+    {
+        HAL_FLASH_Lock();
+        return false;
+    }
+
+    SnapshotWriter writer;
+    writer.address = FLASH_SNAPSHOT_ADDR + SNAPSHOT_HEADER_SIZE * 4;
+    writer.words = 0;
+    writer.checksum = 0;
+    writer.failed = false;
+    for (int chan = 0; chan < CHANNEL_COUNT; chan++)
+    {
+        TouchChannel *channel = snapshot_channels[chan];
+        uint32_t config[SNAPSHOT_CONFIG_SIZE] = {0};
+
+        channel->copyConfigData(config);
+        for (int i = 0; i < SNAPSHOT_CONFIG_SIZE; i++)
+            writer(config[i]);
+
+        memset(config, 0, sizeof(config));
+        channel->sequence.storeSequenceConfigData(config);
+        for (int i = 0; i < SNAPSHOT_CONFIG_SIZE; i++)
+            writer(config[i]);
+
+        // the event count goes in front of the events, but is only known once they are written
+        uint32_t countAddress = writer.address;
+        writer.address += 4;
+        uint32_t count = channel->sequence.serializeTouchEvents(writer, SNAPSHOT_MAX_EVENTS);
+        if (writer.failed || HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, countAddress, (uint64_t)count) != HAL_OK)
+        {
+            HAL_FLASH_Lock();
+            return false;
+        }
+        writer.words++;
+        writer.checksum += count;
+    }
+
+    if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, FLASH_SNAPSHOT_ADDR + 4, (uint64_t)writer.words) != HAL_OK ||
+        HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, FLASH_SNAPSHOT_ADDR + 8, (uint64_t)writer.checksum) != HAL_OK)
+    {
+        HAL_FLASH_Lock();
+        return false; // no commit word, the snapshot gets ignored on the next boot
+    }
+    bool committed = HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, FLASH_SNAPSHOT_ADDR + 12, SNAPSHOT_COMMIT) == HAL_OK;
+    HAL_FLASH_Lock();
+    return committed;
+}
+
+/**
+ * @brief true if anything (complete or not) was written to the snapshot area since it was last erased
+ */
+bool session_snapshot_pending()
+{
+    return snapshot_word(0) != 0xFFFFFFFF;
+}
+
+/**
+ * @brief load a complete snapshot on top of the session loaded from flash. Doesn't erase the snapshot area, that
+ * happens when the restored session gets saved (see GlobalControl::restoreSessionSnapshot())
+ *
+ * @param channels all CHANNEL_COUNT channels
+ * @return true if the snapshot was complete and got loaded
+ */
+bool session_snapshot_restore(TouchChannel **channels)
+{
+    if (snapshot_word(0) != SNAPSHOT_BEGIN || snapshot_word(3) != SNAPSHOT_COMMIT)
+        return false;
+
+    uint32_t words = snapshot_word(1);
+    if (words > SNAPSHOT_MAX_WORDS - SNAPSHOT_HEADER_SIZE)
+        return false;
+
+    uint32_t checksum = 0;
+    int end = SNAPSHOT_HEADER_SIZE + words;
+    for (int i = SNAPSHOT_HEADER_SIZE; i < end; i++)
+        checksum += snapshot_word(i);
+    if (checksum != snapshot_word(2))
+        return false;
+
+    // make sure every channels event count adds up before touching any of them
+    int index = SNAPSHOT_HEADER_SIZE;
+    for (int chan = 0; chan < CHANNEL_COUNT; chan++)
+    {
+        index += SNAPSHOT_CONFIG_SIZE * 2;
+        if (index >= end || snapshot_word(index) > SNAPSHOT_MAX_EVENTS)
+            return false;
+        index += 1 + snapshot_word(index);
+    }
+    if (index != end)
+        return false;
+
+    index = SNAPSHOT_HEADER_SIZE;
+    for (int chan = 0; chan < CHANNEL_COUNT; chan++)
+    {
+        TouchChannel *channel = channels[chan];
+        uint32_t config[SNAPSHOT_CONFIG_SIZE];
+
+        for (int i = 0; i < SNAPSHOT_CONFIG_SIZE; i++)
+            config[i] = snapshot_word(index++);
+        channel->loadConfigData(config);
+
+        bool containsBendEvents = channel->sequence.containsBendEvents; // bends stay as they were saved
+        for (int i = 0; i < SNAPSHOT_CONFIG_SIZE; i++)
+            config[i] = snapshot_word(index++);
+        channel->sequence.loadSequenceConfigData(config);
+        channel->sequence.containsBendEvents = containsBendEvents;
+
+        channel->sequence.unshare();
+        for (int i = 0; i < MAX_SEQ_LENGTH_PPQN; i++)
+            channel->sequence.events[i].data = 0x00;
+        channel->sequence.containsTouchEvents = false;
+        uint32_t count = snapshot_word(index++);
+        for (uint32_t i = 0; i < count; i++)
+            channel->sequence.deserializeTouchEvent(snapshot_word(index++));
+        channel->sequence.eventsChanged();
+    }
+    return true;
+}
+
+/**
+ * @brief VDD dropped below the PVD threshold, the supply is going away
+ */
+extern "C" void HAL_PWR_PVDCallback(void)
+{
+    __disable_irq();
+    session_snapshot_write();
+    __enable_irq(); // only ever gets here if the supply recovered
+}
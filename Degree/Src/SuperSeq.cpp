@@ -1,4 +1,5 @@
 #include "SuperSeq.h"
+#include <string.h>
 
 void SuperSeq::init()
 {
@@ -45,41 +46,13 @@ int SuperSeq::getLastPosition() {
 */
 void SuperSeq::advance()
 {
-    prevPosition = currPosition;
-    currPosition += 1;
-    currStepPosition += 1;
-
-    if (currPosition % PPQN == 0)
-    {
-        prevStep = currStep;
-        currStep += 1;
-        currStepPosition = 0;
-    }
-
-    if (currPosition > lengthPPQN - 1)
-    {
-        if (recordEnabled && adaptiveLength)
-        {
-            if (currStep >= MAX_SEQ_LENGTH) // disable adaptive length, set seq length to max
-            {
-                adaptiveLength = false;
-                this->setLength(MAX_SEQ_LENGTH);
-                currPosition = 0;
-                currStep = 0;
-            } else {
-                // do nothing, let things keep counting upwards
-            }
-        }
-        else // reset loop
-        {
-            currPosition = 0;
-            currStep = 0;
-        }
-    }
+    seq_core_advance_channel(coreIndex);
 }
 
 void SuperSeq::enableRecording() {
+    history.checkpoint(); // a whole recording pass gets undone in one go
     this->recordEnabled = true;
+    setWake(SEQ_WAKE_RECORD, true);
     // if no currently recorded events, enable adaptive length
     if (!this->containsEvents()) {
         this->reset();
@@ -92,6 +65,8 @@ void SuperSeq::enableRecording() {
 
 void SuperSeq::disableRecording() {
     this->recordEnabled = false;
+    setWake(SEQ_WAKE_RECORD, false);
+    eventsChanged();
     
     // if events were recorded and adaptive length was enabled, update the seq length
     if (adaptiveLength)
@@ -124,11 +99,13 @@ void SuperSeq::disableRecording() {
 void SuperSeq::enablePlayback()
 {
     playbackEnabled = true;
+    eventsChanged();
 }
 
 void SuperSeq::disablePlayback()
 {
     playbackEnabled = false;
+    eventsChanged();
 }
 
 void SuperSeq::enableOverdub()
@@ -150,6 +127,7 @@ void SuperSeq::reset()
     currPosition = 0;
     prevStep = currStep;
     currStep = 0;
+    seq_core.resync[coreIndex] = 1; // the next event is somewhere else now
 };
 
 /**
@@ -186,6 +164,8 @@ void SuperSeq::clearAllEvents()
 
 void SuperSeq::clearAllTouchEvents()
 {
+    if (containsTouchEvents)
+        history.checkpoint();
     for (int i = 0; i < PPQN * MAX_SEQ_LENGTH; i++)
     {
         clearTouchAtPosition(i);
@@ -194,6 +174,8 @@ void SuperSeq::clearAllTouchEvents()
 }
 
 void SuperSeq::clearAllBendEvents() {
+    if (containsBendEvents)
+        history.checkpoint();
     for (int i = 0; i < PPQN * MAX_SEQ_LENGTH; i++)
     {
         clearBendAtPosition(i);
@@ -201,11 +183,108 @@ void SuperSeq::clearAllBendEvents() {
     containsBendEvents = false;
 }
 
+/**
+ * @brief copy-on-write. Gives the sequence a pattern of its own if anything else holds a reference to its current one
+ */
+void SuperSeq::unshare()
+{
+    if (!seq_pattern_shared(pattern))
+        return;
+    uint8_t copy = seq_pattern_alloc();
+    configASSERT(copy != SEQ_PATTERN_NONE); // seq_pattern_pin() keeps a buffer spare for every channel
+    memcpy(seq_pattern_events(copy), events, sizeof(SequenceNode) * MAX_SEQ_LENGTH_PPQN);
+    seq_pattern_release(pattern);
+    pattern = copy;
+    events = seq_pattern_events(copy);
+}
+
+/**
+ * @brief every modification of the events goes through here, right before the event at position gets written
+ *
+ * @param plane which half of the event is about to change
+ * @param position event position
+ */
+void SuperSeq::modify(SEQ_PLANE plane, int position)
+{
+    unshare();
+    history.save(plane, position);
+}
+
+/**
+ * @brief play the same pattern as another sequence. Nothing gets copied until one of them is modified
+ */
+void SuperSeq::share(SuperSeq *source)
+{
+    if (source == this)
+        return;
+    loadPattern(source->pattern, source->length, source->containsTouchEvents, source->containsBendEvents);
+}
+
+/**
+ * @brief replace the sequence with a pattern from the pool. The undo history was saved against the old pattern, so it
+ * gets discarded
+ *
+ * @param source pattern index
+ * @param steps sequence length the pattern was recorded with
+ */
+void SuperSeq::loadPattern(uint8_t source, int steps, bool touchEvents, bool bendEvents)
+{
+    history.clear();
+    seq_pattern_retain(source); // before releasing, in case it is the same pattern
+    seq_pattern_release(pattern);
+    pattern = source;
+    events = seq_pattern_events(source);
+    containsTouchEvents = touchEvents;
+    containsBendEvents = bendEvents;
+    setLength(steps); // also flags the events as changed
+}
+
+/**
+ * @brief chain the pattern as it is right now onto the end of the song. Later edits copy it, so the song keeps this
+ * version. Once songs hold SEQ_PATTERN_SONG_SLOTS other patterns the entry follows later edits instead
+ *
+ * @return false if the song is full
+ */
+bool SuperSeq::appendToSong()
+{
+    return song.append(pattern, length, containsTouchEvents, containsBendEvents);
+}
+
+void SuperSeq::clearSong()
+{
+    song.clear();
+}
+
+/**
+ * @brief load the next pattern of the song. Called each time the sequence loops back to the start
+ *
+ * @return true if a different pattern got loaded
+ */
+bool SuperSeq::advanceSong()
+{
+    if (!song.isPlaying() || recordEnabled)
+        return false;
+    SeqSongEntry *entry = song.next();
+    if (entry->pattern == SEQ_PATTERN_NONE || entry->pattern == pattern)
+    {
+        // nothing to load, the channel already holds the pattern
+        if (entry->length == length)
+            return false;
+        setLength(entry->length);
+        return true;
+    }
+    loadPattern(entry->pattern, entry->length, entry->containsTouchEvents, entry->containsBendEvents);
+    return true;
+}
+
 /**
  * @brief clear all bend events in sequence
  */
 void SuperSeq::clearBendAtPosition(int position)
 {
+    if (events[position].bend == BENDER_DAC_ZERO)
+        return;
+    modify(SEQ_PLANE::BEND, position);
     events[position].bend = BENDER_DAC_ZERO;
 };
 
@@ -215,7 +294,11 @@ void SuperSeq::clearBendAtPosition(int position)
  */
 void SuperSeq::clearTouchAtPosition(int position)
 {
+    if (events[position].data == 0x00)
+        return;
+    modify(SEQ_PLANE::TOUCH, position);
     events[position].data = 0x00;
+    eventsChanged();
 }
 
 /**
@@ -226,7 +309,9 @@ void SuperSeq::clearTouchAtPosition(int position)
  */
 void SuperSeq::copyPaste(int prevPosition, int newPosition)
 {
+    modify(SEQ_PLANE::TOUCH, newPosition);
     events[newPosition].data = events[prevPosition].data;
+    eventsChanged();
 }
 
 /**
@@ -243,8 +328,9 @@ void SuperSeq::cutPaste(int prevPosition, int newPosition)
 
 /**
  * @brief Create new event at position
+ * @param glide whether playback should glide into this note (only meaningful for gate HIGH events)
 */
-void SuperSeq::createTouchEvent(int position, uint8_t degree, uint8_t octave, bool gate)
+void SuperSeq::createTouchEvent(int position, uint8_t degree, uint8_t octave, bool gate, bool glide)
 {
     if (!containsTouchEvents)
         containsTouchEvents = true;
@@ -261,7 +347,7 @@ void SuperSeq::createTouchEvent(int position, uint8_t degree, uint8_t octave, bo
     }
     
     newEventPos = position;
-    setEventData(newEventPos, degree, octave, gate, true);
+    setEventData(newEventPos, degree, octave, gate, true, glide);
 };
 
 /**
@@ -275,6 +361,7 @@ void SuperSeq::createBendEvent(int position, uint16_t bend)
     if (!containsBendEvents)
         containsBendEvents = true;
 
+    modify(SEQ_PLANE::BEND, position);
     events[position].bend = bend;
 }
 
@@ -283,6 +370,7 @@ void SuperSeq::createChordEvent(int position, uint8_t degrees, uint8_t octaves)
     if (!containsTouchEvents)
         containsTouchEvents = true;
 
+    modify(SEQ_PLANE::TOUCH, position);
     events[position].activeDegrees = degrees;
     events[position].data = octaves;
     setEventStatus(position, true);
@@ -297,99 +385,271 @@ void SuperSeq::setLength(int steps)
     {
         length = steps;
         lengthPPQN = length * PPQN;
+        eventsChanged();
     }
 };
 
+void SuperSeq::enableQuantize()
+{
+    quantizeEnabled = true;
+    seq_core.resync[coreIndex] = 1;
+}
+
+void SuperSeq::disableQuantize()
+{
+    quantizeEnabled = false;
+    seq_core.resync[coreIndex] = 1;
+}
+
 /**
- * @brief set the level new events get quantized too
+ * @brief set the grid touch events get quantized to on playback. Only the quantized positions get recalculated (on the next
+ * pulse), so this is cheap enough to sweep while the sequence is playing
 */
 void SuperSeq::setQuantizeAmount(QUANT value)
 {
     quantizeAmount = value;
+    quantizeGridDirty = true;
+    seq_core.resync[coreIndex] = 1;
 }
 
 /**
- * @brief Quantize the current sequence
+ * @brief whether touch events should be triggered via getQuantizedEvent() rather than straight from the events array.
+ * Brings the quantized event list up to date first.
+ *
+ * @note while recording the raw positions are used, so new events and overdubbing line up with what is being played
  */
-void SuperSeq::quantize()
+bool SuperSeq::quantizedPlayback()
 {
-    // logger_log("\nPRE-QUANTIZATION");
-    // logSequenceToConsole();
-    
-    int pos = 0;
-    int lastGateHighPos = 0;
-    int lastGateLowPos = 0;
-    
-    while (pos < this->lengthPPQN)
+    if (!quantizeEnabled || recordEnabled || quantizeAmount == QUANT::NONE)
+        return false;
+
+    if (quantizeEventsDirty)
+        indexQuantizedEvents();
+    if (quantizeGridDirty)
+        updateQuantizedPositions();
+
+    return !quantizedEventsOverflow;
+}
+
+/**
+ * @brief get the next touch event to trigger at a playback position. Call repeatedly until it returns -1, more than one
+ * event can get quantized to the same position
+ *
+ * @param position current playback position
+ * @return int the position the event was recorded at (index into events), or -1 if there are no more
+ */
+int SuperSeq::getQuantizedEvent(int position)
+{
+    if (position != quantizeCursorPosition) // find the first event at this position
+    {
+        int low = 0;
+        int high = quantizedEventCount;
+        while (low < high)
+        {
+            int mid = (low + high) / 2;
+            if (quantizedEvents[(quantizedEventStart + mid) % quantizedEventCount].position < position)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        quantizeCursor = low;
+        quantizeCursorPosition = position;
+    }
+
+    if (quantizeCursor < quantizedEventCount)
+    {
+        QuantizedEvent *event = &quantizedEvents[(quantizedEventStart + quantizeCursor) % quantizedEventCount];
+        if (event->position == position)
+        {
+            quantizeCursor++;
+            return event->event;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief touch events were added / removed, or something changed where they play back. Rebuilds the event index when it
+ * is next needed, and wakes the channel on the next pulse so the sequencer core learns where its next event is
+ */
+void SuperSeq::eventsChanged()
+{
+    quantizeEventsDirty = true;
+    seq_core.resync[coreIndex] = 1;
+}
+
+/**
+ * @brief ask the sequencer core to call the channel's handleClock() on every pulse (or stop)
+ *
+ * @param reason SEQ_WAKE_*
+ */
+void SuperSeq::setWake(uint8_t reason, bool enable)
+{
+    seq_core_set_wake(coreIndex, reason, enable);
+}
+
+/**
+ * @brief tell the sequencer core which position the next touch event gets triggered at, so it can skip the pulses in
+ * between. Called by the channel every time it gets woken
+ *
+ * @param enable false when touch events aren't being played back
+ */
+void SuperSeq::updateNextEvent(bool enable)
+{
+    seq_core.resync[coreIndex] = 0;
+    int next = -1;
+    if (enable && playbackEnabled && containsTouchEvents)
+    {
+        bool quantized = quantizedPlayback();
+        if (quantizeEventsDirty)
+            indexQuantizedEvents();
+
+        if (quantizedEventsOverflow)
+        {
+            next = getNextPosition(currPosition); // too many events to index, check every pulse
+        }
+        else if (quantizedEventCount)
+        {
+            // first event after the current position, or wrap around to the first one
+            int low = 0;
+            int high = quantizedEventCount;
+            while (low < high)
+            {
+                int mid = (low + high) / 2;
+                if (getIndexedEventPosition(mid, quantized) <= currPosition)
+                    low = mid + 1;
+                else
+                    high = mid;
+            }
+            next = getIndexedEventPosition(low < quantizedEventCount ? low : 0, quantized);
+        }
+    }
+    seq_core.nextEvent[coreIndex] = next;
+}
+
+/**
+ * @brief position an indexed touch event gets triggered at, in playback order
+ *
+ * @param index 0..quantizedEventCount
+ * @param quantized whether quantized playback is enabled
+ */
+int SuperSeq::getIndexedEventPosition(int index, bool quantized)
+{
+    if (quantized)
+        return quantizedEvents[(quantizedEventStart + index) % quantizedEventCount].position;
+    return quantizedEvents[index].event;
+}
+
+/**
+ * @brief rebuild the list of touch events quantized playback works from. This scans the whole sequence, so it only happens
+ * after events have been added or removed
+ */
+void SuperSeq::indexQuantizedEvents()
+{
+    quantizeEventsDirty = false;
+    quantizedEventsOverflow = false;
+    quantizedEventCount = 0;
+    for (int pos = 0; pos < lengthPPQN; pos++)
     {
-        // should you keep track of gate HIGH and gate LOW events?
-        // If you hold the degree index between iterations than you can delete stray gate low events 
-        // as you iterate over the sequence events
-        
-        // If there is touch event data at this position (bit 5)
         if (events[pos].getStatus())
         {
-            // if event is a gate HIGH event
-            if (events[pos].getGate())
+            if (quantizedEventCount == SEQ_QUANTIZE_MAX_EVENTS)
             {
-                int newPos = getQuantizedPosition(pos, lengthPPQN, quantizeAmount);
-
-                if (newPos == pos) // alread perfect, move on.
-                {
-                    lastGateHighPos = newPos;
-                    pos++;
-                    continue;
-                }
-
-                if (events[newPos].getStatus()) // is there an active event at the new position?
-                {
-                    if (events[newPos].getGate()) // is it a gate HIGH event?
-                    {
-                        this->cutPaste(pos, newPos); // overwrite that event
-                    }
-                    else // if the event is a gate low event
-                    {
-                        if (eventsAreAssociated(newPos, pos) && !events[getNextPosition(newPos)].getStatus()) // reposition gate low event to newPos + 1 (only if there isn't already an event there)
-                        {
-                            cutPaste(newPos, getNextPosition(newPos));
-                        }
-                        else // copy that gate low event to newPos - 1
-                        {                            
-                            this->copyPaste(newPos, getPrevPosition(newPos));
-                        }
-                        // copy only the touch event data to the new position, and delete it from its original position
-                        this->cutPaste(pos, newPos);
-                    }
-                } else { // cut this event to its new position
-                    cutPaste(pos, newPos);
-                }
-                lastGateHighPos = newPos;
+                quantizedEventsOverflow = true;
+                quantizedEventCount = 0;
+                break;
             }
-            else // if event is a gate LOW event
+            quantizedEvents[quantizedEventCount].event = pos;
+            quantizedEventCount++;
+        }
+    }
+    quantizeGridDirty = true;
+}
+
+/**
+ * @brief snap every indexed touch event to the quantize grid, in a few passes over the event list.
+ *
+ * Gate HIGH events snap to the nearest grid line. Gate LOW events keep their distance from the gate HIGH event before them, so
+ * note lengths survive, but never land after the next gate HIGH event. Sequences without any gate HIGH events (chords) snap
+ * every event.
+ *
+ * Positions are worked out unwrapped (0 .. 2 * lengthPPQN) and never decrease, so once the events pushed past the end of the
+ * loop are wrapped back to the start, the list is sorted when read starting at quantizedEventStart.
+ */
+void SuperSeq::updateQuantizedPositions()
+{
+    quantizeGridDirty = false;
+    quantizeCursorPosition = -1;
+    quantizedEventStart = 0;
+    if (quantizedEventCount == 0)
+        return;
+
+    int firstNote = -1;
+    int lastNote = -1;
+    for (int i = 0; i < quantizedEventCount; i++)
+    {
+        if (events[quantizedEvents[i].event].getGate())
+        {
+            if (firstNote == -1)
+                firstNote = i;
+            lastNote = i;
+        }
+    }
+
+    // any gate LOW events before the first note belong to the last note, which was held over the end of the loop
+    int offset = 0;
+    if (lastNote != -1)
+    {
+        int raw = quantizedEvents[lastNote].event;
+        offset = quantize_position(raw, quantizeAmount) - raw;
+    }
+
+    for (int i = 0; i < quantizedEventCount; i++)
+    {
+        int raw = quantizedEvents[i].event;
+        int position;
+        if (firstNote == -1 || events[raw].getGate())
+        {
+            position = quantize_position(raw, quantizeAmount);
+            offset = position - raw;
+        }
+        else
+        {
+            position = raw + offset;
+        }
+        quantizedEvents[i].position = position < 0 ? 0 : position;
+    }
+
+    // walk backwards so each gate LOW event knows where the next note lands
+    if (firstNote != -1)
+    {
+        int nextNote = quantizedEvents[firstNote].position + lengthPPQN;
+        for (int i = quantizedEventCount - 1; i >= 0; i--)
+        {
+            if (events[quantizedEvents[i].event].getGate())
+                nextNote = quantizedEvents[i].position;
+            else if (quantizedEvents[i].position > nextNote)
+                quantizedEvents[i].position = nextNote;
+        }
+    }
+
+    int prev = 0;
+    bool wrapped = false;
+    for (int i = 0; i < quantizedEventCount; i++)
+    {
+        if (quantizedEvents[i].position < prev)
+            quantizedEvents[i].position = prev;
+        prev = quantizedEvents[i].position;
+        if (prev >= lengthPPQN)
+        {
+            if (!wrapped)
             {
-                // check to see if its associated gate HIGH event has overlapped
-                if (events[pos].getDegree() == events[lastGateHighPos].getDegree() && events[lastGateHighPos].getGate() == HIGH)
-                {
-                    if (lastGateHighPos >= pos) // if greater or equal
-                    {
-                        int nextPos = getNextPosition(lastGateHighPos);
-                        if (events[nextPos].getStatus() == false) // if there already is an ective HIGH event, then what?
-                        {
-                            // move this gate low event to lastGateHighPos + 1
-                            cutPaste(pos, nextPos);
-                        } else {
-                            clearTouchAtPosition(pos);
-                        }
-                    }
-                }
-                lastGateLowPos = pos;
+                wrapped = true;
+                quantizedEventStart = i;
             }
+            quantizedEvents[i].position -= lengthPPQN;
         }
-        pos++;
     }
-    // logger_log("\n\nPOST-QUANTIZATION");
-    // logSequenceToConsole();
-    // logger_log("\n");
 }
 
 void SuperSeq::logSequenceToConsole() {
@@ -414,14 +674,15 @@ void SuperSeq::logSequenceToConsole() {
 }
 
 /**
- * @brief contruct an 8-bit value which holds the degree index, octave, gate state, and status of a sequence event.
+ * @brief contruct an 8-bit value which holds the degree index, octave, gate state, glide flag, and status of a sequence event.
  *
  * @param degree the degree index (0..7)
  * @param octave the octave (0..3)
  * @param gate the state of the gate output (high or low)
  * @param status the status of the event
+ * @param glide glide into this note on playback
  */
-void SuperSeq::setEventData(int position, uint8_t degree, uint8_t octave, bool gate, bool status)
+void SuperSeq::setEventData(int position, uint8_t degree, uint8_t octave, bool gate, bool status, bool glide)
 {
     if (gate == LOW) // avoid overwriting any active HIGH event with a active LOW event
     {
@@ -433,9 +694,12 @@ void SuperSeq::setEventData(int position, uint8_t degree, uint8_t octave, bool g
     uint8_t data = 0b00000000;
     data = setIndexBits(degree, data);
     data = setGateBits(gate, data);
+    data = setGlideBits(glide, data);
     data = setStatusBits(status, data);
     data = setOctaveBits(octave, data);
+    modify(SEQ_PLANE::TOUCH, position);
     events[position].data = data;
+    eventsChanged();
 }
 
 /**
@@ -461,9 +725,29 @@ uint32_t SuperSeq::encodeEventData(int position)
  */
 void SuperSeq::decodeEventData(int position, uint32_t data)
 {
+    modify(SEQ_PLANE::TOUCH, position);
+    modify(SEQ_PLANE::BEND, position);
     events[position].bend = (uint16_t)(data >> 16);
     events[position].activeDegrees = (uint8_t)((data & 0x0000FF00) >> 8);
     events[position].data = (uint8_t)(data & 0x000000FF);
+    eventsChanged();
+}
+
+/**
+ * @brief restore a single touch event packed by serializeTouchEvents(). Doesn't touch the undo history or the bend
+ * plane, call eventsChanged() once all of them are restored
+ *
+ * @param data packed touch event
+ */
+void SuperSeq::deserializeTouchEvent(uint32_t data)
+{
+    int position = (int)(data >> 16);
+    if (position >= MAX_SEQ_LENGTH_PPQN)
+        return;
+    unshare();
+    events[position].activeDegrees = (uint8_t)((data & 0x0000FF00) >> 8);
+    events[position].data = (uint8_t)(data & 0x000000FF);
+    containsTouchEvents = true;
 }
 
 /**
@@ -478,6 +762,7 @@ void SuperSeq::storeSequenceConfigData(uint32_t *arr) {
     arr[2] = this->containsBendEvents;
     arr[3] = this->containsTouchEvents;
     arr[4] = (uint32_t)this->quantizeAmount;
+    arr[5] = this->quantizeEnabled;
 }
 
 void SuperSeq::loadSequenceConfigData(uint32_t *arr)
@@ -486,7 +771,9 @@ void SuperSeq::loadSequenceConfigData(uint32_t *arr)
     this->lengthPPQN = (int)arr[1];
     this->containsBendEvents = (bool)arr[2];
     this->containsTouchEvents = (bool)arr[3];
-    this->quantizeAmount = (enum QUANT)arr[4];
+    this->setQuantizeAmount((enum QUANT)arr[4]);
+    this->quantizeEnabled = arr[5] == 1; // blank flash reads 0xFFFFFFFF
+    this->eventsChanged();
 }
 
 uint8_t SuperSeq::getEventDegree(int position)
@@ -514,6 +801,11 @@ bool SuperSeq::getEventGate(int position)
     return events[position].getGate();
 }
 
+bool SuperSeq::getEventGlide(int position)
+{
+    return events[position].getGlide();
+}
+
 bool SuperSeq::getEventStatus(int position)
 {
     return events[position].getStatus();
@@ -521,7 +813,9 @@ bool SuperSeq::getEventStatus(int position)
 
 void SuperSeq::setEventStatus(int position, bool status)
 {
+    modify(SEQ_PLANE::TOUCH, position);
     events[position].data = setStatusBits(status, events[position].data);
+    eventsChanged();
 }
 
 bool SuperSeq::eventsAreAssociated(int pos1, int pos2)
@@ -548,6 +842,11 @@ uint8_t SuperSeq::setGateBits(bool state, uint8_t byte)
     return state ? bitwise_set_bit(byte, SEQ_EVENT_GATE_BIT) : bitwise_clear_bit(byte, SEQ_EVENT_GATE_BIT);
 }
 
+uint8_t SuperSeq::setGlideBits(bool glide, uint8_t byte)
+{
+    return glide ? bitwise_set_bit(byte, SEQ_EVENT_GLIDE_BIT) : bitwise_clear_bit(byte, SEQ_EVENT_GLIDE_BIT);
+}
+
 uint8_t SuperSeq::setStatusBits(bool status, uint8_t byte)
 {
     return status ? bitwise_set_bit(byte, SEQ_EVENT_STATUS_BIT) : bitwise_clear_bit(byte, SEQ_EVENT_STATUS_BIT);
@@ -2,14 +2,24 @@
 
 using namespace DEGREE;
 
-void TouchChannel::init()
+/**
+ * Channel initialization is split up by peripheral bus so GlobalControl can run the I2C buses in parallel:
+ * 
+ * initOutputs()    SPI DACs (1v/o and bender outputs)
+ * initLEDs()       I2C3 LED driver
+ * initTouchPads()  I2C1 touch pads
+ * init()           everything else, once all of the above are done and the bender idle value is known
+ */
+void TouchChannel::initOutputs()
 {
-    uiMode = UI_PLAYBACK;
-    
     output.init(); // must init this first (for the dac)
-    
+    adc.setSampleRate(CV_INPUT_SAMPLE_RATE_HZ);
     adc.setFilter(0.05);
+    bender->init();
+}
 
+void TouchChannel::initLEDs()
+{
     // initialize LED Driver
     _leds->init();
     _leds->setBlinkFrequency(SX1509::ClockSpeed::ULTRA_FAST);
@@ -24,23 +34,22 @@ void TouchChannel::init()
     setLED(CHANNEL_QUANT_LED, DIM_HIGH, false);
     setLED(CHANNEL_PB_LED, DIM_HIGH, false);
     setLED(CHANNEL_RATCHET_LED, DIM_HIGH, false);
+}
 
-    bender->adc.attachSamplingProgressCallback(callback(this, &TouchChannel::displayProgressCallback));
-    bender->init();
-    bender->adc.detachSamplingProgressCallback();
-    display->clear(channelIndex);
-    bender->attachActiveCallback(callback(this, &TouchChannel::benderActiveCallback));
-    bender->attachIdleCallback(callback(this, &TouchChannel::benderIdleCallback));
-    bender->attachTriStateCallback(callback(this, &TouchChannel::benderTriStateCallback));
-
-    // initialize channel touch pads
+void TouchChannel::initTouchPads()
+{
     touchPads->init();
     touchPads->attachInterruptCallback(callback(this, &TouchChannel::handleTouchInterrupt));
     touchPads->attachCallbackTouched(callback(this, &TouchChannel::onTouch));
     touchPads->attachCallbackReleased(callback(this, &TouchChannel::onRelease));
     touchPads->enable();
+}
+
+void TouchChannel::init()
+{
+    uiMode = UI_PLAYBACK;
 
-    display->drawSpiral(channelIndex, true, PWM::PWM_HIGH, 25);
+    bender->setRatchetThresholds(); // needs the bender idle value
 
     // flash settings sensitive below
     if (!sequence.containsEvents()) // don't init if sequence was loaded from flash
@@ -60,7 +69,15 @@ void TouchChannel::init()
 void TouchChannel::handleClock() {
     if (!freezeChannel)
     {
-        bender->poll();
+        // the bender gets polled at a fixed rate by task_bender, only the clocked side of bending is handled here
+        if (!bender->isIdle() && !benderOverride)
+        {
+            // overdub existing bend events when record enabled
+            if (sequence.recordEnabled)
+                sequence.createBendEvent(sequence.currPosition, bender->currBend);
+            if (currBenderMode == RATCHET || currBenderMode == RATCHET_PITCH_BEND)
+                handleRatchet(sequence.currStepPosition, bender->currBend);
+        }
 
         if (playbackMode == QUANTIZER || playbackMode == QUANTIZER_LOOP)
         {
@@ -69,17 +86,45 @@ void TouchChannel::handleClock() {
 
         if (playbackMode == MONO_LOOP || playbackMode == QUANTIZER_LOOP)
         {
+            if (sequence.currPosition == 0 && sequence.advanceSong())
+                updateSequencePlayback();
             handleSequence(sequence.currPosition);
         }
         if (uiMode == UI_QUANTIZE_AMOUNT)
         {
             handleQuantAmountLEDs();
         }
+        updateClockWake();
+    }
+}
+
+/**
+ * @brief tell the sequencer core which pulses this channel needs handleClock() called on. Pulses where nothing but the
+ * position changes get skipped
+ */
+void TouchChannel::updateClockWake()
+{
+    bool looping = playbackMode == MONO_LOOP || playbackMode == QUANTIZER_LOOP;
+    sequence.setWake(SEQ_WAKE_CV, playbackMode == QUANTIZER || playbackMode == QUANTIZER_LOOP);
+    sequence.setWake(SEQ_WAKE_UI, uiMode == UI_QUANTIZE_AMOUNT);
+    sequence.setWake(SEQ_WAKE_BEND_PLAYBACK, looping && sequence.playbackEnabled && sequence.containsBendEvents);
+    sequence.updateNextEvent(looping);
+}
+
+/**
+ * @brief gets called at BENDER_CONTROL_RATE_HZ by task_bender, independent of the tempo
+ */
+void TouchChannel::pollBender()
+{
+    if (!freezeChannel)
+    {
+        bender->poll(this); // calls benderIdleCallback(), benderActiveCallback() and benderTriStateCallback()
     }
 }
 
 void TouchChannel::setUIMode(UIMode targetMode) {
     this->uiMode = targetMode;
+    seq_core.resync[sequence.coreIndex] = 1;
     switch (targetMode)
     {
     case UIMode::UI_PLAYBACK:
@@ -93,6 +138,9 @@ void TouchChannel::setUIMode(UIMode targetMode) {
     case UI_QUANTIZE_AMOUNT:
         updateUI(uiMode);
         break;
+    case UI_GLIDE_TIME:
+        updateUI(uiMode);
+        break;
     }
 }
 
@@ -144,6 +192,18 @@ void TouchChannel::updateUI(UIMode mode)
         }
 
         break;
+
+    case UIMode::UI_GLIDE_TIME:
+        // degree LEDs show the glide time (same as pitch bend range), octave LEDs show the curve
+        setAllOctaveLeds(LedState::OFF, false);
+        setAllDegreeLeds(LedState::OFF, false);
+        setAllDegreeLeds(LedState::BLINK_ON, false);
+        for (int i = 0; i < getGlideTimeIndex() + 1; i++)
+        {
+            setDegreeLed(i, LedState::ON, false);
+        }
+        setOctaveLed(output.glide.getCurve(), LedState::ON, false);
+        break;
     }
 }
 
@@ -153,6 +213,8 @@ void TouchChannel::updateUI(UIMode mode)
 void TouchChannel::setPlaybackMode(PlaybackMode targetMode)
 {
     playbackMode = targetMode;
+    midiNotesHeld = 0;
+    sequence.eventsChanged(); // handleClock() works out what this mode needs it to be woken for
 
     // start from a clean slate by setting all the LEDs LOW
     for (int i = 0; i < DEGREE_COUNT; i++) {
@@ -211,6 +273,7 @@ void TouchChannel::toggleMode()
         if (sequence.containsTouchEvents) {
             sequence.clearAllTouchEvents();
         }
+        sequence.history.clear(); // recorded events mean something different in the other mode, so they can't be brought back
     }
 
     if (playbackMode == MONO || playbackMode == MONO_LOOP)
@@ -238,6 +301,7 @@ void TouchChannel::toggleMode()
  */
 void TouchChannel::onTouch(uint8_t pad)
 {
+    TRACE_IO(TRACE_INPUT_TOUCH, (channelIndex << 8) | 0x80 | pad);
     switch (uiMode)
     {
     case UIMode::UI_PLAYBACK:
@@ -276,11 +340,23 @@ void TouchChannel::onTouch(uint8_t pad)
         output.setPitchBendRange(CHAN_TOUCH_PADS[pad]); // this applies the inverse of the pad (ie. pad = 7, gets mapped to 0)
         updateUI(uiMode);
         break;
+    case UIMode::UI_GLIDE_TIME:
+        if (pad < 8) // degree pads set the glide time
+        {
+            output.glide.setTime(GLIDE_TIME_MAP[CHAN_TOUCH_PADS[pad]]);
+        }
+        else if (CHAN_TOUCH_PADS[pad] <= Glide::EXPONENTIAL) // first two octave pads set the curve
+        {
+            output.glide.setCurve((Glide::Curve)CHAN_TOUCH_PADS[pad]);
+        }
+        updateUI(uiMode);
+        break;
     }
 }
 
 void TouchChannel::onRelease(uint8_t pad)
 {
+    TRACE_IO(TRACE_INPUT_TOUCH, (channelIndex << 8) | pad);
     switch (uiMode)
     {
     case UIMode::UI_PLAYBACK:
@@ -292,6 +368,8 @@ void TouchChannel::onRelease(uint8_t pad)
         break;
     case UIMode::UI_PITCH_BEND_RANGE:
         break;
+    case UIMode::UI_GLIDE_TIME:
+        break;
     }
 }
 
@@ -309,7 +387,7 @@ void TouchChannel::handleTouchPlaybackEvent(uint8_t pad)
                 if (sequence.recordEnabled)
                 {
                     sequence.enableOverdub();
-                    sequence.createTouchEvent(sequence.currPosition, pad, currOctave, HIGH);
+                    sequence.createTouchEvent(sequence.currPosition, pad, currOctave, HIGH, output.glide.getTime() > 0);
                 }
                 // when record is disabled, this block will freeze the sequence and output the curr touched degree until touch is released
                 else {
@@ -318,7 +396,7 @@ void TouchChannel::handleTouchPlaybackEvent(uint8_t pad)
                 triggerNote(pad, currOctave, NOTE_ON);
                 break;
             case QUANTIZER:
-                if (selectPadIsTouched) {
+                if (selectPadIsTouched()) {
                     overrideQuantizer = true;
                     triggerNote(pad, currOctave, NOTE_ON);
                 } else {
@@ -351,7 +429,7 @@ void TouchChannel::handleTouchPlaybackEvent(uint8_t pad)
             if (sequence.recordEnabled)
             {
                 sequence.enableOverdub();
-                sequence.createTouchEvent(sequence.currPosition, currDegree, pad, HIGH);
+                sequence.createTouchEvent(sequence.currPosition, currDegree, pad, HIGH, output.glide.getTime() > 0);
             }
             else
             {
@@ -403,7 +481,6 @@ void TouchChannel::handleReleasePlaybackEvent(uint8_t pad)
         case QUANTIZER:
             if (touchPads->padIsTouched() == false) {
                 overrideQuantizer = false;
-                armSelectPadRelease = false;
                 handleCVInput();
             }
             break;
@@ -453,10 +530,16 @@ void TouchChannel::handleReleasePlaybackEvent(uint8_t pad)
  * @param octave index value between 0..3 that gets mapped to note arrays and pin arrays
  * @param action action
 */
-void TouchChannel::triggerNote(int degree, int octave, Action action)
+/**
+ * @param glide glide to the new note (if this channels glide time is greater than 0). Sequence playback passes the
+ * glide flag recorded with each event, everything else glides by default.
+ */
+void TouchChannel::triggerNote(int degree, int octave, Action action, bool glide)
 {
     // stack the degree, octave, and degree switch state to get an index between 0..DAC_1VO_ARR_SIZE
     int dacIndex = DEGREE_INDEX_MAP[degree] + DAC_OCTAVE_MAP[octave] + degreeSwitches->switchStates[degree];
+    if (action == NOTE_ON || action == SUSTAIN)
+        midiPitch = MIDI_NOTE_BASE + dacIndex; // before the gate goes high, so the note on goes out with the new pitch
 
     prevDegree = currDegree;
     prevOctave = currOctave;
@@ -476,7 +559,7 @@ void TouchChannel::triggerNote(int degree, int octave, Action action)
                     setOctaveLed(currOctave, ON, true);
                 }
             }
-            output.setPitch(dacIndex);
+            output.setPitch(dacIndex, glide);
             break;
         case NOTE_OFF:
             setGate(LOW);
@@ -486,7 +569,7 @@ void TouchChannel::triggerNote(int degree, int octave, Action action)
             {
                 setDegreeLed(degree, ON, true);      // new active note HIGH
             }
-            output.setPitch(dacIndex);
+            output.setPitch(dacIndex, glide);
             break;
         case PREV_NOTE:
             /* code */
@@ -495,11 +578,29 @@ void TouchChannel::triggerNote(int degree, int octave, Action action)
             /* code */
             break;
     }
+    updateMidiOutput(); // a new pitch while the gate stays high
+}
+
+/**
+ * @brief send whatever MIDI it takes for the MIDI output to match the gate and pitch. The note sounds for as long as
+ * the gate is high, so ratchets and quantizer triggers go out as MIDI notes as well
+ */
+void TouchChannel::updateMidiOutput()
+{
+    uint8_t note = gateState == HIGH ? midiPitch : MIDI_NOTE_NONE;
+    if (note == midiNoteSounding)
+        return;
+    if (midiNoteSounding != MIDI_NOTE_NONE)
+        midi_send_note_off(channelIndex, midiNoteSounding);
+    if (note != MIDI_NOTE_NONE)
+        midi_send_note_on(channelIndex, note, MIDI_DEFAULT_VELOCITY);
+    midiNoteSounding = note;
 }
 
 void TouchChannel::freeze(bool state)
 {
     freezeChannel = state;
+    seq_core.resync[sequence.coreIndex] = 1; // events may have been passed while frozen
     if (freezeChannel == true) {
         freezeStep = sequence.currStep; // log the last sequence led to be illuminated
         // maybe blink the degree LEDs?
@@ -534,7 +635,7 @@ void TouchChannel::setLED(int io_pin, LedState state, bool isPlaybackEvent)
 {
     if (isPlaybackEvent && uiMode != UI_PLAYBACK) // this will prevent a sequence from setting LEDs while in any other UI mode
     {
-        if (uiMode == UI_PITCH_BEND_RANGE || uiMode == UI_QUANTIZE_AMOUNT)
+        if (uiMode == UI_PITCH_BEND_RANGE || uiMode == UI_QUANTIZE_AMOUNT || uiMode == UI_GLIDE_TIME)
         {
             return;
         }
@@ -625,9 +726,12 @@ void TouchChannel::updateOctaveLeds(int octave, bool isPlaybackEvent)
 */
 void TouchChannel::setGate(bool state)
 {
+    if (state != gateState)
+        TRACE_IO(TRACE_OUTPUT_GATE, (channelIndex << 8) | state);
     gateState = state;
     gateOut.write(gateState);
     globalGateOut->write(gateState);
+    updateMidiOutput();
 }
 
 #define RATCHET_DIV_1 PPQN / 1
@@ -742,18 +846,25 @@ void TouchChannel::handleBend(uint16_t value) {
 void TouchChannel::handlePitchBend(uint16_t value) {
     if (!touchPads->padIsTouched()) // only apply pitch bend when all pads have been released
     {
+        // the noise threshold is a dead zone around the idle position (ADC units), bends are in fixed point semitones
         uint16_t pitchbend;
+        int bendUpStart = (int)bender->getIdleValue() - BENDER_NOISE_THRESHOLD;
+        int bendDownStart = (int)bender->getIdleValue() + BENDER_NOISE_THRESHOLD;
         // Pitch Bend UP (inverted)
-        if (value < bender->getIdleValue())
+        if ((int)value < bendUpStart)
         {
-            pitchbend = output.calculatePitchBend(value, bender->getMinBend(), bender->getIdleValue());
-            output.setPitchBend(output.maxPitchBend - pitchbend - BENDER_NOISE_THRESHOLD, true); // NOTE: inverted mapping
+            pitchbend = output.calculatePitchBend(value, bender->getMinBend(), bendUpStart);
+            output.setPitchBend(output.maxPitchBend - pitchbend, true); // NOTE: inverted mapping
         }
         // Pitch Bend DOWN
-        else if (value > bender->getIdleValue())
+        else if ((int)value > bendDownStart)
+        {
+            pitchbend = output.calculatePitchBend(value, bendDownStart, bender->getMaxBend());
+            output.setPitchBend(pitchbend, false); // value needs to be negative
+        }
+        else
         {
-            pitchbend = output.calculatePitchBend(value, bender->getIdleValue(), bender->getMaxBend());
-            output.setPitchBend(pitchbend - BENDER_NOISE_THRESHOLD, false); // value needs to be negative
+            output.setPitchBend(0);
         }
     }
 }
@@ -817,50 +928,38 @@ void TouchChannel::disableBenderOverride() {
  * 
  * @param value the raw ADC value from the bender instance
  */
+/**
+ * @brief called from task_bender while the bender is being bent. Recording and ratchets happen in handleClock()
+ * 
+ * @param value current bend
+ */
 void TouchChannel::benderActiveCallback(uint16_t value)
 {
+    sequence.setWake(SEQ_WAKE_BENDER, true);
+    TRACE_IO_ANALOG(TRACE_INPUT_BENDER + channelIndex, value, TRACE_ANALOG_THRESHOLD);
     if (!this->benderOverride)
     {
         bender->updateDAC(value);
-
-        // overdub existing bend events when record enabled
-        // override existng bend events when record disabled (but sequencer still ON)
-        if (sequence.recordEnabled)
+        if (currBenderMode == PITCH_BEND || currBenderMode == RATCHET_PITCH_BEND)
         {
-            sequence.createBendEvent(sequence.currPosition, value);
+            this->handlePitchBend(value);
         }
-        this->handleBend(value);
     }
 }
 
+/**
+ * @brief called from task_bender while the bender is idle. Glides the bender output back to its idle position,
+ * unless a sequence with bend events is playing back (handleSequence() owns the outputs then)
+ */
 void TouchChannel::benderIdleCallback()
 {
-    if (sequence.playbackEnabled)
-    {
-        if (!sequence.containsBendEvents)
-        {
-            bender->updateDAC(bender->currBend); // currBend gets set to ist idle value in the underlying handler
-        }
-    } else {
-        bender->updateDAC(bender->currBend);
-    }
-    
-
-    switch (this->currBenderMode) // do you need this? Or can you call handleBend()?
+    sequence.setWake(SEQ_WAKE_BENDER, false);
+    TRACE_IO_ANALOG(TRACE_INPUT_BENDER + channelIndex, BENDER_DAC_ZERO, 0);
+    if (sequence.playbackEnabled && sequence.containsBendEvents)
     {
-    case BEND_OFF:
-        break;
-    case PITCH_BEND:
-        output.setPitchBend(0);
-        break;
-    case RATCHET:
-        setLED(CHANNEL_RATCHET_LED, ON, true);
-        break;
-    case RATCHET_PITCH_BEND:
-        output.setPitchBend(0);
-        setLED(CHANNEL_RATCHET_LED, ON, true);
-        break;
+        return;
     }
+    bender->updateDAC(bender->currBend); // currBend gets set to ist idle value in the underlying handler
 }
 
 /**
@@ -870,6 +969,26 @@ void TouchChannel::benderIdleCallback()
  */
 void TouchChannel::benderTriStateCallback(Bender::BendState state)
 {
+    // reset the outputs once when the bender is released, rather than on every poll while it sits idle
+    if (state == Bender::BendState::BENDING_IDLE)
+    {
+        switch (this->currBenderMode)
+        {
+        case BEND_OFF:
+            break;
+        case PITCH_BEND:
+            output.setPitchBend(0);
+            break;
+        case RATCHET:
+            setLED(CHANNEL_RATCHET_LED, ON, true);
+            break;
+        case RATCHET_PITCH_BEND:
+            output.setPitchBend(0);
+            setLED(CHANNEL_RATCHET_LED, ON, true);
+            break;
+        }
+    }
+
     switch (this->uiMode)
     {
     case TouchChannel::UIMode::UI_SEQUENCE_LENGTH:
@@ -919,11 +1038,15 @@ void TouchChannel::handleCVInput()
 {
     // NOTE: CV voltage input is inverted, so everything needs to be flipped to make more sense
     currCV = CV_MAX - adc.read_u16();
+    TRACE_IO_ANALOG(TRACE_INPUT_CV + channelIndex, currCV, TRACE_ANALOG_THRESHOLD);
 
     // We only want trigger events in quantizer mode, so if the gate gets set HIGH, make sure to set it back to low the very next tick
     if (gateState == HIGH)
         setGate(LOW);
 
+    if (midiNotesHeld > 0)
+        return; // MIDI notes have the quantizer until they are all released
+
     int refinedValue = 0; // we want a number between 0 and CV_OCTAVE for mapping to degrees. The octave is added afterwords via CV_OCTAVES
     int octave = 0;
 
@@ -951,39 +1074,81 @@ void TouchChannel::handleCVInput()
             // if the calculated value is less than threshold
             if (refinedValue < activeDegreeValues[i].threshold)
             {
-                    // prevent duplicate triggering of that same degree / octave
-                    if (currDegree != activeDegreeValues[i].noteIndex || currOctave != octave) // NOTE: currOctave used to be prevOctave 🤷‍♂️
-                    {
-                        if (!overrideQuantizer)
-                        {
-                            triggerNote(currDegree, prevOctave, NOTE_OFF); // set previous triggered degree
-
-                            // re-DIM previously degree LED
-                            if (bitwise_read_bit(activeDegrees, prevDegree))
-                            {
-                                setDegreeLed(currDegree, DIM_LOW, true);
-                            }
-
-                            // trigger the new degree, and set its LED to blink
-                            triggerNote(activeDegreeValues[i].noteIndex, octave, NOTE_ON);
-                            setDegreeLed(activeDegreeValues[i].noteIndex, LedState::DIM_MED, true);
-
-                            // re-DIM previous Octave LED
-                            if (bitwise_read_bit(activeOctaves, prevOctave))
-                            {
-                                setOctaveLed(prevOctave, LedState::DIM_LOW, true);
-                            }
-                            // BLINK active quantized octave
-                            setOctaveLed(octave, LedState::DIM_MED, true);
-                        }
-                    }
-                    break; // break from loop as soon as we can
+                triggerQuantizedNote(i, octave, false);
+                break; // break from loop as soon as we can
             }
         }
         prevCV = currCV;
     }
 }
 
+/**
+ * @brief trigger one of the active degrees, the way a CV input landing on it would
+ *
+ * @param degreeRank index into activeDegreeValues
+ * @param octave
+ * @param retrigger trigger even if it is the same degree / octave as last time (a new MIDI note)
+ */
+void TouchChannel::triggerQuantizedNote(int degreeRank, int octave, bool retrigger)
+{
+    int noteIndex = activeDegreeValues[degreeRank].noteIndex;
+
+    // prevent duplicate triggering of that same degree / octave
+    if (!retrigger && currDegree == noteIndex && currOctave == octave) // NOTE: currOctave used to be prevOctave 🤷‍♂️
+        return;
+    if (overrideQuantizer)
+        return;
+
+    triggerNote(currDegree, prevOctave, NOTE_OFF); // set previous triggered degree
+
+    // re-DIM previously degree LED
+    if (bitwise_read_bit(activeDegrees, prevDegree))
+    {
+        setDegreeLed(currDegree, DIM_LOW, true);
+    }
+
+    // trigger the new degree, and set its LED to blink
+    triggerNote(noteIndex, octave, NOTE_ON);
+    setDegreeLed(noteIndex, LedState::DIM_MED, true);
+
+    // re-DIM previous Octave LED
+    if (bitwise_read_bit(activeOctaves, prevOctave))
+    {
+        setOctaveLed(prevOctave, LedState::DIM_LOW, true);
+    }
+    // BLINK active quantized octave
+    setOctaveLed(octave, LedState::DIM_MED, true);
+}
+
+/**
+ * @brief MIDI note in, quantized to the active degrees / octaves like the CV input. The MIDI_NOTE_BASE and the 4 octaves
+ * above it get spread evenly over the active octaves, and the 12 semitones of each octave over the active degrees.
+ *
+ * Only does anything in the quantizer modes. Runs in the sequencer task (see SEQ::MIDI_NOTE)
+ *
+ * @param note MIDI note number
+ * @param velocity 0 for a note off
+ */
+void TouchChannel::handleMidiNote(uint8_t note, uint8_t velocity)
+{
+    if (playbackMode != QUANTIZER && playbackMode != QUANTIZER_LOOP)
+        return;
+
+    if (velocity == 0)
+    {
+        if (midiNotesHeld > 0)
+            midiNotesHeld--;
+        return;
+    }
+    midiNotesHeld++;
+
+    int offset = note < MIDI_NOTE_BASE ? 0 : note - MIDI_NOTE_BASE;
+    int octave = offset / 12 < OCTAVE_COUNT ? offset / 12 : OCTAVE_COUNT - 1;
+    int octaveRank = (octave * numActiveOctaves) / OCTAVE_COUNT;
+    int degreeRank = ((offset % 12) * numActiveDegrees) / 12;
+    triggerQuantizedNote(degreeRank, activeOctaveValues[octaveRank].octave, true);
+}
+
 /**
  * @brief when a channels degree is touched, toggle the active/inactive status of the 
  * touched degree by flipping the bit of the given index that was touched
@@ -1067,13 +1232,10 @@ void TouchChannel::setActiveOctaves(int octave)
 */
 void TouchChannel::handleSequence(int position)
 {
-    // always display sequence progression regardless if there are events or not
+    // always display sequence progression regardless if there are events or not. Menus are drawn on a layer above, so no need to check the UI mode
     if (sequence.currStep != sequence.prevStep) // only set led every step
     {
-        if (uiMode == UIMode::UI_PLAYBACK)
-        {
-            stepSequenceLED(sequence.currStep, sequence.prevStep, sequence.length);
-        }
+        stepSequenceLED(sequence.currStep, sequence.prevStep, sequence.length);
     }
 
     // break out if there are no sequence events
@@ -1088,42 +1250,18 @@ void TouchChannel::handleSequence(int position)
     // Handle Touch Events (degrees)
     if (sequence.containsTouchEvents)
     {
-        switch (playbackMode)
+        if (sequence.quantizedPlayback())
         {
-        case MONO:
-            break;
-        case QUANTIZER:
-            break;
-        case MONO_LOOP:
-            if (sequence.getEventStatus(position)) // if event is active
+            // trigger whatever events got quantized to this position, the events themselves stay where they were recorded
+            int event;
+            while ((event = sequence.getQuantizedEvent(position)) != -1)
             {
-                // Handle Sequence Overdubing
-                if (sequence.overdub && position != sequence.newEventPos) // when a node is being created (touched degree has not yet been released), this flag gets set to true so that the sequence handler clears existing nodes
-                {
-                    // if new event overlaps succeeding events, clear those events
-                    sequence.clearTouchAtPosition(position);
-                }
-                else // Handle Sequence Events
-                {
-                    sequence.prevEventPos = position; // store position into variable
-                    triggerNote(sequence.getEventDegree(position), sequence.getEventOctave(position), sequence.getEventGate(position) ? NOTE_ON : NOTE_OFF);
-                }
+                handleSequenceEvent(event);
             }
-            break;
-        case QUANTIZER_LOOP:
-            if (sequence.getEventStatus(position))
-            {
-                if (sequence.overdub)
-                {
-                    sequence.clearTouchAtPosition(position);
-                }
-                else
-                {
-                    activeOctaves = sequence.getActiveOctaves(position);
-                    setActiveDegrees(sequence.getActiveDegrees(position));
-                }
-            }
-            break;
+        }
+        else if (sequence.getEventStatus(position))
+        {
+            handleSequenceEvent(position);
         }
     }
 
@@ -1138,6 +1276,46 @@ void TouchChannel::handleSequence(int position)
     }
 }
 
+/**
+ * @brief trigger a recorded touch event
+ *
+ * @param position the position the event was recorded at
+ */
+void TouchChannel::handleSequenceEvent(int position)
+{
+    switch (playbackMode)
+    {
+    case MONO:
+        break;
+    case QUANTIZER:
+        break;
+    case MONO_LOOP:
+        // Handle Sequence Overdubing
+        if (sequence.overdub && position != sequence.newEventPos) // when a node is being created (touched degree has not yet been released), this flag gets set to true so that the sequence handler clears existing nodes
+        {
+            // if new event overlaps succeeding events, clear those events
+            sequence.clearTouchAtPosition(position);
+        }
+        else // Handle Sequence Events
+        {
+            sequence.prevEventPos = position; // store position into variable
+            triggerNote(sequence.getEventDegree(position), sequence.getEventOctave(position), sequence.getEventGate(position) ? NOTE_ON : NOTE_OFF, sequence.getEventGlide(position));
+        }
+        break;
+    case QUANTIZER_LOOP:
+        if (sequence.overdub)
+        {
+            sequence.clearTouchAtPosition(position);
+        }
+        else
+        {
+            activeOctaves = sequence.getActiveOctaves(position);
+            setActiveDegrees(sequence.getActiveDegrees(position));
+        }
+        break;
+    }
+}
+
 /**
  * @brief reset the sequence
  * @todo you should probably get the currently queued event, see if it has been triggered yet, and disable it if it has been triggered
@@ -1153,14 +1331,18 @@ void TouchChannel::resetSequence()
 }
 
 /**
- * @brief set the sequence length and update UI
+ * @brief set the sequence length and update UI, both the sequence length menu and the sequence underneath it
  *
  * @param length
  */
 void TouchChannel::updateSequenceLength(uint8_t steps)
 {
     sequence.setLength(steps);
-    drawSequenceToDisplay(true);
+    drawSequenceToDisplay(true, LAYER::MENU);
+    if (sequence.containsEvents() || sequence.recordEnabled)
+    {
+        drawSequenceToDisplay(false);
+    }
 }
 
 /**
@@ -1168,33 +1350,35 @@ void TouchChannel::updateSequenceLength(uint8_t steps)
  * 
  * @param step 
  */
-void TouchChannel::setSequenceLED(uint8_t step, uint8_t pwm, bool blink)
+void TouchChannel::setSequenceLED(uint8_t step, uint8_t pwm, bool blink, LAYER layer)
 {
     uint8_t ledIndex = step / 2; // 32 step seq displayed with 16 LEDs
-    display->setChannelLED(channelIndex, ledIndex, pwm, blink); // it is possible ledIndex needs to be subracted by 1 🤔
+    display->setChannelLED(channelIndex, ledIndex, pwm, blink, layer); // it is possible ledIndex needs to be subracted by 1 🤔
 }
 
 /**
  * @brief illuminates the number of LEDs equal to sequence length divided by 2
+ *
+ * @param layer the current step is only highlighted on the sequencer layer
  */
-void TouchChannel::drawSequenceToDisplay(bool blink)
+void TouchChannel::drawSequenceToDisplay(bool blink, LAYER layer)
 {
     for (int i = 0; i < MAX_SEQ_LENGTH; i += 2)
     {
         if (i < sequence.length)
         {
-            if (i == sequence.currStep && sequence.playbackEnabled && uiMode == UIMode::UI_PLAYBACK)
+            if (i == sequence.currStep && sequence.playbackEnabled && layer == LAYER::SEQUENCER)
             {
-                setSequenceLED(i, PWM::PWM_HIGH, blink);
+                setSequenceLED(i, PWM::PWM_HIGH, blink, layer);
             }
             else
             {
-                setSequenceLED(i, PWM::PWM_LOW_MID, blink);
+                setSequenceLED(i, PWM::PWM_LOW_MID, blink, layer);
             }
         }
         else
         {
-            setSequenceLED(i, PWM::PWM_OFF, blink);
+            setSequenceLED(i, PWM::PWM_OFF, blink, layer);
         }
     }
 }
@@ -1249,14 +1433,78 @@ void TouchChannel::enableSequenceRecording()
 void TouchChannel::disableSequenceRecording()
 {
     sequence.disableRecording();
-    
+    updateSequencePlayback();
+}
+
+/**
+ * @brief revert the sequence to how it was before the last recording pass / clear
+ */
+void TouchChannel::undoSequence()
+{
+    if (sequence.history.undo())
+        updateSequencePlayback();
+}
+
+void TouchChannel::redoSequence()
+{
+    if (sequence.history.redo())
+        updateSequencePlayback();
+}
+
+/**
+ * @brief play the same pattern as another channel. The pattern only gets duplicated once either channel modifies it
+ */
+void TouchChannel::copySequence(TouchChannel *source)
+{
+    if (source == this)
+        return;
+    sequence.share(&source->sequence);
+    updateSequencePlayback();
+    display_animate_flash(Display::channelMask(channelIndex), PWM::PWM_HIGH, 2, 100);
+}
+
+/**
+ * @brief chain the sequence as it is now onto the end of the channel's song. Once two or more patterns are chained the
+ * channel moves on to the next one every time its sequence loops
+ */
+void TouchChannel::appendSequenceToSong()
+{
+    if (!sequence.containsEvents())
+        return;
+    if (sequence.appendToSong())
+    {
+        display_animate_flash(Display::channelMask(channelIndex), PWM::PWM_HIGH, 1, 100);
+    }
+    else
+    {
+        logger_log("\nsong full");
+    }
+}
+
+void TouchChannel::clearSong()
+{
+    sequence.clearSong();
+}
+
+/**
+ * @brief keep looping while the sequence contains events, otherwise revert to the non-looping mode
+ */
+void TouchChannel::updateSequencePlayback()
+{
     // if a touch event was recorded, remain in loop mode
     if (sequence.containsEvents())
     {
+        if (playbackMode == MONO)
+        {
+            setPlaybackMode(MONO_LOOP);
+        }
+        else if (playbackMode == QUANTIZER)
+        {
+            setPlaybackMode(QUANTIZER_LOOP);
+        }
         // make sure to update the display so it shows the new seq length
         display->clear(channelIndex);
         drawSequenceToDisplay(false);
-        return;
     }
     else // if no touch event recorded, revert to previous mode
     {
@@ -1275,63 +1523,34 @@ void TouchChannel::disableSequenceRecording()
 void TouchChannel::initializeCalibration() {
     output.resetVoltageMap(); // You should reset prior to tuning
     output.resetDAC();
-    display->flash(3, 100);
-    display->drawSpiral(channelIndex, false, PWM::PWM_OFF, 50);
-    display->clear();
+    display->clear(LAYER::MENU);
+    display_animate_flash(Display::channelMask(channelIndex), PWM::PWM_HIGH, 3, 100);
+    display_animate_spiral(channelIndex, false, true, PWM::PWM_HIGH, 50);
 }
 
 /**
- * @brief ISR from touch IC to send a notification sequencer queue
+ * @brief ISR from touch IC to post an input event to the interrupt handler
  */
 void TouchChannel::handleTouchInterrupt() {
-    dispatch_sequencer_event_ISR((CHAN)channelIndex, SEQ::HANDLE_TOUCH, 0);
-}
-
-void TouchChannel::displayProgressCallback(uint16_t progress)
-{
-    // map the incoming progress to a value between 0..16
-    uint8_t displayProgress = map_num_in_range<uint16_t>(progress, 0, ADC_SAMPLE_COUNTER_LIMIT, 0, 15);
-    this->display->setChannelLED(this->channelIndex, displayProgress, PWM::PWM_MID_HIGH, false);
-    this->setLED(DEGREE_LED_RAINBOW[displayProgress], LedState::ON, false);
-    uint16_t dacProgress = map_num_in_range<uint16_t>(progress, 0, ADC_SAMPLE_COUNTER_LIMIT, 0, BIT_MAX_16);
-    bender->dac->write(bender->dacChan, dacProgress);
-    if (displayProgress == 15)
-    {
-        bender->dac->write(bender->dacChan, BENDER_DAC_ZERO);
-    }
-    
+    dispatch_input_event_ISR(ISR_ID_CHANNEL_TOUCH, TOUCH_INT_PINS[channelIndex], channelIndex);
 }
 
 void TouchChannel::logPeripherals() {
-    logger_log("\n** Channel ");
-    logger_log(this->channelIndex);
-    logger_log(" **");
-    logger_log("\nSX1509 connected: ");
-    logger_log(_leds->isConnected());
-    logger_log("\nGate Out state: ");
-    logger_log(gateOut.read());
-    logger_log("\nMPR121 Int Pin: ");
-    logger_log(touchPads->readInterruptPin());
-
-    logger_log("\nBender Mode: ");
-    logger_log(currBenderMode);
-    logger_log("\nBender ADC Value: ");
-    logger_log(bender->adc.read_u16());
-    bender->adc.log_noise_threshold_to_console("Bender");
-    logger_log("\nBender Min Bend: ");
-    logger_log(bender->adc.getInputMin());
-    logger_log("\nBender Max Bend: ");
-    logger_log(bender->adc.getInputMax());
-
-    logger_log("\nPitch Bend Range (index): ");
-    logger_log(output.getPitchBendRange());
+    LOG("\n** Channel %d **", (int)this->channelIndex);
+    LOG("\nSX1509 connected: %d", (int)_leds->isConnected());
+    LOG("\nGate Out state: %d", (int)gateOut.read());
+    LOG("\nMPR121 Int Pin: %d", (int)touchPads->readInterruptPin());
 
-    logger_log("\nSequence Length: ");
-    logger_log(sequence.length);
+    LOG("\nBender Mode: %d", currBenderMode);
+    LOG("\nBender ADC Value: %u", bender->adc.read_u16());
+    bender->adc.log_noise_threshold_to_console("Bender");
+    LOG("\nBender Min Bend: %u", (uint32_t)bender->adc.getInputMin());
+    LOG("\nBender Max Bend: %u", (uint32_t)bender->adc.getInputMax());
 
-    logger_log("\nSequence Quantization: ");
-    logger_log((int)sequence.quantizeAmount);
-    logger_log("\n");
+    LOG("\nPitch Bend Range (index): %d", (int)output.getPitchBendRange());
+    LOG("\nGlide Time: %d ms", (int)output.glide.getTime());
+    LOG("\nSequence Length: %d", (int)sequence.length);
+    LOG("\nSequence Quantization: %d\n", (int)sequence.quantizeAmount);
 }
 
 /**
@@ -1374,10 +1593,28 @@ void TouchChannel::copyConfigData(uint32_t *arr) {
     arr[0] = (uint32_t)this->playbackMode;
     arr[1] = this->currBenderMode;
     arr[2] = this->output.pbRangeIndex;
+    arr[3] = this->output.glide.getTime();
+    arr[4] = this->output.glide.getCurve();
 }
 
 void TouchChannel::loadConfigData(uint32_t *arr) {
     this->playbackMode = (TouchChannel::PlaybackMode)arr[0];
     this->currBenderMode = arr[1];
     this->output.setPitchBendRange(arr[2]);
+    this->output.glide.setTime(arr[3] > GLIDE_TIME_MAX ? 0 : arr[3]); // configs saved before glide existed hold garbage here
+    this->output.glide.setCurve(arr[4] > Glide::EXPONENTIAL ? Glide::LINEAR : (Glide::Curve)arr[4]);
+}
+
+/**
+ * @brief index into GLIDE_TIME_MAP of the current glide time (or the closest one below it)
+ */
+int TouchChannel::getGlideTimeIndex()
+{
+    int index = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        if (GLIDE_TIME_MAP[i] <= output.glide.getTime())
+            index = i;
+    }
+    return index;
 }
\ No newline at end of file
@@ -2,6 +2,9 @@
 
 using namespace DEGREE;
 
+// the top of the voltage map doesn't fit 16 bits, pitch is carried as an int32_t (Glide holds a 32.16 copy of it)
+static_assert(PITCH_MAX <= INT32_MAX, "pitch doesn't fit an int32_t");
+
 void VoltPerOctave::init()
 {
     dac->init();
@@ -18,7 +21,7 @@ void VoltPerOctave::setPitchBendRange(int value)
     {
         // NOTE: you may need to invert this value
         pbRangeIndex = value;
-        maxPitchBend = dacSemitone * PB_RANGE_MAP[pbRangeIndex]; // multiply semitone DAC value by the max desired number of semitones to be bent
+        maxPitchBend = PB_RANGE_MAP[pbRangeIndex] * PITCH_SEMITONE; // bends get resolved through the calibrated voltage map, so they stay in tune
     }
 }
 
@@ -33,10 +36,22 @@ void VoltPerOctave::setPitchBend(uint16_t value, bool direction)
     this->updateDAC();
 }
 
-void VoltPerOctave::setPitch(int index)
+/**
+ * @param index index to be mapped to voltage map. ranging 0..DAC_1VO_ARR_SIZE
+ * @param slew glide to the new pitch rather than jumping (only if this outputs glide time is greater than 0)
+ */
+void VoltPerOctave::setPitch(int index, bool slew)
 {
     if (index < DAC_1VO_ARR_SIZE) {
         currNoteIndex = index + 12;
+        if (currNoteIndex < DAC_1VO_ARR_SIZE)
+        {
+            // glide in pitch rather than DAC value, so a glide follows the calibrated voltage map between notes too
+            if (slew)
+                glide.setTarget(currNoteIndex * PITCH_SEMITONE);
+            else
+                glide.jump(currNoteIndex * PITCH_SEMITONE);
+        }
         this->updateDAC();
     }
 }
@@ -53,38 +68,87 @@ uint16_t VoltPerOctave::calculatePitchBend(uint16_t input, uint16_t min, uint16_
 }
 
 /**
- * @param index index to be mapped to voltage map. ranging 0..DAC_1VO_ARR_SIZE
- * @param pitchBend DAC value corrosponing to the amount of pitch bend to apply to output. positive or negative
+ * @brief apply the current pitch bend to a pitch
+ * @param pitch note index (fixed point, see PITCH_FRACTION_BITS), ie. wherever a glide between notes currently is
+ * @return DAC value to output
+*/
+uint16_t VoltPerOctave::calculateOutput(int32_t pitch)
+{
+    int32_t bend = bendDirection ? currPitchBend : -(int32_t)currPitchBend;
+    return resolvePitch(pitch + bend);
+}
+
+/**
+ * @brief Convert a fractional note index into a DAC value by interpolating between the two closest notes in the
+ * calibrated voltage map. Anything outside the map gets clamped to its first / last note.
+ *
+ * @param pitch note index (fixed point, see PITCH_FRACTION_BITS)
+ * @return DAC value
+ */
+uint16_t VoltPerOctave::resolvePitch(int32_t pitch)
+{
+    if (pitch < 0)
+        pitch = 0;
+    else if (pitch > PITCH_MAX)
+        pitch = PITCH_MAX;
+    int index = pitch >> PITCH_FRACTION_BITS;
+    int32_t fraction = pitch & (PITCH_SEMITONE - 1);
+    int32_t value = dacVoltageMap[index] + ((dacSemitoneMap[index] * fraction) >> PITCH_FRACTION_BITS);
+    return value < 0 ? 0 : value > BIT_MAX_16 ? BIT_MAX_16 : value;
+}
+
+/**
+ * @brief Precompute the distance between each note in the voltage map and the next one, so resolvePitch() is a single
+ * multiply. Must be called whenever dacVoltageMap changes (calibration, loading from flash, reset).
+ */
+void VoltPerOctave::updateSemitoneMap()
+{
+    for (int i = 0; i < DAC_1VO_ARR_SIZE - 1; i++)
+    {
+        dacSemitoneMap[i] = (int32_t)dacVoltageMap[i + 1] - (int32_t)dacVoltageMap[i];
+    }
+    dacSemitoneMap[DAC_1VO_ARR_SIZE - 1] = 0; // PITCH_MAX lands exactly on the last note
+}
+
+/**
+ * @brief write the current note plus pitch bend to the DAC.
+ * While a glide is running task_glide owns the DAC, and picks up any change in pitch bend on its next step.
 */
 void VoltPerOctave::updateDAC()
 {
-    if (currNoteIndex < DAC_1VO_ARR_SIZE)
+    if (currNoteIndex < DAC_1VO_ARR_SIZE && !glide.isActive())
     {
-        if (!bendDirection)
-        {
-            uint16_t nValue = dacVoltageMap[currNoteIndex] - currPitchBend;
-            if (nValue <= dacVoltageMap[currNoteIndex])
-            {
-                currOutput = nValue;
-            }
-        } else {
-            uint16_t pValue = dacVoltageMap[currNoteIndex] + currPitchBend;
-            if (pValue >= dacVoltageMap[currNoteIndex])
-            {
-                currOutput = pValue;
-            }
-        }
+        currOutput = calculateOutput(glide.read());
         dac->write(dacChannel, currOutput);
+        TRACE_IO(TRACE_OUTPUT_1VO + (int)dacChannel, currOutput);
     }
 }
 
+/**
+ * @brief advance a running glide by one step. Called by task_glide at GLIDE_RATE_HZ, which does the DAC write itself
+ * so that all four channels get updated in a single transfer.
+ *
+ * @return true if currOutput has a new value to be written to the DAC
+ */
+bool VoltPerOctave::stepGlide()
+{
+    if (!glide.tick())
+        return false;
+    currOutput = calculateOutput(glide.read());
+    if (!glide.isActive())
+        TRACE_IO(TRACE_OUTPUT_1VO + (int)dacChannel, currOutput); // only where a glide lands, every step would swamp the trace
+    return true;
+}
+
 /**
  * @brief Set the DAC to the lowest possible value this instance will allow (index 0 of voltage map);
  * 
  */
 void VoltPerOctave::resetDAC()
 {
+    glide.jump(0);
     dac->write(dacChannel, dacVoltageMap[0]);
+    TRACE_IO(TRACE_OUTPUT_1VO + (int)dacChannel, dacVoltageMap[0]);
 }
 
 /**
@@ -104,6 +168,7 @@ void VoltPerOctave::resetVoltageMap()
     {
         dacVoltageMap[i] = floor + (semitone * i);
     }
+    updateSemitoneMap();
 }
 
 void VoltPerOctave::logVoltageMap() {
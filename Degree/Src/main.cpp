@@ -1,5 +1,6 @@
 #include "main.h"
 #include "tim_api.h"
+#include "dwt_api.h"
 #include "logger.h"
 #include "SuperClock.h"
 #include "DigitalOut.h"
@@ -23,6 +24,10 @@
 #include "task_display.h"
 #include "task_interrupt_handler.h"
 #include "task_sequence_handler.h"
+#include "task_bender.h"
+#include "task_glide.h"
+#include "task_benchmark.h"
+#include "okTask.h"
 
 using namespace DEGREE;
 
@@ -53,8 +58,9 @@ SX1509 ledsD(&i2c3, SX1509_CHAN_D_ADDR);
 
 SuperClock superClock;
 
-uint16_t AnalogHandle::DMA_BUFFER[ADC_DMA_BUFF_SIZE] = {0, 0, 0, 0, 0, 0, 0, 0, 0};
-PinName AnalogHandle::ADC_PINS[ADC_DMA_BUFF_SIZE] = {ADC_A, ADC_B, ADC_C, ADC_D, PB_ADC_A, PB_ADC_B, PB_ADC_C, PB_ADC_D, TEMPO_POT};
+uint16_t AnalogHandle::DMA_BUFFER[ADC_DMA_BUFF_SIZE] = {0};
+uint16_t AnalogHandle::CV_DMA_BUFFER[ADC_CV_DMA_BUFF_SIZE] = {0};
+PinName AnalogHandle::ADC_PINS[ADC_INPUT_COUNT] = {ADC_A, ADC_B, ADC_C, ADC_D, PB_ADC_A, PB_ADC_B, PB_ADC_C, PB_ADC_D, TEMPO_POT};
 
 Degrees degrees(DEGREES_INT, &toggleSwitches);
 
@@ -70,6 +76,19 @@ TouchChannel chanD(3, &display, &touchD, &ledsD, &degrees, &dac1, DAC8554::CHAN_
 
 GlobalControl glblCtrl(&superClock, &chanA, &chanB, &chanC, &chanD, &globalTouch, &degrees, &buttons, &display);
 
+// every task stack is statically allocated, run `make ram-budget` to see where the RAM goes
+okStaticTask<RTOS_STACK_SIZE_MIN> loggerTask;
+okStaticTask<512> mainTask;
+okStaticTask<RTOS_STACK_SIZE_MIN> controllerTask;
+okStaticTask<RTOS_STACK_SIZE_MIN> interruptTask;
+okStaticTask<RTOS_STACK_SIZE_MAX / 4> sequencerTask;
+okStaticTask<RTOS_STACK_SIZE_MIN> displayTask;
+okStaticTask<RTOS_STACK_SIZE_MIN> benderTask;
+okStaticTask<RTOS_STACK_SIZE_MIN> glideTask;
+#ifdef BENCHMARK
+okStaticTask<512> benchmarkTask;
+#endif
+
 /**
  * @brief
  * NOTE: The stack used by a task will grow and shrink as the task executes and interrupts are processed.
@@ -83,10 +102,11 @@ void taskMain(void *pvParameters)
   glblCtrl.init();
 
   logger_log_task_watermark();
-  
+
   while (1)
   {
-    glblCtrl.poll(); // instead of polling, create a queue?
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // woken by glblCtrl.pollTimer
+    glblCtrl.poll();
   }
 }
 
@@ -97,21 +117,42 @@ int main(void)
 
   SystemClock_Config();
 
+  dwt_init();
+
   logger_init();
   logger_log("\nLogger Initialized\n");
   logger_log_system_config();
 
+#ifdef BENCHMARK
+  // `make bench` firmware for the emulator, the benchmark task is the only thing which runs
+  benchmarkTask.create(task_benchmark, "benchmark", &glblCtrl, RTOS_PRIORITY_HIGH + 2);
+  loggerTask.create(TASK_logger, "logger", NULL, RTOS_PRIORITY_LOW); // sends the results
+  vTaskStartScheduler();
+#endif
+
   multi_chan_adc_init();
   multi_chan_adc_start();
   HAL_Delay(100);
   
 
-  xTaskCreate(TASK_logger, "logger", RTOS_STACK_SIZE_MIN, NULL, RTOS_PRIORITY_LOW, NULL);
-  xTaskCreate(taskMain, "taskMain", 512, NULL, 1, &main_task_handle);
-  xTaskCreate(task_controller, "controller", RTOS_STACK_SIZE_MIN, &glblCtrl, RTOS_PRIORITY_HIGH, NULL);
-  xTaskCreate(task_interrupt_handler, "ISR handler", RTOS_STACK_SIZE_MIN, &glblCtrl, RTOS_PRIORITY_HIGH + 1, NULL);
-  xTaskCreate(task_sequence_handler, "sequencer", RTOS_STACK_SIZE_MAX / 4, &glblCtrl, RTOS_PRIORITY_HIGH, NULL);
-  xTaskCreate(task_display, "display", RTOS_STACK_SIZE_MIN, &display, RTOS_PRIORITY_LOW, NULL);
+  loggerTask.create(TASK_logger, "logger", NULL, RTOS_PRIORITY_LOW);
+  main_task_handle = mainTask.create(taskMain, "taskMain", NULL, 1);
+  controllerTask.create(task_controller, "controller", &glblCtrl, RTOS_PRIORITY_HIGH);
+  interruptTask.create(task_interrupt_handler, "ISR handler", &glblCtrl, RTOS_PRIORITY_HIGH + 1);
+  sequencerTask.create(task_sequence_handler, "sequencer", &glblCtrl, RTOS_PRIORITY_HIGH);
+  displayTask.create(task_display, "display", &display, RTOS_PRIORITY_LOW);
+  bender_task_handle = benderTask.create(task_bender, "bender", &glblCtrl, RTOS_PRIORITY_HIGH);
+  glide_task_handle = glideTask.create(task_glide, "glide", &glblCtrl, RTOS_PRIORITY_HIGH + 1);
+  glide_timer_init(glide_task_handle);
+
+  mem_telemetry_register_task(loggerTask);
+  mem_telemetry_register_task(mainTask);
+  mem_telemetry_register_task(controllerTask);
+  mem_telemetry_register_task(interruptTask);
+  mem_telemetry_register_task(sequencerTask);
+  mem_telemetry_register_task(displayTask);
+  mem_telemetry_register_task(benderTask);
+  mem_telemetry_register_task(glideTask);
 
   vTaskStartScheduler();
 
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "main.h"
+#include "logger.h"
+#include "dwt_api.h"
+#include "GlobalControl.h"
+
+#define BENCH_CLOCK_TICKS 1000 // PPQN pulses in the handleClock workload
+
+using namespace DEGREE;
+
+/**
+ * @brief DWT cycle counts of a single benchmark workload
+ */
+typedef struct BenchResult
+{
+    const char *name;
+    uint32_t iterations;
+    uint32_t total; // cycles summed over every iteration
+    uint32_t min;   // fastest iteration
+    uint32_t max;   // slowest iteration
+} BenchResult;
+
+void task_benchmark(void *params);
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "main.h"
+#include "GlobalControl.h"
+#include "MultiChanADC.h"
+
+#define BENDER_CONTROL_RATE_HZ 1000 // how often the benders get polled, must divide evenly into ADC_CONTROL_SAMPLE_RATE_HZ
+
+using namespace DEGREE;
+
+extern TaskHandle_t bender_task_handle;
+
+void task_bender(void *params);
+void suspend_bender_task();
+void resume_bender_task();
@@ -2,7 +2,17 @@
 
 #include "main.h"
 #include "Display.h"
+#include "task_stats.h"
+#include "okQueue.h"
 
+#define DISPLAY_QUEUE_LENGTH 96
+
+#define DISPLAY_FRAME_PERIOD           5  // ms between each frame of the display task
+#define DISPLAY_BLINK_PERIOD           30 // ms between each toggle of blinking scene LEDs
+#define DISPLAY_ANIMATION_QUEUE_LENGTH 8
+#define DISPLAY_MAX_ANIMATIONS         8  // animations running, or waiting on an overlapping one to finish
+#define DISPLAY_PROGRESS_BAR_SPEED     20 // ms for a progress bar to fill each column
+#define DISPLAY_PROGRESS_BAR_TIMEOUT   5000 // ms a progress bar waits on its percentage before giving up on the work
 
 extern TaskHandle_t display_task_handle;
 
@@ -14,7 +24,48 @@ enum struct DisplayAction
 };
 typedef enum DisplayAction DisplayAction;
 
+enum class AnimationType : uint8_t
+{
+    SPIRAL,       // light (or erase) a channels LEDs one by one in a spiral
+    SQUARE,       // light (or erase) the outer ring of a channels LEDs
+    FLASH,        // flash a set of LEDs on and off
+    PROGRESS_BAR, // fill the display column by column, up to a percentage
+    COLUMN_FADE   // fade the display from one brightness to another, one column at a time
+};
+
+/**
+ * @brief Animations get drawn by the display task on top of the current scene, so the task submitting one never waits on it.
+ * An animation which shares LEDs with an earlier one waits for that one to finish, so animations submitted back to back
+ * play in order. When an animation finishes its LEDs get redrawn from whatever the scene holds by then.
+ */
+typedef struct DisplayAnimation
+{
+    AnimationType type;
+    uint8_t pwm;      // brightness of lit LEDs
+    uint8_t target;   // PROGRESS_BAR: percent, COLUMN_FADE: brightness to fade to
+    uint8_t count;    // FLASH: number of flashes
+    bool reverse;     // SPIRAL: counter clockwise, COLUMN_FADE: right to left
+    bool erase;       // SPIRAL / SQUARE: start lit and turn LEDs off, PROGRESS_BAR: take the running bar off the display
+    int8_t chan;      // SPIRAL / SQUARE: channel index
+    uint16_t period;  // ms between each step
+    uint64_t mask;    // every LED the animation draws to
+    // state of a running animation, owned by the display task
+    bool started;
+    uint8_t step;
+    uint16_t elapsed;
+    uint16_t idle;    // PROGRESS_BAR: ms spent holding since the percentage last changed
+} DisplayAnimation;
+
 void task_display(void *params);
+void display_wake();
+
+void display_animate(DisplayAnimation animation);
+void display_animate_spiral(int chan, bool clockwise, bool erase, uint8_t pwm, uint16_t speed);
+void display_animate_square(int chan, bool erase, uint8_t pwm, uint16_t speed);
+void display_animate_flash(uint64_t mask, uint8_t pwm, int flashes, uint16_t speed);
+void display_animate_progress(uint8_t percent, uint8_t pwm);
+void display_animate_progress_cancel();
+void display_animate_column_fade(uint8_t from, uint8_t to, bool reverse, uint16_t speed);
 
 void dispatch_display_action(DisplayAction action, CHAN channel, uint16_t data);
 void dispatch_display_action_isr(DisplayAction action, CHAN channel, uint16_t data);
\ No newline at end of file
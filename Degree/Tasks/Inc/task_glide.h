@@ -0,0 +1,18 @@
+#pragma once
+
+#include "main.h"
+#include "GlobalControl.h"
+#include "Glide.h"
+#include "SPI.h"
+
+// DAC8554 control byte (first byte of each 24-bit frame)
+#define DAC8554_LOAD_BUFFER  0x00 // LD1 LD0 = 00, store the value in the channels buffer only
+#define DAC8554_LOAD_ALL     0x20 // LD1 LD0 = 10, store the value, then update every channel from its buffer at once
+#define DAC8554_CHANNEL_SELECT(chan) ((chan) << 1)
+#define DAC8554_FRAME_SIZE 3
+
+using namespace DEGREE;
+
+extern TaskHandle_t glide_task_handle;
+
+void task_glide(void *params);
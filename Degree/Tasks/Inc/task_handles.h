@@ -30,7 +30,23 @@ enum CTRL_ACTION
 };
 typedef enum CTRL_ACTION CTRL_ACTION;
 
+/**
+ * @brief every input interrupt gets posted to qhInterruptQueue as one of these
+ */
+typedef struct InputEvent
+{
+    uint8_t source;     // ISR_ID_XXX
+    uint8_t pin;        // PinName of the interrupt line which fired
+    uint8_t channel;    // channel index for per-channel sources (ie. ISR_ID_CHANNEL_TOUCH)
+    uint32_t timestamp; // DWT cycle count at the time of the interrupt
+} InputEvent;
+
+extern uint32_t input_events_dropped;
+
 CTRL_ACTION noti_get_command(uint32_t notification);
 uint8_t noti_get_channel(uint32_t notification);
 
-void ctrl_dispatch(CTRL_ACTION action, uint8_t channel, uint16_t data);
\ No newline at end of file
+void ctrl_dispatch(CTRL_ACTION action, uint8_t channel, uint16_t data);
+
+void dispatch_input_event_ISR(uint8_t source, uint8_t pin, uint8_t channel);
+void ack_channel_touch_event(uint8_t channel);
\ No newline at end of file
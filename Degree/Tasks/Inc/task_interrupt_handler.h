@@ -2,8 +2,12 @@
 
 #include "main.h"
 #include "logger.h"
+#include "dwt_api.h"
 #include "GlobalControl.h"
+#include "okQueue.h"
+
+#define INPUT_EVENT_QUEUE_LENGTH 64
 
 using namespace DEGREE;
 
-void task_interrupt_handler(void *params);
\ No newline at end of file
+void task_interrupt_handler(void *params);
@@ -3,6 +3,9 @@
 #include "main.h"
 #include "logger.h"
 #include "GlobalControl.h"
+#include "okQueue.h"
+
+#define SEQUENCER_QUEUE_LENGTH 96
 
 using namespace DEGREE;
 
@@ -20,13 +23,19 @@ enum class SEQ
     QUANTIZE,
     CORRECT,
     HANDLE_TOUCH,
-    HANDLE_SELECT_PAD,
     HANDLE_DEGREE,
-    DISPLAY
+    DISPLAY,
+    UNDO,
+    REDO,
+    MIDI_NOTE,
+    COPY,        // data: source channel
+    SONG_APPEND,
+    SONG_CLEAR
 };
 typedef enum SEQ SEQ;
 
 void task_sequence_handler(void *params);
+void sequencer_handle_event(TouchChannel **channels, TouchChannel **core_channels, uint32_t event);
 void dispatch_sequencer_event(CHAN channel, SEQ event, uint16_t position);
 void dispatch_sequencer_event_ISR(CHAN channel, SEQ event, uint16_t position);
 void suspend_sequencer_task();
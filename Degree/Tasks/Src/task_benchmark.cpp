@@ -0,0 +1,232 @@
+#include "task_benchmark.h"
+
+/**
+ * Benchmark firmware (make bench), meant to be run in Renode with bench.py.
+ *
+ * Runs a fixed set of workloads over the hot paths of the sequencer and channels, timing every iteration with the
+ * DWT cycle counter, and prints one line per workload once they have all finished:
+ *
+ *   BENCH_BEGIN <firmware version> <core clock>
+ *   BENCH <workload> <iterations> <avg cycles> <min cycles> <max cycles>
+ *   BENCH_END
+ *
+ * BENCHMARK builds don't touch the I2C / SPI buses (see I2C::write() and SPI::write()), so the numbers are CPU time
+ * only, and they don't need any peripherals to be modelled by the emulator.
+ */
+
+#define BENCH_MAX_RESULTS 16
+#define BENCH_QUANTIZE_ITERATIONS 32
+#define BENCH_CLEAR_ITERATIONS 8
+#define BENCH_CV_SWEEP_STEP 16        // 12-bit ADC samples between each handleCVInput() call
+#define BENCH_BENDER_SWEEP_STEP 64    // 16-bit ADC values between each Bender::calculateOutput() call
+#define BENCH_DENSE_SPACING (PPQN / 4) // a note every 16th for the whole sequence (256 touch events)
+#define BENCH_SPARSE_SPACING (PPQN * 4) // a note every bar (16 touch events)
+
+static BenchResult results[BENCH_MAX_RESULTS];
+static int resultCount = 0;
+static volatile uint32_t bench_sink; // keeps the compiler from optimizing away work whose result goes unused
+
+static BenchResult *bench_start(const char *name)
+{
+    BenchResult *result = &results[resultCount++];
+    result->name = name;
+    result->iterations = 0;
+    result->total = 0;
+    result->min = UINT32_MAX;
+    result->max = 0;
+    return result;
+}
+
+static void bench_record(BenchResult *result, uint32_t cycles)
+{
+    result->iterations++;
+    result->total += cycles;
+    if (cycles < result->min)
+        result->min = cycles;
+    if (cycles > result->max)
+        result->max = cycles;
+}
+
+/**
+ * @brief fill the whole sequence with note on / off pairs. Note ons land a few pulses off the grid, so quantizing has
+ * something to move
+ *
+ * @param spacing PPQN between each note on
+ */
+static void bench_fill_sequence(SuperSeq *seq, int spacing)
+{
+    seq->clearAllEvents();
+    seq->setLength(MAX_SEQ_LENGTH);
+    for (int pos = 0, note = 0; pos < seq->lengthPPQN; pos += spacing, note++)
+    {
+        int noteOn = pos + note % 5;
+        seq->createTouchEvent(noteOn, note % DEGREE_COUNT, note % OCTAVE_COUNT, HIGH);
+        seq->createTouchEvent(noteOn + spacing / 2, note % DEGREE_COUNT, note % OCTAVE_COUNT, LOW);
+    }
+    seq->eventsChanged();
+}
+
+static void bench_quantize(const char *name, SuperSeq *seq, int spacing)
+{
+    bench_fill_sequence(seq, spacing);
+    seq->setQuantizeAmount(QUANT::SIXTEENTH);
+    BenchResult *result = bench_start(name);
+    for (int i = 0; i < BENCH_QUANTIZE_ITERATIONS; i++)
+    {
+        uint32_t start = dwt_get_cycles();
+        seq->indexQuantizedEvents();
+        seq->updateQuantizedPositions();
+        bench_record(result, dwt_get_cycles() - start);
+    }
+    bench_sink = seq->quantizedEventCount;
+}
+
+static void bench_clear_all_events(SuperSeq *seq)
+{
+    BenchResult *result = bench_start("clear_all_events");
+    for (int i = 0; i < BENCH_CLEAR_ITERATIONS; i++)
+    {
+        bench_fill_sequence(seq, BENCH_DENSE_SPACING);
+        uint32_t start = dwt_get_cycles();
+        seq->clearAllEvents();
+        bench_record(result, dwt_get_cycles() - start);
+    }
+}
+
+/**
+ * @brief encode / decode every position of a sequence, the way it gets saved to and loaded from flash. Each iteration
+ * covers the whole sequence
+ */
+static void bench_encode_decode(SuperSeq *seq)
+{
+    uint32_t data[PPQN]; // one step at a time, a whole sequence worth won't fit on the stack
+    bench_fill_sequence(seq, BENCH_DENSE_SPACING);
+
+    BenchResult *encode = bench_start("encode_event_data");
+    BenchResult *decode = bench_start("decode_event_data");
+    for (int i = 0; i < BENCH_QUANTIZE_ITERATIONS; i++)
+    {
+        uint32_t encodeCycles = 0;
+        uint32_t decodeCycles = 0;
+        for (int step = 0; step < MAX_SEQ_LENGTH; step++)
+        {
+            uint32_t start = dwt_get_cycles();
+            for (int j = 0; j < PPQN; j++)
+                data[j] = seq->encodeEventData(step * PPQN + j);
+            encodeCycles += dwt_get_cycles() - start;
+
+            start = dwt_get_cycles();
+            for (int j = 0; j < PPQN; j++)
+                seq->decodeEventData(step * PPQN + j, data[j]);
+            decodeCycles += dwt_get_cycles() - start;
+        }
+        bench_record(encode, encodeCycles);
+        bench_record(decode, decodeCycles);
+    }
+}
+
+/**
+ * @brief sweep the CV input from 0V to max and back down again in quantizer mode
+ */
+static void bench_cv_input(TouchChannel *channel)
+{
+    channel->setPlaybackMode(TouchChannel::QUANTIZER);
+    channel->adc.disableFilter(); // every sample should land, not ease towards the target
+    BenchResult *result = bench_start("handle_cv_input");
+    for (int direction = 0; direction < 2; direction++)
+    {
+        for (int i = 0; i < BIT_MAX_12; i += BENCH_CV_SWEEP_STEP)
+        {
+            channel->adc.sampleReadyCallback(direction == 0 ? i : BIT_MAX_12 - i);
+            uint32_t start = dwt_get_cycles();
+            channel->handleCVInput();
+            bench_record(result, dwt_get_cycles() - start);
+        }
+    }
+}
+
+static void bench_bender_output(Bender *bender)
+{
+    // a typical calibration, idle in the middle with a little less range when bending down
+    bender->adc.avgValueWhenIdle = BENDER_DAC_ZERO;
+    bender->adc.setInputMin(6000);
+    bender->adc.setInputMax(60000);
+    BenchResult *result = bench_start("bender_calculate_output");
+    for (uint32_t value = 0; value <= BIT_MAX_16; value += BENCH_BENDER_SWEEP_STEP)
+    {
+        uint32_t start = dwt_get_cycles();
+        bench_sink = bender->calculateOutput((uint16_t)value);
+        bench_record(result, dwt_get_cycles() - start);
+    }
+}
+
+/**
+ * @brief every channel looping a sequence, two of them quantized. Each iteration is one pulse of the sequencer task
+ * (see SEQ::ADVANCE in task_sequence_handler)
+ */
+static void bench_handle_clock(GlobalControl *ctrl)
+{
+    TouchChannel *core_channels[SEQ_CORE_MAX_CHANNELS];
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+    {
+        TouchChannel *channel = ctrl->channels[i];
+        core_channels[channel->sequence.coreIndex] = channel;
+        bench_fill_sequence(&channel->sequence, i % 2 ? BENCH_SPARSE_SPACING : BENCH_DENSE_SPACING);
+        if (i >= 2)
+            channel->sequence.enableQuantize();
+        channel->setPlaybackMode(TouchChannel::MONO_LOOP);
+        channel->sequence.reset();
+    }
+
+    BenchResult *result = bench_start("handle_clock_4ch");
+    for (int tick = 0; tick < BENCH_CLOCK_TICKS; tick++)
+    {
+        uint32_t start = dwt_get_cycles();
+        uint32_t wake = seq_core_advance();
+        while (wake)
+        {
+            int i = __builtin_ctz(wake);
+            wake &= wake - 1;
+            core_channels[i]->handleClock();
+        }
+        bench_record(result, dwt_get_cycles() - start);
+    }
+}
+
+/**
+ * @brief The only task running in BENCHMARK builds. Runs every workload, prints the results and then idles
+ *
+ * @param params global control
+ */
+void task_benchmark(void *params)
+{
+    GlobalControl *ctrl = (GlobalControl *)params;
+
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+    {
+        ctrl->channels[i]->initOutputs();
+        ctrl->channels[i]->init();
+    }
+    vTaskDelay(100); // let the logger drain whatever init() printed, so UART interrupts don't land in the timings
+
+    bench_quantize("quantize_dense", &ctrl->channels[0]->sequence, BENCH_DENSE_SPACING);
+    bench_quantize("quantize_sparse", &ctrl->channels[0]->sequence, BENCH_SPARSE_SPACING);
+    bench_clear_all_events(&ctrl->channels[0]->sequence);
+    bench_encode_decode(&ctrl->channels[0]->sequence);
+    bench_cv_input(ctrl->channels[1]);
+    bench_bender_output(ctrl->channels[2]->bender);
+    bench_handle_clock(ctrl);
+
+    LOG("\nBENCH_BEGIN %s %u\n", FIRMWARE_VERSION, SystemCoreClock);
+    for (int i = 0; i < resultCount; i++)
+    {
+        BenchResult *result = &results[i];
+        LOG("BENCH %s %u %u %u %u\n", result->name, result->iterations, result->total / result->iterations, result->min, result->max);
+    }
+    LOG("BENCH_END\n");
+
+    while (1)
+    {
+        vTaskDelay(portMAX_DELAY);
+    }
+}
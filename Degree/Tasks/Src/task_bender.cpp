@@ -0,0 +1,42 @@
+#include "task_bender.h"
+
+TaskHandle_t bender_task_handle;
+
+/**
+ * @brief Control rate task for the benders. Runs the bender state machines, pitch bend and bender DAC output at a fixed
+ * rate, woken by the ADC task right after each new sample has been filtered, so bends are equally smooth at any tempo.
+ *
+ * Anything tied to the clock (recording bend events, ratchets) stays in the sequencer, which reads the latest bend
+ * from Bender::currBend once per PPQN.
+ *
+ * @param params global control
+ */
+void task_bender(void *params)
+{
+    GlobalControl *ctrl = (GlobalControl *)params;
+    bender_task_handle = xTaskGetCurrentTaskHandle();
+    AnalogHandle::notifyEverySamples(bender_task_handle, ADC_CONTROL_SAMPLE_RATE_HZ / BENDER_CONTROL_RATE_HZ);
+    while (1)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        for (int i = 0; i < CHANNEL_COUNT; i++)
+        {
+            ctrl->channels[i]->pollBender();
+        }
+    }
+}
+
+/**
+ * @brief the benders are part of playback, so they get suspended along with the sequencer (see suspend_sequencer_task())
+ */
+void suspend_bender_task()
+{
+    if (bender_task_handle)
+        vTaskSuspend(bender_task_handle);
+}
+
+void resume_bender_task()
+{
+    if (bender_task_handle)
+        vTaskResume(bender_task_handle);
+}
@@ -8,6 +8,8 @@ static bool slopeIsPositive = false;               // which direction the signal
 static float signalAverageFrequency = 0;           // running average of signal frequency
 static uint16_t prev_adc_sample = 0;
 
+static StaticSemaphore_t sem_obtain_freq_buffer;
+static StaticSemaphore_t sem_calibrate_buffer;
 SemaphoreHandle_t sem_obtain_freq;
 SemaphoreHandle_t sem_calibrate;
 
@@ -26,13 +28,12 @@ void taskObtainSignalFrequency(void *params)
     int frequencySampleCounter = 0;  // index for storing new frequency sample into freqSamples array
     float avgFrequencySum = 0;       // the sum of all new frequency samples (for calculating a running average afterwards)
 
-    int CALIBRATION_SAMPLE_RATE_HZ = 16000;   // set ADC timer overflow frequency to 16000hz (twice the freq of B8)
     int MAX_FREQ_SAMPLES = 25;               // how many frequency calculations we want to use to obtain our average frequency prediction of the input. The higher the number, the more accurate the result
     int ZERO_CROSS_THRESHOLD = 1000;          // for handling hysterisis at zero crossing point NOTE: If set around 500 freq readings become very unstable
 
     channel->adc.disableFilter(); // must not filter ADC input
     
-    multi_chan_adc_set_sample_rate(&hadc1, &htim3, CALIBRATION_SAMPLE_RATE_HZ); // set ADC timer overflow frequency to 16000hz (twice the freq of B8)
+    channel->adc.setSampleRate(ADC_CV_SAMPLE_RATE_HZ); // every sample the CV ADC takes, 16000hz (twice the freq of B8)
 
     // sample peak to peak;
     okSemaphore *sem = channel->adc.beginMinMaxSampling(2000); // sampling time should be longer than the lowest possible note frequency
@@ -41,8 +42,9 @@ void taskObtainSignalFrequency(void *params)
     channel->adc.queueSample = true;
     signalZeroCrossing = channel->adc.getInputMedian();
 
-    sem_obtain_freq = xSemaphoreCreateBinary();
-    sem_calibrate = xSemaphoreCreateBinary();
+    // re-created in the same static buffers on every calibration, the tasks which used them last time have been deleted
+    sem_obtain_freq = xSemaphoreCreateBinaryStatic(&sem_obtain_freq_buffer);
+    sem_calibrate = xSemaphoreCreateBinaryStatic(&sem_calibrate_buffer);
 
     uint16_t sample = 0;
 
@@ -67,7 +69,7 @@ void taskObtainSignalFrequency(void *params)
         else if (curr_adc_sample <= (signalZeroCrossing - ZERO_CROSS_THRESHOLD) && prev_adc_sample > (signalZeroCrossing - ZERO_CROSS_THRESHOLD) && !slopeIsPositive)
         {
             float vcoPeriod = numSamplesTaken;                                                // how many samples have occurred between positive zero crossings
-            vcoFrequency = (float)multi_chan_adc_get_sample_rate(&hadc1, &htim3) / vcoPeriod; // sample rate divided by period of input signal
+            vcoFrequency = (float)channel->adc.getSampleRate() / vcoPeriod;                   // sample rate divided by period of input signal
             numSamplesTaken = 0;                                                              // reset sample count to zero for the next sampling routine
 
             // NOTE: you could eliminate the freqSamples array by first, ignoring the first iteration of sampling, and then just adding
@@ -128,23 +130,15 @@ void taskCalibrate(void *params)
             newDacValue = channel->output.dacVoltageMap[iteration]; // initialize the dac value
             initialPitchIndex = arr_find_closest_float(const_cast<float *>(PITCH_FREQ_ARR), NUM_PITCH_FREQENCIES, currAvgFreq);
             initialized = true;
-            logger_log("\n** CALIBRATION BEGIN ** ");
-            logger_log("\Channel: ");
-            logger_log(channel->channelIndex);
-            logger_log("\nStarting Frequency: ");
-            logger_log(currAvgFreq);
-            logger_log("\nStarting DAC Value: ");
-            logger_log(newDacValue);
-            logger_log("\nTarget Frequency: ");
-            logger_log(PITCH_FREQ_ARR[initialPitchIndex]);
+            LOG("\n** CALIBRATION BEGIN ** ");
+            LOG("\nChannel: %d", (int)channel->channelIndex);
+            LOG("\nStarting Frequency: %f", currAvgFreq);
+            LOG("\nStarting DAC Value: %u", newDacValue);
+            LOG("\nTarget Frequency: %f", PITCH_FREQ_ARR[initialPitchIndex]);
 
             if (initialPitchIndex + DAC_1VO_ARR_SIZE > NUM_PITCH_FREQENCIES) // if the starting PITCH_FREQ_ARR index is too high, you will overshoot the array. Must notify the UI to lower VCO input frequency
             {
-                logger_log("\nVCO Input Frequency Too High. ");
-                logger_log("INDEX: ");
-                logger_log(initialPitchIndex);
-                logger_log("\nMust be less than -> ");
-                logger_log(NUM_PITCH_FREQENCIES - DAC_1VO_ARR_SIZE);
+                LOG("\nVCO Input Frequency Too High. INDEX: %d\nMust be less than -> %d", (int)initialPitchIndex, NUM_PITCH_FREQENCIES - DAC_1VO_ARR_SIZE);
                 // what is the maximum starting target frequency?
             }
             
@@ -158,25 +152,16 @@ void taskCalibrate(void *params)
         if ((currAvgFreq <= targetFreq + TUNING_TOLERANCE && currAvgFreq >= targetFreq - TUNING_TOLERANCE) || calibrationAttemps > MAX_CALIB_ATTEMPTS)
         {
             channel->output.dacVoltageMap[iteration] = newDacValue > BIT_MAX_16 ? BIT_MAX_16 : newDacValue; // replace current DAC value with adjusted value (NOTE: must cap value or else it will roll over to zero)
-            logger_log("\ni= ");
-            logger_log(iteration);
-            logger_log(" :: x= ");
-            logger_log(targetFreqIndex);
-            logger_log(" :: dac= ");
-            logger_log(newDacValue);
-            logger_log(" :: target freq= ");
-            logger_log(targetFreq);
-            logger_log(" :: actual freq= ");
-            logger_log(currAvgFreq);
-            logger_log(" :: attempts= ");
-            logger_log(calibrationAttemps);
+            LOG("\ni= %d :: x= %d :: dac= %u :: target freq= %f :: actual freq= %f :: attempts= %d",
+                (int)iteration, targetFreqIndex, newDacValue, targetFreq, currAvgFreq, (int)calibrationAttemps);
 
             int ledIndex = map_num_in_range<int>(iteration, 0, DAC_1VO_ARR_SIZE, 0, 63);
-            channel->display->setLED(ledIndex, PWM::PWM_HIGH, false);
+            channel->display->setLED(ledIndex, PWM::PWM_HIGH, false, LAYER::MENU);
 
             // if we are on the final iteration, then some how breakout of all this crap.
             if (iteration == DAC_1VO_ARR_SIZE - 1) {
-                logger_log("\n\n*** CALIBRATION FINISHED ***");
+                LOG("\n\n*** CALIBRATION FINISHED ***");
+                channel->output.updateSemitoneMap();
                 // send a notification to exitCalibration task
                 ctrl_dispatch(CTRL_ACTION::EXIT_1VO_CALIBRATION, channel->channelIndex, 0);
             }
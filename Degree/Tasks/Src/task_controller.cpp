@@ -1,5 +1,10 @@
 #include "task_controller.h"
 
+// calibration tasks only exist while calibrating, but they get their own static stacks so starting a calibration can't fail
+static okStaticTask<RTOS_STACK_SIZE_MIN> tunerTask;
+static okStaticTask<RTOS_STACK_SIZE_MIN> detectorTask;
+static okStaticTask<RTOS_STACK_SIZE_MIN> calibrateTask;
+
 void task_controller(void *params)
 {
     GlobalControl *controller = (GlobalControl *)params;
@@ -27,10 +32,10 @@ void task_controller(void *params)
             for (int i = 0; i < 4; i++)
             {
                 controller->channels[i]->adc.queueSample = false;
+                controller->channels[i]->adc.setSampleRate(CV_INPUT_SAMPLE_RATE_HZ);
             }
             
             // offload all this shit to a task with a much higher stack size
-            multi_chan_adc_set_sample_rate(&hadc1, &htim3, ADC_SAMPLE_RATE_HZ);
 
             controller->saveCalibrationDataToFlash();
 
@@ -44,19 +49,18 @@ void task_controller(void *params)
             break;
 
         case CTRL_ACTION::ENTER_VCO_TUNING:
-            xTaskCreate(task_tuner, "tuner", RTOS_STACK_SIZE_MIN, controller->channels[channel], RTOS_PRIORITY_HIGH, &tuner_task_handle);
-            xTaskCreate(taskObtainSignalFrequency, "detector", RTOS_STACK_SIZE_MIN, controller->channels[channel], RTOS_PRIORITY_MED, &thStartCalibration);
+            tuner_task_handle = tunerTask.create(task_tuner, "tuner", controller->channels[channel], RTOS_PRIORITY_HIGH);
+            thStartCalibration = detectorTask.create(taskObtainSignalFrequency, "detector", controller->channels[channel], RTOS_PRIORITY_MED);
             break;
 
         case CTRL_ACTION::EXIT_VCO_TUNING:
             vTaskDelete(tuner_task_handle);
-            controller->display->setColumn(7, PWM::PWM_HIGH, false);
-            controller->display->setColumn(8, PWM::PWM_HIGH, false);
-            controller->display->flash(3, 200);
-            controller->display->clear();
-            controller->display->fill(30, true);
+            controller->display->clear(LAYER::MENU);
+            controller->display->fill(30, true, LAYER::MENU);
+            display_animate_flash(Display::columnMask(7) | Display::columnMask(8), PWM::PWM_HIGH, 3, 200);
             controller->mode = GlobalControl::VCO_CALIBRATION;
-            xTaskCreate(taskCalibrate, "calibrate", RTOS_STACK_SIZE_MIN, controller->channels[controller->selectedChannel], RTOS_PRIORITY_MED, &thCalibrate);
+            controller->publishUIState();
+            thCalibrate = calibrateTask.create(taskCalibrate, "calibrate", controller->channels[controller->selectedChannel], RTOS_PRIORITY_MED);
             break;
 
         case CTRL_ACTION::ADC_SAMPLING_PROGRESS:
@@ -72,6 +76,5 @@ void task_controller(void *params)
         default:
             break;
         }
-        logger_log_task_watermark(); // TODO: delete for production
     }
 }
\ No newline at end of file
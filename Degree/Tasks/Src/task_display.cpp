@@ -1,11 +1,24 @@
 #include "task_display.h"
 
 TaskHandle_t display_task_handle;
-QueueHandle_t display_queue;
+static okQueue<uint32_t, DISPLAY_QUEUE_LENGTH> display_q;
+QueueHandle_t display_queue = display_q.handle;
+static okQueue<DisplayAnimation, DISPLAY_ANIMATION_QUEUE_LENGTH> animation_q;
+QueueHandle_t animation_queue = animation_q.handle;
+
+static DisplayAnimation animations[DISPLAY_MAX_ANIMATIONS]; // in the order they were submitted
+static int animationCount = 0;
+
+static void receive_animations();
+static void advance_animations(Display *display);
+
 /**
  * @brief the purpose of this task is to manage the state of the display, so you can blink and dim the LEDs in the background, without having to update
  * the entire display as well as manage the displays state in child components ie. the TouchChannel class etc.
  *
+ * It also draws every animation submitted via display_animate(), so no other task has to wait on the display.
+ * While nothing is animating or blinking the task sleeps until display_wake() gets called.
+ *
  * @param params
  */
 void task_display(void *params)
@@ -17,25 +30,354 @@ void task_display(void *params)
     display->setBlinkStatus(3, true);
 
     display_task_handle = xTaskGetCurrentTaskHandle();
-    display_queue = xQueueCreate(96, sizeof(uint32_t));
+    trace_register_queue(display_queue, "display");
+    trace_register_queue(animation_queue, "animation");
     
-    uint32_t action;
     TickType_t xLastWakeTime;
-    const TickType_t xFrequency = 30;
+    const TickType_t xFrequency = DISPLAY_FRAME_PERIOD;
+    int blinkTimer = 0;
 
     // Initialise the xLastWakeTime variable with the current time.
     xLastWakeTime = xTaskGetTickCount();
 
     while (1)
     {
-        // xQueueReceive(display_queue, &action, portMAX_DELAY);
-        
+        if (animationCount == 0 && uxQueueMessagesWaiting(animation_queue) == 0 && !display->isBlinking())
+        {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            xLastWakeTime = xTaskGetTickCount();
+            blinkTimer = 0;
+        }
+
         // Wait for the next cycle.
-        vTaskDelayUntil(&xLastWakeTime, xFrequency);
+        task_delay_until(&xLastWakeTime, xFrequency);
+
+        receive_animations();
+        advance_animations(display);
+
+        blinkTimer += DISPLAY_FRAME_PERIOD;
+        if (blinkTimer >= DISPLAY_BLINK_PERIOD)
+        {
+            blinkTimer = 0;
+            display->blinkScene();
+        }
+    }
+}
+
+/**
+ * @brief move newly submitted animations into the active list. A progress bar which is already running gets
+ * its percentage updated (or gets cancelled) instead of being queued behind itself.
+ */
+static void receive_animations()
+{
+    DisplayAnimation animation;
+    while (animationCount < DISPLAY_MAX_ANIMATIONS && xQueueReceive(animation_queue, &animation, 0) == pdTRUE)
+    {
+        if (animation.type == AnimationType::PROGRESS_BAR)
+        {
+            int i = 0;
+            // skip a bar which was cancelled or filled, it is on its way out
+            while (i < animationCount &&
+                   (animations[i].type != AnimationType::PROGRESS_BAR || animations[i].step >= DISPLAY_COLUMN_COUNT))
+                i++;
+            if (i < animationCount && animation.erase)
+            {
+                if (animations[i].started)
+                {
+                    animations[i].step = DISPLAY_COLUMN_COUNT; // finishes on its next step, handing the LEDs back
+                }
+                else
+                {
+                    animationCount--;
+                    for (int j = i; j < animationCount; j++)
+                        animations[j] = animations[j + 1];
+                }
+                continue;
+            }
+            if (i < animationCount)
+            {
+                if (animation.target != animations[i].target)
+                    animations[i].idle = 0;
+                animations[i].target = animation.target;
+                continue;
+            }
+            if (animation.erase)
+                continue; // nothing to cancel
+        }
+        animation.started = false;
+        animation.step = 0;
+        animation.elapsed = 0;
+        animation.idle = 0;
+        animations[animationCount++] = animation;
+    }
+}
+
+static int animation_length(DisplayAnimation *animation)
+{
+    switch (animation->type)
+    {
+    case AnimationType::SPIRAL:
+        return DISPLAY_SPIRAL_LENGTH;
+    case AnimationType::SQUARE:
+        return DISPLAY_SQUARE_LENGTH;
+    case AnimationType::FLASH:
+        return animation->count * 2;
+    case AnimationType::PROGRESS_BAR:
+    case AnimationType::COLUMN_FADE:
+        return DISPLAY_COLUMN_COUNT;
+    }
+    return 0;
+}
+
+/**
+ * @brief take over the animations LEDs and draw its first frame
+ */
+static void start_animation(Display *display, DisplayAnimation *animation)
+{
+    uint8_t pwm;
+    switch (animation->type)
+    {
+    case AnimationType::SPIRAL:
+    case AnimationType::SQUARE:
+        pwm = animation->erase ? animation->pwm : 0;
+        break;
+    case AnimationType::PROGRESS_BAR:
+        pwm = 0;
+        break;
+    default:
+        pwm = animation->pwm;
+        break;
+    }
+    for (int i = 0; i < DISPLAY_LED_COUNT; i++)
+    {
+        if (animation->mask & DISPLAY_LED_MASK(i))
+            display->setOverlayLED(i, pwm);
+    }
+    animation->started = true;
+}
+
+/**
+ * @brief draw the next step of an animation
+ *
+ * @return false once the animation has finished
+ */
+static bool step_animation(Display *display, DisplayAnimation *animation)
+{
+    int length = animation_length(animation);
+    if (animation->step >= length)
+        return false;
+
+    int index = animation->reverse ? (length - 1) - animation->step : animation->step;
+    uint8_t pwm = animation->erase ? 0 : animation->pwm;
+
+    switch (animation->type)
+    {
+    case AnimationType::SPIRAL:
+        display->setOverlayLED(CHAN_DISPLAY_LED_MAP[animation->chan][DISPLAY_SPIRAL_LED_MAP[index]], pwm);
+        break;
+    case AnimationType::SQUARE:
+        display->setOverlayLED(CHAN_DISPLAY_LED_MAP[animation->chan][DISPLAY_SQUARE_LED_MAP[index]], pwm);
+        break;
+    case AnimationType::FLASH:
+        pwm = (animation->step % 2) ? animation->pwm : 0;
+        for (int i = 0; i < DISPLAY_LED_COUNT; i++)
+        {
+            if (animation->mask & DISPLAY_LED_MASK(i))
+                display->setOverlayLED(i, pwm);
+        }
+        break;
+    case AnimationType::PROGRESS_BAR:
+        // hold on the last filled column until the percentage catches up, or the work looks to have been abandoned
+        if (animation->step >= (animation->target * DISPLAY_COLUMN_COUNT) / 100)
+        {
+            animation->idle += animation->period;
+            return animation->idle < DISPLAY_PROGRESS_BAR_TIMEOUT;
+        }
+        for (int row = 0; row < DISPLAY_ROW_COUNT; row++)
+            display->setOverlayLED(row * DISPLAY_COLUMN_COUNT + animation->step, animation->pwm);
+        break;
+    case AnimationType::COLUMN_FADE:
+        for (int row = 0; row < DISPLAY_ROW_COUNT; row++)
+            display->setOverlayLED(row * DISPLAY_COLUMN_COUNT + index, animation->target);
+        break;
+    }
+    animation->step++;
+    return true;
+}
+
+/**
+ * @brief start any animation which no longer overlaps an earlier one, step each running animation which is due,
+ * and hand the LEDs of finished animations back to the scene
+ */
+static void advance_animations(Display *display)
+{
+    uint64_t claimed = 0; // LEDs of every animation submitted before the current one
+    int i = 0;
+    while (i < animationCount)
+    {
+        DisplayAnimation *animation = &animations[i];
+        bool running = true;
+        if (!animation->started)
+        {
+            if (animation->mask & claimed)
+            {
+                claimed |= animation->mask;
+                i++;
+                continue;
+            }
+            start_animation(display, animation);
+        }
+        else
+        {
+            animation->elapsed += DISPLAY_FRAME_PERIOD;
+            if (animation->elapsed >= animation->period)
+            {
+                animation->elapsed = 0;
+                running = step_animation(display, animation);
+            }
+        }
+
+        if (running)
+        {
+            claimed |= animation->mask;
+            i++;
+        }
+        else
+        {
+            display->releaseOverlay(animation->mask & ~claimed);
+            animationCount--;
+            for (int j = i; j < animationCount; j++)
+                animations[j] = animations[j + 1];
+        }
+    }
+}
+
+/**
+ * @brief wake the display task after giving it something to draw, ie. an animation or blinking LEDs
+ */
+void display_wake()
+{
+    if (display_task_handle != NULL)
+        xTaskNotifyGive(display_task_handle);
+}
+
+/**
+ * @brief submit an animation to the display task. Never blocks, if the queue is full the animation gets dropped.
+ */
+void display_animate(DisplayAnimation animation)
+{
+    xQueueSend(animation_queue, &animation, 0);
+    display_wake();
+}
 
-        // Perform action here.
-        display->blinkScene();
+/**
+ * @brief light (or erase) each of a channels LEDs one after the other, in a spiral towards the center
+ *
+ * @param chan channel index
+ * @param clockwise direction of the spiral
+ * @param erase start with every LED lit at pwm and turn them off, instead of turning them on
+ * @param pwm brightness
+ * @param speed ms between each LED
+ */
+void display_animate_spiral(int chan, bool clockwise, bool erase, uint8_t pwm, uint16_t speed)
+{
+    DisplayAnimation animation = {};
+    animation.type = AnimationType::SPIRAL;
+    animation.chan = chan;
+    animation.reverse = !clockwise;
+    animation.erase = erase;
+    animation.pwm = pwm;
+    animation.period = speed;
+    animation.mask = Display::channelMask(chan);
+    display_animate(animation);
+}
+
+/**
+ * @brief light (or erase) the outer ring of a channels LEDs one after the other
+ */
+void display_animate_square(int chan, bool erase, uint8_t pwm, uint16_t speed)
+{
+    DisplayAnimation animation = {};
+    animation.type = AnimationType::SQUARE;
+    animation.chan = chan;
+    animation.erase = erase;
+    animation.pwm = pwm;
+    animation.period = speed;
+    for (int i = 0; i < DISPLAY_SQUARE_LENGTH; i++)
+    {
+        animation.mask |= DISPLAY_LED_MASK(CHAN_DISPLAY_LED_MAP[chan][DISPLAY_SQUARE_LED_MAP[i]]);
     }
+    display_animate(animation);
+}
+
+/**
+ * @brief flash a set of LEDs off and on
+ *
+ * @param mask LEDs to flash, ie. DISPLAY_ALL_LEDS_MASK or Display::channelMask()
+ * @param pwm brightness of the LEDs while on
+ * @param flashes how many times to flash
+ * @param speed how long each half of a flash should take, in ms
+ */
+void display_animate_flash(uint64_t mask, uint8_t pwm, int flashes, uint16_t speed)
+{
+    DisplayAnimation animation = {};
+    animation.type = AnimationType::FLASH;
+    animation.mask = mask;
+    animation.pwm = pwm;
+    animation.count = flashes;
+    animation.period = speed;
+    display_animate(animation);
+}
+
+/**
+ * @brief fill the display left to right as some work progresses. Call again as the work progresses, the bar stays on
+ * the display until it has been filled to 100 percent, display_animate_progress_cancel() gets called, or the percentage
+ * stops changing for DISPLAY_PROGRESS_BAR_TIMEOUT.
+ *
+ * @param percent 0..100
+ * @param pwm brightness
+ */
+void display_animate_progress(uint8_t percent, uint8_t pwm)
+{
+    DisplayAnimation animation = {};
+    animation.type = AnimationType::PROGRESS_BAR;
+    animation.mask = DISPLAY_ALL_LEDS_MASK;
+    animation.target = percent > 100 ? 100 : percent;
+    animation.pwm = pwm;
+    animation.period = DISPLAY_PROGRESS_BAR_SPEED;
+    display_animate(animation);
+}
+
+/**
+ * @brief take the progress bar off the display, for work which gets abandoned before reaching 100 percent
+ */
+void display_animate_progress_cancel()
+{
+    DisplayAnimation animation = {};
+    animation.type = AnimationType::PROGRESS_BAR;
+    animation.mask = DISPLAY_ALL_LEDS_MASK;
+    animation.erase = true;
+    display_animate(animation);
+}
+
+/**
+ * @brief light the entire display, then dim it one column at a time
+ *
+ * @param from starting brightness
+ * @param to brightness each column fades to
+ * @param reverse go right to left
+ * @param speed ms between each column
+ */
+void display_animate_column_fade(uint8_t from, uint8_t to, bool reverse, uint16_t speed)
+{
+    DisplayAnimation animation = {};
+    animation.type = AnimationType::COLUMN_FADE;
+    animation.mask = DISPLAY_ALL_LEDS_MASK;
+    animation.pwm = from;
+    animation.target = to;
+    animation.reverse = reverse;
+    animation.period = speed;
+    display_animate(animation);
 }
 
 void dispatch_display_action(DisplayAction action, CHAN channel, uint16_t data)
@@ -48,4 +390,4 @@ void dispatch_display_action_isr(DisplayAction action, CHAN channel, uint16_t da
     // BaseType_t xHigherPriorityTaskWoken = pdFALSE;
     // xTaskNotifyFromISR(display_task_handle, action, eSetValueWithOverwrite, &xHigherPriorityTaskWoken);
     // portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
-}
\ No newline at end of file
+}
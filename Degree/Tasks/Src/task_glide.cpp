@@ -0,0 +1,55 @@
+#include "task_glide.h"
+
+TaskHandle_t glide_task_handle;
+
+// dac1 (the 1v/o outputs) gets its own handle on SPI2 so glide updates can go out via DMA. It shares the bus mutex
+// with the DAC8554 drivers. The DAC8554 latches on the falling edge of SCLK (SPI mode 1).
+SPI glideBus(SPI2_MOSI, NC, SPI2_SCK, 1, DAC1_CS);
+
+static uint8_t frames[CHANNEL_COUNT * DAC8554_FRAME_SIZE];
+
+/**
+ * @brief Steps every running glide at GLIDE_RATE_HZ, woken by TIM6. TIM6 gets started by Glide::setTarget() and
+ * stopped here once every glide has landed.
+ *
+ * All the gliding channels go out in a single DMA transfer, one 24-bit frame each. Every frame but the last only
+ * loads the channels buffer, the last one loads its buffer and then updates all four outputs at the same time.
+ * The values get calculated inside a critical section (a few hundred cycles), the transfer happens outside of it.
+ *
+ * @param params global control
+ */
+void task_glide(void *params)
+{
+    GlobalControl *ctrl = (GlobalControl *)params;
+    glide_task_handle = xTaskGetCurrentTaskHandle();
+    glideBus.init();
+    glideBus.initDMA();
+    while (1)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        int count = 0;
+        taskENTER_CRITICAL();
+        for (int i = 0; i < CHANNEL_COUNT; i++)
+        {
+            VoltPerOctave *output = &ctrl->channels[i]->output;
+            if (output->stepGlide())
+            {
+                uint8_t *frame = &frames[count * DAC8554_FRAME_SIZE];
+                frame[0] = DAC8554_LOAD_BUFFER | DAC8554_CHANNEL_SELECT(i);
+                frame[1] = output->currOutput >> 8;
+                frame[2] = output->currOutput & 0xFF;
+                count++;
+            }
+        }
+        if (count == 0)
+            glide_timer_stop();
+        taskEXIT_CRITICAL();
+
+        if (count > 0)
+        {
+            frames[(count - 1) * DAC8554_FRAME_SIZE] |= DAC8554_LOAD_ALL;
+            glideBus.writeFrames(frames, DAC8554_FRAME_SIZE, count);
+        }
+    }
+}
@@ -1,7 +1,42 @@
 #include "task_interrupt_handler.h"
 
 TaskHandle_t thInterruptHandler;
-QueueHandle_t qhInterruptQueue;
+static okQueue<InputEvent, INPUT_EVENT_QUEUE_LENGTH> interrupt_q;
+QueueHandle_t qhInterruptQueue = interrupt_q.handle;
+
+uint32_t input_events_dropped = 0;
+
+// set when a channels touch event has been posted, cleared once the sequencer has serviced it.
+static volatile bool channelTouchPending[CHANNEL_COUNT] = {false, false, false, false};
+
+static void poll_switches(GlobalControl *ctrl) { ctrl->switches->updateDegreeStates(); }
+static void poll_buttons(GlobalControl *ctrl) { ctrl->pollButtons(); }
+static void poll_touch_pads(GlobalControl *ctrl) { ctrl->pollTouchPads(); }
+
+static void wait_us(uint32_t us)
+{
+    if (us)
+        vTaskDelay(pdMS_TO_TICKS((us + 999) / 1000));
+}
+
+/**
+ * @brief read the IC behind a latched interrupt line until it lets go of the line.
+ *
+ * NOTE: the interrupt lines for the MCP23017s and CAP1208 stay LOW until the IC gets read, so an edge which never got
+ * handled leaves the line stuck LOW with no further falling edge. An edge landing inside the debounce window gets
+ * dispatched as deferred (see InterruptIn::debounce()), so wait that window out before reading, then keep reading,
+ * one debounce window apart, for as long as the line stays asserted.
+ */
+static void poll_input_line(GlobalControl *ctrl, InterruptIn *line, void (*poll)(GlobalControl *))
+{
+    wait_us(line->getDebounceRemaining());
+    poll(ctrl);
+    while (line->read() == LOW)
+    {
+        wait_us(dwt_cycles_to_us(line->_debounce));
+        poll(ctrl);
+    }
+}
 
 /**
  * @brief A task which listens to a queue of interrupt events
@@ -12,28 +47,75 @@ void task_interrupt_handler(void *params)
 {
     GlobalControl *global_control = (GlobalControl *)params;
     thInterruptHandler = xTaskGetCurrentTaskHandle();
-    qhInterruptQueue = xQueueCreate(64, sizeof(uint8_t));
+    trace_register_queue(qhInterruptQueue, "input events");
     logger_log_task_watermark();
-    uint8_t isr_source;
+    InputEvent event;
     while (1)
     {
-        xQueueReceive(qhInterruptQueue, &isr_source, portMAX_DELAY);
-        switch (isr_source)
+        xQueueReceive(qhInterruptQueue, &event, portMAX_DELAY);
+        switch (event.source)
         {
         case ISR_ID_TOGGLE_SWITCHES:
             logger_log("\n### Toggle Switch ISR ###\n");
-            global_control->switches->updateDegreeStates();
+            poll_input_line(global_control, &global_control->switches->ioInterupt, poll_switches);
             break;
         case ISR_ID_TACTILE_BUTTONS:
             logger_log("\n### Tactile Buttons ISR ###\n");
-            global_control->pollButtons();
+            poll_input_line(global_control, &global_control->ioInterrupt, poll_buttons);
             break;
         case ISR_ID_TOUCH_PADS:
             logger_log("\n### Touch Pads ISR ###\n");
-            global_control->pollTouchPads();
+            poll_input_line(global_control, &global_control->touchInterrupt, poll_touch_pads);
+            break;
+        case ISR_ID_CHANNEL_TOUCH:
+            dispatch_sequencer_event((CHAN)event.channel, SEQ::HANDLE_TOUCH, 0);
             break;
         default:
             break;
         }
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief post an input event to the interrupt handler task. Must only be called from an ISR.
+ *
+ * Channel touch events get coalesced: while one is pending for a channel, further interrupts from that channel are
+ * ignored, as the pending event will read the latest touch state anyways. This caps how many touch events can sit in
+ * the sequencer queue at once, so a noisy touch line can never crowd out clock events.
+ *
+ * @param source ISR_ID_XXX
+ * @param pin the interrupt pin which fired
+ * @param channel channel index (only used by per-channel sources)
+ */
+void dispatch_input_event_ISR(uint8_t source, uint8_t pin, uint8_t channel)
+{
+    if (source == ISR_ID_CHANNEL_TOUCH)
+    {
+        if (channelTouchPending[channel])
+            return;
+        channelTouchPending[channel] = true;
+    }
+
+    InputEvent event;
+    event.source = source;
+    event.pin = pin;
+    event.channel = channel;
+    event.timestamp = dwt_get_cycles();
+
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    if (xQueueSendFromISR(qhInterruptQueue, &event, &xHigherPriorityTaskWoken) != pdPASS)
+    {
+        input_events_dropped++;
+        if (source == ISR_ID_CHANNEL_TOUCH)
+            channelTouchPending[channel] = false;
+    }
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/**
+ * @brief allow the next touch interrupt from a channel to be posted. Call this before reading the touch IC.
+ */
+void ack_channel_touch_event(uint8_t channel)
+{
+    channelTouchPending[channel] = false;
+}
@@ -1,7 +1,11 @@
 #include "task_sequence_handler.h"
+#include "task_bender.h"
 
 TaskHandle_t sequencer_task_handle;
-QueueHandle_t sequencer_queue;
+static okQueue<uint32_t, SEQUENCER_QUEUE_LENGTH> sequencer_q;
+QueueHandle_t sequencer_queue = sequencer_q.handle;
+
+static void clear_all_sequences(TouchChannel **channels, SEQ_PLANE plane);
 
 /**
  * @brief Task which listens for a notification from the SuperClock
@@ -12,167 +16,210 @@ void task_sequence_handler(void *params)
 {
     GlobalControl *ctrl = (GlobalControl *)params;
     sequencer_task_handle = xTaskGetCurrentTaskHandle();
-    sequencer_queue = xQueueCreate(96, sizeof(uint32_t));
+    trace_register_queue(sequencer_queue, "sequencer");
     uint32_t event = 0x0;
+
+    TouchChannel *core_channels[SEQ_CORE_MAX_CHANNELS]; // seq_core index -> channel
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+        core_channels[ctrl->channels[i]->sequence.coreIndex] = ctrl->channels[i];
+
     while (1)
     {
         // queue == [advance, advance, advance, clear, advance, freeze, advance, advance ]
         xQueueReceive(sequencer_queue, &event, portMAX_DELAY);
-        CHAN channel = (CHAN)bitwise_slice(event, 24, 8);
-        SEQ action = (SEQ)bitwise_slice(event, 16, 8);
-        uint16_t data = bitwise_slice(event, 0, 16);
+        sequencer_handle_event(ctrl->channels, core_channels, event);
+    }
+}
+
+/**
+ * @brief carry out one event from the sequencer queue. Only ever called by the sequencer task, and by trace_replay
+ * (Degree/Test) which drives the channels with it the same way
+ *
+ * @param channels the channels by CHAN
+ * @param core_channels the channels by seq_core index
+ * @param event | chan | action | data |
+ */
+void sequencer_handle_event(TouchChannel **channels, TouchChannel **core_channels, uint32_t event)
+{
+    CHAN channel = (CHAN)bitwise_slice(event, 24, 8);
+    SEQ action = (SEQ)bitwise_slice(event, 16, 8);
+    uint16_t data = bitwise_slice(event, 0, 16);
+    TRACE(TRACE_SEQ_EVENT, ((uint8_t)channel << 8) | (uint8_t)action);
+#ifdef TRACE_IO_ENABLED
+    // what the buttons and MIDI asked for, so a replay can ask for the same. The clock and touch pads get traced as inputs
+    if (action != SEQ::ADVANCE && action != SEQ::HANDLE_TOUCH && action != SEQ::DISPLAY)
+    {
+        TRACE_IO(TRACE_SEQ_EVENT, ((uint8_t)channel << 8) | (uint8_t)action);
+        TRACE_IO(TRACE_SEQ_DATA, data);
+    }
+#endif
 
-        switch (action)
+    switch (action)
+    {
+    case SEQ::ADVANCE:
+        if (channel == CHAN::ALL)
         {
-        case SEQ::ADVANCE:
-            if (channel == CHAN::ALL)
+            // advance every sequence in one pass, then only visit the channels with something to do on this pulse
+            uint32_t wake = seq_core_advance();
+            while (wake)
             {
-                for (int i = 0; i < CHANNEL_COUNT; i++)
-                {
-                    ctrl->channels[i]->sequence.advance();
-                    ctrl->channels[i]->handleClock();
-                }
-            } else {
-                ctrl->channels[channel]->sequence.advance();
-                ctrl->channels[channel]->handleClock();
+                int i = __builtin_ctz(wake);
+                wake &= wake - 1;
+                core_channels[i]->handleClock();
             }
-            break;
+        } else {
+            channels[channel]->sequence.advance();
+            channels[channel]->handleClock();
+        }
+        break;
+
+    case SEQ::HANDLE_TOUCH:
+        ack_channel_touch_event(channel); // ack before reading IC so no interrupts get missed during the read
+        channels[channel]->touchPads->handleTouch(); // this will trigger either onTouch() or onRelease()
+        break;
+
+    case SEQ::MIDI_NOTE:
+        channels[channel]->handleMidiNote(data >> 8, data & 0xFF);
+        break;
 
-        case SEQ::HANDLE_TOUCH:
-            ctrl->channels[channel]->touchPads->handleTouch(); // this will trigger either onTouch() or onRelease()
-            break;
+    case SEQ::HANDLE_DEGREE:
+        for (int i = 0; i < CHANNEL_COUNT; i++)
+            channels[i]->updateDegrees();
+        break;
 
-        case SEQ::HANDLE_SELECT_PAD:
+    case SEQ::FREEZE:
+        if (channel == CHAN::ALL) {
             for (int i = 0; i < CHANNEL_COUNT; i++)
-            {
-                if (ctrl->touchPads->padIsTouched(i, ctrl->currTouched))
-                {
-                    // you might want to put this into the sequence queue to avoid race conditions
-                    ctrl->channels[i]->selectPadIsTouched = true;
-                }
-                else
-                {
-                    ctrl->channels[i]->selectPadIsTouched = false;
-                    ctrl->channels[i]->armSelectPadRelease = true;
-                }
-            }
-            break;
+                channels[i]->freeze((bool)data);
+        } else {
+            channels[channel]->freeze((bool)data);
+        }
+        break;
 
-        case SEQ::HANDLE_DEGREE:
+    case SEQ::RESET:
+        if (channel == CHAN::ALL)
+        {
+#ifdef TRACE_IO_ENABLED
+            trace_start_oneshot(); // a reset is a repeatable place to start capturing from
+            TRACE_IO(TRACE_INPUT_DEGREES, channels[0]->degreeSwitches->currState); // they only get traced when they move
+#endif
             for (int i = 0; i < CHANNEL_COUNT; i++)
-                ctrl->channels[i]->updateDegrees();
-            break;
-
-        case SEQ::FREEZE:
-            if (channel == CHAN::ALL) {
-                for (int i = 0; i < CHANNEL_COUNT; i++)
-                    ctrl->channels[i]->freeze((bool)data);
-            } else {
-                ctrl->channels[channel]->freeze((bool)data);
-            }
-            break;
+                channels[i]->resetSequence();
+        } else {
+            channels[channel]->resetSequence();
+        }
+        break;
 
-        case SEQ::RESET:
-            if (channel == CHAN::ALL)
-            {
-                for (int i = 0; i < CHANNEL_COUNT; i++)
-                    ctrl->channels[i]->resetSequence();
-            } else {
-                ctrl->channels[channel]->resetSequence();
-            }
-            break;
+    case SEQ::CLEAR_TOUCH:
+        if (channel == CHAN::ALL)
+        {
+            clear_all_sequences(channels, SEQ_PLANE::TOUCH);
+        } else {
+            channels[channel]->sequence.clearAllTouchEvents();
+        }
+        break;
 
-        case SEQ::CLEAR_TOUCH:
-            if (channel == CHAN::ALL)
-            {
-                for (int i = 0; i < CHANNEL_COUNT; i++)
-                {
-                    ctrl->channels[i]->sequence.clearAllTouchEvents();
-                }
-            } else {
-                ctrl->channels[channel]->sequence.clearAllTouchEvents();
-            }
-            break;
+    case SEQ::CLEAR_BEND:
+        if (channel == CHAN::ALL)
+        {
+            clear_all_sequences(channels, SEQ_PLANE::BEND);
+        }
+        else
+        {
+            channels[channel]->sequence.clearAllBendEvents();
+        }
+        break;
 
-        case SEQ::CLEAR_BEND:
-            if (channel == CHAN::ALL)
-            {
-                for (int i = 0; i < CHANNEL_COUNT; i++)
-                {
-                    ctrl->channels[i]->sequence.clearAllBendEvents();
-                }
-            }
-            else
-            {
-                ctrl->channels[channel]->sequence.clearAllBendEvents();
-            }
-            break;
+    case SEQ::UNDO:
+        for (int i = 0; i < CHANNEL_COUNT; i++)
+        {
+            if (channel == CHAN::ALL || i == channel)
+                channels[i]->undoSequence();
+        }
+        break;
 
-        case SEQ::RECORD_ENABLE:
-            for (int i = 0; i < CHANNEL_COUNT; i++)
-                ctrl->channels[i]->enableSequenceRecording();
-            break;
+    case SEQ::REDO:
+        for (int i = 0; i < CHANNEL_COUNT; i++)
+        {
+            if (channel == CHAN::ALL || i == channel)
+                channels[i]->redoSequence();
+        }
+        break;
 
-        case SEQ::RECORD_DISABLE:
-            for (int i = 0; i < CHANNEL_COUNT; i++)
-                ctrl->channels[i]->disableSequenceRecording();
-            break;
-            
-        case SEQ::TOGGLE_MODE:
-            ctrl->channels[channel]->toggleMode();
-            break;
-
-        case SEQ::SET_LENGTH:
-            ctrl->channels[channel]->updateSequenceLength(data);
-            break;
-
-        case SEQ::QUANTIZE:
-            if (channel == CHAN::ALL)
-            {
-                for (int i = 0; i < CHANNEL_COUNT; i++)
-                {
-                    if (ctrl->channels[i]->sequence.containsTouchEvents)
-                    {
-                        ctrl->channels[i]->sequence.quantize();
-                    }
-                }
-            } else {
-                if (ctrl->channels[channel]->sequence.containsTouchEvents)
-                    ctrl->channels[channel]->sequence.quantize();
-            }
-            break;
+    case SEQ::COPY:
+        if (data < CHANNEL_COUNT)
+            channels[channel]->copySequence(channels[data]);
+        break;
 
-        case SEQ::CORRECT:
-            for (int i = 0; i < CHANNEL_COUNT; i++)
-            {
-                // you could just setting the sequence to 0, set any potential gates low. You may miss a note but 🤷‍♂️
+    case SEQ::SONG_APPEND:
+        channels[channel]->appendSequenceToSong();
+        break;
 
-                // if sequence is not on its final PPQN of its step, then trigger all remaining PPQNs in current step until currPPQN == 0
-                if (ctrl->channels[i]->sequence.currStepPosition != 0)
-                {
-                    while (ctrl->channels[i]->sequence.currStepPosition != 0)
-                    {
-                        // incrementing the clock will at least keep the sequence in sync with an external clock
-                        ctrl->channels[i]->sequence.advance();
-                        ctrl->channels[i]->handleClock();
-                    }
-                }
-            }
-            break;
+    case SEQ::SONG_CLEAR:
+        channels[channel]->clearSong();
+        break;
+
+    case SEQ::RECORD_ENABLE:
+        for (int i = 0; i < CHANNEL_COUNT; i++)
+            channels[i]->enableSequenceRecording();
+        break;
+
+    case SEQ::RECORD_DISABLE:
+        for (int i = 0; i < CHANNEL_COUNT; i++)
+            channels[i]->disableSequenceRecording();
+        break;
         
-        // Re-Draw the sequence to the display
-        case SEQ::DISPLAY:
-            if (channel == CHAN::ALL)
+    case SEQ::TOGGLE_MODE:
+        channels[channel]->toggleMode();
+        break;
+
+    case SEQ::SET_LENGTH:
+        channels[channel]->updateSequenceLength(data);
+        break;
+
+    case SEQ::QUANTIZE:
+        // toggles quantized playback, recorded events are left where they are so the amount can be changed afterwards
+        for (int i = 0; i < CHANNEL_COUNT; i++)
+        {
+            if (channel != CHAN::ALL && i != channel)
+                continue;
+            if (channels[i]->sequence.quantizeEnabled)
+                channels[i]->sequence.disableQuantize();
+            else
+                channels[i]->sequence.enableQuantize();
+        }
+        break;
+
+    case SEQ::CORRECT:
+        for (int i = 0; i < CHANNEL_COUNT; i++)
+        {
+            // you could just setting the sequence to 0, set any potential gates low. You may miss a note but 🤷‍♂️
+
+            // if sequence is not on its final PPQN of its step, then trigger all remaining PPQNs in current step until currPPQN == 0
+            if (channels[i]->sequence.currStepPosition != 0)
             {
-                for (int i = 0; i < CHANNEL_COUNT; i++)
+                while (channels[i]->sequence.currStepPosition != 0)
                 {
-                    if (ctrl->channels[i]->sequence.playbackEnabled) ctrl->channels[i]->drawSequenceToDisplay(false);
+                    // incrementing the clock will at least keep the sequence in sync with an external clock
+                    channels[i]->sequence.advance();
+                    channels[i]->handleClock();
                 }
             }
-            else {
-                if (ctrl->channels[channel]->sequence.playbackEnabled) ctrl->channels[channel]->drawSequenceToDisplay(false);
+        }
+        break;
+    
+    // Re-Draw the sequence to the display
+    case SEQ::DISPLAY:
+        if (channel == CHAN::ALL)
+        {
+            for (int i = 0; i < CHANNEL_COUNT; i++)
+            {
+                if (channels[i]->sequence.playbackEnabled) channels[i]->drawSequenceToDisplay(false);
             }
         }
+        else {
+            if (channels[channel]->sequence.playbackEnabled) channels[channel]->drawSequenceToDisplay(false);
+        }
     }
 }
 
@@ -195,9 +242,45 @@ void dispatch_sequencer_event_ISR(CHAN channel, SEQ action, uint16_t position)
 void suspend_sequencer_task()
 {
     vTaskSuspend(sequencer_task_handle);
+    suspend_bender_task();
 }
 
 void resume_sequencer_task()
 {
+    resume_bender_task();
     vTaskResume(sequencer_task_handle);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief clear the touch or bend events of every channel as a single change, so one undo on every channel brings all
+ * of them back. When the undo pool can't hold what gets cleared, the channels' undo history is dropped instead of
+ * keeping an undo which would only restore some of them, and the display flashes to say so
+ */
+static void clear_all_sequences(TouchChannel **channels, SEQ_PLANE plane)
+{
+    int pages = 0;
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+        pages += channels[i]->sequence.history.countPages(plane);
+
+    SeqHistory::beginGroup();
+    bool undoable = SeqHistory::reserve(pages);
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+    {
+        SuperSeq *sequence = &channels[i]->sequence;
+        if (!undoable)
+            sequence->history.clear();
+        if (plane == SEQ_PLANE::TOUCH)
+            sequence->clearAllTouchEvents();
+        else
+            sequence->clearAllBendEvents();
+        if (!undoable)
+            sequence->history.clear(); // the checkpoint the clear just made only holds part of it
+    }
+    SeqHistory::endGroup();
+
+    if (!undoable)
+    {
+        logger_log("\nclear can't be undone, not enough room in the undo pool");
+        display_animate_flash(DISPLAY_ALL_LEDS_MASK, PWM::PWM_HIGH, 3, 100);
+    }
+}
@@ -8,7 +8,8 @@ static const float TUNER_TARGET_FREQUENCIES[3] = {
     PITCH_FREQ_ARR[TUNER_TARGET_FREQ_INDEXES[2]]
 };
 
-QueueHandle_t tuner_queue;
+static okQueue<float, 1> tuner_q;
+QueueHandle_t tuner_queue = tuner_q.handle;
 TaskHandle_t tuner_task_handle;
 
 static void timer_callback() {
@@ -21,7 +22,7 @@ void task_tuner(void *params)
     float sampledFrequency;
     int sampledColumn; // column to illuminate in display when representing the sampled frequency
     bool inTune = false;
-    tuner_queue = xQueueCreate(1, sizeof(float));
+    xQueueReset(tuner_queue); // discard any frequency left over from a previous tuning session
     Callback<void()> cb = callback(timer_callback);
     SoftwareTimer timer;
     timer.attachCallback(cb, 3000, false);
@@ -29,9 +30,9 @@ void task_tuner(void *params)
     {
         // listen for items on queue
         xQueueReceive(tuner_queue, &sampledFrequency, portMAX_DELAY);
-        channel->display->clear();
-        channel->display->setColumn(7, PWM::PWM_HIGH, inTune);
-        channel->display->setColumn(8, PWM::PWM_HIGH, inTune);
+        channel->display->clear(LAYER::MENU);
+        channel->display->setColumn(7, PWM::PWM_HIGH, inTune, LAYER::MENU);
+        channel->display->setColumn(8, PWM::PWM_HIGH, inTune, LAYER::MENU);
 
         // find the closest target frequence relative to incoming frequency
         int index = arr_find_closest_float(const_cast<float *>(TUNER_TARGET_FREQUENCIES), 3, sampledFrequency);
@@ -45,12 +46,12 @@ void task_tuner(void *params)
         {
             if (sampledFrequency > nextFrequency) // indicate
             {
-                channel->display->setColumn(15, PWM::PWM_HIGH, true);
-                channel->display->setColumn(14, PWM::PWM_MID, true);
-                channel->display->setColumn(13, PWM::PWM_LOW, true);
+                channel->display->setColumn(15, PWM::PWM_HIGH, true, LAYER::MENU);
+                channel->display->setColumn(14, PWM::PWM_MID, true, LAYER::MENU);
+                channel->display->setColumn(13, PWM::PWM_LOW, true, LAYER::MENU);
             } else {
                 sampledColumn = map_num_in_range<float>(sampledFrequency, targetFrequency, nextFrequency, 9, 15);
-                channel->display->setColumn(sampledColumn, PWM::PWM_LOW_MID, false);
+                channel->display->setColumn(sampledColumn, PWM::PWM_LOW_MID, false, LAYER::MENU);
             }
             inTune = false;
             timer.reset();
@@ -60,13 +61,13 @@ void task_tuner(void *params)
             if (sampledFrequency < prevFrequency)
             {
                 // definetely blink the LEDs when it reaches this point.
-                channel->display->setColumn(0, PWM::PWM_HIGH, true);
-                channel->display->setColumn(1, PWM::PWM_MID, true);
-                channel->display->setColumn(2, PWM::PWM_LOW, true);
+                channel->display->setColumn(0, PWM::PWM_HIGH, true, LAYER::MENU);
+                channel->display->setColumn(1, PWM::PWM_MID, true, LAYER::MENU);
+                channel->display->setColumn(2, PWM::PWM_LOW, true, LAYER::MENU);
             } else {
                 // maybe increase the blink frequency the closer you get to target?
                 sampledColumn = map_num_in_range<float>(sampledFrequency, prevFrequency, targetFrequency, 0, 7);
-                channel->display->setColumn(sampledColumn, PWM::PWM_LOW_MID, false);
+                channel->display->setColumn(sampledColumn, PWM::PWM_LOW_MID, false, LAYER::MENU);
             }
             inTune = false;
             timer.reset();
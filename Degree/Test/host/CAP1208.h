@@ -0,0 +1,18 @@
+/**
+ * Host stand-in for the CAP1208 touch pad driver (see `make replay`)
+ */
+#pragma once
+
+#include "main.h"
+#include "I2C.h"
+
+class CAP1208
+{
+public:
+    CAP1208(I2C *i2c_ptr) { (void)i2c_ptr; }
+
+    void init() {}
+    bool isConnected() { return true; }
+    uint8_t touched() { return 0; }
+    bool padIsTouched(int pad, uint8_t touched) { return touched & (1 << pad); }
+};
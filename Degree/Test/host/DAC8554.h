@@ -0,0 +1,27 @@
+/**
+ * Host stand-in for the DAC8554 driver (see `make replay`). Writes only get kept, the outputs a replay checks are the
+ * TRACE_IO records written next to each DAC write
+ */
+#pragma once
+
+#include "main.h"
+#include "SPI.h"
+
+class DAC8554
+{
+public:
+    enum Channel
+    {
+        CHAN_A = 0,
+        CHAN_B = 1,
+        CHAN_C = 2,
+        CHAN_D = 3
+    };
+
+    uint16_t values[4] = {0, 0, 0, 0};
+
+    DAC8554(PinName mosi, PinName sck, PinName cs) { (void)mosi; (void)sck; (void)cs; }
+
+    void init() {}
+    void write(Channel chan, uint16_t value) { values[chan] = value; }
+};
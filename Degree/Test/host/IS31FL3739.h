@@ -0,0 +1,17 @@
+/**
+ * Host stand-in for the IS31FL3739 LED matrix driver (see `make replay`)
+ */
+#pragma once
+
+#include "main.h"
+#include "I2C.h"
+
+class IS31FL3739
+{
+public:
+    IS31FL3739(I2C *i2c_ptr) { (void)i2c_ptr; }
+
+    void init() {}
+    void setGlobalCurrent(uint8_t value) { (void)value; }
+    void setPWM(int index, uint8_t value) { (void)index; (void)value; }
+};
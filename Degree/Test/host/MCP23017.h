@@ -0,0 +1,28 @@
+/**
+ * Host stand-in for the MCP23017 IO expander driver (see `make replay`). digitalReadAB() returns whatever the replay
+ * last set
+ */
+#pragma once
+
+#include "main.h"
+#include "I2C.h"
+
+#define MCP23017_PORTA 0x00
+#define MCP23017_PORTB 0x01
+
+class MCP23017
+{
+public:
+    uint16_t state = 0;
+
+    MCP23017(I2C *i2c_ptr, uint8_t address) { (void)i2c_ptr; (void)address; }
+
+    void init() {}
+    bool isConnected() { return true; }
+    void setDirection(int port, uint8_t value) { (void)port; (void)value; }
+    void setPullUp(int port, uint8_t value) { (void)port; (void)value; }
+    void setInputPolarity(int port, uint8_t value) { (void)port; (void)value; }
+    void setInterupt(int port, uint8_t value) { (void)port; (void)value; }
+    uint16_t digitalReadAB() { return state; }
+    int getBitStatus(uint16_t value, int bit) { return value & (1 << bit); }
+};
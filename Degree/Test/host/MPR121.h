@@ -0,0 +1,37 @@
+/**
+ * Host stand-in for the MPR121 touch pad driver (see `make replay`). touched() returns whatever the replay last set,
+ * the touch callbacks get called by the replay directly.
+ */
+#pragma once
+
+#include "main.h"
+#include "I2C.h"
+#include "Callback.h"
+
+class MPR121
+{
+public:
+    enum Address
+    {
+        ADDR_GND = 0x5A,
+        ADDR_VDD = 0x5B,
+        ADDR_SDA = 0x5C,
+        ADDR_SCL = 0x5D
+    };
+
+    uint16_t currTouched = 0;
+
+    MPR121(I2C *i2c_ptr, PinName intPin, Address addr = ADDR_GND) { (void)i2c_ptr; (void)intPin; (void)addr; }
+
+    void init() {}
+    void enable() {}
+    bool isConnected() { return true; }
+    int readInterruptPin() { return 1; }
+    void handleTouch() {}
+    uint16_t touched() { return currTouched; }
+    bool padIsTouched() { return currTouched != 0; }
+    bool padIsTouched(int pad, uint16_t touched) { return touched & (1 << pad); }
+    void attachInterruptCallback(Callback<void()> func) { (void)func; }
+    void attachCallbackTouched(Callback<void(uint8_t pad)> func) { (void)func; }
+    void attachCallbackReleased(Callback<void(uint8_t pad)> func) { (void)func; }
+};
@@ -0,0 +1,33 @@
+/**
+ * Host stand-in for the SX1509 LED driver (see `make replay`). The LEDs aren't part of what a replay checks
+ */
+#pragma once
+
+#include "main.h"
+#include "I2C.h"
+
+class SX1509
+{
+public:
+    enum class ClockSpeed
+    {
+        SLOW,
+        MEDIUM,
+        FAST,
+        ULTRA_FAST
+    };
+
+    SX1509(I2C *i2c_ptr, uint8_t address) { (void)i2c_ptr; (void)address; }
+
+    void init() {}
+    bool isConnected() { return true; }
+    void setBlinkFrequency(ClockSpeed speed) { (void)speed; }
+    void ledConfig(int pin) { (void)pin; }
+    void digitalWrite(int pin, int state) { (void)pin; (void)state; }
+    void setPWM(int pin, int value) { (void)pin; (void)value; }
+    void setOnTime(int pin, int value) { (void)pin; (void)value; }
+    void blinkLED(int pin, int onTime, int offTime, int onIntensity, int offIntensity)
+    {
+        (void)pin; (void)onTime; (void)offTime; (void)onIntensity; (void)offIntensity;
+    }
+};
@@ -0,0 +1,134 @@
+/**
+ * Host stand-in for FreeRTOS (see `make replay`). The replay runs every task's work from a single thread, so nothing
+ * ever blocks: queues and notifications drop what gets sent to them, semaphores and mutexes are always free.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "trace.h"
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+typedef void *TaskHandle_t;
+typedef struct QueueDefinition *QueueHandle_t;
+typedef QueueHandle_t SemaphoreHandle_t;
+typedef void *TimerHandle_t;
+typedef void (*TaskFunction_t)(void *);
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t);
+typedef uint32_t StackType_t;
+typedef struct { int unused; } StaticQueue_t;
+typedef struct { int unused; } StaticSemaphore_t;
+typedef struct { int unused; } StaticTask_t;
+typedef struct { int unused; } StaticTimer_t;
+
+typedef struct
+{
+    TaskHandle_t xHandle;
+    const char *pcTaskName;
+    UBaseType_t xTaskNumber;
+} TaskStatus_t;
+
+typedef enum
+{
+    eNoAction = 0,
+    eSetBits,
+    eIncrement,
+    eSetValueWithOverwrite,
+    eSetValueWithoutOverwrite
+} eNotifyAction;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define portMAX_DELAY 0xFFFFFFFFUL
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define configMINIMAL_STACK_SIZE ((uint16_t)128)
+#define configMAX_PRIORITIES 7
+#define configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY 5
+#define configASSERT(x) host_assert((x), #x, __FILE__, __LINE__)
+#define portYIELD_FROM_ISR(x) ((void)(x))
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+#define taskENTER_CRITICAL_FROM_ISR() 0
+#define taskEXIT_CRITICAL_FROM_ISR(x) ((void)(x))
+#define taskYIELD()
+#define taskSCHEDULER_SUSPENDED 0
+#define taskSCHEDULER_NOT_STARTED 1
+#define taskSCHEDULER_RUNNING 2
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+void host_assert(int condition, const char *expression, const char *file, int line);
+TickType_t xTaskGetTickCount(void);
+
+static inline QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t size, uint8_t *storage, StaticQueue_t *buffer)
+{
+    (void)length; (void)size; (void)storage;
+    return (QueueHandle_t)buffer;
+}
+static inline BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t wait) { (void)queue; (void)item; (void)wait; return pdTRUE; }
+static inline BaseType_t xQueueSendToBack(QueueHandle_t queue, const void *item, TickType_t wait) { (void)queue; (void)item; (void)wait; return pdTRUE; }
+static inline BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *woken) { (void)queue; (void)item; (void)woken; return pdTRUE; }
+static inline BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t wait) { (void)queue; (void)item; (void)wait; return pdFALSE; }
+static inline BaseType_t xQueuePeek(QueueHandle_t queue, void *item, TickType_t wait) { (void)queue; (void)item; (void)wait; return pdFALSE; }
+static inline UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) { (void)queue; return 0; }
+static inline BaseType_t xQueueReset(QueueHandle_t queue) { (void)queue; return pdPASS; }
+static inline void vQueueSetQueueNumber(QueueHandle_t queue, UBaseType_t number) { (void)queue; (void)number; }
+
+static inline SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *buffer) { return (SemaphoreHandle_t)buffer; }
+static inline SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *buffer) { return (SemaphoreHandle_t)buffer; }
+static inline BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t wait) { (void)semaphore; (void)wait; return pdTRUE; }
+static inline BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) { (void)semaphore; return pdTRUE; }
+static inline BaseType_t xSemaphoreTakeFromISR(SemaphoreHandle_t semaphore, BaseType_t *woken) { (void)semaphore; (void)woken; return pdTRUE; }
+static inline BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t *woken) { (void)semaphore; (void)woken; return pdTRUE; }
+static inline void vSemaphoreDelete(SemaphoreHandle_t semaphore) { (void)semaphore; }
+
+static inline TaskHandle_t xTaskGetCurrentTaskHandle(void) { return NULL; }
+static inline TaskHandle_t xTaskCreateStatic(TaskFunction_t function, const char *name, uint32_t stackDepth, void *params, UBaseType_t priority, StackType_t *stack, StaticTask_t *buffer)
+{
+    (void)function; (void)name; (void)stackDepth; (void)params; (void)priority; (void)stack;
+    return (TaskHandle_t)buffer;
+}
+static inline BaseType_t xTaskCreate(TaskFunction_t function, const char *name, uint16_t stackDepth, void *params, UBaseType_t priority, TaskHandle_t *handle)
+{
+    (void)function; (void)name; (void)stackDepth; (void)params; (void)priority;
+    if (handle)
+        *handle = NULL;
+    return pdPASS;
+}
+static inline UBaseType_t uxTaskGetSystemState(TaskStatus_t *tasks, UBaseType_t size, uint32_t *runtime) { (void)tasks; (void)size; (void)runtime; return 0; }
+static inline void vTaskSuspend(TaskHandle_t task) { (void)task; }
+static inline void vTaskResume(TaskHandle_t task) { (void)task; }
+static inline BaseType_t xTaskGetSchedulerState(void) { return taskSCHEDULER_NOT_STARTED; }
+static inline void vTaskDelay(TickType_t ticks) { (void)ticks; }
+static inline void vTaskDelayUntil(TickType_t *previous, TickType_t ticks) { *previous += ticks; }
+static inline void vTaskSuspendAll(void) {}
+static inline BaseType_t xTaskResumeAll(void) { return pdFALSE; }
+static inline BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action) { (void)task; (void)value; (void)action; return pdPASS; }
+static inline BaseType_t xTaskNotifyGive(TaskHandle_t task) { (void)task; return pdPASS; }
+static inline BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action, BaseType_t *woken) { (void)task; (void)value; (void)action; (void)woken; return pdPASS; }
+static inline void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken) { (void)task; (void)woken; }
+static inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait) { (void)clear; (void)wait; return 0; }
+static inline BaseType_t xTaskNotifyWait(uint32_t entry, uint32_t exit, uint32_t *value, TickType_t wait) { (void)entry; (void)exit; (void)wait; if (value) *value = 0; return pdFALSE; }
+
+static inline TimerHandle_t xTimerCreateStatic(const char *name, TickType_t period, UBaseType_t reload, void *id, TimerCallbackFunction_t callback, StaticTimer_t *buffer)
+{
+    (void)name; (void)period; (void)reload; (void)id; (void)callback;
+    return (TimerHandle_t)buffer;
+}
+static inline BaseType_t xTimerStart(TimerHandle_t timer, TickType_t wait) { (void)timer; (void)wait; return pdPASS; }
+static inline BaseType_t xTimerStop(TimerHandle_t timer, TickType_t wait) { (void)timer; (void)wait; return pdPASS; }
+static inline BaseType_t xTimerReset(TimerHandle_t timer, TickType_t wait) { (void)timer; (void)wait; return pdPASS; }
+static inline BaseType_t xTimerChangePeriod(TimerHandle_t timer, TickType_t period, TickType_t wait) { (void)timer; (void)period; (void)wait; return pdPASS; }
+static inline void *pvTimerGetTimerID(TimerHandle_t timer) { (void)timer; return NULL; }
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,222 @@
+/**
+ * Host implementations of everything the replay build links against that talks to hardware, or lives in a source file
+ * the replay doesn't build (see `make replay`). Outputs only show up in the trace, so most of these do nothing.
+ */
+
+#include "host.h"
+#include "TouchChannel.h"
+#include "AnalogHandle.h"
+#include "task_bender.h"
+#include "task_display.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+DWT_Type host_dwt;
+TIM_TypeDef host_tim6;
+uint32_t SystemCoreClock = 180000000;
+FILE *host_log = stderr;
+
+Seqlock<UIState> ui_state;
+
+// same order as main.cpp
+uint16_t AnalogHandle::DMA_BUFFER[ADC_DMA_BUFF_SIZE] = {0};
+uint16_t AnalogHandle::CV_DMA_BUFFER[ADC_CV_DMA_BUFF_SIZE] = {0};
+PinName AnalogHandle::ADC_PINS[ADC_INPUT_COUNT] = {ADC_A, ADC_B, ADC_C, ADC_D, PB_ADC_A, PB_ADC_B, PB_ADC_C, PB_ADC_D, TEMPO_POT};
+
+extern "C" void host_assert(int condition, const char *expression, const char *file, int line)
+{
+    if (condition)
+        return;
+    fprintf(stderr, "%s:%d: assert failed: %s\n", file, line, expression);
+    abort();
+}
+
+extern "C" uint32_t HAL_GetTick(void)
+{
+    return DWT->CYCCNT / (SystemCoreClock / 1000);
+}
+
+extern "C" void HAL_Delay(uint32_t ms)
+{
+    (void)ms;
+}
+
+extern "C" TickType_t xTaskGetTickCount(void)
+{
+    return HAL_GetTick();
+}
+
+/* ---- GPIO ---- */
+
+void DigitalOut::gpio_init(PinName pin, int value)
+{
+    (void)pin;
+    _pin = value;
+}
+
+void DigitalOut::write(int value)
+{
+    _pin = value;
+}
+
+int DigitalOut::read()
+{
+    return _pin;
+}
+
+void InterruptIn::init()
+{
+    _debounce = 0;
+    _lastEdge = 0;
+    _dropped = 0;
+    _deferred = false;
+}
+
+int InterruptIn::read()
+{
+    return 1;
+}
+
+void InterruptIn::fall(Callback<void()> func)
+{
+    fallCallback = func;
+}
+
+void InterruptIn::debounce(uint32_t us)
+{
+    (void)us;
+}
+
+/* ---- tasks the replay drives itself, or doesn't run ---- */
+
+void dispatch_input_event_ISR(uint8_t source, uint8_t pin, uint8_t channel)
+{
+    (void)source; (void)pin; (void)channel;
+}
+
+void ack_channel_touch_event(uint8_t channel)
+{
+    (void)channel;
+}
+
+void suspend_bender_task() {}
+void resume_bender_task() {}
+
+void midi_send_note_on(uint8_t channel, uint8_t note, uint8_t velocity)
+{
+    (void)channel; (void)note; (void)velocity;
+}
+
+void midi_send_note_off(uint8_t channel, uint8_t note)
+{
+    (void)channel; (void)note;
+}
+
+/* ---- display ---- */
+
+uint64_t Display::channelMask(int chan)
+{
+    (void)chan;
+    return 0;
+}
+
+void Display::clear(LAYER layer)
+{
+    (void)layer;
+}
+
+void Display::clear(int chan, LAYER layer)
+{
+    (void)chan; (void)layer;
+}
+
+void Display::setChannelLED(int chan, int index, uint8_t pwm, bool blink, LAYER layer)
+{
+    (void)chan; (void)index; (void)pwm; (void)blink; (void)layer;
+}
+
+void display_animate_spiral(int chan, bool clockwise, bool erase, uint8_t pwm, uint16_t speed)
+{
+    (void)chan; (void)clockwise; (void)erase; (void)pwm; (void)speed;
+}
+
+void display_animate_flash(uint64_t mask, uint8_t pwm, int flashes, uint16_t speed)
+{
+    (void)mask; (void)pwm; (void)flashes; (void)speed;
+}
+
+/* ---- logger, written to host_log straight away ---- */
+
+void logger_log(char const *str)
+{
+    fputs(str, host_log);
+}
+
+void logger_log(int const num)
+{
+    fprintf(host_log, "%d", num);
+}
+
+void logger_log(uint32_t const num)
+{
+    fprintf(host_log, "%u", (unsigned)num);
+}
+
+void logger_log(float const f)
+{
+    fprintf(host_log, "%f", f);
+}
+
+void logger_log(bool const boolean)
+{
+    fputs(boolean ? "true" : "false", host_log);
+}
+
+void logger_log_task_watermark(void) {}
+
+const char *logger_logf_next(const char *fmt, char *conversion)
+{
+    *conversion = 0;
+    while (*fmt)
+    {
+        if (*fmt != '%')
+        {
+            fputc(*fmt++, host_log);
+            continue;
+        }
+        fmt++;
+        if (*fmt == '%')
+        {
+            fputc(*fmt++, host_log);
+            continue;
+        }
+        while (*fmt && strchr("-+ #0123456789.l", *fmt))
+            fmt++;
+        if (*fmt)
+            *conversion = *fmt++;
+        return fmt;
+    }
+    return fmt;
+}
+
+void logger_logf_arg(char conversion, long value)
+{
+    fprintf(host_log, conversion == 'x' ? "%lx" : "%ld", value);
+}
+
+void logger_logf_arg(char conversion, unsigned long value)
+{
+    fprintf(host_log, conversion == 'x' ? "%lx" : "%lu", value);
+}
+
+void logger_logf_arg(char conversion, float value)
+{
+    (void)conversion;
+    fprintf(host_log, "%f", value);
+}
+
+void logger_logf_arg(char conversion, const char *str)
+{
+    (void)conversion;
+    fputs(str, host_log);
+}
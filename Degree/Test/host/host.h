@@ -0,0 +1,10 @@
+/**
+ * The stand-ins in this directory replace the HAL, FreeRTOS and the ok-drivers peripheral drivers, so the channel /
+ * sequencer sources build and run on the host for `make replay`. They sit on the include path ahead of the real ones.
+ */
+#pragma once
+
+#include <stdio.h>
+#include "stm32f4xx_hal.h"
+
+extern FILE *host_log; // where logger output goes, stderr unless the replay is dumping the trace
@@ -0,0 +1,201 @@
+/**
+ * Host stand-in for the STM32 HAL, just enough of it for the sequencer sources to compile with the host compiler (see
+ * `make replay`). Peripherals are plain structs in RAM, nothing behind them does anything.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define __IO volatile
+#define __I volatile const
+#define __STATIC_INLINE static inline
+#define UNUSED(x) ((void)(x))
+
+typedef enum
+{
+    HAL_OK = 0x00U,
+    HAL_ERROR = 0x01U,
+    HAL_BUSY = 0x02U,
+    HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+typedef enum
+{
+    HAL_UNLOCKED = 0x00U,
+    HAL_LOCKED = 0x01U
+} HAL_LockTypeDef;
+
+typedef enum
+{
+    GPIO_PIN_RESET = 0,
+    GPIO_PIN_SET
+} GPIO_PinState;
+
+typedef enum
+{
+    RESET = 0U,
+    SET = !RESET
+} FlagStatus, ITStatus;
+
+typedef enum
+{
+    DISABLE = 0U,
+    ENABLE = !DISABLE
+} FunctionalState;
+
+typedef int IRQn_Type;
+
+#define GPIO_PIN_0 ((uint16_t)0x0001)
+#define GPIO_PIN_1 ((uint16_t)0x0002)
+#define GPIO_PIN_2 ((uint16_t)0x0004)
+#define GPIO_PIN_3 ((uint16_t)0x0008)
+#define GPIO_PIN_4 ((uint16_t)0x0010)
+#define GPIO_PIN_5 ((uint16_t)0x0020)
+#define GPIO_PIN_6 ((uint16_t)0x0040)
+#define GPIO_PIN_7 ((uint16_t)0x0080)
+#define GPIO_PIN_8 ((uint16_t)0x0100)
+#define GPIO_PIN_9 ((uint16_t)0x0200)
+#define GPIO_PIN_10 ((uint16_t)0x0400)
+#define GPIO_PIN_11 ((uint16_t)0x0800)
+#define GPIO_PIN_12 ((uint16_t)0x1000)
+#define GPIO_PIN_13 ((uint16_t)0x2000)
+#define GPIO_PIN_14 ((uint16_t)0x4000)
+#define GPIO_PIN_15 ((uint16_t)0x8000)
+
+#define GPIO_SPEED_FREQ_LOW 0x00000000U
+#define GPIO_SPEED_FREQ_MEDIUM 0x00000001U
+#define GPIO_SPEED_FREQ_HIGH 0x00000002U
+#define GPIO_SPEED_FREQ_VERY_HIGH 0x00000003U
+
+#define ADC_CHANNEL_0 0U
+#define ADC_CHANNEL_1 1U
+#define ADC_CHANNEL_2 2U
+#define ADC_CHANNEL_3 3U
+#define ADC_CHANNEL_4 4U
+#define ADC_CHANNEL_5 5U
+#define ADC_CHANNEL_6 6U
+#define ADC_CHANNEL_7 7U
+#define ADC_CHANNEL_8 8U
+#define ADC_CHANNEL_9 9U
+#define ADC_CHANNEL_10 10U
+#define ADC_CHANNEL_11 11U
+#define ADC_CHANNEL_12 12U
+#define ADC_CHANNEL_13 13U
+#define ADC_CHANNEL_14 14U
+#define ADC_CHANNEL_15 15U
+#define ADC_CHANNEL_16 16U
+#define ADC_CHANNEL_17 17U
+#define ADC_CHANNEL_18 18U
+
+typedef struct
+{
+    __IO uint32_t MODER, OTYPER, OSPEEDR, PUPDR, IDR, ODR, BSRR, LCKR, AFR[2];
+} GPIO_TypeDef;
+
+typedef struct
+{
+    uint32_t Pin, Mode, Pull, Speed, Alternate;
+} GPIO_InitTypeDef;
+
+typedef struct
+{
+    __IO uint32_t CR1, CR2, SMCR, DIER, SR, EGR, CCMR1, CCMR2, CCER, CNT, PSC, ARR, RCR, CCR1, CCR2, CCR3, CCR4;
+} TIM_TypeDef;
+
+typedef struct
+{
+    uint32_t Prescaler, CounterMode, Period, ClockDivision, RepetitionCounter, AutoReloadPreload;
+} TIM_Base_InitTypeDef;
+
+typedef struct
+{
+    TIM_TypeDef *Instance;
+    TIM_Base_InitTypeDef Init;
+} TIM_HandleTypeDef;
+
+typedef struct
+{
+    __IO uint32_t CR1, CR2, OAR1, OAR2, DR, SR1, SR2, CCR, TRISE, FLTR;
+} I2C_TypeDef;
+
+typedef struct
+{
+    uint32_t ClockSpeed, DutyCycle, OwnAddress1, AddressingMode, DualAddressMode, OwnAddress2, GeneralCallMode, NoStretchMode;
+} I2C_InitTypeDef;
+
+typedef struct
+{
+    I2C_TypeDef *Instance;
+    I2C_InitTypeDef Init;
+} I2C_HandleTypeDef;
+
+typedef struct
+{
+    __IO uint32_t CR1, CR2, SR, DR, CRCPR, RXCRCR, TXCRCR, I2SCFGR, I2SPR;
+} SPI_TypeDef;
+
+typedef struct
+{
+    SPI_TypeDef *Instance;
+} SPI_HandleTypeDef;
+
+typedef struct
+{
+    void *Instance;
+} DMA_HandleTypeDef;
+
+typedef struct
+{
+    void *Instance;
+} UART_HandleTypeDef;
+
+typedef struct
+{
+    void *Instance;
+} ADC_HandleTypeDef;
+
+typedef struct
+{
+    __IO uint32_t CTRL, CYCCNT;
+} DWT_Type;
+
+extern DWT_Type host_dwt;
+#define DWT (&host_dwt)
+
+extern TIM_TypeDef host_tim6; // Glide's TIM6, the replay steps the glides while TIM_CR1_CEN is set
+#define TIM6 (&host_tim6)
+#define TIM6_DAC_IRQn 54
+#define TIM_CR1_CEN 0x0001U
+#define TIM_DIER_UIE 0x0001U
+#define TIM_EGR_UG 0x0001U
+#define TIM_SR_UIF 0x0001U
+#define __HAL_RCC_TIM6_CLK_ENABLE()
+
+extern uint32_t SystemCoreClock;
+
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t ms);
+static inline uint32_t HAL_RCC_GetPCLK1Freq(void) { return 45000000U; }
+static inline void HAL_NVIC_SetPriority(IRQn_Type irq, uint32_t preempt, uint32_t sub) { (void)irq; (void)preempt; (void)sub; }
+static inline void HAL_NVIC_EnableIRQ(IRQn_Type irq) { (void)irq; }
+static inline void HAL_NVIC_DisableIRQ(IRQn_Type irq) { (void)irq; }
+
+static inline uint32_t __get_PRIMASK(void) { return 0; }
+static inline void __set_PRIMASK(uint32_t primask) { (void)primask; }
+static inline uint32_t __get_BASEPRI(void) { return 0; }
+static inline uint32_t __get_IPSR(void) { return 0; }
+static inline void __disable_irq(void) {}
+static inline void __enable_irq(void) {}
+static inline void __DSB(void) {}
+static inline void __ISB(void) {}
+static inline void __NOP(void) {}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,566 @@
+/**
+ * Host replay of a TRACE_IO capture (see API/Inc/trace.h). Built with `make replay`, no hardware needed.
+ *
+ * usage: build-test/trace_replay capture.txt > replay.txt
+ *
+ * Plays the inputs of the last trace dump in the capture (clock, touch pads, degree switches, benders, CV and the events
+ * the buttons / MIDI handed the sequencer) back into four TouchChannels, the same way the tasks on the module would,
+ * and prints a trace dump of everything the channels did. The HAL, FreeRTOS and the I2C / SPI drivers get replaced by
+ * the stand-ins in Degree/Test/host, so the outputs only end up in the trace.
+ *
+ * Two replays of the same capture give the same dump, which is what `trace-decode.py --golden` compares against.
+ *
+ * Limits:
+ * - the channels start from power on defaults, not whatever was loaded from flash (calibration, sequences, modes)
+ * - analog inputs only get replayed at the resolution they were traced at (TRACE_ANALOG_THRESHOLD)
+ * - only every TRACE_CLOCK_DIVIDER'th clock pulse is in a capture, the ones in between get spread out evenly
+ * - buttons, the channel select pads and the tempo pot aren't replayed, only the sequencer events they caused
+ */
+
+#include "host.h"
+#include "TouchChannel.h"
+#include "Degrees.h"
+#include "Bender.h"
+#include "Display.h"
+#include "Glide.h"
+#include "task_bender.h"
+#include "task_sequence_handler.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+using namespace DEGREE;
+
+DAC8554 dac1(SPI2_MOSI, SPI2_SCK, DAC1_CS);
+DAC8554 dac2(SPI2_MOSI, SPI2_SCK, DAC2_CS);
+
+DigitalOut globalGate(GLOBAL_GATE_OUT, 0);
+
+MCP23017 toggleSwitches(NULL, MCP23017_DEGREES_ADDR);
+
+MPR121 touchA(NULL, TOUCH_INT_A);
+MPR121 touchB(NULL, TOUCH_INT_B, MPR121::ADDR_VDD);
+MPR121 touchC(NULL, TOUCH_INT_C, MPR121::ADDR_SCL);
+MPR121 touchD(NULL, TOUCH_INT_D, MPR121::ADDR_SDA);
+
+Display display(NULL);
+
+SX1509 ledsA(NULL, SX1509_CHAN_A_ADDR);
+SX1509 ledsB(NULL, SX1509_CHAN_B_ADDR);
+SX1509 ledsC(NULL, SX1509_CHAN_C_ADDR);
+SX1509 ledsD(NULL, SX1509_CHAN_D_ADDR);
+
+Degrees degrees(DEGREES_INT, &toggleSwitches);
+
+Bender benderA(&dac2, DAC8554::CHAN_A, PB_ADC_A);
+Bender benderB(&dac2, DAC8554::CHAN_B, PB_ADC_B);
+Bender benderC(&dac2, DAC8554::CHAN_C, PB_ADC_C);
+Bender benderD(&dac2, DAC8554::CHAN_D, PB_ADC_D);
+
+TouchChannel chanA(0, &display, &touchA, &ledsA, &degrees, &dac1, DAC8554::CHAN_A, &benderA, ADC_A, GATE_OUT_A, &globalGate);
+TouchChannel chanB(1, &display, &touchB, &ledsB, &degrees, &dac1, DAC8554::CHAN_B, &benderB, ADC_B, GATE_OUT_B, &globalGate);
+TouchChannel chanC(2, &display, &touchC, &ledsC, &degrees, &dac1, DAC8554::CHAN_C, &benderC, ADC_C, GATE_OUT_C, &globalGate);
+TouchChannel chanD(3, &display, &touchD, &ledsD, &degrees, &dac1, DAC8554::CHAN_D, &benderD, ADC_D, GATE_OUT_D, &globalGate);
+
+static TouchChannel *channels[CHANNEL_COUNT] = {&chanA, &chanB, &chanC, &chanD};
+static TouchChannel *core_channels[SEQ_CORE_MAX_CHANNELS];
+
+struct Record
+{
+    uint64_t time; // DWT cycles, unwrapped
+    uint16_t event;
+    uint16_t arg;
+};
+
+enum ActionType
+{
+    ACTION_PULSE,     // value = pulse
+    ACTION_TOUCH,     // value = TRACE_INPUT_TOUCH arg
+    ACTION_DEGREES,   // value = switch states
+    ACTION_CV,        // channel, value = CV
+    ACTION_SEQUENCER, // value = sequencer event word
+};
+
+struct Action
+{
+    uint64_t time;
+    int rank;  // breaks ties in time, lower goes first
+    int order; // then the order they were found in
+    ActionType type;
+    int channel;
+    uint32_t value;
+};
+
+struct BendInput
+{
+    uint64_t time;
+    uint16_t bend;
+};
+
+static int ignored[TRACE_USER];
+
+/**
+ * @brief read the records of the last TRACE_BEGIN .. TRACE_END dump in a capture
+ *
+ * @return cpu clock the capture was taken at, 0 if there is no dump
+ */
+static uint32_t read_capture(FILE *file, std::vector<Record> &records)
+{
+    char line[1024];
+    uint32_t hz = 0;
+    bool inDump = false;
+    std::vector<Record> dump;
+    while (fgets(line, sizeof(line), file))
+    {
+        char *start;
+        if ((start = strstr(line, "TRACE_BEGIN")) != NULL)
+        {
+            unsigned long count, clock;
+            if (sscanf(start, "TRACE_BEGIN %lu %lu", &count, &clock) == 2)
+            {
+                dump.clear();
+                hz = clock;
+                inDump = true;
+            }
+        }
+        else if (strstr(line, "TRACE_END"))
+        {
+            if (inDump)
+                records = dump;
+            inDump = false;
+        }
+        else if (inDump && (start = strstr(line, "TRACE ")) != NULL)
+        {
+            char *data = start + 6;
+            while (strlen(data) >= 16 && isxdigit((unsigned char)data[0]))
+            {
+                char field[9];
+                Record record;
+                memcpy(field, data, 8);
+                field[8] = '\0';
+                record.time = strtoul(field, NULL, 16);
+                memcpy(field, data + 8, 4);
+                field[4] = '\0';
+                record.event = strtoul(field, NULL, 16);
+                memcpy(field, data + 12, 4);
+                record.arg = strtoul(field, NULL, 16);
+                dump.push_back(record);
+                data += 16;
+            }
+        }
+    }
+
+    // DWT wraps every 2^32 cycles
+    uint64_t offset = 0;
+    for (size_t i = 1; i < records.size(); i++)
+    {
+        if ((uint32_t)records[i].time + offset < records[i - 1].time)
+            offset += 1ULL << 32;
+        records[i].time += offset;
+    }
+    return records.empty() ? 0 : hz;
+}
+
+/**
+ * @brief work out every clock pulse which fired during the capture. Only every TRACE_CLOCK_DIVIDER'th pulse got
+ * recorded, the rest get filled in between them and timed evenly.
+ *
+ * An external clock input which arrives early resets the pulse count to 0, and the sequencer catches up with a
+ * SEQ::CORRECT (see SuperClock::handleInputCaptureCallback()). The CORRECT gets traced by the sequencer task after the
+ * pulse 0 which follows it got recorded, so it gets moved back to the input capture here. A MIDI clock fires the
+ * pulses it caught up on instead, so nothing gets skipped.
+ */
+static void find_clock_pulses(std::vector<Record> &records, std::vector<Action> &actions)
+{
+    std::vector<Action> pulses;
+    std::vector<bool> timed;
+    int next = -1;
+    const uint16_t correct = ((uint8_t)CHAN::ALL << 8) | (uint8_t)SEQ::CORRECT;
+
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        Record &record = records[i];
+        if (record.event == TRACE_CLOCK_PULSE)
+        {
+            int pulse = record.arg % PPQN;
+            if (next >= 0)
+            {
+                for (; next != pulse; next = (next + 1) % PPQN)
+                {
+                    pulses.push_back({0, 1, 0, ACTION_PULSE, (int)CHAN::ALL, (uint32_t)next});
+                    timed.push_back(false);
+                }
+            }
+            pulses.push_back({record.time, 1, 0, ACTION_PULSE, (int)CHAN::ALL, (uint32_t)pulse});
+            timed.push_back(true);
+            next = (pulse + 1) % PPQN;
+        }
+        else if (record.event == TRACE_CLOCK_INPUT_CAPTURE && next >= 0)
+        {
+            // is this an external clock input? Its CORRECT shows up before the pulse after the next one
+            size_t j;
+            bool external = false;
+            int seen = 0;
+            for (j = i + 1; j < records.size(); j++)
+            {
+                if (records[j].event == TRACE_CLOCK_INPUT_CAPTURE || (records[j].event == TRACE_CLOCK_PULSE && ++seen > 1))
+                    break;
+                if (records[j].event == TRACE_SEQ_EVENT && records[j].arg == correct)
+                {
+                    external = true;
+                    records[j].event = TRACE_NONE; // gets replayed here instead
+                    break;
+                }
+            }
+            if (!external)
+                continue;
+
+            int captured = record.arg;
+            if (captured == PPQN - 1 && pulses.size() >= 2)
+            {
+                // TIM4 halts after the last pulse of a beat, in which case the capture happened after it had fired
+                size_t last = pulses.size() - 1;
+                while (last > 0 && !timed[last])
+                    last--;
+                size_t prev = last;
+                while (prev > 0 && !timed[--prev])
+                    ;
+                if (last != prev && timed[prev])
+                {
+                    uint64_t period = (pulses[last].time - pulses[prev].time) / (last - prev);
+                    uint64_t fired = pulses[last].time + (PPQN - 1 - pulses[last].value) * period;
+                    if (fired <= record.time)
+                        captured = PPQN;
+                }
+            }
+            bool beatDone = next == 0 && pulses.back().value == PPQN - 1; // the last pulse of the beat got recorded
+            for (; next < captured && !beatDone; next++)
+            {
+                pulses.push_back({0, 1, 0, ACTION_PULSE, (int)CHAN::ALL, (uint32_t)next});
+                timed.push_back(false);
+            }
+            next = 0;
+            actions.push_back({record.time, 0, 0, ACTION_SEQUENCER, (int)CHAN::ALL,
+                               ((uint32_t)CHAN::ALL << 24) | ((uint32_t)SEQ::CORRECT << 16)});
+        }
+    }
+
+    // spread the pulses which weren't recorded out evenly between the ones which were
+    uint64_t end = records.back().time;
+    for (size_t i = 0; i < pulses.size(); i++)
+    {
+        if (timed[i])
+            continue;
+        size_t j = i;
+        while (j < pulses.size() && !timed[j])
+            j++;
+        uint64_t from = pulses[i - 1].time; // the first pulse is always a recorded one
+        uint64_t to = j < pulses.size() ? pulses[j].time : end;
+        for (size_t k = i; k < j; k++)
+            pulses[k].time = from + (to - from) * (k - i + 1) / (j - i + 1);
+        i = j;
+    }
+    actions.insert(actions.end(), pulses.begin(), pulses.end());
+}
+
+/**
+ * @brief turn every input record into something to do to the channels
+ */
+static void find_inputs(const std::vector<Record> &records, std::vector<Action> &actions,
+                        std::vector<BendInput> *bends)
+{
+    std::vector<uint64_t> pulseTimes;
+    for (const Action &action : actions)
+    {
+        if (action.type == ACTION_PULSE)
+            pulseTimes.push_back(action.time);
+    }
+    std::sort(pulseTimes.begin(), pulseTimes.end());
+
+    uint64_t lastRelease[CHANNEL_COUNT] = {0};
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        const Record &record = records[i];
+        uint16_t event = record.event;
+        if (event == TRACE_INPUT_TOUCH)
+        {
+            int chan = (record.arg >> 8) & 0x3;
+            if (!(record.arg & 0x80))
+                lastRelease[chan] = record.time;
+            actions.push_back({record.time, 1, 0, ACTION_TOUCH, chan, record.arg});
+        }
+        else if (event == TRACE_INPUT_DEGREES)
+        {
+            actions.push_back({record.time, 1, 0, ACTION_DEGREES, (int)CHAN::ALL, record.arg});
+        }
+        else if (event >= TRACE_INPUT_BENDER && event < TRACE_INPUT_BENDER + CHANNEL_COUNT)
+        {
+            bends[event - TRACE_INPUT_BENDER].push_back({record.time, record.arg});
+        }
+        else if (event >= TRACE_INPUT_CV && event < TRACE_INPUT_CV + CHANNEL_COUNT)
+        {
+            // the CV gets read (and traced) by handleClock() or a release in QUANTIZER mode, so it has to be in place
+            // just before whichever of them read it
+            int chan = event - TRACE_INPUT_CV;
+            auto pulse = std::upper_bound(pulseTimes.begin(), pulseTimes.end(), record.time);
+            uint64_t readAt = pulse == pulseTimes.begin() ? record.time : *(pulse - 1);
+            readAt = std::max(readAt, lastRelease[chan]);
+            actions.push_back({readAt, 0, 0, ACTION_CV, chan, record.arg});
+        }
+        else if (event == TRACE_SEQ_EVENT && i + 1 < records.size() && records[i + 1].event == TRACE_SEQ_DATA)
+        {
+            uint32_t word = ((uint32_t)record.arg << 16) | records[i + 1].arg;
+            actions.push_back({record.time, 1, 0, ACTION_SEQUENCER, (int)(record.arg >> 8), word});
+        }
+        else if (event == TRACE_INPUT_BUTTONS || event == TRACE_INPUT_SELECT || event == TRACE_INPUT_TEMPO)
+        {
+            ignored[event]++;
+        }
+    }
+}
+
+/**
+ * @brief set a CV input to the value it got traced at, by handing its ADC the 12-bit sample which reads back closest
+ */
+static void set_cv(TouchChannel *channel, uint16_t cv)
+{
+    int best = 0;
+    int bestError = 0x10000;
+    for (int sample = 0; sample < 4096; sample++)
+    {
+        channel->adc.sampleReadyCallback(sample);
+        int error = abs((BIT_MAX_16 - (int)channel->adc.read_u16()) - (int)cv); // see TouchChannel::handleCVInput()
+        if (error < bestError)
+        {
+            best = sample;
+            bestError = error;
+        }
+    }
+    channel->adc.sampleReadyCallback(best);
+}
+
+/**
+ * @brief what task_bender does, with each bender held at the bend it was last traced at. See Bender::poll()
+ */
+static void poll_benders(const uint16_t *bend)
+{
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+    {
+        TouchChannel *channel = channels[i];
+        Bender *bender = channel->bender;
+        if (channel->freezeChannel)
+            continue;
+        bender->currBend = bend[i];
+        if (bend[i] == BENDER_DAC_ZERO)
+            bender->currState = Bender::BENDING_IDLE;
+        else
+            bender->currState = bend[i] > BENDER_DAC_ZERO ? Bender::BENDING_UP : Bender::BENDING_DOWN;
+
+        if (bender->isIdle())
+            channel->benderIdleCallback();
+        else
+            channel->benderActiveCallback(bender->currBend);
+        if (bender->currState != bender->prevState)
+        {
+            channel->benderTriStateCallback(bender->currState);
+            bender->prevState = bender->currState;
+        }
+    }
+}
+
+/**
+ * @brief what task_glide does on every TIM6 overflow
+ */
+static void step_glides()
+{
+    int count = 0;
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+    {
+        if (channels[i]->output.stepGlide())
+            count++;
+    }
+    if (count == 0)
+        glide_timer_stop();
+}
+
+static void perform(const Action &action)
+{
+    switch (action.type)
+    {
+    case ACTION_PULSE:
+        TRACE_IO_CLOCK(action.value);
+        sequencer_handle_event(channels, core_channels,
+                               ((uint32_t)CHAN::ALL << 24) | ((uint32_t)SEQ::ADVANCE << 16) | action.value);
+        break;
+
+    case ACTION_TOUCH:
+    {
+        TouchChannel *channel = channels[(action.value >> 8) & 0x3];
+        uint8_t pad = action.value & 0x7F;
+        if (action.value & 0x80)
+        {
+            channel->touchPads->currTouched |= 1 << pad;
+            channel->onTouch(pad);
+        } else {
+            channel->touchPads->currTouched &= ~(1 << pad);
+            channel->onRelease(pad);
+        }
+        break;
+    }
+
+    case ACTION_DEGREES:
+        toggleSwitches.state = action.value;
+        degrees.updateDegreeStates();
+        break;
+
+    case ACTION_CV:
+        set_cv(channels[action.channel], action.value);
+        break;
+
+    case ACTION_SEQUENCER:
+        sequencer_handle_event(channels, core_channels, action.value);
+        break;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: %s capture.txt\n", argv[0]);
+        return 1;
+    }
+    FILE *file = fopen(argv[1], "r");
+    if (!file)
+    {
+        fprintf(stderr, "can't open %s\n", argv[1]);
+        return 1;
+    }
+    std::vector<Record> records;
+    uint32_t hz = read_capture(file, records);
+    fclose(file);
+    if (hz == 0)
+    {
+        fprintf(stderr, "no trace dump found in %s\n", argv[1]);
+        return 1;
+    }
+    SystemCoreClock = hz;
+
+    std::vector<Action> actions;
+    std::vector<BendInput> bends[CHANNEL_COUNT];
+    find_clock_pulses(records, actions);
+    find_inputs(records, actions, bends);
+    for (size_t i = 0; i < actions.size(); i++)
+        actions[i].order = i;
+    std::sort(actions.begin(), actions.end(), [](const Action &a, const Action &b) {
+        if (a.time != b.time)
+            return a.time < b.time;
+        if (a.rank != b.rank)
+            return a.rank < b.rank;
+        return a.order < b.order;
+    });
+
+    // same order as GlobalControl::init(), with nothing loaded from flash
+    uint64_t now = records.front().time;
+    DWT->CYCCNT = (uint32_t)now;
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+    {
+        channels[i]->output.resetVoltageMap(); // the default calibration
+        channels[i]->initOutputs();
+    }
+    degrees.init();
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+    {
+        channels[i]->initLEDs();
+        channels[i]->initTouchPads();
+    }
+    for (int i = 0; i < CHANNEL_COUNT; i++)
+    {
+        channels[i]->init();
+        channels[i]->adc.disableFilter(); // the traced CV is the filtered one
+        channels[i]->bender->currState = Bender::BENDING_IDLE;
+        channels[i]->bender->prevState = Bender::BENDING_IDLE;
+        core_channels[channels[i]->sequence.coreIndex] = channels[i];
+    }
+
+    // the capture started with a reset, and the switches where they were at the time
+    for (const Record &record : records)
+    {
+        if (record.event == TRACE_INPUT_DEGREES)
+        {
+            toggleSwitches.state = record.arg;
+            break;
+        }
+    }
+    degrees.updateDegreeStates();
+    sequencer_handle_event(channels, core_channels, ((uint32_t)CHAN::ALL << 24) | ((uint32_t)SEQ::HANDLE_DEGREE << 16));
+    sequencer_handle_event(channels, core_channels, ((uint32_t)CHAN::ALL << 24) | ((uint32_t)SEQ::RESET << 16));
+
+    const uint64_t benderPeriod = hz / BENDER_CONTROL_RATE_HZ;
+    const uint64_t glidePeriod = hz / GLIDE_RATE_HZ;
+    uint64_t nextPoll = now;
+    uint64_t nextGlide = 0;
+    bool gliding = false;
+    uint16_t bend[CHANNEL_COUNT] = {BENDER_DAC_ZERO, BENDER_DAC_ZERO, BENDER_DAC_ZERO, BENDER_DAC_ZERO};
+    size_t bendIndex[CHANNEL_COUNT] = {0};
+    uint64_t end = records.back().time;
+
+    for (size_t i = 0; i <= actions.size(); i++)
+    {
+        uint64_t until = i < actions.size() ? actions[i].time : end;
+
+        // the tasks which run off timers, up to the next action
+        while (true)
+        {
+            if (!gliding && (TIM6->CR1 & TIM_CR1_CEN))
+            {
+                gliding = true;
+                nextGlide = now + glidePeriod;
+            }
+            uint64_t next = gliding ? std::min(nextPoll, nextGlide) : nextPoll;
+            if (next > until)
+                break;
+            now = next;
+            DWT->CYCCNT = (uint32_t)now;
+            if (now == nextGlide && gliding)
+            {
+                step_glides();
+                nextGlide += glidePeriod;
+                gliding = TIM6->CR1 & TIM_CR1_CEN;
+            }
+            else
+            {
+                // each bend gets used by the poll nearest to where it was traced
+                for (int c = 0; c < CHANNEL_COUNT; c++)
+                {
+                    while (bendIndex[c] < bends[c].size() && bends[c][bendIndex[c]].time <= now + benderPeriod / 2)
+                        bend[c] = bends[c][bendIndex[c]++].bend;
+                }
+                poll_benders(bend);
+                nextPoll += benderPeriod;
+            }
+        }
+        if (i == actions.size())
+            break;
+
+        now = std::max(now, until);
+        DWT->CYCCNT = (uint32_t)now;
+        perform(actions[i]);
+    }
+
+    if (trace_head >= TRACE_BUFFER_SIZE)
+        fprintf(stderr, "trace buffer filled up, the end of the replay is missing\n");
+    static const char *names[] = {"buttons", "select pads", "tempo pot"};
+    static const uint16_t events[] = {TRACE_INPUT_BUTTONS, TRACE_INPUT_SELECT, TRACE_INPUT_TEMPO};
+    for (int i = 0; i < 3; i++)
+    {
+        if (ignored[events[i]])
+            fprintf(stderr, "%d %s inputs not replayed\n", ignored[events[i]], names[i]);
+    }
+
+    host_log = stdout;
+    trace_dump();
+    return 0;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+uint32_t rtos_get_time_us(void);
+uint32_t rtos_get_idle_time_us(void);
+uint8_t rtos_get_idle_percent(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -71,6 +71,7 @@ void EXTI3_IRQHandler(void);
 void EXTI4_IRQHandler(void);
 void EXTI9_5_IRQHandler(void);
 void EXTI15_10_IRQHandler(void);
+void PVD_IRQHandler(void);
 
 #ifdef __cplusplus
 }
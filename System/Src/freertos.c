@@ -25,6 +25,7 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "rtos_stats.h"
 
 /* USER CODE END Includes */
 
@@ -45,17 +46,147 @@
 
 /* Private variables ---------------------------------------------------------*/
 /* USER CODE BEGIN Variables */
+extern TIM_HandleTypeDef htim5; // HAL timebase (1MHz counter, 1ms period)
+
+static volatile uint32_t idle_time_us = 0; // total time the idle task has spent asleep
+static uint32_t sleep_start_us = 0;
+static uint32_t idle_window_start_us = 0;  // start of the current idle % measurement window
+static uint32_t idle_window_idle_us = 0;   // idle_time_us at the start of the current window
+
+static volatile uint32_t runtime_stats_overflows = 0; // upper 16 bits of the run time stats counter (TIM7 is only 16-bit)
 
 /* USER CODE END Variables */
 
 /* Private function prototypes -----------------------------------------------*/
 /* USER CODE BEGIN FunctionPrototypes */
+void vApplicationIdleHook(void);
+void TIM7_IRQHandler(void);
 
 /* USER CODE END FunctionPrototypes */
 
 /* Private application code --------------------------------------------------*/
 /* USER CODE BEGIN Application */
 
+/**
+ * @brief microseconds since boot, derived from the HAL timebase (TIM5 counts 0..999us between HAL ticks)
+ * NOTE: wraps every ~71 minutes, so only compare timestamps via unsigned subtraction
+ */
+uint32_t rtos_get_time_us(void)
+{
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  uint32_t ms = HAL_GetTick();
+  uint32_t us = htim5.Instance->CNT;
+  if (__HAL_TIM_GET_FLAG(&htim5, TIM_FLAG_UPDATE))
+  {
+    // counter has rolled over, but the HAL tick interrupt has not been serviced yet
+    ms += 1;
+    us = htim5.Instance->CNT;
+  }
+  __set_PRIMASK(primask);
+  return (ms * 1000) + us;
+}
+
+uint32_t rtos_get_idle_time_us(void)
+{
+  return idle_time_us;
+}
+
+/**
+ * @brief percentage of time the CPU spent asleep in the idle task since the last time this function was called
+ */
+uint8_t rtos_get_idle_percent(void)
+{
+  uint32_t now = rtos_get_time_us();
+  uint32_t idle = idle_time_us;
+  uint32_t elapsed = now - idle_window_start_us;
+  uint32_t slept = idle - idle_window_idle_us;
+  idle_window_start_us = now;
+  idle_window_idle_us = idle;
+  if (elapsed == 0)
+    return 0;
+  return (uint8_t)(((uint64_t)slept * 100) / elapsed);
+}
+
+/**
+ * @brief Called by the idle task on every iteration. Sleep until the next interrupt.
+ * When the kernel expects to be idle for configEXPECTED_IDLE_TIME_BEFORE_SLEEP ticks or more, the tick gets suppressed
+ * (tickless idle) and Pre/PostSleepProcessing get called instead.
+ *
+ * Interrupts stay masked around the WFI (a pending interrupt still wakes the core), so the ISR which wakes it only
+ * runs after the end timestamp is taken and its run time doesn't get counted as idle.
+ */
+void vApplicationIdleHook(void)
+{
+  __disable_irq();
+  uint32_t start = rtos_get_time_us();
+  __DSB();
+  __WFI();
+  idle_time_us += rtos_get_time_us() - start;
+  __enable_irq();
+}
+
+/**
+ * @brief Configure TIM7 as a free running 1MHz counter for FreeRTOS run time stats.
+ * The 16-bit counter overflows every ~65ms, at which point the update interrupt increments the upper 16 bits.
+ */
+void configureTimerForRunTimeStats(void)
+{
+  __HAL_RCC_TIM7_CLK_ENABLE();
+  uint32_t timclock = 2 * HAL_RCC_GetPCLK1Freq();
+  TIM7->PSC = (timclock / 1000000U) - 1U;
+  TIM7->ARR = 0xFFFF;
+  TIM7->EGR = TIM_EGR_UG;   // load the prescaler
+  TIM7->SR = 0;             // UG sets the update flag, clear it
+  TIM7->DIER = TIM_DIER_UIE;
+  HAL_NVIC_SetPriority(TIM7_IRQn, RTOS_ISR_DEFAULT_PRIORITY, 0);
+  HAL_NVIC_EnableIRQ(TIM7_IRQn);
+  TIM7->CR1 = TIM_CR1_CEN;
+}
+
+unsigned long getRunTimeCounterValue(void)
+{
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  uint32_t high = runtime_stats_overflows;
+  uint32_t low = TIM7->CNT;
+  if (TIM7->SR & TIM_SR_UIF)
+  {
+    // counter has rolled over, but the interrupt has not been serviced yet
+    high += 1;
+    low = TIM7->CNT;
+  }
+  __set_PRIMASK(primask);
+  return (high << 16) | low;
+}
+
+void TIM7_IRQHandler(void)
+{
+  if (TIM7->SR & TIM_SR_UIF)
+  {
+    TIM7->SR = ~TIM_SR_UIF;
+    runtime_stats_overflows++;
+  }
+}
+
+/**
+ * @brief called by portSUPPRESS_TICKS_AND_SLEEP() with interrupts disabled, right before WFI
+ */
+void PreSleepProcessing(uint32_t ulExpectedIdleTime)
+{
+  (void)ulExpectedIdleTime;
+  sleep_start_us = rtos_get_time_us();
+}
+
+/**
+ * @brief called by portSUPPRESS_TICKS_AND_SLEEP() with interrupts disabled, right after waking up
+ */
+void PostSleepProcessing(uint32_t ulExpectedIdleTime)
+{
+  (void)ulExpectedIdleTime;
+  idle_time_us += rtos_get_time_us() - sleep_start_us;
+}
+
 /* USER CODE END Application */
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
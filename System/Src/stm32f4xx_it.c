@@ -234,4 +234,12 @@ void EXTI15_10_IRQHandler(void)
   HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_14);
   HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_15);
 }
+
+/**
+  * @brief This function handles the PVD interrupt through EXTI line 16 (supply brown out, see SessionSnapshot.h).
+  */
+void PVD_IRQHandler(void)
+{
+  HAL_PWR_PVD_IRQHandler();
+}
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,134 @@
+#!/usr/bin/python3
+
+# Runs the benchmark firmware (`make bench`) in Renode and collects the DWT cycle count of every workload, so a change
+# to a hot path can be checked before anything gets flashed. Run via `make bench-run`.
+#
+# usage: python3 bench.py build-bench/ok-bench.elf [--json results.json] [--baseline bench.json] [--threshold 5]
+#        python3 bench.py --capture uart.txt [...]     (parse a capture of the benchmark output instead of running Renode)
+#
+# Renode models the Cortex-M4 cycle counter from the number of instructions executed, so counts are not what the
+# hardware would measure (no flash wait states, no pipeline stalls), but they are repeatable from run to run, which is
+# what catching regressions needs. QEMU doesn't model the STM32F446 (RCC, DMA, DWT), so it can't run this firmware.
+#
+# Exits with 1 if a workload got slower than --threshold percent compared to --baseline, or went missing.
+
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+from optparse import OptionParser
+
+RENODE_SCRIPT = '''
+mach create "ok-bench"
+machine LoadPlatformDescription @platforms/cpus/stm32f4.repl
+machine LoadPlatformDescriptionFromString "dwt: Miscellaneous.DWT @ sysbus 0xE0001000 {{ frequency: {clock} }}"
+sysbus LoadELF @{elf}
+sysbus.usart3 CreateFileBackend @{output} true
+start
+'''
+
+CORE_CLOCK = 180000000
+
+def run_renode(renode, elf, timeout):
+  """runs the firmware until it prints BENCH_END, returns everything it printed over the UART"""
+  workdir = tempfile.mkdtemp(prefix='ok-bench-')
+  script = os.path.join(workdir, 'bench.resc')
+  output = os.path.join(workdir, 'uart.txt')
+  open(script, 'w').write(RENODE_SCRIPT.format(clock=CORE_CLOCK, elf=os.path.abspath(elf), output=output))
+
+  proc = subprocess.Popen([renode, '--disable-xwt', '--console', '-e', 'include @%s' % script],
+                          stdin=subprocess.DEVNULL, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+  text = ''
+  deadline = time.time() + timeout
+  try:
+    while time.time() < deadline and proc.poll() is None:
+      time.sleep(0.5)
+      if os.path.exists(output):
+        text = open(output, 'rb').read().decode('ascii', 'replace')
+        if 'BENCH_END' in text:
+          break
+  finally:
+    proc.kill()
+    proc.wait()
+    shutil.rmtree(workdir, ignore_errors=True)
+
+  if 'BENCH_END' not in text:
+    raise RuntimeError('benchmark did not finish within %d seconds' % timeout)
+  return text
+
+def parse(text):
+  """returns {'firmware', 'clock', 'workloads': {name: {iterations, avg, min, max}}} from the benchmark output"""
+  results = None
+  for line in text.splitlines():
+    fields = line.split()
+    if not fields:
+      continue
+    if fields[0] == 'BENCH_BEGIN':
+      results = {'firmware': fields[1], 'clock': int(fields[2]), 'workloads': {}}
+    elif fields[0] == 'BENCH' and results is not None and len(fields) == 6:
+      iterations, avg, low, high = [int(f) for f in fields[2:]]
+      results['workloads'][fields[1]] = {'iterations': iterations, 'avg': avg, 'min': low, 'max': high}
+    elif fields[0] == 'BENCH_END' and results is not None:
+      return results
+  raise ValueError('no complete BENCH_BEGIN ... BENCH_END block in the benchmark output')
+
+def report(results):
+  print('firmware %s @ %d MHz' % (results['firmware'], results['clock'] // 1000000))
+  print('%-26s %10s %12s %12s %12s' % ('workload', 'iterations', 'avg cycles', 'min', 'max'))
+  for name, w in results['workloads'].items():
+    print('%-26s %10d %12d %12d %12d' % (name, w['iterations'], w['avg'], w['min'], w['max']))
+
+def compare(baseline, results, threshold):
+  """prints how every workload changed against the baseline, returns False if any got slower than threshold (%)"""
+  ok = True
+  print('\n%-26s %12s %12s %9s' % ('workload', 'baseline', 'now', 'change'))
+  for name, before in baseline['workloads'].items():
+    after = results['workloads'].get(name)
+    if after is None:
+      print('%-26s %12d %12s %9s  MISSING' % (name, before['avg'], '-', '-'))
+      ok = False
+      continue
+    change = 100.0 * (after['avg'] - before['avg']) / max(before['avg'], 1)
+    regression = change > threshold
+    ok = ok and not regression
+    print('%-26s %12d %12d %+8.1f%%%s' % (name, before['avg'], after['avg'], change, '  REGRESSION' if regression else ''))
+  for name in results['workloads']:
+    if name not in baseline['workloads']:
+      print('%-26s %12s %12d %9s  NEW' % (name, '-', results['workloads'][name]['avg'], '-'))
+  return ok
+
+def main():
+  parser = OptionParser(usage='%prog [options] ok-bench.elf')
+  parser.add_option('--renode', dest='renode', default='renode', help='path to the renode executable')
+  parser.add_option('--timeout', type='int', dest='timeout', default=120, help='seconds to wait for the benchmarks to finish')
+  parser.add_option('--capture', dest='capture', default=None, help='parse a capture of the UART output instead of running Renode')
+  parser.add_option('--json', dest='json', default=None, help='write the results to a file (use it as a baseline later)')
+  parser.add_option('--baseline', dest='baseline', default=None, help='results to compare against')
+  parser.add_option('--threshold', type='float', dest='threshold', default=5.0,
+                    help='how much slower (%) a workload may get before it counts as a regression (default 5)')
+  (options, args) = parser.parse_args()
+
+  if options.capture:
+    text = open(options.capture, 'rb').read().decode('ascii', 'replace')
+  elif len(args) == 1:
+    text = run_renode(options.renode, args[0], options.timeout)
+  else:
+    parser.error('expected the benchmark ELF, or --capture')
+
+  results = parse(text)
+  report(results)
+
+  if options.json:
+    with open(options.json, 'w') as f:
+      json.dump(results, f, indent=2)
+
+  if options.baseline:
+    baseline = json.load(open(options.baseline))
+    if not compare(baseline, results, options.threshold):
+      sys.exit(1)
+
+if __name__ == '__main__':
+  main()
@@ -0,0 +1,157 @@
+#!/usr/bin/python3
+
+# Decodes tokenized log output (firmware built with LOGGER_TOKENIZED, see API/Inc/logger.h) back into readable text.
+#
+# usage: python3 log-decode.py -e build/ok-degree.elf serial_capture.bin
+#        python3 log-decode.py -e build/ok-degree.elf -p /dev/tty.usbserial -b 115200   (requires pyserial)
+#
+# The format strings are read from the .log_strings section of the ELF, which must be the exact build running on
+# the device. Plain text output (ie. logger_log()) mixed into the stream is passed through untouched.
+
+import sys
+import re
+import struct
+from optparse import OptionParser
+
+TOKEN_MARKER = 0x01
+SPECIFIER = re.compile(r'%([-+ #0-9.]*)l*([diuxfs%])')
+
+def read_log_strings(elf_path):
+  """returns {token: format string} from the .log_strings section of a 32-bit little endian ELF"""
+  data = open(elf_path, 'rb').read()
+  if data[:4] != b'\x7fELF' or data[4] != 1:
+    raise ValueError('%s is not a 32-bit ELF file' % elf_path)
+  e_shoff, = struct.unpack_from('<I', data, 0x20)
+  e_shentsize, e_shnum, e_shstrndx = struct.unpack_from('<HHH', data, 0x2E)
+
+  def section(index):
+    # name, type, flags, addr, offset, size
+    return struct.unpack_from('<IIIIII', data, e_shoff + index * e_shentsize)
+
+  names_offset = section(e_shstrndx)[4]
+  for i in range(e_shnum):
+    name, _, _, addr, offset, size = section(i)
+    end = data.index(b'\0', names_offset + name)
+    if data[names_offset + name:end] != b'.log_strings':
+      continue
+    strings = {}
+    blob = data[offset:offset + size]
+    position = 0
+    while position < len(blob):
+      end = blob.find(b'\0', position)
+      if end < 0:
+        end = len(blob)
+      if end > position:
+        strings[(addr + position) & 0xFFFF] = blob[position:end].decode('utf-8', 'replace')
+      position = end + 1
+    return strings
+  raise ValueError('%s has no .log_strings section, was it built with LOGGER_TOKENIZED?' % elf_path)
+
+class Decoder:
+  def __init__(self, strings):
+    self.strings = strings
+    self.buffer = bytearray()
+
+  def feed(self, data):
+    """consume raw bytes, returns the text that could be decoded so far"""
+    self.buffer += data
+    out = []
+    while self.buffer:
+      if self.buffer[0] != TOKEN_MARKER:
+        end = self.buffer.find(bytes([TOKEN_MARKER]))
+        if end < 0:
+          end = len(self.buffer)
+        out.append(self.buffer[:end].decode('utf-8', 'replace'))
+        del self.buffer[:end]
+        continue
+      result = self.decode_frame(self.buffer)
+      if result is None:
+        break # incomplete frame, wait for more bytes
+      text, length = result
+      out.append(text)
+      del self.buffer[:length]
+    return ''.join(out)
+
+  def decode_frame(self, frame):
+    if len(frame) < 3:
+      return None
+    token = frame[1] | (frame[2] << 8)
+    fmt = self.strings.get(token)
+    if fmt is None:
+      return ('<unknown token 0x%04x>' % token, 3)
+    position = 3
+    text = []
+    last = 0
+    for match in SPECIFIER.finditer(fmt):
+      text.append(fmt[last:match.start()])
+      last = match.end()
+      flags, conversion = match.groups()
+      if conversion == '%':
+        text.append('%')
+        continue
+      if conversion in 'fs':
+        result = self.read_string(frame, position) if conversion == 's' else self.read_float(frame, position)
+      else:
+        result = self.read_varint(frame, position)
+      if result is None:
+        return None
+      value, position = result
+      if conversion in 'di':
+        value = (value >> 1) ^ -(value & 1) # undo zigzag
+        conversion = 'd'
+      elif conversion == 'u':
+        conversion = 'd'
+      text.append(('%' + flags + conversion) % value)
+    text.append(fmt[last:])
+    return (''.join(text), position)
+
+  @staticmethod
+  def read_varint(frame, position):
+    value = 0
+    shift = 0
+    while True:
+      if position >= len(frame):
+        return None
+      byte = frame[position]
+      position += 1
+      value |= (byte & 0x7F) << shift
+      shift += 7
+      if not byte & 0x80:
+        return (value, position)
+
+  @staticmethod
+  def read_float(frame, position):
+    if position + 4 > len(frame):
+      return None
+    return (struct.unpack_from('<f', frame, position)[0], position + 4)
+
+  @staticmethod
+  def read_string(frame, position):
+    if position >= len(frame):
+      return None
+    length = frame[position]
+    if position + 1 + length > len(frame):
+      return None
+    return (frame[position + 1:position + 1 + length].decode('utf-8', 'replace'), position + 1 + length)
+
+if __name__ == '__main__':
+  parser = OptionParser(usage='%prog -e firmware.elf [capture.bin]')
+  parser.add_option('-e', '--elf', dest='elf', help='ELF file the running firmware was built from')
+  parser.add_option('-p', '--port', dest='port', help='read live from a serial port instead of a file')
+  parser.add_option('-b', '--baud', dest='baud', type='int', default=115200, help='serial port baud rate (default 115200)')
+  (options, args) = parser.parse_args()
+
+  if not options.elf:
+    parser.error('an ELF file is required')
+
+  decoder = Decoder(read_log_strings(options.elf))
+
+  if options.port:
+    import serial
+    port = serial.Serial(options.port, options.baud)
+    while True:
+      sys.stdout.write(decoder.feed(port.read(port.in_waiting or 1)))
+      sys.stdout.flush()
+  else:
+    source = open(args[0], 'rb') if args else sys.stdin.buffer
+    sys.stdout.write(decoder.feed(source.read()))
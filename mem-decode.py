@@ -0,0 +1,134 @@
+#!/usr/bin/python3
+
+# Decodes the output of mem_telemetry_dump() (see Degree/Inc/MemTelemetry.h) into a table.
+#
+# usage: python3 mem-decode.py serial_capture.txt [--all] [--csv]
+#
+# The capture can contain any other log output, only lines between MEM_BEGIN and MEM_END are used. By default only the
+# last dump is decoded, --all decodes every dump in the capture (one per status gesture), handy for spotting a stack or
+# queue creeping towards its limit over a long session.
+
+import sys
+import struct
+from optparse import OptionParser
+
+VERSION = 1
+
+WARNINGS = ['heap', 'stack', 'queue', 'events']
+
+# warning margins, same as MemTelemetry.h
+STACK_WARNING = 32 # words left
+QUEUE_WARNING = 75 # % full
+EVENTS_WARNING = 90 # % of max events
+
+def parse(lines):
+  """yields {'tasks', 'queues', 'blob'} for every dump found in lines"""
+  dump = None
+  for line in lines:
+    line = line.strip()
+    if line.startswith('MEM_BEGIN'):
+      dump = {'size': int(line.split()[1]), 'tasks': {}, 'queues': {}, 'blob': ''}
+    elif dump is None:
+      continue
+    elif line.startswith('MEM_TASK'):
+      fields = line.split(None, 2)
+      dump['tasks'][int(fields[1])] = fields[2] if len(fields) > 2 else '?'
+    elif line.startswith('MEM_QUEUE'):
+      fields = line.split(None, 2)
+      dump['queues'][int(fields[1])] = fields[2] if len(fields) > 2 else '?'
+    elif line.startswith('MEM_END'):
+      dump['blob'] = bytes.fromhex(dump['blob'])
+      result = dump
+      dump = None
+      yield result
+    elif line.startswith('MEM '):
+      dump['blob'] += line[4:]
+
+class Reader:
+  def __init__(self, blob):
+    self.blob = blob
+    self.offset = 0
+
+  def read(self, fmt):
+    values = struct.unpack_from('<' + fmt, self.blob, self.offset)
+    self.offset += struct.calcsize('<' + fmt)
+    return values if len(values) > 1 else values[0]
+
+def decode(dump):
+  """turns a dump's blob back into the fields of MemTelemetry"""
+  blob = Reader(dump['blob'])
+  version, task_count, queue_count, channel_count = blob.read('BBBB')
+  if version != VERSION:
+    raise ValueError('unknown telemetry version %d' % version)
+  result = {}
+  result['heap_size'], result['heap_free'], result['heap_min_free'], result['warnings'] = blob.read('IIII')
+  result['tasks'] = []
+  for i in range(task_count):
+    size, free = blob.read('HH')
+    result['tasks'].append((dump['tasks'].get(i, 'task %d' % i), size, free))
+  result['queues'] = []
+  for i in range(1, queue_count + 1):
+    length, waiting, peak = blob.read('HHH')
+    if length:
+      result['queues'].append((dump['queues'].get(i, 'queue %d' % i), length, waiting, peak))
+  result['channels'] = [blob.read('HH') for chan in range(channel_count)]
+  result['max_events'], result['history_pages'], result['history_peak'], result['history_size'] = blob.read('HHHH')
+  return result
+
+def rows(mem):
+  """yields (name, used, size, peak, warning) for every line of the table"""
+  yield ('heap', mem['heap_size'] - mem['heap_min_free'], mem['heap_size'], None, bool(mem['warnings'] & 1))
+  for name, size, free in mem['tasks']:
+    yield ('stack ' + name, size - free, size, None, free < STACK_WARNING)
+  for name, length, waiting, peak in mem['queues']:
+    yield ('queue ' + name, waiting, length, peak, peak * 100 >= length * QUEUE_WARNING)
+  for chan, (events, peak) in enumerate(mem['channels']):
+    yield ('events ' + 'ABCD'[chan], events, mem['max_events'], peak, events * 100 >= mem['max_events'] * EVENTS_WARNING)
+  yield ('undo history', mem['history_pages'], mem['history_size'], mem['history_peak'], False)
+
+def print_table(mem):
+  warnings = [name for bit, name in enumerate(WARNINGS) if mem['warnings'] & (1 << bit)]
+  print('heap free %d / %d, warnings: %s' % (mem['heap_free'], mem['heap_size'], ', '.join(warnings) or 'none'))
+  print('%-20s %8s %8s %8s %6s' % ('', 'used', 'size', 'peak', '%'))
+  for name, used, size, peak, warning in rows(mem):
+    worst = used if peak is None else peak
+    percent = 100.0 * worst / size if size else 0
+    print('%-20s %8d %8d %8s %5.1f%%%s' % (name, used, size, '-' if peak is None else peak, percent,
+                                          '  <-- !!' if warning else ''))
+
+def print_csv(mem, index):
+  for name, used, size, peak, warning in rows(mem):
+    print('%d,%s,%d,%d,%s,%d' % (index, name, used, size, '' if peak is None else peak, warning))
+
+def main():
+  parser = OptionParser(usage='%prog [options] capture.txt')
+  parser.add_option('--all', action='store_true', dest='all', default=False, help='decode every dump, not just the last')
+  parser.add_option('--csv', action='store_true', dest='csv', default=False, help='output comma separated values')
+  (options, args) = parser.parse_args()
+  if len(args) != 1:
+    parser.print_help()
+    sys.exit(1)
+
+  dumps = list(parse(open(args[0], errors='replace')))
+  if not dumps:
+    print('no memory telemetry dump found in %s' % args[0])
+    sys.exit(1)
+  if not options.all:
+    dumps = dumps[-1:]
+
+  if options.csv:
+    print('dump,name,used,size,peak,warning')
+  for index, dump in enumerate(dumps):
+    if len(dump['blob']) != dump['size']:
+      print('dump %d is truncated (%d of %d bytes), skipping' % (index, len(dump['blob']), dump['size']), file=sys.stderr)
+      continue
+    mem = decode(dump)
+    if options.csv:
+      print_csv(mem, index)
+    else:
+      if options.all:
+        print('\n-- dump %d --' % index)
+      print_table(mem)
+
+if __name__ == '__main__':
+  main()
@@ -0,0 +1,104 @@
+#!/usr/bin/python3
+
+# Lists every statically allocated object in RAM (.data / .bss) from the firmware ELF, grouped by what it is used for,
+# so the memory headroom is known exactly. Run via `make ram-budget` after a build.
+#
+# usage: python3 ram-budget.py build/ok-degree.elf [--ram 131072] [--all]
+#
+# Grouping is done by symbol name (see CATEGORIES), so keep task buffers named *Task and queues named *_q.
+
+import re
+import shutil
+import struct
+import subprocess
+from optparse import OptionParser
+
+RAM_SECTIONS = ('.data', '.bss')
+
+# first match wins
+CATEGORIES = [
+  ('task stacks', re.compile(r'(Task|_Stack|_TCB)(\.\d+)?$')),
+  ('queues', re.compile(r'(_q|[qQ]ueue|_queue_\w+)(\.\d+)?$')),
+  ('rtos heap', re.compile(r'^ucHeap')),
+  ('channels / sequences', re.compile(r'^chan[A-D]$')),
+  ('sequence history', re.compile(r'^seq_history_\w+$')),
+  ('sequence patterns', re.compile(r'^seq_pattern_\w+$')),
+  ('logging / trace', re.compile(r'^(ring_buffer|trace_\w+)(\.\d+)?$')),
+]
+
+def read_symbols(elf_path):
+  """returns [(name, size, section)] for every data object in a 32-bit little endian ELF"""
+  data = open(elf_path, 'rb').read()
+  if data[:4] != b'\x7fELF' or data[4] != 1:
+    raise ValueError('%s is not a 32-bit ELF file' % elf_path)
+  e_shoff, = struct.unpack_from('<I', data, 0x20)
+  e_shentsize, e_shnum, e_shstrndx = struct.unpack_from('<HHH', data, 0x2E)
+
+  sections = []
+  for i in range(e_shnum):
+    # name, type, flags, addr, offset, size, link, info, addralign, entsize
+    sections.append(struct.unpack_from('<10I', data, e_shoff + i * e_shentsize))
+
+  def cstring(offset):
+    return data[offset:data.index(b'\0', offset)].decode('ascii', 'replace')
+
+  names_offset = sections[e_shstrndx][4]
+  section_names = [cstring(names_offset + s[0]) for s in sections]
+
+  symbols = []
+  for s in sections:
+    if s[1] != 2: # SHT_SYMTAB
+      continue
+    strings_offset = sections[s[6]][4]
+    for offset in range(s[4], s[4] + s[5], 16):
+      name, value, size, info, other, shndx = struct.unpack_from('<IIIBBH', data, offset)
+      if info & 0xF != 1 or size == 0 or shndx >= len(section_names): # STT_OBJECT only
+        continue
+      if section_names[shndx] in RAM_SECTIONS:
+        symbols.append((cstring(strings_offset + name), size, section_names[shndx]))
+  return symbols
+
+def demangle(names):
+  tool = shutil.which('arm-none-eabi-c++filt') or shutil.which('c++filt')
+  if not tool or not names:
+    return names
+  result = subprocess.run([tool], input='\n'.join(names), capture_output=True, text=True)
+  demangled = result.stdout.splitlines()
+  return demangled if len(demangled) == len(names) else names
+
+def categorize(name):
+  for category, pattern in CATEGORIES:
+    if pattern.search(name):
+      return category
+  return 'other'
+
+if __name__ == '__main__':
+  parser = OptionParser(usage='%prog firmware.elf')
+  parser.add_option('-r', '--ram', dest='ram', type='int', default=128 * 1024, help='total RAM in bytes (default 131072)')
+  parser.add_option('-a', '--all', dest='all', action='store_true', default=False, help='list small objects in "other" too')
+  (options, args) = parser.parse_args()
+  if len(args) != 1:
+    parser.error('an ELF file is required')
+
+  symbols = read_symbols(args[0])
+  names = demangle([s[0] for s in symbols])
+  groups = {}
+  for name, (_, size, section) in zip(names, symbols):
+    groups.setdefault(categorize(name), []).append((size, name, section))
+
+  total = 0
+  for category in [c[0] for c in CATEGORIES] + ['other']:
+    entries = sorted(groups.get(category, []), reverse=True)
+    if not entries:
+      continue
+    subtotal = sum(e[0] for e in entries)
+    total += subtotal
+    print('%-32s %8d bytes' % (category.upper(), subtotal))
+    for size, name, section in entries:
+      if category == 'other' and not options.all and size < 256:
+        continue
+      print('  %-30s %8d  %s' % (name[:30], size, section))
+    print('')
+
+  print('%-32s %8d / %d bytes ( %d %% )' % ('TOTAL STATIC', total, options.ram, 100 * total // options.ram))
+  print('%-32s %8d bytes (main stack, plus anything not in a task)' % ('REMAINING', options.ram - total))
@@ -0,0 +1,252 @@
+#!/usr/bin/python3
+
+# Decodes the output of trace_dump() (see API/Inc/trace.h) into a timeline.
+#
+# usage: python3 trace-decode.py serial_capture.txt [--csv]
+#
+# The capture can contain any other log output, only lines between TRACE_BEGIN and TRACE_END are used.
+#
+# Comparing captures (firmware built with TRACE_IO_ENABLED):
+#   python3 trace-decode.py before.txt --io > before-io.txt   # inputs + outputs, timed relative to the clock
+#   python3 trace-decode.py after.txt --compare before-io.txt # diff the outputs of another capture against it
+#
+# Both captures have to be taken while playing the same thing into the module (an external sequencer driving the clock
+# and CV inputs works best). Outputs are matched by clock pulse, so captures line up as long as they both started from
+# a sequencer reset.
+#
+# Replaying a capture instead (see Degree/Test/trace_replay.cpp):
+#   make replay && build-test/trace_replay capture.txt > golden.txt  # on a known good build
+#   make replay && build-test/trace_replay capture.txt > replay.txt  # after a change
+#   python3 trace-decode.py replay.txt --golden golden.txt
+#
+# A replay plays the inputs of one capture into the channels on the host, so both runs get exactly the same input.
+
+import sys
+from optparse import OptionParser
+
+EVENTS = [
+  'NONE',
+  'TASK_SWITCHED_IN',
+  'TASK_CREATE',
+  'QUEUE_SEND',
+  'QUEUE_SEND_FROM_ISR',
+  'QUEUE_SEND_FAILED',
+  'QUEUE_RECEIVE',
+  'QUEUE_RECEIVE_FAILED',
+  'CLOCK_PULSE',
+  'CLOCK_INPUT_CAPTURE',
+  'SEQ_EVENT',
+  'I2C_BEGIN',
+  'I2C_END',
+  'SPI_BEGIN',
+  'SPI_END',
+  'FLASH_BEGIN',
+  'FLASH_END',
+  'IN_BUTTONS',
+  'IN_TOUCH',
+  'IN_SELECT',
+  'IN_DEGREES',
+  'IN_TEMPO',
+] + ['IN_BENDER_%s' % c for c in 'ABCD'] + ['IN_CV_%s' % c for c in 'ABCD'] \
+  + ['OUT_1VO_%d' % c for c in range(4)] + ['OUT_BEND_%d' % c for c in range(4)] + ['OUT_GATE', 'SEQ_DATA']
+
+IO_FIRST = EVENTS.index('IN_BUTTONS')
+IO_LAST = EVENTS.index('OUT_GATE')
+OUTPUT_FIRST = EVENTS.index('OUT_1VO_0')
+CLOCK_PULSE = EVENTS.index('CLOCK_PULSE')
+PPQN = 96 # only every TRACE_CLOCK_DIVIDER'th pulse is recorded, its arg is the pulse within the quarter note
+
+# must match enum class SEQ in Degree/Tasks/Inc/task_sequence_handler.h
+SEQ_ACTIONS = [
+  'ADVANCE', 'FREEZE', 'RESET', 'CLEAR_TOUCH', 'CLEAR_BEND', 'RECORD_ENABLE', 'RECORD_DISABLE', 'TOGGLE_MODE',
+  'SET_LENGTH', 'QUANTIZE', 'CORRECT', 'HANDLE_TOUCH', 'HANDLE_DEGREE', 'DISPLAY',
+  'UNDO', 'REDO', 'MIDI_NOTE', 'COPY', 'SONG_APPEND', 'SONG_CLEAR',
+]
+
+CHANNELS = ['A', 'B', 'C', 'D', 'ALL']
+
+def parse(lines):
+  """returns (cpu_hz, tasks, queues, records) for the last dump found in lines"""
+  dump = None
+  for line in lines:
+    line = line.strip()
+    if line.startswith('TRACE_BEGIN'):
+      fields = line.split()
+      dump = {'hz': int(fields[2]), 'tasks': {}, 'queues': {}, 'records': []}
+    elif dump is None:
+      continue
+    elif line.startswith('TRACE_TASK'):
+      fields = line.split(None, 2)
+      dump['tasks'][int(fields[1])] = fields[2] if len(fields) > 2 else '?'
+    elif line.startswith('TRACE_QUEUE'):
+      fields = line.split(None, 2)
+      dump['queues'][int(fields[1])] = fields[2] if len(fields) > 2 else '?'
+    elif line.startswith('TRACE_END'):
+      result = dump
+      dump = None
+      yield result
+    elif line.startswith('TRACE '):
+      data = line[6:]
+      for i in range(0, len(data) - 15, 16):
+        record = data[i:i + 16]
+        dump['records'].append((int(record[0:8], 16), int(record[8:12], 16), int(record[12:16], 16)))
+
+def unwrap(records):
+  """DWT cycle counter wraps every 2^32 cycles, records are in chronological order"""
+  offset = 0
+  prev = None
+  for timestamp, event, arg in records:
+    if prev is not None and timestamp < prev:
+      offset += 1 << 32
+    prev = timestamp
+    yield timestamp + offset, event, arg
+
+def describe(event, arg, tasks, queues):
+  name = EVENTS[event] if event < len(EVENTS) else 'USER_%d' % (event - len(EVENTS))
+  if event in (1, 2):
+    detail = tasks.get(arg, 'task %d' % arg)
+  elif 3 <= event <= 7:
+    detail = queues.get(arg, 'queue %d' % arg if arg else 'semaphore/mutex')
+  elif event == 10:
+    chan, action = arg >> 8, arg & 0xFF
+    detail = '%s %s' % (CHANNELS[chan] if chan < len(CHANNELS) else chan,
+                        SEQ_ACTIONS[action] if action < len(SEQ_ACTIONS) else action)
+  elif event == 11:
+    detail = 'addr 0x%02x' % (arg >> 1)
+  elif name == 'IN_BUTTONS':
+    detail = '0x%04x' % arg
+  elif name == 'IN_TOUCH':
+    detail = '%s pad %d %s' % (CHANNELS[(arg >> 8) & 0x3], arg & 0x7F, 'touched' if arg & 0x80 else 'released')
+  elif name == 'IN_SELECT':
+    detail = '0x%02x' % arg
+  elif name == 'IN_DEGREES':
+    detail = '0x%04x' % arg
+  elif name == 'OUT_GATE':
+    detail = '%s %s' % (CHANNELS[(arg >> 8) & 0x3], 'HIGH' if arg & 1 else 'LOW')
+  else:
+    detail = str(arg)
+  return name, detail
+
+def io_timeline(records, hz):
+  """yields (pulse, us since that pulse, name, detail) for every input / output record, starting at the first recorded
+  clock pulse. Pulses count up from the start of the capture"""
+  us_per_cycle = 1e6 / hz
+  pulse = None
+  pulse_time = 0
+  quarter = 0
+  for timestamp, event, arg in records:
+    if event == CLOCK_PULSE:
+      if pulse is not None and arg <= pulse % PPQN:
+        quarter += 1 # wrapped, or a clock input reset the pulse count early
+      pulse = quarter * PPQN + arg
+      pulse_time = timestamp
+      continue
+    if pulse is None or event < IO_FIRST or event > IO_LAST:
+      continue
+    name, detail = describe(event, arg, {}, {})
+    yield pulse, (timestamp - pulse_time) * us_per_cycle, name, detail
+
+def format_io(entry):
+  pulse, offset, name, detail = entry
+  return '%6d %+10.2f us  %-12s %s' % (pulse, offset, name, detail)
+
+def parse_io(lines):
+  """reads back the output of --io"""
+  for line in lines:
+    fields = line.split(None, 4)
+    if len(fields) < 4 or not fields[0].isdigit():
+      continue
+    yield int(fields[0]), float(fields[1].lstrip('+')), fields[3], fields[4].strip() if len(fields) > 4 else ''
+
+def compare(reference, run, tolerance_us):
+  """diff the outputs of two timelines, reference being the one from the --io file or the golden replay. Returns the
+  number of mismatches"""
+  reference = [e for e in reference if EVENTS.index(e[2]) >= OUTPUT_FIRST]
+  run = [e for e in run if EVENTS.index(e[2]) >= OUTPUT_FIRST]
+  errors = 0
+  worst = 0.0
+  total = 0.0
+  for i, (expected, actual) in enumerate(zip(reference, run)):
+    if expected[0] != actual[0] or expected[2:] != actual[2:]:
+      print('output %d differs\n  reference: %s\n  run:       %s' % (i, format_io(expected), format_io(actual)))
+      errors += 1
+      if errors >= 10:
+        print('too many differences, stopping')
+        return errors
+      continue
+    delta = actual[1] - expected[1]
+    total += delta
+    worst = max(worst, abs(delta))
+    if abs(delta) > tolerance_us:
+      print('output %d is %+.2f us off\n  reference: %s\n  run:       %s' % (i, delta, format_io(expected), format_io(actual)))
+      errors += 1
+  if len(reference) != len(run):
+    print('reference has %d outputs, run has %d' % (len(reference), len(run)))
+    errors += 1
+  matched = min(len(reference), len(run))
+  if matched:
+    print('%d outputs compared, mean timing delta %+.2f us, worst %.2f us' % (matched, total / matched, worst))
+  return errors
+
+def main():
+  parser = OptionParser(usage='%prog [options] capture.txt')
+  parser.add_option('--csv', action='store_true', dest='csv', default=False, help='output comma separated values')
+  parser.add_option('--io', action='store_true', dest='io', default=False,
+                    help='only inputs and outputs, timed relative to the last clock pulse')
+  parser.add_option('--compare', dest='compare', default=None,
+                    help='compare outputs against a file written by --io from a capture of the same input')
+  parser.add_option('--golden', dest='golden', default=None,
+                    help='compare outputs against a trace dump from trace_replay on a known good build')
+  parser.add_option('--tolerance', dest='tolerance', type='float', default=100.0,
+                    help='how far (us) an output can drift from the reference (default 100)')
+  (options, args) = parser.parse_args()
+  if len(args) != 1:
+    parser.print_help()
+    sys.exit(1)
+
+  dumps = list(parse(open(args[0], errors='replace')))
+  if not dumps:
+    print('no trace dump found in %s' % args[0])
+    sys.exit(1)
+
+  dump = dumps[-1]
+  records = list(unwrap(dump['records']))
+  if not records:
+    print('trace dump is empty')
+    return
+
+  if options.io or options.compare or options.golden:
+    timeline = list(io_timeline(records, dump['hz']))
+    if options.compare or options.golden:
+      if options.golden:
+        golden = list(parse(open(options.golden, errors='replace')))
+        if not golden:
+          print('no trace dump found in %s' % options.golden)
+          sys.exit(1)
+        reference = list(io_timeline(list(unwrap(golden[-1]['records'])), golden[-1]['hz']))
+      else:
+        reference = list(parse_io(open(options.compare)))
+      errors = compare(reference, timeline, options.tolerance)
+      print('MATCH' if errors == 0 else 'MISMATCH')
+      sys.exit(1 if errors else 0)
+    for entry in timeline:
+      print(format_io(entry))
+    return
+
+  start = records[0][0]
+  us_per_cycle = 1e6 / dump['hz']
+  prev = start
+  if options.csv:
+    print('time_us,delta_us,event,detail')
+  for timestamp, event, arg in records:
+    name, detail = describe(event, arg, dump['tasks'], dump['queues'])
+    t = (timestamp - start) * us_per_cycle
+    delta = (timestamp - prev) * us_per_cycle
+    prev = timestamp
+    if options.csv:
+      print('%.2f,%.2f,%s,%s' % (t, delta, name, detail))
+    else:
+      print('%12.2f us  (+%9.2f)  %-22s %s' % (t, delta, name, detail))
+
+if __name__ == '__main__':
+  main()